@@ -21,7 +21,13 @@
 #include "algo_utils.h"
 #include "xalgo_local.h"
 
+#include <QAtomicInt>
+#include <QBuffer>
 #include <QCryptographicHash>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
 #include <algorithm>
 #include <cstdlib>
 #include <limits>
@@ -102,6 +108,49 @@ qint32 Algo_utils::getReadChunkSize(const XBinary::DATAPROCESS_STATE *pState, qi
     return nBufferSize;
 }
 
+bool Algo_utils::isProcessedWindowFilled(const XBinary::DATAPROCESS_STATE *pState)
+{
+    if (!pState || (pState->nProcessedLimit < 0) || (pState->nProcessedOffset < 0) ||
+        (pState->nProcessedOffset > ((std::numeric_limits<qint64>::max)() - pState->nProcessedLimit))) {
+        return false;
+    }
+
+    return pState->nCountOutput >= (pState->nProcessedOffset + pState->nProcessedLimit);
+}
+
+bool Algo_utils::takeInputSpan(XBinary::DATAPROCESS_STATE *pState, const char **ppData, qint64 *pnSize)
+{
+    QBuffer *pBuffer = qobject_cast<QBuffer *>(pState ? pState->pDeviceInput : nullptr);
+
+    if (!pBuffer || !ppData || !pnSize || pState->bReadError || !pBuffer->isReadable() || (pState->nInputOffset < 0) ||
+        (pState->nCountInput < 0) || (pState->nInputLimit < -1)) {
+        return false;
+    }
+
+    const QByteArray &baData = pBuffer->data();
+    const qint64 nStart = pState->nInputOffset + pState->nCountInput;
+    qint64 nEnd = baData.size();
+
+    if (pState->nInputLimit != -1) {
+        // A member that runs past the buffer is left to the regular reads, which report it
+        if ((pState->nInputOffset > nEnd) || (pState->nInputLimit > nEnd - pState->nInputOffset)) {
+            return false;
+        }
+
+        nEnd = pState->nInputOffset + pState->nInputLimit;
+    }
+
+    if ((nStart > nEnd) || !pBuffer->seek(nEnd)) {
+        return false;
+    }
+
+    *ppData = baData.constData() + nStart;
+    *pnSize = nEnd - nStart;
+    pState->nCountInput += *pnSize;
+
+    return true;
+}
+
 int Algo_utils::ascii85ReadByte(XBinary::DATAPROCESS_STATE *pState)
 {
     if (!pState || !pState->pDeviceInput || (pState->nCountInput < 0) || (pState->nInputLimit < -1) ||
@@ -165,12 +214,21 @@ bool Algo_utils::decompressLZMA(CLzmaDec *pState, XBinary::DATAPROCESS_STATE *pD
     }
 
     QByteArray baPending;
-    baPending.reserve(nBufferSize);
     QByteArray baOutput(nBufferSize, 0);
     qint64 nTotalOutput = 0;
-    bool bInputExhausted = false;
     ELzmaStatus lastStatus = LZMA_STATUS_NOT_FINISHED;
 
+    // A memory-backed input is decoded in place; otherwise it is staged through baPending
+    const char *pSpan = nullptr;
+    qint64 nSpanSize = 0;
+    qint64 nSpanPosition = 0;
+    const bool bSpan = takeInputSpan(pDecompressState, &pSpan, &nSpanSize);
+    bool bInputExhausted = bSpan;
+
+    if (!bSpan) {
+        baPending.reserve(nBufferSize);
+    }
+
     while (XBinary::isPdStructNotCanceled(pPdStruct)) {
         while (!bInputExhausted && (baPending.size() < nBufferSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
             const qint32 nRequest = getReadChunkSize(pDecompressState, nBufferSize - baPending.size());
@@ -198,7 +256,9 @@ bool Algo_utils::decompressLZMA(CLzmaDec *pState, XBinary::DATAPROCESS_STATE *pD
             return false;
         }
 
-        SizeT inProcessed = (SizeT)baPending.size();
+        const char *pInput = bSpan ? (pSpan + nSpanPosition) : baPending.constData();
+        const qint64 nInputSize = bSpan ? qMin(nSpanSize - nSpanPosition, (qint64)0x40000000) : baPending.size();
+        SizeT inProcessed = (SizeT)nInputSize;
         SizeT outProcessed = (SizeT)nBufferSize;
         ELzmaFinishMode finishMode = LZMA_FINISH_ANY;
 
@@ -214,15 +274,21 @@ bool Algo_utils::decompressLZMA(CLzmaDec *pState, XBinary::DATAPROCESS_STATE *pD
         }
 
         ELzmaStatus status = LZMA_STATUS_NOT_SPECIFIED;
-        const SRes ret = X_LzmaDec_DecodeToBuf(pState, (Byte *)baOutput.data(), &outProcessed, (const Byte *)baPending.constData(), &inProcessed,
+        const SRes ret = X_LzmaDec_DecodeToBuf(pState, (Byte *)baOutput.data(), &outProcessed, (const Byte *)pInput, &inProcessed,
                                                finishMode, &status);
-        if ((ret != 0) || (inProcessed > (SizeT)baPending.size()) || (outProcessed > (SizeT)nBufferSize)) {
+        if ((ret != 0) || (inProcessed > (SizeT)nInputSize) || (outProcessed > (SizeT)nBufferSize)) {
             return false;
         }
 
         if (inProcessed > 0) {
-            baPending.remove(0, (qint32)inProcessed);
+            if (bSpan) {
+                nSpanPosition += (qint64)inProcessed;
+            } else {
+                baPending.remove(0, (qint32)inProcessed);
+            }
         }
+
+        const qint64 nPending = bSpan ? (nSpanSize - nSpanPosition) : baPending.size();
         if (outProcessed > 0) {
             if (XBinary::_writeDevice(baOutput.constData(), (qint32)outProcessed, pDecompressState) != (qint32)outProcessed) {
                 return false;
@@ -231,12 +297,17 @@ bool Algo_utils::decompressLZMA(CLzmaDec *pState, XBinary::DATAPROCESS_STATE *pD
         }
 
         lastStatus = status;
-        const bool bBoundedInputConsumed = (pDecompressState->nInputLimit != -1) && bInputExhausted && baPending.isEmpty();
+
+        if (isProcessedWindowFilled(pDecompressState)) {
+            // The requested output window is complete; the rest of the stream is not needed
+            return !pDecompressState->bReadError && !pDecompressState->bWriteError;
+        }
+        const bool bBoundedInputConsumed = (pDecompressState->nInputLimit != -1) && bInputExhausted && (nPending == 0);
         const bool bFinished = (status == LZMA_STATUS_FINISHED_WITH_MARK) ||
                                ((status == LZMA_STATUS_MAYBE_FINISHED_WITHOUT_MARK) && (nExpectedOutput >= 0) &&
                                 (nTotalOutput == nExpectedOutput) && bBoundedInputConsumed);
         if (bFinished) {
-            rewindUnusedInput(pDecompressState, baPending.size());
+            rewindUnusedInput(pDecompressState, nPending);
             baPending.clear();
             break;
         }
@@ -245,7 +316,7 @@ bool Algo_utils::decompressLZMA(CLzmaDec *pState, XBinary::DATAPROCESS_STATE *pD
             // The decoder needs more input. Preserve the pending prefix and
             // refill it; a full buffer or actual EOF with no progress is a
             // malformed/stalled stream.
-            if (bInputExhausted || (baPending.size() >= nBufferSize)) {
+            if (bInputExhausted || (nPending >= nBufferSize)) {
                 return false;
             }
         }
@@ -276,12 +347,21 @@ bool Algo_utils::decompressLZMA2(CLzma2Dec *pState, XBinary::DATAPROCESS_STATE *
     }
 
     QByteArray baPending;
-    baPending.reserve(nBufferSize);
     QByteArray baOutput(nBufferSize, 0);
     qint64 nTotalOutput = 0;
-    bool bInputExhausted = false;
     ELzmaStatus lastStatus = LZMA_STATUS_NOT_FINISHED;
 
+    // A memory-backed input is decoded in place; otherwise it is staged through baPending
+    const char *pSpan = nullptr;
+    qint64 nSpanSize = 0;
+    qint64 nSpanPosition = 0;
+    const bool bSpan = takeInputSpan(pDecompressState, &pSpan, &nSpanSize);
+    bool bInputExhausted = bSpan;
+
+    if (!bSpan) {
+        baPending.reserve(nBufferSize);
+    }
+
     while (XBinary::isPdStructNotCanceled(pPdStruct)) {
         while (!bInputExhausted && (baPending.size() < nBufferSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
             const qint32 nRequest = getReadChunkSize(pDecompressState, nBufferSize - baPending.size());
@@ -309,7 +389,9 @@ bool Algo_utils::decompressLZMA2(CLzma2Dec *pState, XBinary::DATAPROCESS_STATE *
             return false;
         }
 
-        SizeT inProcessed = (SizeT)baPending.size();
+        const char *pInput = bSpan ? (pSpan + nSpanPosition) : baPending.constData();
+        const qint64 nInputSize = bSpan ? qMin(nSpanSize - nSpanPosition, (qint64)0x40000000) : baPending.size();
+        SizeT inProcessed = (SizeT)nInputSize;
         SizeT outProcessed = (SizeT)nBufferSize;
         ELzmaFinishMode finishMode = LZMA_FINISH_ANY;
         if (nExpectedOutput >= 0) {
@@ -324,15 +406,21 @@ bool Algo_utils::decompressLZMA2(CLzma2Dec *pState, XBinary::DATAPROCESS_STATE *
         }
 
         ELzmaStatus status = LZMA_STATUS_NOT_SPECIFIED;
-        const SRes ret = X_Lzma2Dec_DecodeToBuf(pState, (Byte *)baOutput.data(), &outProcessed, (const Byte *)baPending.constData(), &inProcessed,
+        const SRes ret = X_Lzma2Dec_DecodeToBuf(pState, (Byte *)baOutput.data(), &outProcessed, (const Byte *)pInput, &inProcessed,
                                                 finishMode, &status);
-        if ((ret != 0) || (inProcessed > (SizeT)baPending.size()) || (outProcessed > (SizeT)nBufferSize)) {
+        if ((ret != 0) || (inProcessed > (SizeT)nInputSize) || (outProcessed > (SizeT)nBufferSize)) {
             return false;
         }
 
         if (inProcessed > 0) {
-            baPending.remove(0, (qint32)inProcessed);
+            if (bSpan) {
+                nSpanPosition += (qint64)inProcessed;
+            } else {
+                baPending.remove(0, (qint32)inProcessed);
+            }
         }
+
+        const qint64 nPending = bSpan ? (nSpanSize - nSpanPosition) : baPending.size();
         if (outProcessed > 0) {
             if (XBinary::_writeDevice(baOutput.constData(), (qint32)outProcessed, pDecompressState) != (qint32)outProcessed) {
                 return false;
@@ -341,13 +429,18 @@ bool Algo_utils::decompressLZMA2(CLzma2Dec *pState, XBinary::DATAPROCESS_STATE *
         }
 
         lastStatus = status;
+
+        if (isProcessedWindowFilled(pDecompressState)) {
+            return !pDecompressState->bReadError && !pDecompressState->bWriteError;
+        }
+
         if (status == LZMA_STATUS_FINISHED_WITH_MARK) {
-            rewindUnusedInput(pDecompressState, baPending.size());
+            rewindUnusedInput(pDecompressState, nPending);
             baPending.clear();
             break;
         }
 
-        if ((inProcessed == 0) && (outProcessed == 0) && (bInputExhausted || (baPending.size() >= nBufferSize))) {
+        if ((inProcessed == 0) && (outProcessed == 0) && (bInputExhausted || (nPending >= nBufferSize))) {
             return false;
         }
     }
@@ -603,6 +696,272 @@ bool Algo_utils::compressDeflate(XBinary::DATAPROCESS_STATE *pCompressState, XBi
            ((pCompressState->nInputLimit == -1) || (pCompressState->nCountInput == pCompressState->nInputLimit));
 }
 
+namespace {
+
+const qint32 N_DEFLATE_PARALLEL_BLOCK_SIZE = 0x20000;
+const qint32 N_DEFLATE_DICTIONARY_SIZE = 0x8000;
+const qint32 N_DEFLATE_BLOCKS_PER_THREAD = 2;
+
+struct DEFLATE_BLOCKJOB {
+    QByteArray baInput;
+    QByteArray baDictionary;
+    QByteArray baOutput;
+    quint32 nCRC32;
+    bool bLast;
+    bool bValid;
+};
+
+// Every block but the last ends with a sync flush (byte aligned, not final), so the block outputs
+// concatenate into one standard raw deflate stream.
+void deflateCompressBlock(DEFLATE_BLOCKJOB *pJob, int nCompressionLevel)
+{
+    pJob->bValid = false;
+    pJob->nCRC32 = (quint32)z_crc32(0, (const Bytef *)pJob->baInput.constData(), (uInt)pJob->baInput.size());
+
+    z_stream stream = {};
+
+    if (X_deflateInit2(&stream, nCompressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return;
+    }
+
+    if (!pJob->baDictionary.isEmpty() &&
+        (z_deflateSetDictionary(&stream, (const Bytef *)pJob->baDictionary.constData(), (uInt)pJob->baDictionary.size()) != Z_OK)) {
+        X_deflateEnd(&stream);
+        return;
+    }
+
+    pJob->baOutput.resize((qint32)z_deflateBound(&stream, (uLong)pJob->baInput.size()) + 16);
+
+    stream.next_in = (Bytef *)pJob->baInput.data();
+    stream.avail_in = (uInt)pJob->baInput.size();
+
+    const int nFlush = pJob->bLast ? Z_FINISH : Z_SYNC_FLUSH;
+    qint32 nOutputSize = 0;
+
+    while (true) {
+        if (nOutputSize == pJob->baOutput.size()) {
+            pJob->baOutput.resize(pJob->baOutput.size() + 0x1000);
+        }
+
+        stream.next_out = (Bytef *)pJob->baOutput.data() + nOutputSize;
+        stream.avail_out = (uInt)(pJob->baOutput.size() - nOutputSize);
+
+        const int ret = X_deflate(&stream, nFlush);
+
+        nOutputSize = (qint32)(pJob->baOutput.size() - stream.avail_out);
+
+        if ((ret != Z_OK) && (ret != Z_STREAM_END)) {
+            break;
+        }
+
+        if (pJob->bLast ? (ret == Z_STREAM_END) : ((stream.avail_in == 0) && (stream.avail_out != 0))) {
+            pJob->bValid = true;
+            break;
+        }
+    }
+
+    X_deflateEnd(&stream);
+
+    pJob->baOutput.resize(nOutputSize);
+}
+
+void deflateRunBlockJobs(DEFLATE_BLOCKJOB *pJobs, qint32 nNumberOfJobs, QAtomicInt *pNextJob, int nCompressionLevel, XBinary::PDSTRUCT *pPdStruct)
+{
+    while (true) {
+        const qint32 nIndex = pNextJob->fetchAndAddOrdered(1);
+
+        if (nIndex >= nNumberOfJobs) {
+            break;
+        }
+
+        if (XBinary::isPdStructStopped(pPdStruct)) {
+            continue;
+        }
+
+        deflateCompressBlock(&(pJobs[nIndex]), nCompressionLevel);
+    }
+}
+
+class XDeflateBlockWorker : public QRunnable {
+public:
+    XDeflateBlockWorker(DEFLATE_BLOCKJOB *pJobs, qint32 nNumberOfJobs, QAtomicInt *pNextJob, int nCompressionLevel, XBinary::PDSTRUCT *pPdStruct)
+        : m_pJobs(pJobs), m_nNumberOfJobs(nNumberOfJobs), m_pNextJob(pNextJob), m_nCompressionLevel(nCompressionLevel), m_pPdStruct(pPdStruct)
+    {
+    }
+
+    void run() override
+    {
+        deflateRunBlockJobs(m_pJobs, m_nNumberOfJobs, m_pNextJob, m_nCompressionLevel, m_pPdStruct);
+    }
+
+private:
+    DEFLATE_BLOCKJOB *m_pJobs;
+    qint32 m_nNumberOfJobs;
+    QAtomicInt *m_pNextJob;
+    int m_nCompressionLevel;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
+bool deflateReadBlock(XBinary::DATAPROCESS_STATE *pCompressState, QByteArray *pbaBlock)
+{
+    pbaBlock->resize(N_DEFLATE_PARALLEL_BLOCK_SIZE);
+    qint32 nSize = 0;
+
+    while (nSize < N_DEFLATE_PARALLEL_BLOCK_SIZE) {
+        const qint32 nToRead = Algo_utils::getReadChunkSize(pCompressState, N_DEFLATE_PARALLEL_BLOCK_SIZE - nSize);
+        if (nToRead <= 0) break;
+
+        const qint32 nRead = XBinary::_readDevice(pbaBlock->data() + nSize, nToRead, pCompressState);
+        if (nRead < 0) {
+            pCompressState->bReadError = true;
+            break;
+        }
+
+        if (nRead == 0) {
+            if ((pCompressState->nInputLimit != -1) || !pCompressState->pDeviceInput->atEnd()) {
+                pCompressState->bReadError = true;
+            }
+            break;
+        }
+
+        nSize += nRead;
+    }
+
+    pbaBlock->resize(nSize);
+
+    return !pCompressState->bReadError;
+}
+
+bool deflateWriteAll(XBinary::DATAPROCESS_STATE *pCompressState, const char *pData, qint64 nSize, XBinary::PDSTRUCT *pPdStruct)
+{
+    qint64 nWrittenTotal = 0;
+
+    while ((nWrittenTotal < nSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        const qint64 nWritten = pCompressState->pDeviceOutput->write(pData + nWrittenTotal, nSize - nWrittenTotal);
+        if ((nWritten <= 0) || (nWritten > (nSize - nWrittenTotal)) ||
+            (pCompressState->nCountOutput > ((std::numeric_limits<qint64>::max)() - nWritten))) {
+            pCompressState->bWriteError = true;
+            break;
+        }
+        nWrittenTotal += nWritten;
+        pCompressState->nCountOutput += nWritten;
+    }
+
+    return !pCompressState->bWriteError && (nWrittenTotal == nSize);
+}
+
+}  // namespace
+
+bool Algo_utils::compressDeflateParallel(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, int nCompressionLevel, qint32 nNumberOfThreads,
+                                         quint32 *pnCRC32)
+{
+    if (!pCompressState || !pCompressState->pDeviceInput || !pCompressState->pDeviceOutput ||
+        (pCompressState->nInputOffset < 0) || (pCompressState->nInputLimit < -1)) {
+        return false;
+    }
+
+    pCompressState->bReadError = false;
+    pCompressState->bWriteError = false;
+    pCompressState->nCountInput = 0;
+    pCompressState->nCountOutput = 0;
+
+    if (!XBinary::isPdStructNotCanceled(pPdStruct)) return false;
+    if (!pCompressState->pDeviceInput->seek(pCompressState->nInputOffset) &&
+        (pCompressState->pDeviceInput->pos() != pCompressState->nInputOffset)) {
+        pCompressState->bReadError = true;
+        return false;
+    }
+
+    // Appends at the destination's current position, as compressDeflate does
+    if (pCompressState->pDeviceOutput->pos() < 0) {
+        pCompressState->bWriteError = true;
+        return false;
+    }
+
+    if (nNumberOfThreads <= 0) {
+        nNumberOfThreads = QThread::idealThreadCount();
+    }
+
+    nNumberOfThreads = qBound(1, nNumberOfThreads, 64);
+
+    const qint32 nBatchSize = nNumberOfThreads * N_DEFLATE_BLOCKS_PER_THREAD;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, nNumberOfThreads - 1));
+
+    QVector<DEFLATE_BLOCKJOB> vecJobs;
+    QByteArray baPending;
+    QByteArray baDictionary;
+    quint32 nCRC32 = 0;
+    bool bFinished = false;
+    bool bError = !deflateReadBlock(pCompressState, &baPending);
+
+    while (!bError && !bFinished && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        vecJobs.clear();
+
+        // One block of read-ahead tells whether the current block is the last one
+        while (!bError && (vecJobs.size() < nBatchSize)) {
+            DEFLATE_BLOCKJOB job = {};
+            job.baInput = baPending;
+            job.baDictionary = baDictionary;
+
+            if (baPending.size() >= N_DEFLATE_DICTIONARY_SIZE) {
+                baDictionary = baPending.right(N_DEFLATE_DICTIONARY_SIZE);
+            } else {
+                baDictionary = (baDictionary + baPending).right(N_DEFLATE_DICTIONARY_SIZE);
+            }
+
+            baPending.clear();
+            bError = !deflateReadBlock(pCompressState, &baPending);
+            job.bLast = baPending.isEmpty();
+
+            vecJobs.append(job);
+
+            if (job.bLast) break;
+        }
+
+        if (bError) break;
+
+        const qint32 nNumberOfJobs = vecJobs.size();
+
+        {
+            QAtomicInt nNextJob(0);
+            DEFLATE_BLOCKJOB *pJobs = vecJobs.data();
+            const qint32 nNumberOfWorkers = qMin(nNumberOfThreads, nNumberOfJobs) - 1;
+
+            for (qint32 i = 0; i < nNumberOfWorkers; i++) {
+                threadPool.start(new XDeflateBlockWorker(pJobs, nNumberOfJobs, &nNextJob, nCompressionLevel, pPdStruct));
+            }
+
+            deflateRunBlockJobs(pJobs, nNumberOfJobs, &nNextJob, nCompressionLevel, pPdStruct);
+
+            threadPool.waitForDone();
+        }
+
+        for (qint32 i = 0; (i < nNumberOfJobs) && !bError; i++) {
+            const DEFLATE_BLOCKJOB &job = vecJobs.at(i);
+
+            if (!job.bValid || !deflateWriteAll(pCompressState, job.baOutput.constData(), job.baOutput.size(), pPdStruct)) {
+                bError = true;
+                break;
+            }
+
+            nCRC32 = (quint32)z_crc32_combine(nCRC32, job.nCRC32, (z_off_t)job.baInput.size());
+
+            if (job.bLast) {
+                bFinished = true;
+            }
+        }
+    }
+
+    if (pnCRC32) {
+        *pnCRC32 = nCRC32;
+    }
+
+    return bFinished && !bError && !pCompressState->bReadError && !pCompressState->bWriteError && XBinary::isPdStructNotCanceled(pPdStruct) &&
+           ((pCompressState->nInputLimit == -1) || (pCompressState->nCountInput == pCompressState->nInputLimit));
+}
+
 bool Algo_utils::getUclMethodFromState(const XBinary::DATAPROCESS_STATE *pDecompressState, XUCLDecoder::METHOD *pMethod)
 {
     QVariant vMethod = pDecompressState->mapProperties.value(XBinary::FPART_PROP_TYPE);
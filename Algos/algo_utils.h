@@ -41,6 +41,12 @@ public:
     static void seekToStart(XBinary::DATAPROCESS_STATE *pState);
     static void prepareState(XBinary::DATAPROCESS_STATE *pState);
     static qint32 getReadChunkSize(const XBinary::DATAPROCESS_STATE *pState, qint32 nBufferSize);
+    // Rest of the input as one pointer when the input device is an in-memory QBuffer (mapped
+    // file members arrive this way). The span counts as read, like a _readDevice() of that size
+    static bool takeInputSpan(XBinary::DATAPROCESS_STATE *pState, const char **ppData, qint64 *pnSize);
+    // True once a bounded output window (nProcessedOffset/nProcessedLimit) has been written in full;
+    // a decoder may stop there instead of decoding the rest of the member
+    static bool isProcessedWindowFilled(const XBinary::DATAPROCESS_STATE *pState);
 
     static int ascii85ReadByte(XBinary::DATAPROCESS_STATE *pState);
     static bool ascii85WriteBytes(XBinary::DATAPROCESS_STATE *pState, const unsigned char *pBuffer, int nSize);
@@ -57,6 +63,9 @@ public:
     static unsigned deflate64ReadFunc(void *pInDesc, unsigned char **ppBuffer);
     static int deflate64WriteFunc(void *pOutDesc, unsigned char *pBuffer, unsigned nSize);
     static bool compressDeflate(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, int nCompressionLevel, int nWindowBits);
+    // Raw deflate only. Blocks are compressed independently with the previous 32 KB as dictionary
+    static bool compressDeflateParallel(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, int nCompressionLevel, qint32 nNumberOfThreads,
+                                        quint32 *pnCRC32 = nullptr);
 
     static bool getUclMethodFromState(const XBinary::DATAPROCESS_STATE *pDecompressState, XUCLDecoder::METHOD *pMethod);
     static bool readInputData(XBinary::DATAPROCESS_STATE *pDecompressState, QByteArray *pbaInput, XBinary::PDSTRUCT *pPdStruct);
@@ -1889,6 +1889,208 @@ save_state_and_return:
 
 #include <new>
 
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+namespace {
+
+const quint64 N_BZIP2_BLOCK_MAGIC = 0x314159265359ULL;
+const quint64 N_BZIP2_EOS_MAGIC = 0x177245385090ULL;
+const quint64 N_BZIP2_MAGIC_MASK = 0xFFFFFFFFFFFFULL;
+// Below this the serial state machine is faster than splitting.
+const qint64 N_BZIP2_PARALLEL_MIN_INPUT = 0x100000;
+// 900k symbols of at most 20 bits plus the coding tables.
+const qint64 N_BZIP2_MAX_BLOCK_INPUT = 0x280000;
+// 900k bytes of RLE1 runs expand at most 259/5.
+const qint32 N_BZIP2_MAX_BLOCK_OUTPUT = 0x3000000;
+const qint32 N_BZIP2_BLOCKS_PER_THREAD = 4;
+
+struct BZIP2_BLOCKJOB {
+    qint64 nBitStart;
+    qint64 nBitEnd;
+    quint32 nBlockCRC;
+    bool bValid;
+    bool bTooLarge;
+    QByteArray baOutput;
+};
+
+quint32 bzip2ReadBits(const QByteArray &baData, qint64 nBitOffset, qint32 nCount)
+{
+    quint32 nResult = 0;
+    const uchar *pData = (const uchar *)baData.constData();
+
+    for (qint32 i = 0; i < nCount; i++) {
+        const qint64 nBit = nBitOffset + i;
+        nResult = (nResult << 1) | ((pData[nBit >> 3] >> (7 - (nBit & 7))) & 1);
+    }
+
+    return nResult;
+}
+
+// A single block re-packed as a byte-aligned stream: header, block, end marker and a combined CRC
+// equal to the block CRC, so the embedded decoder validates the block without any changes.
+QByteArray bzip2BuildBlockStream(const QByteArray &baData, char cLevel, qint64 nBitStart, qint64 nBitEnd, quint32 nBlockCRC)
+{
+    const qint64 nBits = nBitEnd - nBitStart;
+    const qint64 nTotalBits = 32 + nBits + 48 + 32;
+
+    QByteArray baResult((qint32)((nTotalBits + 7) / 8), 0);
+    uchar *pOut = (uchar *)baResult.data();
+    const uchar *pIn = (const uchar *)baData.constData();
+    const qint64 nInSize = baData.size();
+
+    pOut[0] = BZ_HDR_B;
+    pOut[1] = BZ_HDR_Z;
+    pOut[2] = BZ_HDR_h;
+    pOut[3] = (uchar)cLevel;
+
+    const qint64 nByteStart = nBitStart >> 3;
+    const qint32 nShift = (qint32)(nBitStart & 7);
+    const qint64 nFullBytes = nBits >> 3;
+
+    for (qint64 i = 0; i < nFullBytes; i++) {
+        quint32 nValue = (quint32)pIn[nByteStart + i] << nShift;
+
+        if (nShift && (nByteStart + i + 1 < nInSize)) {
+            nValue |= pIn[nByteStart + i + 1] >> (8 - nShift);
+        }
+
+        pOut[4 + i] = (uchar)nValue;
+    }
+
+    qint64 nOutBit = 32 + nFullBytes * 8;
+
+    for (qint64 nBit = nBitStart + nFullBytes * 8; nBit < nBitEnd; nBit++, nOutBit++) {
+        if ((pIn[nBit >> 3] >> (7 - (nBit & 7))) & 1) pOut[nOutBit >> 3] |= (uchar)(0x80 >> (nOutBit & 7));
+    }
+
+    for (qint32 i = 47; i >= 0; i--, nOutBit++) {
+        if ((N_BZIP2_EOS_MAGIC >> i) & 1) pOut[nOutBit >> 3] |= (uchar)(0x80 >> (nOutBit & 7));
+    }
+
+    for (qint32 i = 31; i >= 0; i--, nOutBit++) {
+        if ((nBlockCRC >> i) & 1) pOut[nOutBit >> 3] |= (uchar)(0x80 >> (nOutBit & 7));
+    }
+
+    return baResult;
+}
+
+void bzip2DecodeBlock(const QByteArray &baData, char cLevel, BZIP2_BLOCKJOB *pJob)
+{
+    pJob->bValid = false;
+    pJob->bTooLarge = (pJob->nBitEnd - pJob->nBitStart) > (N_BZIP2_MAX_BLOCK_INPUT * 8);
+    pJob->baOutput.clear();
+
+    if (pJob->bTooLarge) {
+        return;
+    }
+
+    QByteArray baStream = bzip2BuildBlockStream(baData, cLevel, pJob->nBitStart, pJob->nBitEnd, pJob->nBlockCRC);
+
+    bz_stream strm = {};
+
+    if (X_BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) {
+        return;
+    }
+
+    strm.next_in = baStream.data();
+    strm.avail_in = (unsigned int)baStream.size();
+
+    QByteArray baOutput(0x100000, Qt::Uninitialized);
+    qint32 nOutputSize = 0;
+    qint32 ret = BZ_OK;
+
+    while (ret == BZ_OK) {
+        if (nOutputSize == baOutput.size()) {
+            if (baOutput.size() >= N_BZIP2_MAX_BLOCK_OUTPUT) {
+                ret = BZ_MEM_ERROR;
+                break;
+            }
+
+            baOutput.resize(qMin((qint32)(baOutput.size() * 2), N_BZIP2_MAX_BLOCK_OUTPUT));
+        }
+
+        strm.next_out = baOutput.data() + nOutputSize;
+        strm.avail_out = (unsigned int)(baOutput.size() - nOutputSize);
+
+        ret = X_BZ2_bzDecompress(&strm);
+
+        nOutputSize = (qint32)(baOutput.size() - strm.avail_out);
+
+        if ((ret == BZ_OK) && (strm.avail_in == 0) && (strm.avail_out != 0)) {
+            // The decoder wants more input than the block has
+            ret = BZ_UNEXPECTED_EOF;
+        }
+    }
+
+    X_BZ2_bzDecompressEnd(&strm);
+
+    if ((ret == BZ_STREAM_END) && (strm.avail_in == 0)) {
+        baOutput.resize(nOutputSize);
+        pJob->baOutput = baOutput;
+        pJob->bValid = true;
+    }
+}
+
+// Blocks are handed out through a shared cursor, so a thread that finishes a small block
+// immediately takes the next pending one instead of waiting on a fixed partition.
+void bzip2RunBlockJobs(const QByteArray *pbaData, char cLevel, BZIP2_BLOCKJOB *pJobs, qint32 nNumberOfJobs, QAtomicInt *pNextJob,
+                       XBinary::PDSTRUCT *pPdStruct)
+{
+    while (true) {
+        const qint32 nIndex = pNextJob->fetchAndAddOrdered(1);
+
+        if (nIndex >= nNumberOfJobs) {
+            break;
+        }
+
+        if (XBinary::isPdStructStopped(pPdStruct)) {
+            continue;
+        }
+
+        bzip2DecodeBlock(*pbaData, cLevel, &(pJobs[nIndex]));
+    }
+}
+
+class XBZIP2BlockWorker : public QRunnable {
+public:
+    XBZIP2BlockWorker(const QByteArray *pbaData, char cLevel, BZIP2_BLOCKJOB *pJobs, qint32 nNumberOfJobs, QAtomicInt *pNextJob, XBinary::PDSTRUCT *pPdStruct)
+        : m_pbaData(pbaData), m_cLevel(cLevel), m_pJobs(pJobs), m_nNumberOfJobs(nNumberOfJobs), m_pNextJob(pNextJob), m_pPdStruct(pPdStruct)
+    {
+    }
+
+    void run() override
+    {
+        bzip2RunBlockJobs(m_pbaData, m_cLevel, m_pJobs, m_nNumberOfJobs, m_pNextJob, m_pPdStruct);
+    }
+
+private:
+    const QByteArray *m_pbaData;
+    char m_cLevel;
+    BZIP2_BLOCKJOB *m_pJobs;
+    qint32 m_nNumberOfJobs;
+    QAtomicInt *m_pNextJob;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
+qint64 bzip2GetInputSize(const XBinary::DATAPROCESS_STATE *pDecompressState)
+{
+    if (pDecompressState->nInputLimit != -1) {
+        return pDecompressState->nInputLimit;
+    }
+
+    if (!pDecompressState->pDeviceInput->isSequential()) {
+        return pDecompressState->pDeviceInput->size() - pDecompressState->nInputOffset;
+    }
+
+    return 0;
+}
+
+}  // namespace
+
 XBZIP2Decoder::XBZIP2Decoder(QObject *parent) : QObject(parent)
 {
 }
@@ -1900,6 +2102,10 @@ bool XBZIP2Decoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBi
     if (pDecompressState && pDecompressState->pDeviceInput && pDecompressState->pDeviceOutput &&
         (pDecompressState->nInputOffset >= 0) && (pDecompressState->nInputLimit >= -1) &&
         XBinary::isPdStructNotCanceled(pPdStruct)) {
+        if ((QThread::idealThreadCount() > 1) && (bzip2GetInputSize(pDecompressState) >= N_BZIP2_PARALLEL_MIN_INPUT)) {
+            return decompressParallel(pDecompressState, 0, pPdStruct);
+        }
+
         const qint32 nRequestedBufferSize = XBinary::getBufferSize(pPdStruct);
         if (nRequestedBufferSize <= 0) return false;
         const qint32 _nBufferSize = qBound((qint32)0x1000, nRequestedBufferSize, (qint32)0x100000);
@@ -1998,3 +2204,276 @@ bool XBZIP2Decoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBi
 
     return bResult;
 }
+
+bool XBZIP2Decoder::decompressParallel(XBinary::DATAPROCESS_STATE *pDecompressState, qint32 nNumberOfThreads, XBinary::PDSTRUCT *pPdStruct)
+{
+    bool bResult = false;
+
+    if (pDecompressState && pDecompressState->pDeviceInput && pDecompressState->pDeviceOutput &&
+        (pDecompressState->nInputOffset >= 0) && (pDecompressState->nInputLimit >= -1) &&
+        XBinary::isPdStructNotCanceled(pPdStruct)) {
+        const qint32 nRequestedBufferSize = XBinary::getBufferSize(pPdStruct);
+        if (nRequestedBufferSize <= 0) return false;
+        const qint32 nBufferSize = qBound((qint32)0x10000, nRequestedBufferSize, (qint32)0x100000);
+
+        if (nNumberOfThreads <= 0) {
+            nNumberOfThreads = QThread::idealThreadCount();
+        }
+
+        nNumberOfThreads = qBound(1, nNumberOfThreads, 64);
+
+        Algo_utils::prepareState(pDecompressState);
+        if (pDecompressState->bReadError || pDecompressState->bWriteError) {
+            return false;
+        }
+
+        const qint32 nBatchSize = nNumberOfThreads * N_BZIP2_BLOCKS_PER_THREAD;
+        const qint64 nMaxPending = qMin((qint64)(nBatchSize + 1) * N_BZIP2_MAX_BLOCK_INPUT, (qint64)0x4000000);
+
+        // Bit positions below are relative to baData, which holds the compressed bytes not yet emitted
+        QByteArray baData;
+        qint64 nScanByte = 0;
+        quint64 nRegister = 0;
+        qint32 nRegisterBits = 0;
+        QList<qint64> listBlockMarks;
+        QList<qint64> listEndMarks;
+        qint64 nConsumedBit = 0;
+        qint64 nEndBit = -1;
+        char cLevel = 0;
+        bool bHeader = false;
+        bool bInputEnd = false;
+        bool bError = false;
+        bool bStreamEnd = false;
+        quint32 nCombinedCRC = 0;
+
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(qMax(1, nNumberOfThreads - 1));
+
+        QVector<BZIP2_BLOCKJOB> vecJobs;
+
+        while (!bError && !bStreamEnd && !XBinary::isPdStructStopped(pPdStruct)) {
+            while (!bInputEnd && (listBlockMarks.size() <= nBatchSize) && (baData.size() < nMaxPending)) {
+                const qint32 nRequest = Algo_utils::getReadChunkSize(pDecompressState, nBufferSize);
+                if (nRequest <= 0) {
+                    bInputEnd = true;
+                    break;
+                }
+
+                const qint32 nOldSize = baData.size();
+                baData.resize(nOldSize + nRequest);
+                const qint32 nRead = XBinary::_readDevice(baData.data() + nOldSize, nRequest, pDecompressState);
+                if (nRead <= 0) {
+                    baData.resize(nOldSize);
+                    bInputEnd = true;
+                    break;
+                }
+                baData.resize(nOldSize + nRead);
+
+                if (!bHeader) {
+                    if (baData.size() < 4) {
+                        continue;
+                    }
+
+                    cLevel = baData.at(3);
+
+                    if ((baData.at(0) != BZ_HDR_B) || (baData.at(1) != BZ_HDR_Z) || (baData.at(2) != BZ_HDR_h) || (cLevel < (BZ_HDR_0 + 1)) ||
+                        (cLevel > (BZ_HDR_0 + 9))) {
+                        bError = true;
+                        break;
+                    }
+
+                    baData.remove(0, 4);
+                    bHeader = true;
+                }
+
+                // Magics may start at any bit: keep 56+ bits in the register and test all eight alignments per byte
+                const uchar *pData = (const uchar *)baData.constData();
+                const qint64 nDataSize = baData.size();
+
+                for (; nScanByte < nDataSize; nScanByte++) {
+                    nRegister = (nRegister << 8) | pData[nScanByte];
+                    nRegisterBits = qMin(nRegisterBits + 8, 64);
+
+                    for (qint32 nShift = 7; nShift >= 0; nShift--) {
+                        if (nRegisterBits >= (48 + nShift)) {
+                            const quint64 nValue = (nRegister >> nShift) & N_BZIP2_MAGIC_MASK;
+                            const qint64 nBitPos = nScanByte * 8 + 7 - nShift - 47;
+
+                            if (nValue == N_BZIP2_BLOCK_MAGIC) {
+                                listBlockMarks.append(nBitPos);
+                            } else if (nValue == N_BZIP2_EOS_MAGIC) {
+                                listEndMarks.append(nBitPos);
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (bError) break;
+
+            if (!bHeader) {
+                bError = true;
+                break;
+            }
+
+            if (bInputEnd && (nEndBit == -1)) {
+                // Only an end marker that closes the input (footer CRC plus byte padding) is real
+                for (qint32 i = listEndMarks.size() - 1; i >= 0; i--) {
+                    const qint64 nCandidate = listEndMarks.at(i);
+
+                    if ((nCandidate >= nConsumedBit) && (((nCandidate + 80 + 7) / 8) == baData.size())) {
+                        nEndBit = nCandidate;
+                        break;
+                    }
+                }
+
+                if (nEndBit == -1) {
+                    bError = true;
+                    break;
+                }
+
+                while (!listBlockMarks.isEmpty() && (listBlockMarks.last() >= nEndBit)) {
+                    listBlockMarks.removeLast();
+                }
+            }
+
+            if (nEndBit == nConsumedBit) {
+                bStreamEnd = (bzip2ReadBits(baData, nEndBit + 48, 32) == nCombinedCRC);
+                bError = !bStreamEnd;
+                break;
+            }
+
+            if (listBlockMarks.isEmpty() || (listBlockMarks.first() != nConsumedBit)) {
+                bError = true;
+                break;
+            }
+
+            qint32 nNumberOfJobs = listBlockMarks.size() - 1;
+
+            if (nEndBit != -1) {
+                nNumberOfJobs++;
+            }
+
+            nNumberOfJobs = qMin(nNumberOfJobs, nBatchSize);
+
+            if (nNumberOfJobs <= 0) {
+                // No following magic within the bounded window
+                bError = true;
+                break;
+            }
+
+            vecJobs.resize(nNumberOfJobs);
+
+            for (qint32 i = 0; i < nNumberOfJobs; i++) {
+                BZIP2_BLOCKJOB &job = vecJobs[i];
+                job.nBitStart = listBlockMarks.at(i);
+                job.nBitEnd = (i + 1 < listBlockMarks.size()) ? listBlockMarks.at(i + 1) : nEndBit;
+                job.nBlockCRC = bzip2ReadBits(baData, job.nBitStart + 48, 32);
+                job.bValid = false;
+                job.bTooLarge = false;
+                job.baOutput.clear();
+            }
+
+            {
+                QAtomicInt nNextJob(0);
+                BZIP2_BLOCKJOB *pJobs = vecJobs.data();
+                const qint32 nNumberOfWorkers = qMin(nNumberOfThreads, nNumberOfJobs) - 1;
+
+                for (qint32 i = 0; i < nNumberOfWorkers; i++) {
+                    threadPool.start(new XBZIP2BlockWorker(&baData, cLevel, pJobs, nNumberOfJobs, &nNextJob, pPdStruct));
+                }
+
+                bzip2RunBlockJobs(&baData, cLevel, pJobs, nNumberOfJobs, &nNextJob, pPdStruct);
+
+                threadPool.waitForDone();
+            }
+
+            if (XBinary::isPdStructStopped(pPdStruct)) {
+                break;
+            }
+
+            // Emit in stream order. A block that fails to decode may have been cut by a magic that is
+            // really part of its Huffman data, so it is merged with the following range and retried.
+            qint32 nIndex = 0;
+
+            while (nIndex < vecJobs.size()) {
+                BZIP2_BLOCKJOB *pJob = &(vecJobs[nIndex]);
+
+                if (!pJob->bValid) {
+                    if (pJob->bTooLarge || (pJob->nBitEnd == nEndBit)) {
+                        bError = true;
+                        break;
+                    }
+
+                    listBlockMarks.removeOne(pJob->nBitEnd);
+
+                    if (nIndex + 1 < vecJobs.size()) {
+                        const qint64 nMergedEnd = vecJobs.at(nIndex + 1).nBitEnd;
+                        vecJobs.remove(nIndex + 1);
+                        pJob = &(vecJobs[nIndex]);
+                        pJob->nBitEnd = nMergedEnd;
+                        bzip2DecodeBlock(baData, cLevel, pJob);
+                        continue;
+                    }
+
+                    // The next boundary is outside this batch: retry from this block with more input
+                    break;
+                }
+
+                if (pJob->baOutput.size() && !XBinary::_writeDevice(pJob->baOutput.data(), pJob->baOutput.size(), pDecompressState)) {
+                    bError = true;
+                    break;
+                }
+
+                nCombinedCRC = (nCombinedCRC << 1) | (nCombinedCRC >> 31);
+                nCombinedCRC ^= pJob->nBlockCRC;
+                nConsumedBit = pJob->nBitEnd;
+                pJob->baOutput.clear();
+                nIndex++;
+            }
+
+            vecJobs.clear();
+
+            if (bError) break;
+
+            while (!listBlockMarks.isEmpty() && (listBlockMarks.first() < nConsumedBit)) {
+                listBlockMarks.removeFirst();
+            }
+
+            while (!listEndMarks.isEmpty() && (listEndMarks.first() < nConsumedBit)) {
+                listEndMarks.removeFirst();
+            }
+
+            const qint64 nDropBytes = nConsumedBit >> 3;
+
+            if (nDropBytes > 0) {
+                const qint64 nDropBits = nDropBytes * 8;
+
+                baData.remove(0, (qint32)nDropBytes);
+                nScanByte -= nDropBytes;
+                nConsumedBit -= nDropBits;
+
+                if (nEndBit != -1) {
+                    nEndBit -= nDropBits;
+                }
+
+                for (qint32 i = 0; i < listBlockMarks.size(); i++) {
+                    listBlockMarks[i] -= nDropBits;
+                }
+
+                for (qint32 i = 0; i < listEndMarks.size(); i++) {
+                    listEndMarks[i] -= nDropBits;
+                }
+            }
+        }
+
+        const bool bConsumedInput = bInputEnd && ((pDecompressState->nInputLimit == -1) || (pDecompressState->nCountInput == pDecompressState->nInputLimit));
+        const bool bExpectedOutput = !pDecompressState->mapProperties.contains(XBinary::FPART_PROP_UNCOMPRESSEDSIZE) ||
+                                     ((pDecompressState->mapProperties.value(XBinary::FPART_PROP_UNCOMPRESSEDSIZE).toLongLong() >= 0) &&
+                                      (pDecompressState->nCountOutput == pDecompressState->mapProperties.value(XBinary::FPART_PROP_UNCOMPRESSEDSIZE).toLongLong()));
+        bResult = bStreamEnd && !bError && bConsumedInput && bExpectedOutput && !pDecompressState->bReadError && !pDecompressState->bWriteError &&
+                  XBinary::isPdStructNotCanceled(pPdStruct);
+    }
+
+    return bResult;
+}
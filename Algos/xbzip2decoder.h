@@ -313,6 +313,9 @@ public:
     explicit XBZIP2Decoder(QObject *parent = nullptr);
 
     static bool decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    // Splits the stream at its (bit-aligned) block magics and decodes the blocks on worker threads.
+    // nNumberOfThreads <= 0 selects QThread::idealThreadCount()
+    static bool decompressParallel(XBinary::DATAPROCESS_STATE *pDecompressState, qint32 nNumberOfThreads = 0, XBinary::PDSTRUCT *pPdStruct = nullptr);
 };
 
 #endif  // XBZIP2DECODER_H
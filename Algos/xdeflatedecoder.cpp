@@ -10391,6 +10391,8 @@ int inflateBack9End(z_stream *strm)
 
 }  // namespace
 
+#include <QThread>
+
 XDeflateDecoder::XDeflateDecoder(QObject *parent) : QObject(parent)
 {
 }
@@ -10416,18 +10418,30 @@ bool XDeflateDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, X
 
         qint32 ret = Z_OK;
 
+        // A memory-backed input is inflated in place instead of through bufferIn
+        const char *pSpan = nullptr;
+        qint64 nSpanSize = 0;
+        qint64 nSpanPosition = 0;
+        const bool bSpan = Algo_utils::takeInputSpan(pDecompressState, &pSpan, &nSpanSize);
+        bool bWindowFilled = false;
+
         if (X_inflateInit2(&strm, -MAX_WBITS) == Z_OK) {
             do {
-                qint32 nBufferSize = Algo_utils::getReadChunkSize(pDecompressState, _nBufferSize);
-                strm.avail_in = XBinary::_readDevice(bufferIn, nBufferSize, pDecompressState);
+                if (bSpan) {
+                    strm.avail_in = (uInt)qMin(nSpanSize - nSpanPosition, (qint64)0x40000000);
+                    strm.next_in = (quint8 *)(pSpan + nSpanPosition);
+                    nSpanPosition += strm.avail_in;
+                } else {
+                    qint32 nBufferSize = Algo_utils::getReadChunkSize(pDecompressState, _nBufferSize);
+                    strm.avail_in = XBinary::_readDevice(bufferIn, nBufferSize, pDecompressState);
+                    strm.next_in = (quint8 *)bufferIn;
+                }
 
                 if (strm.avail_in == 0) {
                     ret = Z_ERRNO;
                     break;
                 }
 
-                strm.next_in = (quint8 *)bufferIn;
-
                 do {
                     strm.avail_out = _nBufferSize;
                     strm.next_out = (quint8 *)bufferOut;
@@ -10445,9 +10459,14 @@ bool XDeflateDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, X
                             break;
                         }
                     }
+
+                    if (Algo_utils::isProcessedWindowFilled(pDecompressState)) {
+                        bWindowFilled = true;
+                        break;
+                    }
                 } while (strm.avail_out == 0);
 
-                if ((ret == Z_DATA_ERROR) || (ret == Z_MEM_ERROR) || (ret == Z_NEED_DICT) || (ret == Z_ERRNO)) {
+                if ((ret == Z_DATA_ERROR) || (ret == Z_MEM_ERROR) || (ret == Z_NEED_DICT) || (ret == Z_ERRNO) || bWindowFilled) {
                     break;
                 }
 
@@ -10460,13 +10479,17 @@ bool XDeflateDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, X
             // finish a raw stream with bytes from the following container
             // footer still buffered in avail_in, so expose the exact number of
             // compressed bytes consumed to container parsers.
-            if ((ret == Z_STREAM_END) && (strm.avail_in > 0) && (pDecompressState->nCountInput >= (qint64)strm.avail_in)) {
-                pDecompressState->nCountInput -= strm.avail_in;
+            const qint64 nUnused = (qint64)strm.avail_in + (nSpanSize - nSpanPosition);
+
+            if ((ret == Z_STREAM_END) && (nUnused > 0) && (pDecompressState->nCountInput >= nUnused)) {
+                pDecompressState->nCountInput -= nUnused;
             }
 
             X_inflateEnd(&strm);
 
-            bResult = (ret == Z_STREAM_END);
+            // Once the requested output window is complete the rest of the
+            // stream is not decoded.
+            bResult = (ret == Z_STREAM_END) || (bWindowFilled && (ret != Z_ERRNO));
         }
 
         delete[] bufferIn;
@@ -10659,9 +10682,20 @@ bool XDeflateDecoder::decompress_zlib(XBinary::DATAPROCESS_STATE *pDecompressSta
 
 bool XDeflateDecoder::compress(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, int nCompressionLevel)
 {
+    // Large bounded inputs go through the block-parallel engine; the output is still one raw deflate stream
+    if (pCompressState && (pCompressState->nInputLimit >= 0x100000) && (QThread::idealThreadCount() > 1)) {
+        return Algo_utils::compressDeflateParallel(pCompressState, pPdStruct, nCompressionLevel, 0);
+    }
+
     return Algo_utils::compressDeflate(pCompressState, pPdStruct, nCompressionLevel, -MAX_WBITS);
 }
 
+bool XDeflateDecoder::compressParallel(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, int nCompressionLevel, qint32 nNumberOfThreads,
+                                       quint32 *pnCRC32)
+{
+    return Algo_utils::compressDeflateParallel(pCompressState, pPdStruct, nCompressionLevel, nNumberOfThreads, pnCRC32);
+}
+
 bool XDeflateDecoder::compress_zlib(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, int nCompressionLevel)
 {
     return Algo_utils::compressDeflate(pCompressState, pPdStruct, nCompressionLevel, MAX_WBITS);
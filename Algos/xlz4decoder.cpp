@@ -67,9 +67,20 @@ bool writeOutput(const QByteArray *pOutput, size_t nOutputSize, qint64 nExpected
 class Lz4InputBuffer {
 public:
     Lz4InputBuffer(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRUCT *pPdStruct, qint32 nChunkSize)
-        : m_pState(pState), m_pPdStruct(pPdStruct), m_nChunkSize(nChunkSize), m_nPosition(0), m_bAtEnd(false)
+        : m_pState(pState), m_pPdStruct(pPdStruct), m_nChunkSize(nChunkSize), m_nPosition(0), m_bAtEnd(false), m_bSpan(false)
     {
-        m_baData.reserve(nChunkSize);
+        const char *pSpan = nullptr;
+        qint64 nSpanSize = 0;
+
+        // A memory-backed input is used in place: the whole member is already "read"
+        if ((pState->nInputLimit != -1) && (pState->nInputLimit <= (std::numeric_limits<qint32>::max)()) &&
+            Algo_utils::takeInputSpan(pState, &pSpan, &nSpanSize)) {
+            m_baData = QByteArray::fromRawData(pSpan, (qint32)nSpanSize);
+            m_bAtEnd = true;
+            m_bSpan = true;
+        } else {
+            m_baData.reserve(nChunkSize);
+        }
     }
 
     qint32 available() const
@@ -95,6 +106,9 @@ public:
         }
 
         m_nPosition += nSize;
+        // Compacting a span would detach the raw data into a copy
+        if (m_bSpan) return;
+
         if (m_nPosition == m_baData.size()) {
             m_baData.clear();
             m_nPosition = 0;
@@ -151,6 +165,7 @@ private:
     QByteArray m_baData;
     qint32 m_nPosition;
     bool m_bAtEnd;
+    bool m_bSpan;
 };
 
 bool decodeFrame(Lz4InputBuffer *pInput, QByteArray *pOutput, qint64 nExpectedOutput,
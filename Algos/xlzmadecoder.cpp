@@ -318,6 +318,72 @@ bool readExactState(char *pBuffer, qint32 nSize, XBinary::DATAPROCESS_STATE *pSt
 
     return true;
 }
+
+// ZIP method 14 prefixes the raw stream with the encoder version and the properties size
+const quint8 LZMA_ZIP_VERSION_MAJOR = 26;
+const quint8 LZMA_ZIP_VERSION_MINOR = 1;
+
+// 7-Zip stream callbacks over a DATAPROCESS_STATE. The input side keeps the CRC of what it hands out.
+struct LZMA_ENC_INSTREAM {
+    ISeqInStream vt;
+    XBinary::DATAPROCESS_STATE *pState;
+    quint32 nCRC32;
+};
+
+struct LZMA_ENC_OUTSTREAM {
+    ISeqOutStream vt;
+    XBinary::DATAPROCESS_STATE *pState;
+};
+
+struct LZMA_ENC_PROGRESS {
+    ICompressProgress vt;
+    XBinary::PDSTRUCT *pPdStruct;
+};
+
+SRes lzmaEncRead(ISeqInStreamPtr p, void *pBuffer, size_t *pnSize)
+{
+    LZMA_ENC_INSTREAM *pStream = Z7_CONTAINER_FROM_VTBL(p, LZMA_ENC_INSTREAM, vt);
+    const qint32 nRequest = Algo_utils::getReadChunkSize(pStream->pState, (qint32)(std::min)(*pnSize, (size_t)0x100000));
+    *pnSize = 0;
+
+    if (nRequest <= 0) return SZ_OK;
+
+    const qint32 nRead = XBinary::_readDevice((char *)pBuffer, nRequest, pStream->pState);
+    if ((nRead < 0) || ((nRead == 0) && ((pStream->pState->nInputLimit != -1) || !pStream->pState->pDeviceInput->atEnd()))) {
+        pStream->pState->bReadError = true;
+    }
+    if (pStream->pState->bReadError) return SZ_ERROR_READ;
+
+    if (nRead > 0) {
+        pStream->nCRC32 = XBinary::_getCRC32((const char *)pBuffer, nRead, pStream->nCRC32, XBinary::_getCRC32Table_EDB88320());
+        *pnSize = (size_t)nRead;
+    }
+
+    return SZ_OK;
+}
+
+size_t lzmaEncWrite(ISeqOutStreamPtr p, const void *pBuffer, size_t nSize)
+{
+    LZMA_ENC_OUTSTREAM *pStream = Z7_CONTAINER_FROM_VTBL(p, LZMA_ENC_OUTSTREAM, vt);
+    size_t nWritten = 0;
+
+    while (nWritten < nSize) {
+        const qint32 nChunkSize = (qint32)(std::min)(nSize - nWritten, (size_t)0x100000);
+        if (XBinary::_writeDevice((char *)pBuffer + nWritten, nChunkSize, pStream->pState) != nChunkSize) break;
+        nWritten += nChunkSize;
+    }
+
+    return nWritten;
+}
+
+SRes lzmaEncProgress(ICompressProgressPtr p, UInt64 nInSize, UInt64 nOutSize)
+{
+    Q_UNUSED(nInSize)
+    Q_UNUSED(nOutSize)
+
+    const LZMA_ENC_PROGRESS *pProgress = Z7_CONTAINER_FROM_VTBL(p, LZMA_ENC_PROGRESS, vt);
+    return XBinary::isPdStructNotCanceled(pProgress->pPdStruct) ? SZ_OK : SZ_ERROR_PROGRESS;
+}
 }  // namespace
 
 XLZMADecoder::XLZMADecoder(QObject *parent) : QObject(parent)
@@ -901,6 +967,83 @@ bool XLZMADecoder::decompressXZ(XBinary::DATAPROCESS_STATE *pDecompressState, XB
     return true;
 }
 
+bool XLZMADecoder::compress(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, qint32 nCompressionLevel, quint32 *pnCRC32)
+{
+    if (!pCompressState || !pCompressState->pDeviceInput || !pCompressState->pDeviceOutput || (pCompressState->nInputOffset < 0) ||
+        (pCompressState->nInputLimit < -1) || (nCompressionLevel < 0) || (nCompressionLevel > 9)) {
+        return false;
+    }
+
+    pCompressState->bReadError = false;
+    pCompressState->bWriteError = false;
+    pCompressState->nCountInput = 0;
+    pCompressState->nCountOutput = 0;
+
+    if (!XBinary::isPdStructNotCanceled(pPdStruct)) return false;
+    if (!pCompressState->pDeviceInput->seek(pCompressState->nInputOffset) &&
+        (pCompressState->pDeviceInput->pos() != pCompressState->nInputOffset)) {
+        pCompressState->bReadError = true;
+        return false;
+    }
+
+    CLzmaEncHandle pEncoder = LzmaEnc_Create(Algo_utils::lzmaAlloc());
+    if (!pEncoder) return false;
+
+    // Members are already compressed concurrently, so each encoder stays single-threaded.
+    // The end marker lets the stream be written before its size is known.
+    CLzmaEncProps props;
+    LzmaEncProps_Init(&props);
+    props.level = nCompressionLevel;
+    props.numThreads = 1;
+    props.writeEndMark = 1;
+    if (pCompressState->nInputLimit != -1) {
+        props.reduceSize = (UInt64)pCompressState->nInputLimit;
+    }
+
+    bool bResult = false;
+    Byte properties[LZMA_PROPS_SIZE] = {};
+    SizeT nPropertiesSize = LZMA_PROPS_SIZE;
+
+    if ((LzmaEnc_SetProps(pEncoder, &props) == SZ_OK) && (LzmaEnc_WriteProperties(pEncoder, properties, &nPropertiesSize) == SZ_OK) &&
+        (nPropertiesSize == LZMA_PROPS_SIZE)) {
+        // Same layout decompress() reads back
+        char header[4 + LZMA_PROPS_SIZE] = {};
+        header[0] = (char)LZMA_ZIP_VERSION_MAJOR;
+        header[1] = (char)LZMA_ZIP_VERSION_MINOR;
+        header[2] = (char)LZMA_PROPS_SIZE;
+        header[3] = 0;
+        memcpy(header + 4, properties, LZMA_PROPS_SIZE);
+
+        if (XBinary::_writeDevice(header, sizeof(header), pCompressState) == (qint32)sizeof(header)) {
+            LZMA_ENC_INSTREAM inStream = {};
+            inStream.vt.Read = lzmaEncRead;
+            inStream.pState = pCompressState;
+            inStream.nCRC32 = 0xFFFFFFFF;
+
+            LZMA_ENC_OUTSTREAM outStream = {};
+            outStream.vt.Write = lzmaEncWrite;
+            outStream.pState = pCompressState;
+
+            LZMA_ENC_PROGRESS progress = {};
+            progress.vt.Progress = lzmaEncProgress;
+            progress.pPdStruct = pPdStruct;
+
+            const SRes nRet = LzmaEnc_Encode(pEncoder, &outStream.vt, &inStream.vt, &progress.vt, Algo_utils::lzmaAlloc(), Algo_utils::lzmaAlloc());
+
+            bResult = (nRet == SZ_OK) && !pCompressState->bReadError && !pCompressState->bWriteError &&
+                      ((pCompressState->nInputLimit == -1) || (pCompressState->nCountInput == pCompressState->nInputLimit));
+
+            if (pnCRC32) {
+                *pnCRC32 = inStream.nCRC32 ^ 0xFFFFFFFF;
+            }
+        }
+    }
+
+    LzmaEnc_Destroy(pEncoder, Algo_utils::lzmaAlloc(), Algo_utils::lzmaAlloc());
+
+    return bResult && XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
 /* ===== Begin embedded xlzma_local.c ===== */
 /* Local renamed copies of the 7-Zip LZMA decoder C entry points. */
 
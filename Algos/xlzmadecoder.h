@@ -34,6 +34,9 @@ public:
     static bool decompressLZMA2(XBinary::DATAPROCESS_STATE *pDecompressState, XBinary::PDSTRUCT *pPdStruct = nullptr);
     static bool decompressLZMA2(XBinary::DATAPROCESS_STATE *pDecompressState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct = nullptr);
     static bool decompressXZ(XBinary::DATAPROCESS_STATE *pDecompressState, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    // Writes the ZIP method 14 layout: version, properties size, properties, then an end-marked stream
+    static bool compress(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct = nullptr, qint32 nCompressionLevel = 5,
+                         quint32 *pnCRC32 = nullptr);
 };
 
 #endif  // XLZMADECODER_H
@@ -24,6 +24,99 @@
 #include <limits>
 #include <new>
 #include <new>
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Moves the start of a bounded STORE member between two local files without a
+// user-space buffer: a reflink clone when the filesystem can share the extent,
+// otherwise copy_file_range.  Returns how many bytes were placed; the regular
+// copy loop finishes anything left, so every refusal is a silent fallback.
+qint64 storeCopyFileRange(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRUCT *pPdStruct)
+{
+    qint64 nResult = 0;
+#ifdef Q_OS_LINUX
+    QFile *pInputFile = qobject_cast<QFile *>(pState->pDeviceInput);
+    QFile *pOutputFile = qobject_cast<QFile *>(pState->pDeviceOutput);
+    const qint64 nSize = pState->nInputLimit;
+
+    // A processed window means only part of the member is wanted; leave that
+    // to _writeDevice().
+    if (!pInputFile || !pOutputFile || (nSize <= 0) || (pState->nProcessedOffset != 0) || (pState->nProcessedLimit != -1) ||
+        pState->bReadError || pState->bWriteError || !pOutputFile->flush()) {
+        return 0;
+    }
+
+    const int nInputHandle = pInputFile->handle();
+    const int nOutputHandle = pOutputFile->handle();
+    // Several extents of one record (UDF) land one after another in the same
+    // output; each starts where the previous one ended, not at zero.
+    const qint64 nOutputOffset = pOutputFile->pos();
+    if ((nInputHandle < 0) || (nOutputHandle < 0) || (nOutputOffset < 0)) {
+        return 0;
+    }
+
+#ifdef FICLONERANGE
+    // Clone ranges must start on a block boundary; other layouts fail with
+    // EINVAL and drop to the copy below.
+    struct stat status = {};
+    if ((fstat(nOutputHandle, &status) == 0) && (status.st_blksize > 0) && ((pState->nInputOffset % status.st_blksize) == 0) &&
+        ((nOutputOffset % status.st_blksize) == 0)) {
+        struct file_clone_range range = {};
+        range.src_fd = nInputHandle;
+        range.src_offset = (quint64)pState->nInputOffset;
+        range.src_length = (quint64)nSize;
+        range.dest_offset = (quint64)nOutputOffset;
+
+        if (ioctl(nOutputHandle, FICLONERANGE, &range) == 0) {
+            nResult = nSize;
+        }
+    }
+#endif
+
+#ifdef SYS_copy_file_range
+    while ((nResult < nSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        // Bounded steps keep cancellation responsive on large members.
+        const size_t nChunk = (size_t)qMin(nSize - nResult, (qint64)0x1000000);
+        qint64 nInputPos = pState->nInputOffset + nResult;
+        qint64 nOutputPos = nOutputOffset + nResult;
+        const long nCopied = syscall(SYS_copy_file_range, nInputHandle, &nInputPos, nOutputHandle, &nOutputPos, nChunk, 0);
+
+        if (nCopied <= 0) {
+            break;
+        }
+
+        nResult += nCopied;
+    }
+#endif
+
+    if (nResult > 0) {
+        // The descriptors were used with explicit offsets; move the QFile
+        // cursors to where the buffered loop expects them.
+        pState->nCountInput = nResult;
+        pState->nCountOutput = nResult;
+
+        if (!pInputFile->seek(pState->nInputOffset + nResult)) {
+            pState->bReadError = true;
+        }
+        if (!pOutputFile->seek(nOutputOffset + nResult)) {
+            pState->bWriteError = true;
+        }
+    }
+#else
+    Q_UNUSED(pState)
+    Q_UNUSED(pPdStruct)
+#endif
+    return nResult;
+}
+}  // namespace
 
 XStoreDecoder::XStoreDecoder(QObject *parent) : QObject(parent)
 {
@@ -67,9 +160,38 @@ bool XStoreDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBi
 
         Algo_utils::prepareState(pDecompressState);
 
+        qint64 nOffset = 0;
+        const char *pSpan = nullptr;
+        qint64 nSpanSize = 0;
+
+        if (Algo_utils::takeInputSpan(pDecompressState, &pSpan, &nSpanSize)) {
+            // Memory-backed input: write straight from the span
+            while ((nOffset < nSpanSize) && XBinary::isPdStructNotCanceled(pPdStruct) && !Algo_utils::isProcessedWindowFilled(pDecompressState)) {
+                const qint32 nChunk = (qint32)qMin(nSpanSize - nOffset, (qint64)_nBufferSize);
+
+                if (XBinary::_writeDevice(pSpan + nOffset, nChunk, pDecompressState) != nChunk) break;
+
+                nOffset += nChunk;
+            }
+        } else if ((pDecompressState->nProcessedOffset > 0) && !pDecompressState->bReadError) {
+            // Output bytes before the window map one to one onto input bytes:
+            // seek past them instead of reading and discarding them.
+            const qint64 nSkip = (pDecompressState->nInputLimit == -1)
+                                     ? pDecompressState->nProcessedOffset
+                                     : qMin(pDecompressState->nProcessedOffset, pDecompressState->nInputLimit);
+
+            if (pDecompressState->pDeviceInput->seek(pDecompressState->nInputOffset + nSkip)) {
+                pDecompressState->nCountInput = nSkip;
+                pDecompressState->nCountOutput = nSkip;
+                nOffset = nSkip;
+            }
+        } else {
+            nOffset = storeCopyFileRange(pDecompressState, pPdStruct);
+        }
+
         // Copy data from input to output
-        for (qint64 nOffset = 0;
-             ((pDecompressState->nInputLimit == -1) || (nOffset < pDecompressState->nInputLimit)) && XBinary::isPdStructNotCanceled(pPdStruct);) {
+        for (; ((pDecompressState->nInputLimit == -1) || (nOffset < pDecompressState->nInputLimit)) && XBinary::isPdStructNotCanceled(pPdStruct) &&
+               !Algo_utils::isProcessedWindowFilled(pDecompressState);) {
             qint32 nBufferSize = Algo_utils::getReadChunkSize(pDecompressState, _nBufferSize);
 
             if (nBufferSize <= 0) {
@@ -91,8 +213,12 @@ bool XStoreDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBi
             nOffset += nRead;
         }
 
-        const bool bInputComplete = (pDecompressState->nInputLimit == -1) || (pDecompressState->nCountInput == pDecompressState->nInputLimit);
-        const bool bOutputSizeMatches = !bHasExpectedSize || (pDecompressState->nCountOutput == nExpectedSize);
+        // A filled output window ends the copy early; the member's remaining
+        // bytes are simply not needed.
+        const bool bWindowFilled = Algo_utils::isProcessedWindowFilled(pDecompressState);
+        const bool bInputComplete =
+            bWindowFilled || (pDecompressState->nInputLimit == -1) || (pDecompressState->nCountInput == pDecompressState->nInputLimit);
+        const bool bOutputSizeMatches = bWindowFilled || !bHasExpectedSize || (pDecompressState->nCountOutput == nExpectedSize);
         bResult = bInputComplete && bOutputSizeMatches && XBinary::isPdStructNotCanceled(pPdStruct) && !pDecompressState->bReadError &&
                   !pDecompressState->bWriteError;
 
@@ -163,9 +163,20 @@ private:
 class ZstdInputBuffer {
 public:
     ZstdInputBuffer(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRUCT *pPdStruct, qint32 nChunkSize)
-        : m_pState(pState), m_pPdStruct(pPdStruct), m_nChunkSize(nChunkSize), m_nPosition(0), m_bAtEnd(false)
+        : m_pState(pState), m_pPdStruct(pPdStruct), m_nChunkSize(nChunkSize), m_nPosition(0), m_bAtEnd(false), m_bSpan(false)
     {
-        m_baData.reserve(nChunkSize);
+        const char *pSpan = nullptr;
+        qint64 nSpanSize = 0;
+
+        // A memory-backed input is used in place: the whole member is already "read"
+        if ((pState->nInputLimit != -1) && (pState->nInputLimit <= (std::numeric_limits<qint32>::max)()) &&
+            Algo_utils::takeInputSpan(pState, &pSpan, &nSpanSize)) {
+            m_baData = QByteArray::fromRawData(pSpan, (qint32)nSpanSize);
+            m_bAtEnd = true;
+            m_bSpan = true;
+        } else {
+            m_baData.reserve(nChunkSize);
+        }
     }
 
     qint32 available() const
@@ -191,6 +202,9 @@ public:
         }
 
         m_nPosition += nSize;
+        // Compacting a span would detach the raw data into a copy
+        if (m_bSpan) return;
+
         if (m_nPosition == m_baData.size()) {
             m_baData.clear();
             m_nPosition = 0;
@@ -247,9 +261,79 @@ private:
     QByteArray m_baData;
     qint32 m_nPosition;
     bool m_bAtEnd;
+    bool m_bSpan;
 };
 }  // namespace
 
+// Declarations of the XZstdEnc::ZSTD_CStream API defined in zstdenclib.cpp,
+// which has no header of its own (see the note at the top of that file).
+namespace XZstdEnc {
+typedef struct ZSTD_CCtx_s ZSTD_CCtx;
+typedef ZSTD_CCtx ZSTD_CStream;
+
+typedef struct ZSTD_inBuffer_s {
+    const void *src;
+    size_t size;
+    size_t pos;
+} ZSTD_inBuffer;
+
+typedef struct ZSTD_outBuffer_s {
+    void *dst;
+    size_t size;
+    size_t pos;
+} ZSTD_outBuffer;
+
+ZSTD_CStream *ZSTD_createCStream(void);
+size_t ZSTD_freeCStream(ZSTD_CStream *zcs);
+size_t ZSTD_initCStream(ZSTD_CStream *zcs, int compressionLevel);
+size_t ZSTD_compressStream(ZSTD_CStream *zcs, ZSTD_outBuffer *output, ZSTD_inBuffer *input);
+size_t ZSTD_endStream(ZSTD_CStream *zcs, ZSTD_outBuffer *output);
+size_t ZSTD_CStreamInSize(void);
+size_t ZSTD_CStreamOutSize(void);
+unsigned ZSTD_isError(size_t result);
+}  // namespace XZstdEnc
+
+namespace {
+bool zstdReadBlock(XBinary::DATAPROCESS_STATE *pCompressState, qint32 nBlockSize, QByteArray *pbaBlock)
+{
+    pbaBlock->resize(nBlockSize);
+    qint32 nSize = 0;
+
+    while (nSize < nBlockSize) {
+        const qint32 nToRead = Algo_utils::getReadChunkSize(pCompressState, nBlockSize - nSize);
+        if (nToRead <= 0) break;
+
+        const qint32 nRead = XBinary::_readDevice(pbaBlock->data() + nSize, nToRead, pCompressState);
+        if (nRead < 0) {
+            pCompressState->bReadError = true;
+            break;
+        }
+
+        if (nRead == 0) {
+            if ((pCompressState->nInputLimit != -1) || !pCompressState->pDeviceInput->atEnd()) {
+                pCompressState->bReadError = true;
+            }
+            break;
+        }
+
+        nSize += nRead;
+    }
+
+    pbaBlock->resize(nSize);
+
+    return !pCompressState->bReadError;
+}
+
+// Writes out what the stream has put into baOutput so far.
+bool zstdFlushOutput(XBinary::DATAPROCESS_STATE *pCompressState, const QByteArray &baOutput, XZstdEnc::ZSTD_outBuffer *pOutput)
+{
+    const qint32 nSize = (qint32)pOutput->pos;
+    pOutput->pos = 0;
+
+    return (nSize == 0) || (XBinary::_writeDevice(baOutput.constData(), nSize, pCompressState) == nSize);
+}
+}  // namespace
+
 XZstdDecoder::XZstdDecoder(QObject *parent) : QObject(parent)
 {
 }
@@ -287,6 +371,7 @@ bool XZstdDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBin
     bool bCurrentFrameIsLegacy = false;
     bool bSawDataFrame = false;
     bool bFinished = false;
+    bool bWindowFilled = false;
     bool bValid = true;
 
     while (XBinary::isPdStructNotCanceled(pPdStruct)) {
@@ -373,6 +458,12 @@ bool XZstdDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBin
             break;
         }
 
+        if (Algo_utils::isProcessedWindowFilled(pDecompressState)) {
+            // The requested output window is complete; later frames are not decoded.
+            bWindowFilled = true;
+            break;
+        }
+
         if (nRet == 0) {
             if (bCurrentFrameIsData) bSawDataFrame = true;
             bAtFrameStart = true;
@@ -394,6 +485,69 @@ bool XZstdDecoder::decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBin
                              ((pDecompressState->nInputLimit == -1) ||
                               (pDecompressState->nCountInput == pDecompressState->nInputLimit));
     const bool bExactOutput = (nExpectedOutput == -1) || (pDecompressState->nCountOutput == nExpectedOutput);
-    return bValid && bFinished && bExactInput && bExactOutput && !pDecompressState->bReadError &&
+    return bValid && (bWindowFilled || (bFinished && bExactInput && bExactOutput)) && !pDecompressState->bReadError &&
            !pDecompressState->bWriteError && XBinary::isPdStructNotCanceled(pPdStruct);
 }
+
+bool XZstdDecoder::compress(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct, qint32 nCompressionLevel, quint32 *pnCRC32)
+{
+    if (!pCompressState || !pCompressState->pDeviceInput || !pCompressState->pDeviceOutput || (pCompressState->nInputOffset < 0) ||
+        (pCompressState->nInputLimit < -1) || (nCompressionLevel < 1) || (nCompressionLevel > 22)) {
+        return false;
+    }
+
+    pCompressState->bReadError = false;
+    pCompressState->bWriteError = false;
+    pCompressState->nCountInput = 0;
+    pCompressState->nCountOutput = 0;
+
+    if (!XBinary::isPdStructNotCanceled(pPdStruct)) return false;
+    if (!pCompressState->pDeviceInput->seek(pCompressState->nInputOffset) &&
+        (pCompressState->pDeviceInput->pos() != pCompressState->nInputOffset)) {
+        pCompressState->bReadError = true;
+        return false;
+    }
+
+    XZstdEnc::ZSTD_CStream *pStream = XZstdEnc::ZSTD_createCStream();
+    if (!pStream) return false;
+
+    // One frame without content size or checksum; ZIP keeps its own CRC.
+    bool bResult = !XZstdEnc::ZSTD_isError(XZstdEnc::ZSTD_initCStream(pStream, nCompressionLevel));
+
+    QByteArray baInput;
+    QByteArray baOutput((qint32)XZstdEnc::ZSTD_CStreamOutSize(), 0);
+    XZstdEnc::ZSTD_outBuffer output = {baOutput.data(), (size_t)baOutput.size(), 0};
+    const qint32 nChunkSize = (qint32)XZstdEnc::ZSTD_CStreamInSize();
+    quint32 nCRC32 = 0xFFFFFFFF;
+
+    while (bResult && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        bResult = zstdReadBlock(pCompressState, nChunkSize, &baInput);
+        if (!bResult || baInput.isEmpty()) break;
+
+        nCRC32 = XBinary::_getCRC32(baInput.constData(), baInput.size(), nCRC32, XBinary::_getCRC32Table_EDB88320());
+
+        XZstdEnc::ZSTD_inBuffer input = {baInput.constData(), (size_t)baInput.size(), 0};
+
+        while (bResult && (input.pos < input.size)) {
+            bResult = !XZstdEnc::ZSTD_isError(XZstdEnc::ZSTD_compressStream(pStream, &output, &input)) &&
+                      zstdFlushOutput(pCompressState, baOutput, &output);
+        }
+    }
+
+    // ZSTD_endStream() returns the number of bytes still to flush.
+    size_t nRemaining = 1;
+
+    while (bResult && (nRemaining != 0) && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        nRemaining = XZstdEnc::ZSTD_endStream(pStream, &output);
+        bResult = !XZstdEnc::ZSTD_isError(nRemaining) && zstdFlushOutput(pCompressState, baOutput, &output);
+    }
+
+    XZstdEnc::ZSTD_freeCStream(pStream);
+
+    if (pnCRC32) {
+        *pnCRC32 = nCRC32 ^ 0xFFFFFFFF;
+    }
+
+    return bResult && (nRemaining == 0) && !pCompressState->bReadError && !pCompressState->bWriteError && XBinary::isPdStructNotCanceled(pPdStruct) &&
+           ((pCompressState->nInputLimit == -1) || (pCompressState->nCountInput == pCompressState->nInputLimit));
+}
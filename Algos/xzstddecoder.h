@@ -58,6 +58,9 @@ public:
     explicit XZstdDecoder(QObject *parent = nullptr);
 
     static bool decompress(XBinary::DATAPROCESS_STATE *pDecompressState, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    // Writes one frame; nCompressionLevel follows the usual 1..22 scale
+    static bool compress(XBinary::DATAPROCESS_STATE *pCompressState, XBinary::PDSTRUCT *pPdStruct = nullptr, qint32 nCompressionLevel = 3,
+                         quint32 *pnCRC32 = nullptr);
 };
 
 #endif  // XZSTDDECODER_H
@@ -0,0 +1,661 @@
+/* Copyright (c) 2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Offline throughput benchmark.  Synthetic corpora are generated from a fixed
+// seed, packed with the formats XArchive can write, and listed, extracted and
+// tested through the public XArchives API.  Extracted content is checked
+// against the corpus.  Archives of other formats (RAR, 7z, CAB, ...) can be
+// measured from a user-supplied --fixtures directory; there is no corpus to
+// check those against, so their results are marked unverified.  Results are
+// written as JSON so decoder throughput can be compared between builds.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+#include "x_ar.h"
+#include "xarchives.h"
+#include "xtar.h"
+#include "xzip.h"
+#include "xzlib.h"
+
+namespace {
+const qint64 N_BENCH_MIB = 1024 * 1024;
+const qint64 N_BENCH_CHUNK = 1024 * 1024;
+
+struct BENCH_OPTIONS {
+    quint64 nSeed;
+    qint64 nCorpusSize;   // text and random workloads
+    qint64 nHugeSize;     // single large file
+    qint32 nTinyCount;    // many small files
+    qint32 nIterations;
+    QString sFixturesPath;  // empty: synthetic corpora only
+};
+
+struct BENCH_WORKLOAD {
+    QString sName;
+    QString sFolder;
+    qint32 nNumberOfFiles;
+    qint64 nTotalSize;
+};
+
+enum BENCH_FORMAT {
+    BENCH_FORMAT_ZIP = 0,
+    BENCH_FORMAT_TAR,
+    BENCH_FORMAT_AR,
+    BENCH_FORMAT_ZLIB
+};
+
+struct BENCH_PACKER {
+    BENCH_FORMAT format;
+    QString sName;
+    QString sSuffix;
+    XBinary::HANDLE_METHOD method;
+    bool bSingleFile;  // one member only (zlib)
+};
+
+// xorshift64*: the corpora must be identical on every platform and Qt version.
+class BenchRandom {
+public:
+    explicit BenchRandom(quint64 nSeed) : m_nState(nSeed ? nSeed : 0x9E3779B97F4A7C15ULL)
+    {
+    }
+
+    quint64 next()
+    {
+        m_nState ^= m_nState >> 12;
+        m_nState ^= m_nState << 25;
+        m_nState ^= m_nState >> 27;
+        return m_nState * 0x2545F4914F6CDD1DULL;
+    }
+
+    quint32 bounded(quint32 nBound)
+    {
+        return (quint32)(next() % nBound);
+    }
+
+private:
+    quint64 m_nState;
+};
+
+QString benchMethodName(XBinary::HANDLE_METHOD method)
+{
+    return XBinary::handleMethodToString(method);
+}
+
+bool benchWriteText(const QString &sFileName, qint64 nSize, BenchRandom *pRandom)
+{
+    static const char *g_pszWords[] = {"archive", "record",  "stream", "header", "offset", "window", "decoder", "block",
+                                       "member",  "folder",  "solid",  "method", "packed", "volume", "index",   "table"};
+    const quint32 nNumberOfWords = sizeof(g_pszWords) / sizeof(g_pszWords[0]);
+
+    QFile file(sFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QByteArray baChunk;
+    baChunk.reserve((qint32)N_BENCH_CHUNK + 16);
+    qint64 nWritten = 0;
+    qint32 nColumn = 0;
+
+    while (nWritten < nSize) {
+        baChunk.clear();
+
+        while ((baChunk.size() < N_BENCH_CHUNK) && (nWritten + baChunk.size() < nSize)) {
+            baChunk.append(g_pszWords[pRandom->bounded(nNumberOfWords)]);
+            nColumn++;
+
+            if (nColumn == 12) {
+                baChunk.append('\n');
+                nColumn = 0;
+            } else {
+                baChunk.append(' ');
+            }
+        }
+
+        const qint64 nChunkSize = qMin((qint64)baChunk.size(), nSize - nWritten);
+        if (file.write(baChunk.constData(), nChunkSize) != nChunkSize) return false;
+        nWritten += nChunkSize;
+    }
+
+    return true;
+}
+
+bool benchWriteRandom(const QString &sFileName, qint64 nSize, BenchRandom *pRandom)
+{
+    QFile file(sFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QByteArray baChunk((qint32)N_BENCH_CHUNK, 0);
+    qint64 nWritten = 0;
+
+    while (nWritten < nSize) {
+        const qint64 nChunkSize = qMin(N_BENCH_CHUNK, nSize - nWritten);
+
+        // Little-endian words, the last one cut to the chunk's tail.
+        for (qint64 i = 0; i < nChunkSize; i += 8) {
+            uchar pValue[8];
+            qToLittleEndian<quint64>(pRandom->next(), pValue);
+            memcpy(baChunk.data() + i, pValue, (size_t)qMin((qint64)8, nChunkSize - i));
+        }
+
+        if (file.write(baChunk.constData(), nChunkSize) != nChunkSize) return false;
+        nWritten += nChunkSize;
+    }
+
+    return true;
+}
+
+bool benchCreateWorkloads(const QString &sRootPath, const BENCH_OPTIONS &options, QList<BENCH_WORKLOAD> *pListWorkloads)
+{
+    BenchRandom random(options.nSeed);
+    QDir dirRoot(sRootPath);
+
+    {
+        BENCH_WORKLOAD workload = {"text", dirRoot.filePath("text"), 1, options.nCorpusSize};
+        if (!dirRoot.mkpath("text") || !benchWriteText(QDir(workload.sFolder).filePath("text.txt"), workload.nTotalSize, &random)) return false;
+        pListWorkloads->append(workload);
+    }
+    {
+        BENCH_WORKLOAD workload = {"random", dirRoot.filePath("random"), 1, options.nCorpusSize};
+        if (!dirRoot.mkpath("random") || !benchWriteRandom(QDir(workload.sFolder).filePath("random.bin"), workload.nTotalSize, &random)) return false;
+        pListWorkloads->append(workload);
+    }
+    {
+        BENCH_WORKLOAD workload = {"tiny", dirRoot.filePath("tiny"), options.nTinyCount, 0};
+        if (!dirRoot.mkpath("tiny")) return false;
+
+        for (qint32 i = 0; i < options.nTinyCount; i++) {
+            const qint64 nSize = 16 + random.bounded(1024);
+            // Half text, half noise, so no method gets an all-compressible set.
+            const QString sFileName = QDir(workload.sFolder).filePath(QString("t%1.dat").arg(i, 5, 10, QLatin1Char('0')));
+            const bool bResult = (i & 1) ? benchWriteRandom(sFileName, nSize, &random) : benchWriteText(sFileName, nSize, &random);
+            if (!bResult) return false;
+            workload.nTotalSize += nSize;
+        }
+
+        pListWorkloads->append(workload);
+    }
+    {
+        BENCH_WORKLOAD workload = {"huge", dirRoot.filePath("huge"), 1, options.nHugeSize};
+        if (!dirRoot.mkpath("huge") || !benchWriteText(QDir(workload.sFolder).filePath("huge.txt"), workload.nTotalSize, &random)) return false;
+        pListWorkloads->append(workload);
+    }
+
+    return true;
+}
+
+bool benchPack(const BENCH_PACKER &packer, const BENCH_WORKLOAD &workload, const QString &sArchiveName)
+{
+    QFile file(sArchiveName);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate)) return false;
+
+    XZip zip;
+    XTAR tar;
+    X_Ar ar;
+    XZlib zlib;
+    XBinary *pPacker = nullptr;
+
+    if (packer.format == BENCH_FORMAT_ZIP) pPacker = &zip;
+    else if (packer.format == BENCH_FORMAT_TAR) pPacker = &tar;
+    else if (packer.format == BENCH_FORMAT_AR) pPacker = &ar;
+    else if (packer.format == BENCH_FORMAT_ZLIB) pPacker = &zlib;
+
+    if (!pPacker) return false;
+
+    QMap<XBinary::PACK_PROP, QVariant> mapProperties;
+    mapProperties.insert(XBinary::PACK_PROP_COMPRESSMETHOD, (qint32)packer.method);
+    mapProperties.insert(XBinary::PACK_PROP_PATHMODE, (qint32)XBinary::PATH_MODE_RELATIVE);
+    mapProperties.insert(XBinary::PACK_PROP_BASEPATH, workload.sFolder);
+
+    XBinary::PACK_STATE packState = {};
+    bool bResult = pPacker->initPack(&packState, &file, mapProperties);
+
+    if (bResult) {
+        if (packer.bSingleFile) {
+            const QStringList listFiles = QDir(workload.sFolder).entryList(QDir::Files, QDir::Name);
+            bResult = (listFiles.count() == 1) && pPacker->addFile(&packState, QDir(workload.sFolder).filePath(listFiles.first()));
+        } else {
+            bResult = pPacker->addFolder(&packState, workload.sFolder);
+        }
+    }
+
+    // finishPack also releases the pack context after a failed add.
+    bResult = pPacker->finishPack(&packState) && bResult;
+
+    return bResult;
+}
+
+// Size and CRC32 of one file.
+bool benchGetFileContent(const QString &sFileName, QPair<qint64, quint32> *pContent)
+{
+    QFile file(sFileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QByteArray baBuffer((qint32)N_BENCH_CHUNK, 0);
+    quint32 nCRC = 0xFFFFFFFFU;
+    qint64 nSize = 0;
+
+    while (true) {
+        const qint64 nRead = file.read(baBuffer.data(), baBuffer.size());
+        if (nRead < 0) return false;
+        if (nRead == 0) break;
+
+        nCRC = XBinary::_getCRC32(baBuffer.constData(), (qint32)nRead, nCRC, XBinary::_getCRC32Table_EDB88320());
+        nSize += nRead;
+    }
+
+    *pContent = qMakePair(nSize, nCRC ^ 0xFFFFFFFFU);
+
+    return true;
+}
+
+// Sizes and CRC32s of every file under sFolder, sorted.  Names are left out:
+// single-stream formats (zlib) do not store one.
+bool benchGetFolderContent(const QString &sFolder, QList<QPair<qint64, quint32>> *pListContent)
+{
+    pListContent->clear();
+    QDirIterator iterator(sFolder, QDir::Files, QDirIterator::Subdirectories);
+
+    while (iterator.hasNext()) {
+        QPair<qint64, quint32> content;
+        if (!benchGetFileContent(iterator.next(), &content)) return false;
+        pListContent->append(content);
+    }
+
+    std::sort(pListContent->begin(), pListContent->end());
+
+    return true;
+}
+
+// A measurement is only "ok" if the data it produced matches the corpus.
+void benchSetVerified(QJsonObject *pJsonMeasure, bool bVerified)
+{
+    if (pJsonMeasure->value("ok").toBool() && !bVerified) {
+        pJsonMeasure->insert("ok", false);
+        pJsonMeasure->insert("error", QString("content mismatch"));
+    }
+}
+
+// Runs function nIterations times; reports the best and median wall time.
+// setup runs before each iteration, outside the timed region.
+template <typename SETUP, typename FUNCTION>
+QJsonObject benchMeasure(qint32 nIterations, qint64 nBytes, SETUP setup, FUNCTION function)
+{
+    QList<qint64> listTimes;
+    bool bResult = true;
+
+    for (qint32 i = 0; (i < nIterations) && bResult; i++) {
+        setup();
+
+        QElapsedTimer timer;
+        timer.start();
+        bResult = function();
+        listTimes.append(timer.nsecsElapsed());
+    }
+
+    std::sort(listTimes.begin(), listTimes.end());
+
+    QJsonObject jsonResult;
+    jsonResult.insert("ok", bResult);
+
+    if (bResult && !listTimes.isEmpty()) {
+        const qint64 nBest = qMax((qint64)1, listTimes.first());
+        const qint64 nMedian = qMax((qint64)1, listTimes.at(listTimes.count() / 2));
+
+        jsonResult.insert("iterations", listTimes.count());
+        jsonResult.insert("best_ms", (double)nBest / 1000000.0);
+        jsonResult.insert("median_ms", (double)nMedian / 1000000.0);
+        jsonResult.insert("bytes", (double)nBytes);
+        jsonResult.insert("best_mib_s", ((double)nBytes / N_BENCH_MIB) / ((double)nBest / 1000000000.0));
+    }
+
+    return jsonResult;
+}
+
+template <typename FUNCTION>
+QJsonObject benchMeasure(qint32 nIterations, qint64 nBytes, FUNCTION function)
+{
+    return benchMeasure(nIterations, nBytes, []() {}, function);
+}
+
+// sSourceFolder is the corpus the archive was packed from; empty for fixtures.
+QJsonObject benchArchive(const QString &sArchiveName, const QString &sSourceFolder, const QString &sScratchPath, const BENCH_OPTIONS &options)
+{
+    QJsonObject jsonResult;
+    const QList<XArchive::RECORD> listRecords = XArchives::getRecords(sArchiveName);
+
+    qint64 nTotalSize = 0;
+    qint32 nMember = -1;
+
+    for (qint32 i = 0; i < listRecords.count(); i++) {
+        nTotalSize += qMax((qint64)0, listRecords.at(i).spInfo.nUncompressedSize);
+
+        // The largest member, so a single extract is not dominated by setup.
+        if ((nMember == -1) || (listRecords.at(i).spInfo.nUncompressedSize > listRecords.at(nMember).spInfo.nUncompressedSize)) {
+            nMember = i;
+        }
+    }
+
+    QJsonArray jsonMethods;
+    QSet<QString> stMethods;
+
+    for (qint32 i = 0; i < listRecords.count(); i++) {
+        const QString sMethod = benchMethodName(listRecords.at(i).spInfo.compressMethod);
+        if (!stMethods.contains(sMethod)) {
+            stMethods.insert(sMethod);
+            jsonMethods.append(sMethod);
+        }
+    }
+
+    jsonResult.insert("archive_bytes", (double)QFileInfo(sArchiveName).size());
+    jsonResult.insert("records", listRecords.count());
+    jsonResult.insert("uncompressed_bytes", (double)nTotalSize);
+    jsonResult.insert("record_methods", jsonMethods);
+
+    if (listRecords.isEmpty()) {
+        jsonResult.insert("error", QString("no records"));
+        return jsonResult;
+    }
+
+    const QString sExtractPath = QDir(sScratchPath).filePath("extract");
+    const QString sMemberName = QDir(sScratchPath).filePath("member.bin");
+    const QString sSessionPath = QDir(sScratchPath).filePath("session");
+    XArchive::RECORD record = listRecords.at(nMember);
+
+    jsonResult.insert("list", benchMeasure(options.nIterations, QFileInfo(sArchiveName).size(), [&]() {
+                          return !XArchives::getRecords(sArchiveName).isEmpty();
+                      }));
+
+    const bool bVerify = !sSourceFolder.isEmpty();
+    QList<QPair<qint64, quint32>> listSourceContent;
+    const bool bSourceContent = bVerify && benchGetFolderContent(sSourceFolder, &listSourceContent);
+    jsonResult.insert("verified", bVerify);
+
+    // Each run starts from an empty folder; the last run's output stays on
+    // disk and is compared with the corpus.
+    QJsonObject jsonExtract = benchMeasure(
+        options.nIterations, nTotalSize, [&]() { QDir(sExtractPath).removeRecursively(); },
+        [&]() { return XArchives::decompressToFolder(sArchiveName, sExtractPath); });
+    if (bVerify) {
+        QList<QPair<qint64, quint32>> listExtractContent;
+        benchSetVerified(&jsonExtract, bSourceContent && benchGetFolderContent(sExtractPath, &listExtractContent) &&
+                                           (listExtractContent == listSourceContent));
+    }
+    jsonResult.insert("extract", jsonExtract);
+
+    QJsonObject jsonMember = benchMeasure(options.nIterations, qMax((qint64)0, record.spInfo.nUncompressedSize), [&]() {
+        return XArchives::decompressToFile(sArchiveName, &record, sMemberName);
+    });
+    if (bVerify) {
+        QPair<qint64, quint32> memberContent;
+        benchSetVerified(&jsonMember, bSourceContent && benchGetFileContent(sMemberName, &memberContent) && listSourceContent.contains(memberContent));
+    }
+    jsonResult.insert("extract_member", jsonMember);
+
+    // The session path verifies each record's CRC against its own output file,
+    // so a round trip through it also covers the readable staging of results.
+    QJsonObject jsonSession;
+    XArchiveSession session;
+
+    if (session.open(sArchiveName)) {
+        QMap<qint32, QString> mapResultFileNames;
+
+        for (qint32 i = 0; i < session.getNumberOfRecords(); i++) {
+            mapResultFileNames.insert(i, QDir(sSessionPath).filePath(session.getRecord(i).spInfo.sRecordName));
+        }
+
+        jsonSession = benchMeasure(
+            options.nIterations, nTotalSize, [&]() { QDir(sSessionPath).removeRecursively(); },
+            [&]() { return session.decompressToFiles(mapResultFileNames); });
+        if (bVerify) {
+            QList<QPair<qint64, quint32>> listSessionContent;
+            benchSetVerified(&jsonSession, bSourceContent && benchGetFolderContent(sSessionPath, &listSessionContent) &&
+                                               (listSessionContent == listSourceContent));
+        }
+    } else {
+        jsonSession.insert("ok", false);
+        jsonSession.insert("error", QString("cannot open session"));
+    }
+
+    jsonResult.insert("session_extract", jsonSession);
+
+    jsonResult.insert("test", benchMeasure(options.nIterations, nTotalSize, [&]() {
+                          return XArchives::testArchive(sArchiveName, QMap<XBinary::UNPACK_PROP, QVariant>());
+                      }));
+
+    QDir(sExtractPath).removeRecursively();
+    QDir(sSessionPath).removeRecursively();
+    QFile::remove(sMemberName);
+
+    return jsonResult;
+}
+
+// Measured operations, summed per record method in the "methods" output.
+const char *const g_pszBenchOperations[] = {"list", "extract", "extract_member", "session_extract", "test"};
+
+// Bytes and best time per record method and operation, across formats and
+// workloads; archives mixing methods are left out.
+typedef QMap<QString, QMap<QString, QPair<double, double>>> BENCH_METHOD_TOTALS;
+
+void benchAddMethodTotals(const QJsonObject &jsonEntry, BENCH_METHOD_TOTALS *pMapTotals)
+{
+    const QJsonArray jsonMethods = jsonEntry.value("record_methods").toArray();
+    if (jsonMethods.count() != 1) return;
+
+    for (const char *pszOperation : g_pszBenchOperations) {
+        const QJsonObject jsonMeasure = jsonEntry.value(pszOperation).toObject();
+
+        if (jsonMeasure.value("ok").toBool()) {
+            QPair<double, double> &pair = (*pMapTotals)[jsonMethods.at(0).toString()][pszOperation];
+            pair.first += jsonMeasure.value("bytes").toDouble();
+            pair.second += jsonMeasure.value("best_ms").toDouble();
+        }
+    }
+}
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("xarchive_benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("XArchive list/extract/test throughput benchmark (JSON output)");
+    parser.addHelpOption();
+
+    QCommandLineOption optionOutput("output", "Write JSON to <file> instead of stdout.", "file");
+    QCommandLineOption optionSeed("seed", "Corpus seed.", "number", "1480675907");
+    QCommandLineOption optionSize("size", "Text and random corpus size in MiB.", "mib", "16");
+    QCommandLineOption optionHuge("huge", "Huge single-file corpus size in MiB.", "mib", "256");
+    QCommandLineOption optionTiny("tiny", "Number of files in the tiny-file corpus.", "count", "2000");
+    QCommandLineOption optionIterations("iterations", "Runs per measurement; best and median are reported.", "count", "3");
+    QCommandLineOption optionFixtures("fixtures", "Also benchmark every archive in <dir> (formats XArchive cannot pack); results are unverified.",
+                                      "dir");
+    parser.addOptions({optionOutput, optionSeed, optionSize, optionHuge, optionTiny, optionIterations, optionFixtures});
+    parser.process(app);
+
+    BENCH_OPTIONS options = {};
+    options.nSeed = parser.value(optionSeed).toULongLong();
+    options.nCorpusSize = qMax((qint64)1, parser.value(optionSize).toLongLong()) * N_BENCH_MIB;
+    options.nHugeSize = qMax((qint64)1, parser.value(optionHuge).toLongLong()) * N_BENCH_MIB;
+    options.nTinyCount = qMax(1, parser.value(optionTiny).toInt());
+    options.nIterations = qMax(1, parser.value(optionIterations).toInt());
+    options.sFixturesPath = parser.value(optionFixtures);
+
+    if (!options.sFixturesPath.isEmpty() && !QFileInfo(options.sFixturesPath).isDir()) {
+        qCritical("%s is not a directory", qPrintable(options.sFixturesPath));
+        return 1;
+    }
+
+    QTemporaryDir temporaryDir;
+    if (!temporaryDir.isValid()) {
+        qCritical("Cannot create temporary directory");
+        return 1;
+    }
+
+    QDir dirWork(temporaryDir.path());
+    QList<BENCH_WORKLOAD> listWorkloads;
+
+    if (!dirWork.mkpath("corpus") || !benchCreateWorkloads(dirWork.filePath("corpus"), options, &listWorkloads)) {
+        qCritical("Cannot generate corpus");
+        return 1;
+    }
+
+    const QList<BENCH_PACKER> listPackers = {
+        {BENCH_FORMAT_ZIP, "zip", "zip", XBinary::HANDLE_METHOD_STORE, false},
+        {BENCH_FORMAT_ZIP, "zip", "zip", XBinary::HANDLE_METHOD_DEFLATE, false},
+        {BENCH_FORMAT_ZIP, "zip", "zip", XBinary::HANDLE_METHOD_LZMA, false},
+        {BENCH_FORMAT_ZIP, "zip", "zip", XBinary::HANDLE_METHOD_ZSTD, false},
+        {BENCH_FORMAT_TAR, "tar", "tar", XBinary::HANDLE_METHOD_STORE, false},
+        {BENCH_FORMAT_AR, "ar", "a", XBinary::HANDLE_METHOD_STORE, false},
+        {BENCH_FORMAT_ZLIB, "zlib", "zlib", XBinary::HANDLE_METHOD_DEFLATE, true},
+    };
+
+    QJsonArray jsonResults;
+    BENCH_METHOD_TOTALS mapMethodTotals;
+    const QString sScratchPath = dirWork.filePath("scratch");
+    dirWork.mkpath("scratch");
+    dirWork.mkpath("archives");
+
+    for (const BENCH_WORKLOAD &workload : listWorkloads) {
+        for (const BENCH_PACKER &packer : listPackers) {
+            if (packer.bSingleFile && (workload.nNumberOfFiles != 1)) continue;
+
+            const QString sArchiveName = dirWork.filePath(QString("archives/%1_%2_%3.%4")
+                                                              .arg(workload.sName, packer.sName, benchMethodName(packer.method).toLower(), packer.sSuffix));
+
+            QJsonObject jsonEntry;
+            jsonEntry.insert("source", QString("synthetic"));
+            jsonEntry.insert("workload", workload.sName);
+            jsonEntry.insert("files", workload.nNumberOfFiles);
+            jsonEntry.insert("format", packer.sName);
+            jsonEntry.insert("method", benchMethodName(packer.method));
+
+            QElapsedTimer timer;
+            timer.start();
+            const bool bPacked = benchPack(packer, workload, sArchiveName);
+            jsonEntry.insert("pack_ms", (double)timer.nsecsElapsed() / 1000000.0);
+
+            if (bPacked) {
+                const QJsonObject jsonArchive = benchArchive(sArchiveName, workload.sFolder, sScratchPath, options);
+                for (QJsonObject::const_iterator iter = jsonArchive.constBegin(); iter != jsonArchive.constEnd(); ++iter) {
+                    jsonEntry.insert(iter.key(), iter.value());
+                }
+                benchAddMethodTotals(jsonEntry, &mapMethodTotals);
+            } else {
+                jsonEntry.insert("error", QString("pack failed"));
+            }
+
+            QFile::remove(sArchiveName);
+            jsonResults.append(jsonEntry);
+        }
+    }
+
+    if (!options.sFixturesPath.isEmpty()) {
+        QStringList listFixtures;
+        QDirIterator iterator(options.sFixturesPath, QDir::Files, QDirIterator::Subdirectories);
+
+        while (iterator.hasNext()) {
+            listFixtures.append(iterator.next());
+        }
+
+        listFixtures.sort();
+
+        for (const QString &sFixture : listFixtures) {
+            QJsonObject jsonEntry;
+            jsonEntry.insert("source", QString("fixture"));
+            jsonEntry.insert("workload", QDir(options.sFixturesPath).relativeFilePath(sFixture));
+            jsonEntry.insert("format", QFileInfo(sFixture).suffix().toLower());
+
+            const QJsonObject jsonArchive = benchArchive(sFixture, QString(), sScratchPath, options);
+            for (QJsonObject::const_iterator iter = jsonArchive.constBegin(); iter != jsonArchive.constEnd(); ++iter) {
+                jsonEntry.insert(iter.key(), iter.value());
+            }
+
+            const QJsonArray jsonRecordMethods = jsonEntry.value("record_methods").toArray();
+            jsonEntry.insert("method", (jsonRecordMethods.count() == 1) ? jsonRecordMethods.at(0).toString() : QString("mixed"));
+            benchAddMethodTotals(jsonEntry, &mapMethodTotals);
+            jsonResults.append(jsonEntry);
+        }
+    }
+
+    QJsonObject jsonMethods;
+    for (BENCH_METHOD_TOTALS::const_iterator iter = mapMethodTotals.constBegin(); iter != mapMethodTotals.constEnd(); ++iter) {
+        QJsonObject jsonMethod;
+
+        for (QMap<QString, QPair<double, double>>::const_iterator iterOperation = iter.value().constBegin(); iterOperation != iter.value().constEnd();
+             ++iterOperation) {
+            QJsonObject jsonOperation;
+            jsonOperation.insert("bytes", iterOperation.value().first);
+            jsonOperation.insert("best_ms", iterOperation.value().second);
+            if (iterOperation.value().second > 0) {
+                jsonOperation.insert("mib_s", (iterOperation.value().first / N_BENCH_MIB) / (iterOperation.value().second / 1000.0));
+            }
+            jsonMethod.insert(iterOperation.key(), jsonOperation);
+        }
+
+        jsonMethods.insert(iter.key(), jsonMethod);
+    }
+
+    QJsonObject jsonCorpus;
+    jsonCorpus.insert("seed", QString::number(options.nSeed));
+    jsonCorpus.insert("size_bytes", (double)options.nCorpusSize);
+    jsonCorpus.insert("huge_bytes", (double)options.nHugeSize);
+    jsonCorpus.insert("tiny_files", options.nTinyCount);
+
+    QJsonObject jsonRoot;
+    jsonRoot.insert("benchmark", QString("xarchive"));
+    jsonRoot.insert("schema", 2);
+    jsonRoot.insert("qt", QString(qVersion()));
+    jsonRoot.insert("iterations", options.nIterations);
+    jsonRoot.insert("corpus", jsonCorpus);
+    jsonRoot.insert("results", jsonResults);
+    jsonRoot.insert("methods", jsonMethods);
+
+    const QByteArray baJson = QJsonDocument(jsonRoot).toJson(QJsonDocument::Indented);
+    const QString sOutput = parser.value(optionOutput);
+
+    if (sOutput.isEmpty()) {
+        QFile fileOutput;
+        if (!fileOutput.open(stdout, QIODevice::WriteOnly) || (fileOutput.write(baJson) != baJson.size())) return 1;
+    } else {
+        QFile fileOutput(sOutput);
+        if (!fileOutput.open(QIODevice::WriteOnly | QIODevice::Truncate) || (fileOutput.write(baJson) != baJson.size())) {
+            qCritical("Cannot write %s", qPrintable(sOutput));
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -996,6 +996,11 @@ QMap<XBinary::UNPACK_PROP, QVariant> X_Ar::getDefaultUnpackProperties()
     return result;
 }
 
+bool X_Ar::isParallelUnpackSupported()
+{
+    return true;
+}
+
 bool X_Ar::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
 {
     if (m_bUnpackOperationInProgress) {
@@ -60,6 +60,10 @@ set(XARCHIVE_SOURCES
     ${CMAKE_CURRENT_LIST_DIR}/xdecompress.h
     ${CMAKE_CURRENT_LIST_DIR}/xcompresseddevice.cpp
     ${CMAKE_CURRENT_LIST_DIR}/xcompresseddevice.h
+    ${CMAKE_CURRENT_LIST_DIR}/xvolumesetdevice.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xvolumesetdevice.h
+    ${CMAKE_CURRENT_LIST_DIR}/xforwarddecoder.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/xforwarddecoder.h
     ${CMAKE_CURRENT_LIST_DIR}/xdeb.cpp
     ${CMAKE_CURRENT_LIST_DIR}/xdeb.h
     ${CMAKE_CURRENT_LIST_DIR}/xgzip.cpp
@@ -231,6 +235,7 @@ set(XARCHIVE_SOURCES
     ${CMAKE_CURRENT_LIST_DIR}/Algos/lz4declib.h
     ${CMAKE_CURRENT_LIST_DIR}/Algos/zstdlegacydeclib.h
     ${CMAKE_CURRENT_LIST_DIR}/Algos/zstddeclib.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Algos/zstdenclib.cpp
     # The five entries below were converted from C to C++ on 2026-08-17 and must
     # stay C++: they define ZSTDv05/06/07_* and ZBUFFv07_* symbols that no header
     # declares, so a C build of one and a C++ build of its caller fail at link,
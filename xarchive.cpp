@@ -26,22 +26,32 @@
 #include <limits>
 #include <memory>
 #include <new>
+#include <QAtomicInt>
 #include <QBuffer>
 #include <QCryptographicHash>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QHash>
+#include <QMutex>
+#include <QRunnable>
 #include <QSaveFile>
 #include <QSet>
 #include <QTemporaryFile>
+#include <QThread>
+#include <QThreadPool>
 #include <QUuid>
+#include <QVector>
 
 #ifdef Q_OS_WIN
 #include <io.h>
 #include <windows.h>
 #elif defined(Q_OS_UNIX)
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
 #endif
 
 namespace {
@@ -678,8 +688,365 @@ static bool archiveFingerprintSource(
     *pFingerprint = hash.result();
     return true;
 }
+
+// Marks the work file of an XArchive::OutputStage; only such a file may take the
+// decoder output in place (archiveIsFreshFileOutput()).
+const char ARCHIVE_STAGE_PROPERTY[] = "_xarchive_output_stage";
+
+// One independently decodable piece of a parallel folder extraction: a single
+// member, every member of one solid folder in archive order, or a run of small
+// neighbouring members that is read from the source in one request.
+struct ARCHIVE_PARALLEL_UNIT {
+    QVector<qint32> listRecords;
+    qint64 nReadOffset;
+    qint64 nReadSize;  // 0: members read the source directly
+};
+
+// Coalescing limits: members up to 1 MiB, separated by at most 64 KiB, are
+// merged into reads of up to 16 MiB.
+const qint64 N_ARCHIVE_COALESCE_EXTENT = 0x100000;
+const qint64 N_ARCHIVE_COALESCE_GAP = 0x10000;
+const qint64 N_ARCHIVE_COALESCE_RUN = 0x1000000;
+
+struct ARCHIVE_PARALLEL_CONTEXT {
+    QString sSourceFileName;
+    QString sCanonicalRoot;
+    QVector<XBinary::ARCHIVERECORD> listRecords;
+    QVector<QString> listResultFileNames;
+    QVector<QString> listSafeRecordPaths;
+    QVector<ARCHIVE_PARALLEL_UNIT> listUnits;
+    QMap<XBinary::UNPACK_PROP, QVariant> mapUnpackProperties;
+    QAtomicInt nNextUnit;
+    QAtomicInt nFailed;
+    QMutex mutexError;
+    QString sErrorString;
+    XBinary::PDSTRUCT *pPdStruct;
+};
+
+bool archiveIsRecordSolid(const XBinary::ARCHIVERECORD &archiveRecord)
+{
+    return archiveRecord.mapProperties.contains(XBinary::FPART_PROP_SOLIDFOLDERINDEX) ||
+           archiveRecord.mapProperties.value(XBinary::FPART_PROP_ISSOLID, false).toBool();
+}
+
+// Directory order often jumps back and forth across the source.  Units are
+// handed out by where their data starts instead, and runs of small
+// non-solid members become single sequential reads.  Output names stay
+// attached to the records, so the logical layout is unchanged.
+void archivePlanParallelUnits(ARCHIVE_PARALLEL_CONTEXT *pContext)
+{
+    QVector<ARCHIVE_PARALLEL_UNIT> listUnits = pContext->listUnits;
+    const QVector<XBinary::ARCHIVERECORD> &listRecords = pContext->listRecords;
+
+    std::stable_sort(listUnits.begin(), listUnits.end(), [&](const ARCHIVE_PARALLEL_UNIT &unit1, const ARCHIVE_PARALLEL_UNIT &unit2) {
+        return listRecords.at(unit1.listRecords.first()).nStreamOffset < listRecords.at(unit2.listRecords.first()).nStreamOffset;
+    });
+
+    QVector<ARCHIVE_PARALLEL_UNIT> listResult;
+
+    for (qint32 i = 0; i < listUnits.size(); i++) {
+        const ARCHIVE_PARALLEL_UNIT &unit = listUnits.at(i);
+        const XBinary::ARCHIVERECORD &archiveRecord = listRecords.at(unit.listRecords.first());
+        const bool bSmall =
+            (unit.listRecords.size() == 1) && !archiveIsRecordSolid(archiveRecord) && (archiveRecord.nStreamSize <= N_ARCHIVE_COALESCE_EXTENT);
+
+        if (bSmall && !listResult.isEmpty() && (listResult.last().nReadSize > 0)) {
+            ARCHIVE_PARALLEL_UNIT &run = listResult.last();
+            const qint64 nRunEnd = run.nReadOffset + run.nReadSize;
+            const qint64 nEnd = archiveRecord.nStreamOffset + archiveRecord.nStreamSize;
+
+            if ((archiveRecord.nStreamOffset >= nRunEnd) && ((archiveRecord.nStreamOffset - nRunEnd) <= N_ARCHIVE_COALESCE_GAP) &&
+                ((nEnd - run.nReadOffset) <= N_ARCHIVE_COALESCE_RUN)) {
+                run.listRecords.append(unit.listRecords.first());
+                run.nReadSize = nEnd - run.nReadOffset;
+                continue;
+            }
+        }
+
+        ARCHIVE_PARALLEL_UNIT next = unit;
+        next.nReadOffset = bSmall ? archiveRecord.nStreamOffset : 0;
+        next.nReadSize = bSmall ? qMax((qint64)1, archiveRecord.nStreamSize) : 0;
+        listResult.append(next);
+    }
+
+    // A run of one gains nothing from the extra copy.
+    for (qint32 i = 0; i < listResult.size(); i++) {
+        if (listResult.at(i).listRecords.size() == 1) {
+            listResult[i].nReadOffset = 0;
+            listResult[i].nReadSize = 0;
+        }
+    }
+
+    pContext->listUnits = listResult;
+}
+
+void archiveFailParallelUnit(ARCHIVE_PARALLEL_CONTEXT *pContext, const QString &sErrorString)
+{
+    QMutexLocker locker(&pContext->mutexError);
+    if (pContext->nFailed.testAndSetOrdered(0, 1)) {
+        pContext->sErrorString = sErrorString;
+    }
+}
+
+// Decodes one unit through the worker's own source handle and decoder; each
+// member is staged beside its destination and published only when complete.
+bool archiveUnpackParallelUnit(ARCHIVE_PARALLEL_CONTEXT *pContext, QFile *pSource, const ARCHIVE_PARALLEL_UNIT &unit)
+{
+    XDecompress xDecompress;
+    QIODevice *pInput = pSource;
+    QByteArray baRun;
+    QBuffer bufferRun;
+
+    if (unit.nReadSize > 0) {
+        if ((unit.nReadSize > (std::numeric_limits<int>::max)()) || !pSource->seek(unit.nReadOffset)) {
+            archiveFailParallelUnit(pContext, XArchive::tr("Cannot read file: %1").arg(pContext->sSourceFileName));
+            return false;
+        }
+        baRun = pSource->read(unit.nReadSize);
+        bufferRun.setBuffer(&baRun);
+        if ((baRun.size() != unit.nReadSize) || !bufferRun.open(QIODevice::ReadOnly)) {
+            archiveFailParallelUnit(pContext, XArchive::tr("Cannot read file: %1").arg(pContext->sSourceFileName));
+            return false;
+        }
+        pInput = &bufferRun;
+    }
+
+    for (qint32 i = 0; i < unit.listRecords.size(); i++) {
+        if (pContext->nFailed.loadAcquire() || !XBinary::isPdStructNotCanceled(pContext->pPdStruct)) return false;
+
+        const qint32 nRecord = unit.listRecords.at(i);
+        const QString &sResultFileName = pContext->listResultFileNames.at(nRecord);
+
+        XArchive::OutputStage outputStage(sResultFileName);
+        if (!outputStage.open()) {
+            archiveFailParallelUnit(pContext, XArchive::tr("Cannot create file: %1").arg(sResultFileName));
+            return false;
+        }
+
+        XBinary::ARCHIVERECORD archiveRecord = pContext->listRecords.at(nRecord);
+        if (unit.nReadSize > 0) {
+            archiveRecord.nStreamOffset -= unit.nReadOffset;
+        }
+
+        if (!xDecompress.decompressArchiveRecord(archiveRecord, pInput, outputStage.device(), pContext->mapUnpackProperties, pContext->pPdStruct) ||
+            !XBinary::isPdStructNotCanceled(pContext->pPdStruct)) {
+            archiveFailParallelUnit(pContext, XArchive::tr("Cannot decompress: %1").arg(sResultFileName));
+            return false;
+        }
+
+        if (archivePathHasUnsafeLink(pContext->sCanonicalRoot, pContext->listSafeRecordPaths.at(nRecord)) || !outputStage.commit()) {
+            archiveFailParallelUnit(pContext, XArchive::tr("Cannot write file: %1").arg(sResultFileName));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void archiveRunParallelUnits(ARCHIVE_PARALLEL_CONTEXT *pContext)
+{
+    QFile source(pContext->sSourceFileName);
+    bool bSourceOpened = false;
+    const qint32 nNumberOfUnits = pContext->listUnits.size();
+
+    while (true) {
+        const qint32 nIndex = pContext->nNextUnit.fetchAndAddOrdered(1);
+
+        if (nIndex >= nNumberOfUnits) {
+            break;
+        }
+
+        if (pContext->nFailed.loadAcquire() || !XBinary::isPdStructNotCanceled(pContext->pPdStruct)) {
+            continue;
+        }
+
+        if (!bSourceOpened) {
+            bSourceOpened = source.open(QIODevice::ReadOnly);
+            if (!bSourceOpened) {
+                archiveFailParallelUnit(pContext, XArchive::tr("Cannot open file: %1").arg(pContext->sSourceFileName));
+                continue;
+            }
+        }
+
+        archiveUnpackParallelUnit(pContext, &source, pContext->listUnits.at(nIndex));
+    }
+}
+
+class ArchiveParallelUnpackWorker : public QRunnable {
+public:
+    explicit ArchiveParallelUnpackWorker(ARCHIVE_PARALLEL_CONTEXT *pContext) : m_pContext(pContext)
+    {
+    }
+
+    void run() override
+    {
+        archiveRunParallelUnits(m_pContext);
+    }
+
+private:
+    ARCHIVE_PARALLEL_CONTEXT *m_pContext;
+};
 }  // namespace
 
+XArchive::OutputStage::OutputStage(const QString &sResultFileName)
+    : m_sResultFileName(QFileInfo(sResultFileName).absoluteFilePath()),
+      m_namedFile(QDir(QFileInfo(sResultFileName).absolutePath())
+                      .filePath(QLatin1String(".xarchive-XXXXXX"))),
+      m_bUnnamed(false),
+      m_bCommitted(false)
+{
+}
+
+bool XArchive::OutputStage::open()
+{
+    const bool bResult = _open();
+    if (bResult) {
+        device()->setProperty(ARCHIVE_STAGE_PROPERTY, true);
+    }
+    return bResult;
+}
+
+QFile *XArchive::OutputStage::device()
+{
+    return m_bUnnamed ? &m_unnamedFile : static_cast<QFile *>(&m_namedFile);
+}
+
+bool XArchive::OutputStage::commit()
+{
+    QFile *pFile = device();
+    // The data reaches the disk before any name points at it, so a crash
+    // cannot leave a complete-looking but empty or torn destination.
+    if (m_bCommitted || !pFile->isOpen() || !pFile->flush() ||
+        !_syncFile(pFile)) {
+        return false;
+    }
+    const QByteArray baTarget = QFile::encodeName(m_sResultFileName);
+    bool bResult = false;
+#if defined(Q_OS_LINUX) && defined(O_TMPFILE)
+    if (m_bUnnamed) {
+        const QByteArray baProcPath =
+            "/proc/self/fd/" + QByteArray::number((int)pFile->handle());
+        bResult = (::linkat(AT_FDCWD, baProcPath.constData(), AT_FDCWD,
+                            baTarget.constData(), AT_SYMLINK_FOLLOW) == 0);
+        if (!bResult) {
+            // linkat() never replaces, so an existing target fails with
+            // EEXIST; name the inode beside the target and rename that
+            // over it.
+            const QByteArray baLink = QFile::encodeName(
+                QDir(QFileInfo(m_sResultFileName).absolutePath())
+                    .filePath(QLatin1String(".xarchive-") +
+                              QString::fromLatin1(QUuid::createUuid()
+                                                      .toRfc4122()
+                                                      .toHex())));
+            if (::linkat(AT_FDCWD, baProcPath.constData(), AT_FDCWD,
+                         baLink.constData(), AT_SYMLINK_FOLLOW) == 0) {
+                bResult = (::rename(baLink.constData(),
+                                    baTarget.constData()) == 0);
+                if (!bResult) ::unlink(baLink.constData());
+            }
+        }
+        if (bResult) {
+            pFile->close();
+            m_bCommitted = true;
+            return true;
+        }
+        // The inode cannot be named here (no /proc, or a filesystem that
+        // refuses the link): copy it into the named sibling temporary and
+        // publish that instead.
+        bResult = _copyToNamedFile(pFile);
+        pFile->close();
+        if (!bResult) return false;
+    }
+#endif
+    const QString sStageFileName = m_namedFile.fileName();
+    m_namedFile.close();
+#ifdef Q_OS_WIN
+    bResult = MoveFileExW(
+        reinterpret_cast<const wchar_t *>(
+            QDir::toNativeSeparators(sStageFileName).utf16()),
+        reinterpret_cast<const wchar_t *>(
+            QDir::toNativeSeparators(m_sResultFileName).utf16()),
+        MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    bResult = (::rename(QFile::encodeName(sStageFileName).constData(),
+                        baTarget.constData()) == 0);
+#endif
+    if (bResult) m_namedFile.setAutoRemove(false);
+    m_bCommitted = bResult;
+    return bResult;
+}
+
+bool XArchive::OutputStage::_open()
+{
+#if defined(Q_OS_LINUX) && defined(O_TMPFILE)
+    const QByteArray baDirectory =
+        QFile::encodeName(QFileInfo(m_sResultFileName).absolutePath());
+    const int nHandle = ::open(baDirectory.constData(),
+                               O_TMPFILE | O_RDWR | O_CLOEXEC, 0666);
+    if (nHandle >= 0) {
+        if (m_unnamedFile.open(nHandle, QIODevice::ReadWrite,
+                               QFileDevice::AutoCloseHandle)) {
+            m_bUnnamed = true;
+            _inheritPermissions((int)m_unnamedFile.handle(), 0);
+            return true;
+        }
+        ::close(nHandle);
+    }
+#endif
+    if (!m_namedFile.open()) return false;
+#ifdef Q_OS_UNIX
+    // QTemporaryFile is owner-only; a fresh destination gets the usual
+    // rw-r--r-- instead.
+    _inheritPermissions((int)m_namedFile.handle(), 0644);
+#endif
+    return true;
+}
+
+bool XArchive::OutputStage::_syncFile(QFile *pFile)
+{
+#ifdef Q_OS_WIN
+    return FlushFileBuffers(
+               (HANDLE)_get_osfhandle((int)pFile->handle())) != 0;
+#elif defined(Q_OS_UNIX)
+    return ::fsync((int)pFile->handle()) == 0;
+#else
+    Q_UNUSED(pFile)
+    return true;
+#endif
+}
+
+bool XArchive::OutputStage::_copyToNamedFile(QFile *pSource)
+{
+    if (!m_namedFile.open() || !pSource->seek(0)) return false;
+#ifdef Q_OS_UNIX
+    _inheritPermissions((int)m_namedFile.handle(), 0644);
+#endif
+    QByteArray baBuffer(0x10000, Qt::Uninitialized);
+    qint64 nRead = 0;
+    while ((nRead = pSource->read(baBuffer.data(), baBuffer.size())) > 0) {
+        if (m_namedFile.write(baBuffer.constData(), nRead) != nRead) {
+            return false;
+        }
+    }
+    return (nRead == 0) && m_namedFile.flush() && _syncFile(&m_namedFile);
+}
+
+void XArchive::OutputStage::_inheritPermissions(int nHandle, int nDefaultMode)
+{
+#ifdef Q_OS_UNIX
+    struct stat status = {};
+    if (::stat(QFile::encodeName(m_sResultFileName).constData(),
+               &status) == 0) {
+        ::fchmod(nHandle, status.st_mode & 07777);
+    } else if (nDefaultMode) {
+        ::fchmod(nHandle, (mode_t)nDefaultMode);
+    }
+#else
+    Q_UNUSED(nHandle)
+    Q_UNUSED(nDefaultMode)
+#endif
+}
+
 QObject *XArchive::getArchiveSourceSessionRegistry(bool bCreate) const
 {
     if (!m_pArchiveSourceSessionRegistry && bCreate) {
@@ -1255,6 +1622,12 @@ bool XArchive::transferUnpackSourceOwnership(UNPACK_STATE *pFromState,
     return true;
 }
 
+const XBinary::PACK_PROP XArchive::PACK_PROP_STREAMING;
+const XBinary::UNPACK_PROP XArchive::UNPACK_PROP_MAPSOURCE;
+const XBinary::UNPACK_PROP XArchive::UNPACK_PROP_PARTIALWINDOW;
+const XBinary::UNPACK_PROP XArchive::UNPACK_PROP_THREADS;
+const XBinary::UNPACK_PROP XArchive::UNPACK_PROP_DECODERMEMORY;
+
 XArchive::XArchive(QIODevice *pDevice)
     : XBinary(pDevice),
       m_pArchiveSourceSessionRegistry(nullptr),
@@ -2015,8 +2388,8 @@ XArchive::COMPRESS_RESULT XArchive::_decompress(DECOMPRESSSTRUCT *pDecompressStr
     return result;
 }
 
-bool XArchive::_decompressRecord(const RECORD *pRecord, QIODevice *pSourceDevice, QIODevice *pDestDevice, PDSTRUCT *pPdStruct, qint64 nDecompressedOffset = 0,
-                                 qint64 nDecompressedLimit = -1)
+bool XArchive::_decompressRecord(const RECORD *pRecord, QIODevice *pSourceDevice, QIODevice *pDestDevice, PDSTRUCT *pPdStruct, qint64 nDecompressedOffset,
+                                 qint64 nDecompressedLimit, const QMap<UNPACK_PROP, QVariant> &mapUnpackProperties)
 {
     bool bResult = false;
 
@@ -2097,6 +2470,7 @@ bool XArchive::_decompressRecord(const RECORD *pRecord, QIODevice *pSourceDevice
         state.nInputLimit = record.nDataSize;
         state.nProcessedOffset = nDecompressedOffset;
         state.nProcessedLimit = nDecompressedLimit;
+        state.mapUnpackProperties = mapUnpackProperties;
 
         XDecompress decompressor;
         bResult = decompressor.multiDecompress(&state, pPdStruct);
@@ -2313,6 +2687,12 @@ XArchive::COMPRESS_RESULT XArchive::_compress_deflate(QIODevice *pSourceDevice,
 }
 
 QByteArray XArchive::decompress(const XArchive::RECORD *pRecord, PDSTRUCT *pPdStruct, qint64 nDecompressedOffset, qint64 nDecompressedLimit)
+{
+    return decompress(pRecord, QMap<UNPACK_PROP, QVariant>(), pPdStruct, nDecompressedOffset, nDecompressedLimit);
+}
+
+QByteArray XArchive::decompress(const XArchive::RECORD *pRecord, const QMap<UNPACK_PROP, QVariant> &mapUnpackProperties, PDSTRUCT *pPdStruct,
+                                qint64 nDecompressedOffset, qint64 nDecompressedLimit)
 {
     QByteArray result;
     QPointer<XArchive> guardedArchive(this);
@@ -2337,7 +2717,7 @@ QByteArray XArchive::decompress(const XArchive::RECORD *pRecord, PDSTRUCT *pPdSt
         if (!buffer.open(QIODevice::ReadWrite) ||
             !guardedArchive->unpackArchiveStreamRecord(
                 archiveRecord, &buffer,
-                QMap<UNPACK_PROP, QVariant>(), pPdStruct) ||
+                mapUnpackProperties, pPdStruct) ||
             !guardedArchive || !guardedSourceDevice ||
             !isProgressAlive() ||
             !XBinary::isPdStructNotCanceled(pPdStruct)) {
@@ -2367,7 +2747,8 @@ QByteArray XArchive::decompress(const XArchive::RECORD *pRecord, PDSTRUCT *pPdSt
     // verify the record's stored checksum, so a write-only destination fails
     // every record that carries one.
     if (buffer.open(QIODevice::ReadWrite)) {
-        const bool bDecompressed = _decompressRecord(pRecord, guardedSourceDevice.data(), &buffer, pPdStruct, nDecompressedOffset, nDecompressedLimit);
+        const bool bDecompressed =
+            _decompressRecord(pRecord, guardedSourceDevice.data(), &buffer, pPdStruct, nDecompressedOffset, nDecompressedLimit, mapUnpackProperties);
         buffer.close();
 
         // A QByteArray return value must never expose a valid-looking prefix
@@ -2487,54 +2868,26 @@ bool XArchive::decompressToFile(const XArchive::RECORD *pRecord, const QString &
         return outputFile.commit();
     }
 
-    // QSaveFile is deliberately write-only, while the shared decompressor
-    // rereads complete output for CRC/authentication.  Decode into a private
-    // readable temporary first, then copy the authenticated result into the
-    // atomic replacement file.
-    QTemporaryFile workFile;
-    if (!workFile.open()) {
+    // The shared decompressor rereads complete output for CRC/authentication,
+    // so it needs a readable file; decode into the destination's own work file
+    // and let it take the destination name only once the record is verified.
+    OutputStage outputStage(sResultFileName);
+    if (!outputStage.open()) {
         return false;
     }
 
     // A zero packed size is not proof of a valid empty member.  The selected
     // codec must still validate its terminator, declared output size, password,
     // and checksum contract.
-    const bool bResult = _decompressRecord(pRecord, guardedSourceDevice.data(), &workFile, pPdStruct, 0, -1);
+    const bool bResult = _decompressRecord(pRecord, guardedSourceDevice.data(), outputStage.device(), pPdStruct, 0, -1);
 
     if (!guardedArchive || !guardedSourceDevice || !bResult ||
         !isProgressAlive() || !XBinary::isPdStructNotCanceled(pPdStruct) ||
-        !workFile.seek(0)) {
+        (outputStage.device()->error() != QFile::NoError)) {
         return false;
     }
 
-    QSaveFile file(sResultFileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        return false;
-    }
-
-    QByteArray baBuffer(0x4000, 0);
-    qint64 nRemaining = workFile.size();
-    bool bCopyResult = nRemaining >= 0;
-    while (bCopyResult && (nRemaining > 0) && isProgressAlive() &&
-           XBinary::isPdStructNotCanceled(pPdStruct)) {
-        const qint64 nRead = archiveReadWithBoundedProgress(&workFile, baBuffer.data(), (std::min)(nRemaining, (qint64)baBuffer.size()));
-        if ((nRead <= 0) || (nRead > nRemaining) ||
-            !archiveWriteAll(&file, baBuffer.constData(), nRead,
-                             pPdStruct)) {
-            bCopyResult = false;
-            break;
-        }
-        nRemaining -= nRead;
-    }
-
-    if (!bCopyResult || (nRemaining != 0) || !isProgressAlive() ||
-        !XBinary::isPdStructNotCanceled(pPdStruct) ||
-        (file.error() != QFile::NoError)) {
-        file.cancelWriting();
-        return false;
-    }
-
-    return file.commit();
+    return outputStage.commit();
 }
 
 bool XArchive::decompressToDevice(const RECORD *pRecord, QIODevice *pDestDevice, PDSTRUCT *pPdStruct)
@@ -2824,55 +3177,20 @@ bool XArchive::unpackToFolder(const QString &sResultPathName, PDSTRUCT *pPdStruc
                        archivePathHasUnsafeLink(sCanonicalRoot, sSafeRecordPath)) {
                 bResult = false;
             } else {
-                const QString sOutputDirectory =
-                    QFileInfo(sResultFileName).absolutePath();
-                QTemporaryFile stagedFile(
-                    QDir(sOutputDirectory).filePath(
-                        QLatin1String(".xarchive-XXXXXX")));
-                if (!stagedFile.open() ||
-                    !guardedArchive->unpackCurrent(&state, &stagedFile,
+                XArchive::OutputStage outputStage(sResultFileName);
+                if (!outputStage.open() ||
+                    !guardedArchive->unpackCurrent(&state,
+                                                   outputStage.device(),
                                                    pPdStruct) ||
                     !guardedArchive || !isProgressAlive() ||
                     (state.nCurrentIndex != nExpectedIndex) ||
                     (state.nNumberOfRecords != nNumberOfRecords) ||
                     !isPdStructNotCanceled(pPdStruct) ||
-                    !stagedFile.seek(0) ||
                     archivePathHasUnsafeLink(sCanonicalRoot,
                                              sSafeRecordPath)) {
                     bResult = false;
                 } else {
-                    QSaveFile outputFile(sResultFileName);
-                    bool bPublished = outputFile.open(QIODevice::WriteOnly);
-                    QByteArray baBuffer(0x4000, 0);
-                    qint64 nRemaining = stagedFile.size();
-                    bPublished = bPublished && (nRemaining >= 0);
-
-                    while (bPublished && (nRemaining > 0) &&
-                           isProgressAlive() &&
-                           isPdStructNotCanceled(pPdStruct)) {
-                        const qint64 nRead = archiveReadWithBoundedProgress(
-                            &stagedFile, baBuffer.data(),
-                            (std::min)(nRemaining,
-                                       (qint64)baBuffer.size()));
-                        if ((nRead <= 0) || (nRead > nRemaining) ||
-                            !archiveWriteAll(&outputFile,
-                                             baBuffer.constData(), nRead,
-                                             pPdStruct)) {
-                            bPublished = false;
-                            break;
-                        }
-                        nRemaining -= nRead;
-                    }
-
-                    if (!bPublished || (nRemaining != 0) ||
-                        !isProgressAlive() ||
-                        !isPdStructNotCanceled(pPdStruct) ||
-                        (outputFile.error() != QFile::NoError)) {
-                        outputFile.cancelWriting();
-                        bResult = false;
-                    } else {
-                        bResult = outputFile.commit();
-                    }
+                    bResult = outputStage.commit();
                 }
             }
         }
@@ -2912,6 +3230,145 @@ bool XArchive::unpackToFolder(const QString &sResultPathName, PDSTRUCT *pPdStruc
            isPdStructNotCanceled(pPdStruct);
 }
 
+bool XArchive::isParallelUnpackSupported()
+{
+    return false;
+}
+
+bool XArchive::unpackToFolderParallel(const QString &sResultPathName, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
+{
+    QPointer<XArchive> guardedArchive(this);
+    PDSTRUCT pdStructEmpty = {};
+    if (!pPdStruct) {
+        pdStructEmpty = XBinary::createPdStruct();
+        pPdStruct = &pdStructEmpty;
+    }
+    if (!isPdStructNotCanceled(pPdStruct)) return false;
+
+    // Workers read through their own handles, so the source must be reopenable
+    // by name.
+    QPointer<QFile> guardedSourceFile(qobject_cast<QFile *>(getDevice()));
+    const qint32 nNumberOfThreads = qMax(1, QThread::idealThreadCount());
+
+    if (!isParallelUnpackSupported() || !guardedSourceFile || guardedSourceFile->fileName().isEmpty()) {
+        return guardedArchive->XBinary::unpackToFolder(sResultPathName, mapProperties, pPdStruct);
+    }
+
+    QString sCanonicalRoot = _normalizeOutputPath(QDir(sResultPathName).absolutePath());
+    if (!XBinary::createDirectory(sCanonicalRoot)) return false;
+    sCanonicalRoot = QDir::fromNativeSeparators(QFileInfo(sCanonicalRoot).canonicalFilePath());
+    if (sCanonicalRoot.isEmpty() || !QFileInfo(sCanonicalRoot).isDir()) return false;
+
+    ARCHIVE_PARALLEL_CONTEXT context;
+    context.sSourceFileName = guardedSourceFile->fileName();
+    context.sCanonicalRoot = sCanonicalRoot;
+    context.pPdStruct = pPdStruct;
+
+    // List once.  Folders are created here so that workers only ever publish
+    // files; members of one solid folder stay together in archive order.
+    UNPACK_STATE state = {};
+    if (!guardedArchive->initUnpack(&state, mapProperties, pPdStruct) || !guardedArchive) return false;
+
+    context.mapUnpackProperties = state.mapUnpackProperties;
+
+    bool bResult = (state.nCurrentIndex == 0) && (state.nNumberOfRecords >= 0);
+    bool bParallel = bResult;
+    QSet<QString> stResultFileNames;
+    QMap<qint64, qint32> mapSolidUnits;
+
+    while (bResult && (state.nCurrentIndex < state.nNumberOfRecords) && isPdStructNotCanceled(pPdStruct)) {
+        const ARCHIVERECORD archiveRecord = guardedArchive->infoCurrent(&state, pPdStruct);
+        if (!guardedArchive || archiveRecord.mapProperties.isEmpty() || !XBinary::isArchiveRecordExtentValid(archiveRecord)) {
+            bResult = false;
+            break;
+        }
+
+        qint32 nArchiveStreamIndex = -1;
+        const QString sRecordName = QDir::fromNativeSeparators(archiveRecord.mapProperties.value(FPART_PROP_ORIGINALNAME).toString());
+        QString sSafeRecordPath;
+
+        if (!archiveGetSafeRelativePath(sRecordName, &sSafeRecordPath)) {
+            bResult = false;
+        } else if (!sSafeRecordPath.isEmpty()) {
+            const QString sResultFileName = _normalizeOutputPath(QDir(sCanonicalRoot).absoluteFilePath(sSafeRecordPath));
+            const bool bIsFolder = archiveRecord.mapProperties.value(FPART_PROP_ISFOLDER, false).toBool() || sRecordName.endsWith(QLatin1Char('/'));
+
+            if (!_isSafeChildPath(sResultFileName, sCanonicalRoot) || archivePathHasUnsafeLink(sCanonicalRoot, sSafeRecordPath)) {
+                bResult = false;
+            } else if (bIsFolder) {
+                bResult = XBinary::createDirectory(sResultFileName);
+            } else if (XBinary::getArchiveStreamRecordIndex(archiveRecord, &nArchiveStreamIndex)) {
+                // Session-only members need the sequential unpackCurrent().
+                bParallel = false;
+            } else {
+                // A name that repeats is overwritten in archive order, which
+                // only the sequential path preserves.
+                const QString sKey = sResultFileName.toLower();
+                if (stResultFileNames.contains(sKey)) bParallel = false;
+                stResultFileNames.insert(sKey);
+
+                if (!XBinary::createDirectory(QFileInfo(sResultFileName).absolutePath())) {
+                    bResult = false;
+                } else {
+                    const qint32 nRecord = context.listRecords.size();
+                    context.listRecords.append(archiveRecord);
+                    context.listResultFileNames.append(sResultFileName);
+                    context.listSafeRecordPaths.append(sSafeRecordPath);
+
+                    if (archiveRecord.mapProperties.contains(FPART_PROP_SOLIDFOLDERINDEX)) {
+                        const qint64 nSolidFolder = archiveRecord.mapProperties.value(FPART_PROP_SOLIDFOLDERINDEX).toLongLong();
+                        if (!mapSolidUnits.contains(nSolidFolder)) {
+                            mapSolidUnits.insert(nSolidFolder, context.listUnits.size());
+                            context.listUnits.append(ARCHIVE_PARALLEL_UNIT());
+                        }
+                        context.listUnits[mapSolidUnits.value(nSolidFolder)].listRecords.append(nRecord);
+                    } else {
+                        ARCHIVE_PARALLEL_UNIT unit = {};
+                        unit.listRecords.append(nRecord);
+                        context.listUnits.append(unit);
+                    }
+                }
+            }
+        }
+
+        if (!bResult || !guardedArchive->moveToNext(&state, pPdStruct) || !guardedArchive) break;
+    }
+
+    bResult = bResult && guardedArchive && (state.nCurrentIndex >= (state.nNumberOfRecords - 1));
+    const bool bFinished = guardedArchive && guardedArchive->finishUnpack(&state, nullptr);
+
+    if (!bResult || !bFinished || !isPdStructNotCanceled(pPdStruct)) return false;
+
+    if (!bParallel || (context.listUnits.size() < 2)) {
+        return guardedArchive->XBinary::unpackToFolder(sResultPathName, mapProperties, pPdStruct);
+    }
+
+    archivePlanParallelUnits(&context);
+
+    {
+        QThreadPool threadPool;
+        const qint32 nNumberOfWorkers = qMin(nNumberOfThreads, context.listUnits.size()) - 1;
+        threadPool.setMaxThreadCount(qMax(1, nNumberOfWorkers));
+
+        for (qint32 i = 0; i < nNumberOfWorkers; i++) {
+            threadPool.start(new ArchiveParallelUnpackWorker(&context));
+        }
+
+        archiveRunParallelUnits(&context);
+
+        threadPool.waitForDone();
+    }
+
+    if (context.nFailed.loadAcquire()) {
+        if (!context.sErrorString.isEmpty()) {
+            XBinary::setPdStructErrorString(pPdStruct, context.sErrorString);
+        }
+        return false;
+    }
+
+    return guardedArchive && isPdStructNotCanceled(pPdStruct);
+}
+
 bool XArchive::decompressToPath(const QString &sArchiveFileName, const QString &sRecordPathName, const QString &sResultPathName, PDSTRUCT *pPdStruct)
 {
     bool bResult = false;
@@ -3385,6 +3842,71 @@ bool XArchive::publishUnpackOutput(QIODevice *pStageDevice,
     return true;
 }
 
+// The empty work file of an OutputStage, at offset zero, is not
+// visible under the destination name until commit(), so a failed record
+// clobbers nothing there and the decoder may write into it directly.  Any
+// other file, even an empty one, belongs to the caller and is staged.
+static bool archiveIsFreshFileOutput(QIODevice *pDevice)
+{
+    QPointer<QFile> guardedFile(qobject_cast<QFile *>(pDevice));
+    if (!guardedFile || !guardedFile->isOpen() || !guardedFile->isReadable() ||
+        !guardedFile->property(ARCHIVE_STAGE_PROPERTY).toBool())
+        return false;
+    const qint64 nSize = guardedFile->size();
+    if (!guardedFile) return false;
+    const qint64 nPosition = guardedFile->pos();
+    return guardedFile && (nSize == 0) && (nPosition == 0);
+}
+
+bool XArchive::_unpackCurrentDirect(const UNPACK_STATE *pState,
+                                    const ARCHIVERECORD &archiveRecord,
+                                    const SOURCE_DEVICE_SNAPSHOT &sourceSnapshot,
+                                    QIODevice *pDevice, PDSTRUCT *pPdStruct)
+{
+    QPointer<XArchive> guardedArchive(this);
+    QPointer<QIODevice> guardedOutput(pDevice);
+    QPointer<QIODevice> guardedSource(getDevice());
+    if (!guardedOutput || !guardedSource) return false;
+
+    XDecompress xDecompress;
+    connect(&xDecompress, &XDecompress::errorMessage,
+            this, &XBinary::errorMessage);
+    connect(&xDecompress, &XDecompress::infoMessage,
+            this, &XBinary::infoMessage);
+
+    bool bResult = xDecompress.decompressArchiveRecord(
+        archiveRecord, guardedSource.data(), guardedOutput.data(),
+        pState->mapUnpackProperties, pPdStruct);
+    bResult = bResult && guardedArchive && guardedOutput && guardedSource &&
+              guardedArchive->isSourceDeviceSnapshotCurrent(
+                  sourceSnapshot, guardedArchive->getDevice(), pPdStruct) &&
+              guardedArchive && guardedOutput &&
+              guardedArchive->isUnpackOutputSupported(guardedOutput.data()) &&
+              guardedArchive && guardedOutput &&
+              XBinary::isPdStructNotCanceled(pPdStruct);
+
+    qint64 nPublished = -1;
+    if (bResult) {
+        nPublished = guardedOutput->size();
+        bResult = guardedOutput && (nPublished >= 0) &&
+                  guardedOutput->seek(nPublished) && guardedArchive &&
+                  guardedOutput;
+    }
+
+    // As in publishUnpackOutput, source authentication is the last check.
+    if (bResult) {
+        bResult = guardedArchive->isUnpackSourceCurrent(pState, pPdStruct) &&
+                  guardedArchive && guardedOutput && guardedSource;
+    }
+
+    if (!bResult && guardedOutput) {
+        XBinary::resize(guardedOutput.data(), 0);
+        if (guardedOutput) guardedOutput->seek(0);
+    }
+
+    return bResult;
+}
+
 bool XArchive::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct)
 {
     UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress);
@@ -3446,14 +3968,21 @@ bool XArchive::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT
                    &emptyStage, guardedOutput.data(), pState, pPdStruct);
     }
 
-    // Decode and authenticate into private storage first.  Caller-owned
-    // destinations are published only after the complete record succeeds, so
-    // decoder, CRC, cancellation and source-mutation failures cannot expose a
-    // partial result.
     const qint64 nExpectedSize = archiveRecord.mapProperties
         .value(XBinary::FPART_PROP_UNCOMPRESSEDSIZE, (qint64)0)
         .toLongLong();
     if (nExpectedSize < 0) return false;
+    // An OutputStage work file is itself private until its commit, so
+    // the record is decoded into it in place.
+    if (archiveIsFreshFileOutput(guardedOutput.data())) {
+        return guardedArchive->_unpackCurrentDirect(
+            pState, archiveRecord, sourceSnapshot, guardedOutput.data(),
+            pPdStruct);
+    }
+    // Any other destination belongs to the caller: decode and authenticate
+    // into private storage first and publish only after the complete record
+    // succeeds, so decoder, CRC, cancellation and source-mutation failures
+    // cannot expose a partial result.
     QIODevice *pWorkDevice = XBinary::createFileBuffer(
         nExpectedSize, pPdStruct);
     if (!pWorkDevice) {
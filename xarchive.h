@@ -32,6 +32,7 @@
 #include "Algos/xlzmadecoder.h"
 #include "Algos/xlzssdecoder.h"
 #include <QSharedPointer>
+#include <QTemporaryFile>
 
 class XArchive : public XBinary {
     Q_OBJECT
@@ -39,6 +40,38 @@ class XArchive : public XBinary {
 public:
     struct INTERNAL_INFO : XBinary::INTERNAL_INFO {};
 
+    // Work file created beside a file destination.  A record is decoded
+    // straight into it and it takes the destination name only after the
+    // record has been authenticated, so every extracted byte is written once
+    // and the device stays readable for the CRC check.  On Linux it is an
+    // unnamed O_TMPFILE inode that linkat() names at commit; other systems,
+    // and filesystems without O_TMPFILE, use a hidden sibling temporary
+    // instead.  The final step is always a same-directory rename, so a reader
+    // sees either the old file or the complete new one.
+    class OutputStage {
+    public:
+        explicit OutputStage(const QString &sResultFileName);
+
+        bool open();
+        QFile *device();
+        bool commit();
+
+    private:
+        bool _open();
+        static bool _syncFile(QFile *pFile);
+        bool _copyToNamedFile(QFile *pSource);
+        // Replacing a file keeps its permissions, as QSaveFile does.
+        void _inheritPermissions(int nHandle, int nDefaultMode);
+
+        QString m_sResultFileName;
+        QFile m_unnamedFile;
+        QTemporaryFile m_namedFile;
+        bool m_bUnnamed;
+        bool m_bCommitted;
+
+        Q_DISABLE_COPY(OutputStage)
+    };
+
     struct SOURCE_DEVICE_CHAIN_ITEM {
         QPointer<QIODevice> pDevice;
         bool bIsSubDevice;
@@ -139,6 +172,18 @@ public:
     static const qint32 COMPRESS_BUFFERSIZE = 0x4000;    // TODO Check mb set/get ???
     static const qint32 DECOMPRESS_BUFFERSIZE = 0x4000;  // TODO Check mb set/get ???
 
+    // Properties beyond the XBinary enums; the values are assigned in XDecompress (N_PROP_EXTENSION).
+    // bool: write once, sizes follow the data
+    static const PACK_PROP PACK_PROP_STREAMING = XDecompress::PACK_PROP_STREAMING;
+    // bool: decode file-backed members from a QFile::map view (see XDecompress)
+    static const UNPACK_PROP UNPACK_PROP_MAPSOURCE = XDecompress::UNPACK_PROP_MAPSOURCE;
+    // bool: windowed reads stop at the window end and skip the record CRC (see XDecompress)
+    static const UNPACK_PROP UNPACK_PROP_PARTIALWINDOW = XDecompress::UNPACK_PROP_PARTIALWINDOW;
+    // qint32: decoder threads, 0 means all cores (see XDecompress)
+    static const UNPACK_PROP UNPACK_PROP_THREADS = XDecompress::UNPACK_PROP_THREADS;
+    // qint64: decoder memory budget in bytes (see XDecompress)
+    static const UNPACK_PROP UNPACK_PROP_DECODERMEMORY = XDecompress::UNPACK_PROP_DECODERMEMORY;
+
     bool captureSourceDeviceSnapshot(QIODevice *pDevice, SOURCE_DEVICE_SNAPSHOT *pSnapshot);
     bool isSourceDeviceSnapshotCurrent(const SOURCE_DEVICE_SNAPSHOT &snapshot,
                                        QIODevice *pCurrentDevice,
@@ -326,6 +371,13 @@ protected:
     bool publishUnpackOutput(QIODevice *pStageDevice, QIODevice *pOutputDevice,
                              const UNPACK_STATE *pState,
                              PDSTRUCT *pPdStruct = nullptr);
+    // Decodes straight into an empty file destination, truncating it back to
+    // empty on failure; used instead of the stage copy when there is nothing
+    // in the destination to preserve.
+    bool _unpackCurrentDirect(const UNPACK_STATE *pState,
+                              const ARCHIVERECORD &archiveRecord,
+                              const SOURCE_DEVICE_SNAPSHOT &sourceSnapshot,
+                              QIODevice *pDevice, PDSTRUCT *pPdStruct);
 
     bool isDeviceReplacementAllowed() const override
     {
@@ -473,11 +525,13 @@ public:
 
     static COMPRESS_RESULT _decompress(DECOMPRESSSTRUCT *pDecompressStruct, PDSTRUCT *pPdStruct = nullptr);
     static bool _decompressRecord(const RECORD *pRecord, QIODevice *pSourceDevice, QIODevice *pDestDevice, PDSTRUCT *pPdStruct, qint64 nDecompressedOffset,
-                                  qint64 nDecompressedLimit);
+                                  qint64 nDecompressedLimit, const QMap<UNPACK_PROP, QVariant> &mapUnpackProperties = QMap<UNPACK_PROP, QVariant>());
     static COMPRESS_RESULT _compress(HANDLE_METHOD compressMethod, QIODevice *pSourceDevice, QIODevice *pDestDevice, PDSTRUCT *pPdStruct = nullptr);
     static COMPRESS_RESULT _compress_deflate(QIODevice *pSourceDevice, QIODevice *pDestDevice, qint32 nLevel, qint32 nMethod, qint32 nWindowsBits, qint32 nMemLevel,
                                              qint32 nStrategy, PDSTRUCT *pPdStruct = nullptr);
     QByteArray decompress(const RECORD *pRecord, PDSTRUCT *pPdStruct = nullptr, qint64 nDecompressedOffset = 0, qint64 nDecompressedLimit = -1);
+    QByteArray decompress(const RECORD *pRecord, const QMap<UNPACK_PROP, QVariant> &mapUnpackProperties, PDSTRUCT *pPdStruct = nullptr,
+                          qint64 nDecompressedOffset = 0, qint64 nDecompressedLimit = -1);
     QByteArray decompress(QList<RECORD> *pListArchive, const QString &sRecordFileName, PDSTRUCT *pPdStruct = nullptr);
     QByteArray decompress(const QString &sRecordFileName, PDSTRUCT *pPdStruct = nullptr);
     bool decompressToFile(const RECORD *pRecord, const QString &sResultFileName, PDSTRUCT *pPdStruct = nullptr);
@@ -494,6 +548,15 @@ public:
         const QMap<UNPACK_PROP, QVariant> &mapProperties,
         PDSTRUCT *pPdStruct = nullptr);
     bool unpackToFolder(const QString &sResultPathName, PDSTRUCT *pPdStruct = nullptr);
+    // Property-aware folder extraction.  Formats that opt in through
+    // isParallelUnpackSupported() are listed once and their independent units
+    // (single members, or whole solid folders) are decoded on a thread pool in
+    // source offset order, with small neighbouring members read together;
+    // everything else runs the sequential streaming extraction.
+    bool unpackToFolderParallel(const QString &sResultPathName, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr);
+    // True when every record decodes from its own extent through the base
+    // unpackCurrent(), with no session state shared between members.
+    virtual bool isParallelUnpackSupported();
     bool dumpToFile(const RECORD *pRecord, const QString &sFileName, PDSTRUCT *pPdStruct = nullptr);
     static RECORD getArchiveRecord(const QString &sRecordFileName, QList<RECORD> *pListRecords, PDSTRUCT *pPdStruct = nullptr);
     static RECORD getArchiveRecordByUUID(const QString &sUUID, QList<RECORD> *pListRecords, PDSTRUCT *pPdStruct = nullptr);
@@ -153,6 +153,8 @@ HEADERS += \
     $$PWD/xcompress.h \
     $$PWD/xdecompress.h \
     $$PWD/xcompresseddevice.h \
+    $$PWD/xvolumesetdevice.h \
+    $$PWD/xforwarddecoder.h \
     $$PWD/xdeb.h \
     $$PWD/xdos16.h \
     $$PWD/xgzip.h \
@@ -257,6 +259,8 @@ SOURCES += \
     $$PWD/xcompress.cpp \
     $$PWD/xdecompress.cpp \
     $$PWD/xcompresseddevice.cpp \
+    $$PWD/xvolumesetdevice.cpp \
+    $$PWD/xforwarddecoder.cpp \
     $$PWD/xdeb.cpp \
     $$PWD/xdos16.cpp \
     $$PWD/xgzip.cpp \
@@ -350,6 +354,13 @@ SOURCES += \
     SOURCES += $$PWD/Algos/zstddeclib.cpp
 }
 
+# The Zstandard compressor used by XZip packing. Its symbols live in namespace
+# XZstdEnc, so it links next to zstddeclib.cpp without clashes.
+!contains(XCONFIG, xarchive_zstdenclib) {
+    XCONFIG += xarchive_zstdenclib
+    SOURCES += $$PWD/Algos/zstdenclib.cpp
+}
+
 # Versioned Zstandard symbols and namespaced xxHash are independent of the
 # guarded single-file current-format decoder above. Keep a separate guard so
 # projects that included zstddeclib through another module still receive the
@@ -20,11 +20,23 @@
  */
 #include "xarchives.h"
 
+#include <algorithm>
+#include <new>
+
 #include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
 #include <QFileInfo>
+#include <QMutex>
 #include <QSaveFile>
 #include <QTemporaryDir>
 
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
 #include "xfilteredarchive.h"
 
 namespace {
@@ -186,12 +198,280 @@ bool unpackStaticRecord(XBinary *pBinary, const XArchive::RECORD *pRecord,
         QMap<XBinary::UNPACK_PROP, QVariant>(), pPdStruct);
 }
 
+QByteArray decompressRecord(QIODevice *pDevice, XBinary::FT fileType, const XArchive::RECORD *pRecord, XBinary::PDSTRUCT *pPdStruct,
+                            qint64 nDecompressedOffset, qint64 nDecompressedSize,
+                            const QMap<XBinary::UNPACK_PROP, QVariant> &mapUnpackProperties = QMap<XBinary::UNPACK_PROP, QVariant>())
+{
+    QByteArray baResult;
+
+    if (!pDevice || !pRecord || (nDecompressedOffset < 0) ||
+        (nDecompressedSize < -1) ||
+        !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return baResult;
+    }
+
+    XBinary *pBinary = XFormats::createClass(fileType, pDevice);
+
+    if (pBinary && XFormats::isStaticUnpacker(fileType)) {
+        QBuffer buffer(&baResult);
+        const bool bOpened = buffer.open(QIODevice::ReadWrite);
+        const bool bUnpacked = bOpened &&
+            unpackStaticRecord(pBinary, pRecord, &buffer, pPdStruct);
+        buffer.close();
+
+        if (!bUnpacked || !XBinary::isPdStructNotCanceled(pPdStruct) ||
+            (nDecompressedOffset > baResult.size())) {
+            baResult.clear();
+        } else if ((nDecompressedOffset != 0) ||
+                   (nDecompressedSize != -1)) {
+            const qint64 nAvailable = baResult.size() - nDecompressedOffset;
+            const qint64 nResultSize = (nDecompressedSize == -1)
+                ? nAvailable : qMin(nAvailable, nDecompressedSize);
+            baResult = baResult.mid((qint32)nDecompressedOffset,
+                                    (qint32)nResultSize);
+        }
+
+        delete pBinary;
+        return baResult;
+    }
+
+    XArchive *pArchives = dynamic_cast<XArchive *>(pBinary);
+
+    if (pArchives) {
+        baResult = pArchives->decompress(pRecord, mapUnpackProperties, pPdStruct, nDecompressedOffset, nDecompressedSize);
+    }
+
+    delete pBinary;
+
+    return baResult;
+}
+
+// Optional sidecar listing index.  A listing is stored in the cache directory
+// under a name derived from the archive path and is reused only while the
+// archive's size, modification time, file id and the hash of its first and
+// last 64 KiB all still match.  Nothing is read or written while the
+// directory is empty.
+const quint32 N_LISTING_CACHE_MAGIC = 0x58494458;  // "XDIX"
+const quint32 N_LISTING_CACHE_VERSION = 1;
+const qint64 N_LISTING_CACHE_PROBE_SIZE = 0x10000;
+const qint32 N_LISTING_CACHE_MAX_RECORDS = 0x4000000;
+
+struct LISTING_CACHE_KEY {
+    qint64 nSize;
+    qint64 nModified;
+    quint64 nDevice;
+    quint64 nInode;
+    QByteArray baHeaderHash;
+};
+
+QMutex &listingCacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QString &listingCacheDirectory()
+{
+    static QString sDirectory;
+    return sDirectory;
+}
+
+QString listingCacheGetDirectory()
+{
+    QMutexLocker locker(&listingCacheMutex());
+    return listingCacheDirectory();
+}
+
+bool listingCacheKey(QFile *pFile, LISTING_CACHE_KEY *pKey)
+{
+    const QFileInfo fileInfo(pFile->fileName());
+    if (!fileInfo.exists()) return false;
+
+    pKey->nSize = pFile->size();
+    pKey->nModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    pKey->nDevice = 0;
+    pKey->nInode = 0;
+#ifdef Q_OS_UNIX
+    struct stat status = {};
+    if (::fstat(pFile->handle(), &status) != 0) return false;
+    pKey->nDevice = (quint64)status.st_dev;
+    pKey->nInode = (quint64)status.st_ino;
+#endif
+
+    const qint64 nPosition = pFile->pos();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!pFile->seek(0)) return false;
+    hash.addData(pFile->read(N_LISTING_CACHE_PROBE_SIZE));
+    if (pKey->nSize > N_LISTING_CACHE_PROBE_SIZE) {
+        if (!pFile->seek(qMax(N_LISTING_CACHE_PROBE_SIZE, pKey->nSize - N_LISTING_CACHE_PROBE_SIZE))) return false;
+        hash.addData(pFile->read(N_LISTING_CACHE_PROBE_SIZE));
+    }
+    pKey->baHeaderHash = hash.result();
+
+    return pFile->seek(nPosition);
+}
+
+QString listingCacheFileName(const QString &sDirectory, QFile *pFile)
+{
+    const QString sPath = QFileInfo(pFile->fileName()).absoluteFilePath();
+    return QDir(sDirectory).filePath(QString::fromLatin1(QCryptographicHash::hash(sPath.toUtf8(), QCryptographicHash::Sha1).toHex()) +
+                                     QLatin1String(".xdix"));
+}
+
+void listingCacheWriteKey(QDataStream &stream, const LISTING_CACHE_KEY &key)
+{
+    stream << key.nSize << key.nModified << key.nDevice << key.nInode << key.baHeaderHash;
+}
+
+bool listingCacheLoad(QFile *pFile, XBinary::FT *pFileType, QList<XArchive::RECORD> *pListRecords)
+{
+    const QString sDirectory = listingCacheGetDirectory();
+    if (sDirectory.isEmpty()) return false;
+
+    LISTING_CACHE_KEY key = {};
+    if (!listingCacheKey(pFile, &key)) return false;
+
+    QFile fileIndex(listingCacheFileName(sDirectory, pFile));
+    if (!fileIndex.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream stream(&fileIndex);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 nMagic = 0;
+    quint32 nVersion = 0;
+    LISTING_CACHE_KEY keyIndex = {};
+    stream >> nMagic >> nVersion;
+    stream >> keyIndex.nSize >> keyIndex.nModified >> keyIndex.nDevice >> keyIndex.nInode >> keyIndex.baHeaderHash;
+
+    if ((stream.status() != QDataStream::Ok) || (nMagic != N_LISTING_CACHE_MAGIC) || (nVersion != N_LISTING_CACHE_VERSION) ||
+        (keyIndex.nSize != key.nSize) || (keyIndex.nModified != key.nModified) || (keyIndex.nDevice != key.nDevice) ||
+        (keyIndex.nInode != key.nInode) || (keyIndex.baHeaderHash != key.baHeaderHash)) {
+        return false;
+    }
+
+    qint32 nFileType = 0;
+    qint32 nNumberOfRecords = 0;
+    stream >> nFileType >> nNumberOfRecords;
+    if ((stream.status() != QDataStream::Ok) || (nNumberOfRecords < 0) || (nNumberOfRecords > N_LISTING_CACHE_MAX_RECORDS)) return false;
+
+    QList<XArchive::RECORD> listRecords;
+    listRecords.reserve(nNumberOfRecords);
+
+    for (qint32 i = 0; (i < nNumberOfRecords) && (stream.status() == QDataStream::Ok); i++) {
+        XArchive::RECORD record = {};
+        qint32 nCompressMethod = 0;
+        qint32 nCompressMethod2 = 0;
+        qint32 nNumberOfProperties = 0;
+
+        stream >> record.spInfo.sRecordName >> record.spInfo.nCRC32 >> record.spInfo.nUncompressedSize >> record.spInfo.nWindowSize >>
+            record.spInfo.bIsSolid >> nCompressMethod >> nCompressMethod2;
+        stream >> record.nDataOffset >> record.nDataSize >> record.nHeaderOffset >> record.nHeaderSize >> record.nOptHeaderOffset >>
+            record.nOptHeaderSize >> record.sUUID;
+        stream >> nNumberOfProperties;
+        if (nNumberOfProperties < 0) return false;
+
+        record.spInfo.compressMethod = (XBinary::HANDLE_METHOD)nCompressMethod;
+        record.spInfo.compressMethod2 = (XBinary::HANDLE_METHOD)nCompressMethod2;
+
+        for (qint32 j = 0; (j < nNumberOfProperties) && (stream.status() == QDataStream::Ok); j++) {
+            qint32 nProperty = 0;
+            QVariant varValue;
+            stream >> nProperty >> varValue;
+            record.mapProperties.insert((XBinary::FPART_PROP)nProperty, varValue);
+        }
+
+        listRecords.append(record);
+    }
+
+    if (stream.status() != QDataStream::Ok) return false;
+
+    *pFileType = (XBinary::FT)nFileType;
+    *pListRecords = listRecords;
+
+    return true;
+}
+
+void listingCacheSave(QFile *pFile, XBinary::FT fileType, const QList<XArchive::RECORD> &listRecords)
+{
+    const QString sDirectory = listingCacheGetDirectory();
+    if (sDirectory.isEmpty() || (listRecords.count() > N_LISTING_CACHE_MAX_RECORDS) || !QDir().mkpath(sDirectory)) return;
+
+    LISTING_CACHE_KEY key = {};
+    if (!listingCacheKey(pFile, &key)) return;
+
+    QSaveFile fileIndex(listingCacheFileName(sDirectory, pFile));
+    if (!fileIndex.open(QIODevice::WriteOnly)) return;
+
+    QDataStream stream(&fileIndex);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    stream << N_LISTING_CACHE_MAGIC << N_LISTING_CACHE_VERSION;
+    listingCacheWriteKey(stream, key);
+    stream << (qint32)fileType << (qint32)listRecords.count();
+
+    for (const XArchive::RECORD &record : listRecords) {
+        stream << record.spInfo.sRecordName << record.spInfo.nCRC32 << record.spInfo.nUncompressedSize << record.spInfo.nWindowSize
+               << record.spInfo.bIsSolid << (qint32)record.spInfo.compressMethod << (qint32)record.spInfo.compressMethod2;
+        stream << record.nDataOffset << record.nDataSize << record.nHeaderOffset << record.nHeaderSize << record.nOptHeaderOffset
+               << record.nOptHeaderSize << record.sUUID;
+        stream << (qint32)record.mapProperties.count();
+
+        for (auto it = record.mapProperties.constBegin(); it != record.mapProperties.constEnd(); ++it) {
+            stream << (qint32)it.key() << it.value();
+        }
+    }
+
+    if (stream.status() == QDataStream::Ok) {
+        fileIndex.commit();
+    } else {
+        fileIndex.cancelWriting();
+    }
+}
+
+// Complete listings of a named archive go through the sidecar index when one
+// is configured; the detected type is stored with them so a hit skips both
+// detection passes as well as the directory parse.
+QList<XArchive::RECORD> getCachedRecords(QFile *pFile, XBinary::FT *pFileType, XBinary::PDSTRUCT *pPdStruct)
+{
+    QList<XArchive::RECORD> listResult;
+    XBinary::FT fileTypeIndex = XBinary::FT_UNKNOWN;
+
+    if (listingCacheLoad(pFile, &fileTypeIndex, &listResult) &&
+        ((*pFileType == XBinary::FT_UNKNOWN) || (*pFileType == fileTypeIndex))) {
+        *pFileType = fileTypeIndex;
+        return listResult;
+    }
+
+    if (*pFileType == XBinary::FT_UNKNOWN) {
+        *pFileType = preferredUnpackerFileType(pFile, pPdStruct);
+    }
+
+    listResult = XArchives::getRecords(pFile, *pFileType, -1, pPdStruct);
+
+    if (!listResult.isEmpty() && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        listingCacheSave(pFile, *pFileType, listResult);
+    }
+
+    return listResult;
+}
+
 }  // namespace
 
 XArchives::XArchives(QObject *pParent) : QObject(pParent)
 {
 }
 
+void XArchives::setListingCacheDirectory(const QString &sDirectoryName)
+{
+    QMutexLocker locker(&listingCacheMutex());
+    listingCacheDirectory() = sDirectoryName;
+}
+
+QString XArchives::getListingCacheDirectory()
+{
+    return listingCacheGetDirectory();
+}
+
 QList<XArchive::RECORD> XArchives::getRecords(QIODevice *pDevice, XBinary::FT fileType, qint32 nLimit, XBinary::PDSTRUCT *pPdStruct)
 {
     QList<XArchive::RECORD> listResult;
@@ -249,7 +529,11 @@ QList<XArchive::RECORD> XArchives::getRecords(const QString &sFileName, XBinary:
     file.setFileName(sFileName);
 
     if (file.open(QIODevice::ReadOnly)) {
-        listResult = getRecords(&file, fileType, nLimit, pPdStruct);
+        if ((nLimit == -1) && !getListingCacheDirectory().isEmpty()) {
+            listResult = getCachedRecords(&file, &fileType, pPdStruct);
+        } else {
+            listResult = getRecords(&file, fileType, nLimit, pPdStruct);
+        }
 
         file.close();
     }
@@ -268,50 +552,20 @@ QList<XArchive::RECORD> XArchives::getRecordsFromDirectory(const QString &sDirec
 
 QByteArray XArchives::decompress(QIODevice *pDevice, const XArchive::RECORD *pRecord, XBinary::PDSTRUCT *pPdStruct, qint64 nDecompressedOffset, qint64 nDecompressedSize)
 {
-    QByteArray baResult;
+    return decompress(pDevice, pRecord, QMap<XBinary::UNPACK_PROP, QVariant>(), pPdStruct, nDecompressedOffset, nDecompressedSize);
+}
 
+QByteArray XArchives::decompress(QIODevice *pDevice, const XArchive::RECORD *pRecord, const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties,
+                                 XBinary::PDSTRUCT *pPdStruct, qint64 nDecompressedOffset, qint64 nDecompressedSize)
+{
     if (!pDevice || !pRecord || (nDecompressedOffset < 0) ||
         (nDecompressedSize < -1) ||
         !XBinary::isPdStructNotCanceled(pPdStruct)) {
-        return baResult;
+        return QByteArray();
     }
 
-    XBinary::FT fileType = preferredUnpackerFileType(pDevice, pPdStruct);
-
-    XBinary *pBinary = XFormats::createClass(fileType, pDevice);
-
-    if (pBinary && XFormats::isStaticUnpacker(fileType)) {
-        QBuffer buffer(&baResult);
-        const bool bOpened = buffer.open(QIODevice::ReadWrite);
-        const bool bUnpacked = bOpened &&
-            unpackStaticRecord(pBinary, pRecord, &buffer, pPdStruct);
-        buffer.close();
-
-        if (!bUnpacked || !XBinary::isPdStructNotCanceled(pPdStruct) ||
-            (nDecompressedOffset > baResult.size())) {
-            baResult.clear();
-        } else if ((nDecompressedOffset != 0) ||
-                   (nDecompressedSize != -1)) {
-            const qint64 nAvailable = baResult.size() - nDecompressedOffset;
-            const qint64 nResultSize = (nDecompressedSize == -1)
-                ? nAvailable : qMin(nAvailable, nDecompressedSize);
-            baResult = baResult.mid((qint32)nDecompressedOffset,
-                                    (qint32)nResultSize);
-        }
-
-        delete pBinary;
-        return baResult;
-    }
-
-    XArchive *pArchives = dynamic_cast<XArchive *>(pBinary);
-
-    if (pArchives) {
-        baResult = pArchives->decompress(pRecord, pPdStruct, nDecompressedOffset, nDecompressedSize);
-    }
-
-    delete pBinary;
-
-    return baResult;
+    return decompressRecord(pDevice, preferredUnpackerFileType(pDevice, pPdStruct), pRecord, pPdStruct, nDecompressedOffset, nDecompressedSize,
+                            mapProperties);
 }
 
 QByteArray XArchives::decompress(const QString &sFileName, const XArchive::RECORD *pRecord, XBinary::PDSTRUCT *pPdStruct, qint64 nDecompressedOffset,
@@ -351,7 +605,15 @@ QByteArray XArchives::decompress(const QString &sFileName, const QString &sRecor
     file.setFileName(sFileName);
 
     if (file.open(QIODevice::ReadOnly)) {
-        baResult = decompress(&file, sRecordFileName, pPdStruct);
+        XBinary::FT fileType = XBinary::FT_UNKNOWN;
+        QList<XArchive::RECORD> listRecords = getCachedRecords(&file, &fileType, pPdStruct);
+
+        XArchive::RECORD record = XArchive::getArchiveRecord(sRecordFileName, &listRecords, pPdStruct);
+
+        if (!record.spInfo.sRecordName.isEmpty()) {
+            baResult = decompressRecord(&file, fileType, &record, pPdStruct, 0, -1);
+        }
+
         file.close();
     }
 
@@ -471,7 +733,8 @@ bool XArchives::decompressToFile(const QString &sFileName, const QString &sRecor
     file.setFileName(sFileName);
 
     if (file.open(QIODevice::ReadOnly)) {
-        QList<XArchive::RECORD> listRecords = getRecords(&file, XBinary::FT_UNKNOWN, -1, pPdStruct);  // TODO FT
+        XBinary::FT fileType = XBinary::FT_UNKNOWN;
+        QList<XArchive::RECORD> listRecords = getCachedRecords(&file, &fileType, pPdStruct);
 
         XArchive::RECORD record = XArchive::getArchiveRecord(sRecordFileName, &listRecords, pPdStruct);
 
@@ -519,10 +782,11 @@ bool XArchives::decompressToFolder(QIODevice *pDevice, const QString &sResultFil
     }
 
     // XArchive has a legacy overload with the same name which hides the
-    // property-aware implementation inherited from XBinary.  Call the base
-    // implementation explicitly so passwords and the other unpack options are
-    // preserved for the complete streaming operation.
-    bool bResult = pArchive->XBinary::unpackToFolder(sResultFileFolder, mapProperties, pPdStruct);
+    // property-aware implementation inherited from XBinary.
+    // unpackToFolderParallel() runs that base implementation for formats
+    // without independent records, so passwords and the other unpack options
+    // are preserved for the complete streaming operation either way.
+    bool bResult = pArchive->unpackToFolderParallel(sResultFileFolder, mapProperties, pPdStruct);
 
     // Keep compatibility with formats that only implement the legacy RECORD
     // API.  Property-aware streaming is always attempted first; the legacy
@@ -592,7 +856,7 @@ bool XArchives::decompressToFolder(const QString &sFileName, const QString &sRes
     if (!bPreferNative && isIp7zSourceAvailable()) {
         QList<XBinary::ARCHIVERECORD> listProbe;
         if (listArchiveWithIp7zSource(sFileName, sPassword, &listProbe, &sIp7zError, pPdStruct)) {
-            bResult = extractArchiveWithIp7zSource(sFileName, sPassword, sResultFileFolder, &sIp7zError, pPdStruct);
+            bResult = extractArchiveWithIp7zSource(sFileName, sPassword, sResultFileFolder, &sIp7zError, pPdStruct, mapProperties);
             if (bResult) return true;
 
             // Extraction is staged by the source-built ip7z bridge, so an
@@ -663,7 +927,7 @@ bool XArchives::testArchive(const QString &sFileName, const QMap<XBinary::UNPACK
     if (!bPreferNative && isIp7zSourceAvailable()) {
         QList<XBinary::ARCHIVERECORD> listProbe;
         if (listArchiveWithIp7zSource(sFileName, sPassword, &listProbe, &sIp7zError, pPdStruct)) {
-            const bool bResult = testArchiveWithIp7zSource(sFileName, sPassword, &sIp7zError, pPdStruct);
+            const bool bResult = testArchiveWithIp7zSource(sFileName, sPassword, &sIp7zError, pPdStruct, mapProperties);
             if (bResult) return true;
             if (!XBinary::isPdStructNotCanceled(pPdStruct) ||
                 !ip7zAllowsNativeFallback(sIp7zError)) {
@@ -715,7 +979,9 @@ bool XArchives::isArchiveRecordPresent(const QString &sFileName, const QString &
     file.setFileName(sFileName);
 
     if (file.open(QIODevice::ReadOnly)) {
-        bResult = isArchiveRecordPresent(&file, sRecordFileName, pPdStruct);
+        XBinary::FT fileType = XBinary::FT_UNKNOWN;
+        QList<XArchive::RECORD> listRecords = getCachedRecords(&file, &fileType, pPdStruct);
+        bResult = XArchive::isArchiveRecordPresent(sRecordFileName, &listRecords, pPdStruct);
         file.close();
     }
 
@@ -910,3 +1176,320 @@ void XArchives::_findFiles(const QString &sDirectoryName, QList<XArchive::RECORD
         }
     }
 }
+
+XArchiveSession::XArchiveSession(QObject *pParent)
+    : QObject(pParent),
+      m_pVolumeSet(nullptr),
+      m_pDevice(nullptr),
+      m_fileType(XBinary::FT_UNKNOWN),
+      m_pBinary(nullptr),
+      m_pArchive(nullptr),
+      m_pDecompress(nullptr)
+{
+}
+
+XArchiveSession::~XArchiveSession()
+{
+    _close();
+}
+
+bool XArchiveSession::open(const QString &sFileName, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_mutex);
+
+    _close();
+
+    XBinary::FT fileType = XBinary::FT_UNKNOWN;
+    QList<XArchive::RECORD> listRecords;
+    // Only byte splits concatenate to a valid archive; RAR and split ZIP
+    // volumes are opened one by one until their formats handle sets.
+    const QStringList listVolumes = XVolumeSetDevice::findVolumes(sFileName);
+
+    if (listVolumes.count() > 1) {
+        // The volumes are read as one concatenated source; the sidecar
+        // listing index is keyed by a single file, so it is not used here.
+        m_pVolumeSet = new (std::nothrow) XVolumeSetDevice;
+
+        if (!m_pVolumeSet || !m_pVolumeSet->setFileNames(listVolumes) || !m_pVolumeSet->open(QIODevice::ReadOnly)) {
+            _close();
+            return false;
+        }
+
+        m_pDevice = m_pVolumeSet;
+        fileType = preferredUnpackerFileType(m_pDevice, pPdStruct);
+        listRecords = XArchives::getRecords(m_pDevice, fileType, -1, pPdStruct);
+    } else {
+        m_file.setFileName(sFileName);
+
+        if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+        m_pDevice = &m_file;
+        listRecords = getCachedRecords(&m_file, &fileType, pPdStruct);
+    }
+
+    if (!XBinary::isPdStructNotCanceled(pPdStruct)) {
+        _close();
+        return false;
+    }
+
+    m_pBinary = XFormats::createClass(fileType, m_pDevice);
+
+    if (m_pBinary && !XFormats::isStaticUnpacker(fileType)) {
+        m_pArchive = dynamic_cast<XArchive *>(m_pBinary);
+
+        if (!m_pArchive) {
+            // Same fallback as XArchives::getRecords().
+            delete m_pBinary;
+            m_pBinary = XFormats::createClass(XBinary::FT_ZIP, m_pDevice);
+            m_pArchive = dynamic_cast<XArchive *>(m_pBinary);
+        }
+
+        if (!m_pArchive) {
+            _close();
+            return false;
+        }
+
+        if (m_pArchive->isParallelUnpackSupported()) {
+            m_pDecompress = new XDecompress;
+        }
+        m_mapUnpackProperties = m_pArchive->getDefaultUnpackProperties();
+    } else if (!m_pBinary) {
+        _close();
+        return false;
+    }
+
+    m_fileType = fileType;
+    m_listRecords = listRecords;
+
+    const qint32 nNumberOfRecords = m_listRecords.count();
+    m_hashRecordIndexes.reserve(nNumberOfRecords);
+
+    for (qint32 i = 0; i < nNumberOfRecords; i++) {
+        // The first record of a repeated name wins, as in XArchive::getArchiveRecord().
+        const QString &sRecordName = m_listRecords.at(i).spInfo.sRecordName;
+        if (!m_hashRecordIndexes.contains(sRecordName)) {
+            m_hashRecordIndexes.insert(sRecordName, i);
+        }
+    }
+
+    return true;
+}
+
+void XArchiveSession::close()
+{
+    QMutexLocker locker(&m_mutex);
+
+    _close();
+}
+
+bool XArchiveSession::isOpen() const
+{
+    return m_pBinary != nullptr;
+}
+
+XBinary::FT XArchiveSession::getFileType() const
+{
+    return m_fileType;
+}
+
+void XArchiveSession::setUnpackProperties(const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (auto it = mapProperties.constBegin(); it != mapProperties.constEnd(); ++it) {
+        m_mapUnpackProperties.insert(it.key(), it.value());
+    }
+}
+
+// The lookups take the lock too: open() and close() replace the listing from
+// another thread.
+qint32 XArchiveSession::getNumberOfRecords() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_listRecords.count();
+}
+
+QList<XArchive::RECORD> XArchiveSession::getRecords() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_listRecords;
+}
+
+XArchive::RECORD XArchiveSession::getRecord(qint32 nIndex) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if ((nIndex < 0) || (nIndex >= m_listRecords.count())) return XArchive::RECORD();
+
+    return m_listRecords.at(nIndex);
+}
+
+qint32 XArchiveSession::getRecordIndex(const QString &sRecordName) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_hashRecordIndexes.value(sRecordName, -1);
+}
+
+bool XArchiveSession::isRecordPresent(const QString &sRecordName) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_hashRecordIndexes.contains(sRecordName);
+}
+
+bool XArchiveSession::decompressToDevice(qint32 nIndex, QIODevice *pDestDevice, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_mutex);
+
+    return _decompressToDevice(nIndex, pDestDevice, pPdStruct);
+}
+
+QByteArray XArchiveSession::decompress(qint32 nIndex, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_mutex);
+
+    return _decompress(nIndex, pPdStruct);
+}
+
+QByteArray XArchiveSession::decompress(const QString &sRecordName, XBinary::PDSTRUCT *pPdStruct)
+{
+    // Resolve the name under the same lock, so the index cannot go stale.
+    QMutexLocker locker(&m_mutex);
+
+    const qint32 nIndex = m_hashRecordIndexes.value(sRecordName, -1);
+    if (nIndex == -1) return QByteArray();
+
+    return _decompress(nIndex, pPdStruct);
+}
+
+bool XArchiveSession::decompressToFile(qint32 nIndex, const QString &sResultFileName, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_mutex);
+
+    return _decompressToFile(nIndex, sResultFileName, pPdStruct);
+}
+
+bool XArchiveSession::decompressToFile(const QString &sRecordName, const QString &sResultFileName, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const qint32 nIndex = m_hashRecordIndexes.value(sRecordName, -1);
+    if (nIndex == -1) return false;
+
+    return _decompressToFile(nIndex, sResultFileName, pPdStruct);
+}
+
+bool XArchiveSession::decompressToFiles(const QMap<qint32, QString> &mapResultFileNames, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QList<qint32> listIndexes = mapResultFileNames.keys();
+
+    for (qint32 i = 0; i < listIndexes.count(); i++) {
+        if ((listIndexes.at(i) < 0) || (listIndexes.at(i) >= m_listRecords.count())) return false;
+    }
+
+    std::stable_sort(listIndexes.begin(), listIndexes.end(), [this](qint32 nIndex1, qint32 nIndex2) {
+        return m_listRecords.at(nIndex1).nDataOffset < m_listRecords.at(nIndex2).nDataOffset;
+    });
+
+    for (qint32 i = 0; i < listIndexes.count(); i++) {
+        if (!_decompressToFile(listIndexes.at(i), mapResultFileNames.value(listIndexes.at(i)), pPdStruct)) return false;
+    }
+
+    return XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+void XArchiveSession::_close()
+{
+    delete m_pBinary;
+    m_pBinary = nullptr;
+    m_pArchive = nullptr;
+    // The solid cache is keyed by the source device, which the next open reuses.
+    delete m_pDecompress;
+    m_pDecompress = nullptr;
+    m_fileType = XBinary::FT_UNKNOWN;
+    m_mapUnpackProperties.clear();
+    m_listRecords.clear();
+    m_hashRecordIndexes.clear();
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    delete m_pVolumeSet;
+    m_pVolumeSet = nullptr;
+    m_pDevice = nullptr;
+}
+
+bool XArchiveSession::_decompressToDevice(qint32 nIndex, QIODevice *pDestDevice, XBinary::PDSTRUCT *pPdStruct)
+{
+    if (!m_pBinary || !pDestDevice || (nIndex < 0) || (nIndex >= m_listRecords.count()) || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return false;
+    }
+
+    const XArchive::RECORD &record = m_listRecords.at(nIndex);
+    XBinary::ARCHIVERECORD archiveRecord = archiveRecordFromLegacyRecord(record);
+
+    if (!m_pArchive) {
+        // The listing is the static unpacker's own record list, so indexes match.
+        return m_pBinary->unpackRecordByIndex(nIndex, &archiveRecord, pDestDevice, m_mapUnpackProperties, pPdStruct);
+    }
+
+    qint32 nArchiveStreamIndex = -1;
+
+    if (m_pDecompress && !XBinary::getArchiveStreamRecordIndex(archiveRecord, &nArchiveStreamIndex)) {
+        return m_pDecompress->decompressArchiveRecord(archiveRecord, m_pDevice, pDestDevice, m_mapUnpackProperties, pPdStruct);
+    }
+
+    return m_pArchive->decompressToDevice(&record, pDestDevice, pPdStruct);
+}
+
+QByteArray XArchiveSession::_decompress(qint32 nIndex, XBinary::PDSTRUCT *pPdStruct)
+{
+    QByteArray baResult;
+
+    QBuffer buffer(&baResult);
+
+    // Readable as well: the decoders reread the output to check its CRC.
+    if (buffer.open(QIODevice::ReadWrite)) {
+        const bool bResult = _decompressToDevice(nIndex, &buffer, pPdStruct);
+        buffer.close();
+
+        if (!bResult || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+            baResult.clear();
+        }
+    }
+
+    return baResult;
+}
+
+bool XArchiveSession::_decompressToFile(qint32 nIndex, const QString &sResultFileName, XBinary::PDSTRUCT *pPdStruct)
+{
+    if ((nIndex < 0) || (nIndex >= m_listRecords.count())) return false;
+
+    if (m_listRecords.at(nIndex).mapProperties.value(XBinary::FPART_PROP_ISFOLDER, false).toBool()) {
+        return XBinary::createDirectory(sResultFileName) && XBinary::isPdStructNotCanceled(pPdStruct);
+    }
+
+    if (!XBinary::createDirectory(QFileInfo(sResultFileName).absolutePath())) return false;
+
+    // The decoder rereads its output for the CRC check, so the record goes
+    // into a readable work file that takes the destination name only after it
+    // has been verified.
+    XArchive::OutputStage outputStage(sResultFileName);
+
+    if (!outputStage.open()) return false;
+
+    bool bResult = _decompressToDevice(nIndex, outputStage.device(), pPdStruct) && XBinary::isPdStructNotCanceled(pPdStruct) &&
+                   (outputStage.device()->error() == QFile::NoError);
+
+    if (bResult) {
+        bResult = outputStage.commit();
+    }
+
+    return bResult;
+}
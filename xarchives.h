@@ -27,6 +27,10 @@
 
 #include "xformats.h"
 #include "xarchive.h"
+#include "xvolumesetdevice.h"
+
+#include <QHash>
+#include <QMutex>
 
 class XArchives : public QObject {
     Q_OBJECT
@@ -40,6 +44,9 @@ public:
     static QList<XArchive::RECORD> getRecordsFromDirectory(const QString &sDirectoryName, qint32 nLimit = -1, XBinary::PDSTRUCT *pPdStruct = nullptr);
     static QByteArray decompress(QIODevice *pDevice, const XArchive::RECORD *pRecord, XBinary::PDSTRUCT *pPdStruct = nullptr, qint64 nDecompressedOffset = 0,
                                  qint64 nDecompressedSize = -1);
+    // With XArchive::UNPACK_PROP_PARTIALWINDOW set, a slice is streamed and decoding stops at its end instead of checking the record CRC.
+    static QByteArray decompress(QIODevice *pDevice, const XArchive::RECORD *pRecord, const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties,
+                                 XBinary::PDSTRUCT *pPdStruct = nullptr, qint64 nDecompressedOffset = 0, qint64 nDecompressedSize = -1);
     static QByteArray decompress(const QString &sFileName, const XArchive::RECORD *pRecord, XBinary::PDSTRUCT *pPdStruct = nullptr, qint64 nDecompressedOffset = 0,
                                  qint64 nDecompressedSize = -1);
     static QByteArray decompress(QIODevice *pDevice, const QString &sRecordFileName, XBinary::PDSTRUCT *pPdStruct = nullptr);
@@ -68,24 +75,118 @@ public:
                                          QList<XBinary::ARCHIVERECORD> *pListRecords,
                                          QString *pErrorString = nullptr,
                                          XBinary::PDSTRUCT *pPdStruct = nullptr);
+    // XArchive::UNPACK_PROP_THREADS and UNPACK_PROP_DECODERMEMORY in
+    // mapProperties are forwarded to the 7-Zip handler.
     static bool testArchiveWithIp7zSource(const QString &sFileName, const QString &sPassword,
                                          QString *pErrorString = nullptr,
-                                         XBinary::PDSTRUCT *pPdStruct = nullptr);
+                                         XBinary::PDSTRUCT *pPdStruct = nullptr,
+                                         const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties = QMap<XBinary::UNPACK_PROP, QVariant>());
     static bool extractArchiveWithIp7zSource(const QString &sFileName, const QString &sPassword,
                                             const QString &sResultFolder,
                                             QString *pErrorString = nullptr,
-                                            XBinary::PDSTRUCT *pPdStruct = nullptr);
+                                            XBinary::PDSTRUCT *pPdStruct = nullptr,
+                                            const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties = QMap<XBinary::UNPACK_PROP, QVariant>());
     static bool extractArchiveRecordWithIp7zSource(const QString &sFileName,
                                                   const QString &sRecordName,
                                                   const QString &sPassword,
                                                   QIODevice *pOutputDevice,
                                                   QString *pErrorString = nullptr,
-                                                  XBinary::PDSTRUCT *pPdStruct = nullptr);
+                                                  XBinary::PDSTRUCT *pPdStruct = nullptr,
+                                                  const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties = QMap<XBinary::UNPACK_PROP, QVariant>());
     static QSet<XBinary::FT> getArchiveOpenValidFileTypes();
+    // Directory for the optional sidecar listing index used by the file-name
+    // overloads; an empty name (the default) disables it.
+    static void setListingCacheDirectory(const QString &sDirectoryName);
+    static QString getListingCacheDirectory();
 
 private:
     static void _findFiles(const QString &sDirectoryName, QList<XArchive::RECORD> *pListRecords, qint32 nLimit,
                            XBinary::PDSTRUCT *pPdStruct);  // TODO mb nLimit pointer to qint32
 };
 
+// An archive opened once for many lookups and extractions.  The type is
+// detected and the directory parsed when the session opens; records are then
+// found through a name index and decoded from the one source handle.  Formats
+// whose records decode independently share one XDecompress (and its solid
+// cache) across extractions.  Lookups may run concurrently; extractions are
+// serialised on the shared handle.
+class XArchiveSession : public QObject {
+    Q_OBJECT
+
+public:
+    explicit XArchiveSession(QObject *pParent = nullptr);
+    ~XArchiveSession();
+
+    bool open(const QString &sFileName, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    void close();
+    bool isOpen() const;
+    XBinary::FT getFileType() const;
+    void setUnpackProperties(const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties);
+
+    qint32 getNumberOfRecords() const;
+    QList<XArchive::RECORD> getRecords() const;
+    XArchive::RECORD getRecord(qint32 nIndex) const;
+    qint32 getRecordIndex(const QString &sRecordName) const;
+    bool isRecordPresent(const QString &sRecordName) const;
+
+    bool decompressToDevice(qint32 nIndex, QIODevice *pDestDevice, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    QByteArray decompress(qint32 nIndex, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    QByteArray decompress(const QString &sRecordName, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    bool decompressToFile(qint32 nIndex, const QString &sResultFileName, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    bool decompressToFile(const QString &sRecordName, const QString &sResultFileName, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    // Batch extraction (record index -> result file name), decoded in source
+    // offset order; stops at the first failure.
+    bool decompressToFiles(const QMap<qint32, QString> &mapResultFileNames, XBinary::PDSTRUCT *pPdStruct = nullptr);
+
+private:
+    void _close();
+    bool _decompressToDevice(qint32 nIndex, QIODevice *pDestDevice, XBinary::PDSTRUCT *pPdStruct);
+    QByteArray _decompress(qint32 nIndex, XBinary::PDSTRUCT *pPdStruct);
+    bool _decompressToFile(qint32 nIndex, const QString &sResultFileName, XBinary::PDSTRUCT *pPdStruct);
+
+    mutable QMutex m_mutex;
+    QFile m_file;
+    XVolumeSetDevice *m_pVolumeSet;  // .001-style byte splits, opened instead of m_file
+    QIODevice *m_pDevice;  // m_file or m_pVolumeSet
+    XBinary::FT m_fileType;
+    XBinary *m_pBinary;
+    XArchive *m_pArchive;  // nullptr for static unpackers
+    XDecompress *m_pDecompress;  // shared decoder, when records decode independently
+    QMap<XBinary::UNPACK_PROP, QVariant> m_mapUnpackProperties;
+    QList<XArchive::RECORD> m_listRecords;
+    QHash<QString, qint32> m_hashRecordIndexes;
+};
+
+// A 7-Zip core archive kept open between calls.  Format detection and
+// IInArchive::Open run once; a batch of records is then decoded by a single
+// Extract call, so a solid block is walked once for all of its selected
+// members, and each member streams straight into its caller device.  A
+// failed extraction may leave a partial member in a device.
+class XArchiveIp7zSession : public QObject {
+    Q_OBJECT
+
+public:
+    explicit XArchiveIp7zSession(QObject *pParent = nullptr);
+    ~XArchiveIp7zSession();
+
+    bool open(const QString &sFileName, const QString &sPassword, QString *pErrorString = nullptr, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    void close();
+    bool isOpen() const;
+    QString getFormatName() const;
+    // Coder settings (XArchive::UNPACK_PROP_THREADS, UNPACK_PROP_DECODERMEMORY) for later extractions.
+    void setUnpackProperties(const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties);
+
+    QList<XBinary::ARCHIVERECORD> getRecords() const;
+    qint32 getRecordIndex(const QString &sRecordName) const;  // -1 when missing or ambiguous
+    bool extractRecord(qint32 nIndex, QIODevice *pOutputDevice, QString *pErrorString = nullptr, XBinary::PDSTRUCT *pPdStruct = nullptr);
+    // Batch extraction (record index -> open writable device) in one pass.
+    bool extractRecords(const QMap<qint32, QIODevice *> &mapOutputDevices, QString *pErrorString = nullptr, XBinary::PDSTRUCT *pPdStruct = nullptr);
+
+private:
+    void _close();
+
+    struct SESSION;
+    SESSION *m_pSession;
+};
+
 #endif  // XARCHIVES_H
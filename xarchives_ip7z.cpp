@@ -25,6 +25,7 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QRegularExpression>
@@ -33,6 +34,8 @@
 #include <QSet>
 #include <QTemporaryDir>
 #include <QTemporaryFile>
+#include <QThread>
+#include <QVector>
 
 #ifdef Q_OS_WIN
 #include <qt_windows.h>
@@ -63,7 +66,9 @@ namespace {
 const char *const UNSUPPORTED_FORMAT_ERROR = "Unsupported archive format";
 const qint64 COPY_BUFFER_SIZE = 64 * 1024;
 const UInt64 MAXIMUM_SCAN = (UInt64)1 << 23;
-const UInt64 MAX_DECODER_MEMORY = (sizeof(void *) <= 4) ? ((UInt64)512 << 20) : ((UInt64)4 << 30);
+// Default decoder memory budget.  A 32-bit Qt process cannot safely go
+// beyond it, so there it is also the ceiling for a caller's budget.
+const UInt64 DEFAULT_DECODER_MEMORY = (sizeof(void *) <= 4) ? ((UInt64)512 << 20) : ((UInt64)4 << 30);
 const UInt32 MAX_ARCHIVE_ITEMS = 100000;
 const qint32 MAX_PROPERTY_CHARS = 32768;
 const qint64 MAX_METADATA_CHARS = 32LL * 1024 * 1024;
@@ -92,6 +97,32 @@ struct TechnicalEntry {
     UInt32 nIndex = 0;
 };
 
+// Coder settings forwarded to the handler through ISetProperties.
+struct CoderOptions {
+    UInt32 nThreads = 0;  // "mt"; 0 keeps the handler default
+    UInt64 nMemoryLimit = DEFAULT_DECODER_MEMORY;
+    bool bMemoryLimit = false;  // "memuse" was requested explicitly
+};
+
+CoderOptions coderOptions(const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties)
+{
+    CoderOptions options;
+
+    if (mapProperties.contains(XArchive::UNPACK_PROP_THREADS)) {
+        const qint32 nThreads = mapProperties.value(XArchive::UNPACK_PROP_THREADS).toInt();
+        options.nThreads = (UInt32)((nThreads > 0) ? nThreads : qMax(1, QThread::idealThreadCount()));
+    }
+
+    const qint64 nMemoryLimit = mapProperties.value(XArchive::UNPACK_PROP_DECODERMEMORY, (qint64)0).toLongLong();
+    if (nMemoryLimit > 0) {
+        options.nMemoryLimit = (UInt64)nMemoryLimit;
+        if ((sizeof(void *) <= 4) && (options.nMemoryLimit > DEFAULT_DECODER_MEMORY)) options.nMemoryLimit = DEFAULT_DECODER_MEMORY;
+        options.bMemoryLimit = true;
+    }
+
+    return options;
+}
+
 struct StagedEntry {
     QString sRelativePath;
     QString sSourcePath;
@@ -757,6 +788,7 @@ struct OpenedArchive {
     QString sFormat;
     QString sDisplayName;
     QList<ArchiveLayer> parents;
+    CoderOptions coderOptions;  // configuration, kept across close()
 
     OpenedArchive() = default;
 
@@ -1344,12 +1376,15 @@ class ArchiveExtractCallback final : public IArchiveExtractCallback,
 
 public:
     ArchiveExtractCallback(IInArchive *pArchive, const QList<TechnicalEntry> *pEntries, const QString &sStageRoot,
-                           QIODevice *pSelectedOutput, const QString &sPassword, XBinary::PDSTRUCT *pPdStruct)
+                           QIODevice *pSelectedOutput, const QString &sPassword, UInt64 nMemoryLimit, XBinary::PDSTRUCT *pPdStruct,
+                           const QMap<UInt32, QIODevice *> *pMapOutputs = nullptr)
         : m_archive(pArchive),
           m_pEntries(pEntries),
           m_sStageRoot(sStageRoot),
           m_pSelectedOutput(pSelectedOutput),
+          m_pMapOutputs(pMapOutputs),
           m_password(toUString(sPassword)),
+          m_nMemoryLimit(nMemoryLimit),
           m_progress(pPdStruct)
     {
     }
@@ -1376,7 +1411,10 @@ private:
     const QList<TechnicalEntry> *m_pEntries;
     QString m_sStageRoot;
     QIODevice *m_pSelectedOutput;
+    const QMap<UInt32, QIODevice *> *m_pMapOutputs;  // per-index outputs of a batch
+    QIODevice *m_pCurrentOutput = nullptr;
     UString m_password;
+    UInt64 m_nMemoryLimit;
     ProgressGuard m_progress;
     mutable QMutex m_errorMutex;
     QString m_sError;
@@ -1404,6 +1442,7 @@ Z7_COM7F_IMF(ArchiveExtractCallback::GetStream(UInt32 index, ISequentialOutStrea
     m_currentStream.Release();
     m_currentFile.reset();
     m_sCurrentPath.clear();
+    m_pCurrentOutput = nullptr;
     m_nCurrentIndex = index;
     m_nAskMode = askExtractMode;
     if (!m_progress.canContinue()) return E_ABORT;
@@ -1420,7 +1459,12 @@ Z7_COM7F_IMF(ArchiveExtractCallback::GetStream(UInt32 index, ISequentialOutStrea
     }
 
     QIODevice *pDevice = m_pSelectedOutput;
-    if (!pDevice) {
+    if (m_pMapOutputs) {
+        // A batch names its members; the others in a solid block are only
+        // decoded through.
+        pDevice = m_pMapOutputs->value(index, nullptr);
+        if (!pDevice) return S_OK;
+    } else if (!pDevice) {
         if (m_sStageRoot.isEmpty()) return E_FAIL;
         m_sCurrentPath = QDir(m_sStageRoot).filePath(entry.sNormalizedPath);
         if (!isContainedPath(m_sCurrentPath, m_sStageRoot) || !QDir().mkpath(QFileInfo(m_sCurrentPath).absolutePath())) return E_FAIL;
@@ -1429,6 +1473,7 @@ Z7_COM7F_IMF(ArchiveExtractCallback::GetStream(UInt32 index, ISequentialOutStrea
         pDevice = m_currentFile.data();
     }
     if (!pDevice || !pDevice->isOpen() || !pDevice->isWritable()) return E_FAIL;
+    if (!m_currentFile) m_pCurrentOutput = pDevice;
 
     QtOutStream *pSpec = new QtOutStream(pDevice, m_progress.pPdStruct);
     CMyComPtr<ISequentialOutStream> stream = pSpec;
@@ -1457,9 +1502,10 @@ Z7_COM7F_IMF(ArchiveExtractCallback::SetOperationResult(Int32 opRes))
         m_currentFile->close();
         if (opRes != NArchive::NExtract::NOperationResult::kOK && !m_sCurrentPath.isEmpty()) QFile::remove(m_sCurrentPath);
         m_currentFile.reset();
-    } else if (m_pSelectedOutput) {
-        QFileDevice *pFileDevice = qobject_cast<QFileDevice *>(m_pSelectedOutput);
+    } else if (m_pCurrentOutput) {
+        QFileDevice *pFileDevice = qobject_cast<QFileDevice *>(m_pCurrentOutput);
         if (pFileDevice && !pFileDevice->flush()) opRes = NArchive::NExtract::NOperationResult::kDataError;
+        m_pCurrentOutput = nullptr;
     }
     recordResult(opRes);
     return m_progress.canContinue() ? S_OK : E_ABORT;
@@ -1481,8 +1527,9 @@ Z7_COM7F_IMF(ArchiveExtractCallback::RequestMemoryUse(UInt32 flags, UInt32, UInt
     }
 
     // A 32-bit Qt process cannot safely satisfy the RAR5 handler's 4 GiB default.
-    // Keep enough address-space headroom for Qt, archive metadata, and decoder overhead.
-    if (*allowedSize > MAX_DECODER_MEMORY) *allowedSize = MAX_DECODER_MEMORY;
+    // Keep enough address-space headroom for Qt, archive metadata, and decoder
+    // overhead, or stay within the caller's budget.
+    if (*allowedSize > m_nMemoryLimit) *allowedSize = m_nMemoryLimit;
     if (flags & NRequestMemoryUseFlags::k_IsReport) return S_OK;
     if (requiredSize <= *allowedSize) {
         *answerFlags = NRequestMemoryAnswerFlags::k_Allow;
@@ -1496,7 +1543,7 @@ Z7_COM7F_IMF(ArchiveExtractCallback::RequestMemoryUse(UInt32 flags, UInt32, UInt
     {
         QMutexLocker locker(&m_errorMutex);
         if (m_sError.isEmpty()) {
-            m_sError = QStringLiteral("Archive extraction requires %1 MiB of decoder memory; the safe process limit is %2 MiB")
+            m_sError = QStringLiteral("Archive extraction requires %1 MiB of decoder memory; the decoder memory limit is %2 MiB")
                            .arg((requiredSize + ((UInt64)1 << 20) - 1) >> 20)
                            .arg((*allowedSize + ((UInt64)1 << 20) - 1) >> 20);
         }
@@ -1721,21 +1768,44 @@ bool copyDevice(QIODevice *pSource, QIODevice *pTarget, QString *pErrorString, X
     return false;
 }
 
-bool configureDecoderMemoryLimit(OpenedArchive *pOpened, QString *pErrorString)
+bool configureCoderProperties(OpenedArchive *pOpened, QString *pErrorString)
 {
     if (!pOpened || !pOpened->archive) return false;
-    if (pOpened->sFormat != QLatin1String("Rar5")) return true;
+    const CoderOptions &options = pOpened->coderOptions;
+    const bool bRar5 = (pOpened->sFormat == QLatin1String("Rar5"));
+    if (!bRar5 && !options.nThreads && !options.bMemoryLimit) return true;
 
     CMyComPtr<ISetProperties> properties;
     const HRESULT nQueryResult = pOpened->archive->QueryInterface(IID_ISetProperties, (void **)&properties);
     if (nQueryResult != S_OK || !properties) {
+        if (!bRar5) return true;  // the handler has no coder settings
         setError(pErrorString, QStringLiteral("RAR5 decoder memory limit is unavailable"));
         return false;
     }
-    const wchar_t *names[] = {L"memx"};
-    NWindows::NCOM::CPropVariant value;
-    value = MAX_DECODER_MEMORY;
-    if (properties->SetProperties(names, &value, 1) != S_OK) {
+
+    // Handlers reset their settings on every SetProperties call, so all
+    // names go in one call.  RAR5 takes its limit as "memx", the others as
+    // "memuse".
+    const wchar_t *names[2] = {};
+    NWindows::NCOM::CPropVariant values[2];
+    UInt32 nNumberOfProperties = 0;
+    if (bRar5 || options.bMemoryLimit) {
+        names[nNumberOfProperties] = bRar5 ? L"memx" : L"memuse";
+        values[nNumberOfProperties] = options.nMemoryLimit;
+        nNumberOfProperties++;
+    }
+    if (options.nThreads) {
+        names[nNumberOfProperties] = L"mt";
+        values[nNumberOfProperties] = options.nThreads;
+        nNumberOfProperties++;
+    }
+
+    if (properties->SetProperties(names, values, nNumberOfProperties) == S_OK) return true;
+
+    // A handler may reject a setting it does not know; only the RAR5 limit
+    // is mandatory.
+    if (!bRar5) return true;
+    if ((nNumberOfProperties == 1) || (properties->SetProperties(names, values, 1) != S_OK)) {
         setError(pErrorString, QStringLiteral("Cannot enforce the RAR5 decoder memory limit"));
         return false;
     }
@@ -1744,10 +1814,11 @@ bool configureDecoderMemoryLimit(OpenedArchive *pOpened, QString *pErrorString)
 
 bool runExtract(OpenedArchive *pOpened, const QList<TechnicalEntry> &entries, const QString &sPassword,
                 const UInt32 *pIndices, UInt32 nItems, bool bTest, const QString &sStageRoot, QIODevice *pSelectedOutput,
-                QString *pErrorString, XBinary::PDSTRUCT *pPdStruct)
+                QString *pErrorString, XBinary::PDSTRUCT *pPdStruct, const QMap<UInt32, QIODevice *> *pMapOutputs = nullptr)
 {
-    if (!configureDecoderMemoryLimit(pOpened, pErrorString)) return false;
-    ArchiveExtractCallback *pCallbackSpec = new ArchiveExtractCallback(pOpened->archive, &entries, sStageRoot, pSelectedOutput, sPassword, pPdStruct);
+    if (!configureCoderProperties(pOpened, pErrorString)) return false;
+    ArchiveExtractCallback *pCallbackSpec = new ArchiveExtractCallback(pOpened->archive, &entries, sStageRoot, pSelectedOutput, sPassword,
+                                                                       pOpened->coderOptions.nMemoryLimit, pPdStruct, pMapOutputs);
     CMyComPtr<IArchiveExtractCallback> callback = pCallbackSpec;
     const HRESULT nResult = pOpened->archive->Extract(pIndices, nItems, bTest ? 1 : 0, callback);
     const QString sCallbackError = pCallbackSpec->errorString();
@@ -1768,6 +1839,31 @@ bool runExtract(OpenedArchive *pOpened, const QList<TechnicalEntry> &entries, co
     return true;
 }
 
+QList<XBinary::ARCHIVERECORD> entriesToRecords(const QList<TechnicalEntry> &entries)
+{
+    QList<XBinary::ARCHIVERECORD> listResult;
+    // kpidBlock is the folder-level accounting key.  7-Zip reports a packed
+    // size only on the first member of a solid block; mark every member of a
+    // shared block so callers can count that size once without treating the
+    // other members as missing metadata.
+    QMap<QString, qint32> mapBlockCounts;
+    for (const TechnicalEntry &entry : entries) {
+        const QString sBlock = entry.mapValues.value(QStringLiteral("Block"));
+        if (!entry.bIsFolder && !sBlock.isEmpty()) {
+            mapBlockCounts[sBlock] = mapBlockCounts.value(sBlock) + 1;
+        }
+    }
+    for (const TechnicalEntry &entry : entries) {
+        XBinary::ARCHIVERECORD record = technicalToRecord(entry);
+        const QString sBlock = entry.mapValues.value(QStringLiteral("Block"));
+        if (!entry.bIsFolder && !sBlock.isEmpty() && (mapBlockCounts.value(sBlock) > 1)) {
+            record.mapProperties.insert(XBinary::FPART_PROP_ISSOLID, true);
+        }
+        listResult.append(record);
+    }
+    return listResult;
+}
+
 }  // namespace
 
 bool XArchives::isIp7zSourceAvailable()
@@ -1803,30 +1899,13 @@ bool XArchives::listArchiveWithIp7zSource(const QString &sFileName, const QStrin
         setError(pErrorString, sReadError);
         return false;
     }
-    // kpidBlock is the folder-level accounting key.  7-Zip reports a packed
-    // size only on the first member of a solid block; mark every member of a
-    // shared block so callers can count that size once without treating the
-    // other members as missing metadata.
-    QMap<QString, qint32> mapBlockCounts;
-    for (const TechnicalEntry &entry : entries) {
-        const QString sBlock = entry.mapValues.value(QStringLiteral("Block"));
-        if (!entry.bIsFolder && !sBlock.isEmpty()) {
-            mapBlockCounts[sBlock] = mapBlockCounts.value(sBlock) + 1;
-        }
-    }
-    for (const TechnicalEntry &entry : entries) {
-        XBinary::ARCHIVERECORD record = technicalToRecord(entry);
-        const QString sBlock = entry.mapValues.value(QStringLiteral("Block"));
-        if (!entry.bIsFolder && !sBlock.isEmpty() && (mapBlockCounts.value(sBlock) > 1)) {
-            record.mapProperties.insert(XBinary::FPART_PROP_ISSOLID, true);
-        }
-        pListRecords->append(record);
-    }
+    *pListRecords = entriesToRecords(entries);
     return true;
 }
 
 bool XArchives::testArchiveWithIp7zSource(const QString &sFileName, const QString &sPassword,
-                                         QString *pErrorString, XBinary::PDSTRUCT *pPdStruct)
+                                         QString *pErrorString, XBinary::PDSTRUCT *pPdStruct,
+                                         const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties)
 {
     setError(pErrorString, QString());
     if (!QFileInfo(sFileName).isFile()) {
@@ -1835,6 +1914,7 @@ bool XArchives::testArchiveWithIp7zSource(const QString &sFileName, const QStrin
     }
     OpenedArchive opened;
     if (!openArchive(sFileName, sPassword, &opened, pErrorString, pPdStruct)) return false;
+    opened.coderOptions = coderOptions(mapProperties);
     QString sReadError;
     const QList<TechnicalEntry> entries = readEntries(opened.archive, opened.sDisplayName, &sReadError, pPdStruct);
     bool bResult = sReadError.isEmpty() && runExtract(&opened, entries, sPassword, nullptr, (UInt32)(Int32)-1, true,
@@ -1846,7 +1926,7 @@ bool XArchives::testArchiveWithIp7zSource(const QString &sFileName, const QStrin
 
 bool XArchives::extractArchiveWithIp7zSource(const QString &sFileName, const QString &sPassword,
                                             const QString &sResultFolder, QString *pErrorString,
-                                            XBinary::PDSTRUCT *pPdStruct)
+                                            XBinary::PDSTRUCT *pPdStruct, const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties)
 {
     setError(pErrorString, QString());
     if (!QFileInfo(sFileName).isFile() || sResultFolder.isEmpty()) {
@@ -1855,6 +1935,7 @@ bool XArchives::extractArchiveWithIp7zSource(const QString &sFileName, const QSt
     }
     OpenedArchive opened;
     if (!openArchive(sFileName, sPassword, &opened, pErrorString, pPdStruct)) return false;
+    opened.coderOptions = coderOptions(mapProperties);
     QString sReadError;
     const QList<TechnicalEntry> entries = readEntries(opened.archive, opened.sDisplayName, &sReadError, pPdStruct);
     if (!sReadError.isEmpty() || !validateEntries(entries, pErrorString)) {
@@ -1888,7 +1969,8 @@ bool XArchives::extractArchiveWithIp7zSource(const QString &sFileName, const QSt
 
 bool XArchives::extractArchiveRecordWithIp7zSource(const QString &sFileName, const QString &sRecordName,
                                                   const QString &sPassword, QIODevice *pOutputDevice,
-                                                  QString *pErrorString, XBinary::PDSTRUCT *pPdStruct)
+                                                  QString *pErrorString, XBinary::PDSTRUCT *pPdStruct,
+                                                  const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties)
 {
     setError(pErrorString, QString());
     if (!QFileInfo(sFileName).isFile() || sRecordName.isEmpty() || !pOutputDevice || !pOutputDevice->isOpen() || !pOutputDevice->isWritable()) {
@@ -1897,6 +1979,7 @@ bool XArchives::extractArchiveRecordWithIp7zSource(const QString &sFileName, con
     }
     OpenedArchive opened;
     if (!openArchive(sFileName, sPassword, &opened, pErrorString, pPdStruct)) return false;
+    opened.coderOptions = coderOptions(mapProperties);
     QString sReadError;
     const QList<TechnicalEntry> entries = readEntries(opened.archive, opened.sDisplayName, &sReadError, pPdStruct);
     if (!sReadError.isEmpty() || !validateEntries(entries, pErrorString)) {
@@ -1932,3 +2015,161 @@ bool XArchives::extractArchiveRecordWithIp7zSource(const QString &sFileName, con
     if (!bExtracted || !stagedFile.flush()) return false;
     return copyDevice(&stagedFile, pOutputDevice, pErrorString, pPdStruct);
 }
+
+struct XArchiveIp7zSession::SESSION {
+    QMutex mutex;
+    OpenedArchive opened;
+    QString sPassword;
+    QList<TechnicalEntry> listEntries;
+    QList<XBinary::ARCHIVERECORD> listRecords;
+    QHash<QString, qint32> hashRecordIndexes;  // -1 marks a name shared by several records
+};
+
+XArchiveIp7zSession::XArchiveIp7zSession(QObject *pParent) : QObject(pParent)
+{
+    m_pSession = new SESSION;
+}
+
+XArchiveIp7zSession::~XArchiveIp7zSession()
+{
+    close();
+    delete m_pSession;
+}
+
+bool XArchiveIp7zSession::open(const QString &sFileName, const QString &sPassword, QString *pErrorString, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    _close();
+    setError(pErrorString, QString());
+
+    if (!QFileInfo(sFileName).isFile()) {
+        setError(pErrorString, QStringLiteral("Archive file does not exist"));
+        return false;
+    }
+    if (!ProgressGuard(pPdStruct).canContinue()) {
+        setError(pErrorString, QStringLiteral("Archive operation canceled"));
+        return false;
+    }
+    // The source and volume streams opened here outlive this call, so they
+    // are not bound to pPdStruct; extractions observe their own.
+    if (!openArchive(sFileName, sPassword, &m_pSession->opened, pErrorString, nullptr)) return false;
+
+    QString sReadError;
+    m_pSession->listEntries = readEntries(m_pSession->opened.archive, m_pSession->opened.sDisplayName, &sReadError, pPdStruct);
+    if (!sReadError.isEmpty()) {
+        _close();
+        setError(pErrorString, sReadError);
+        return false;
+    }
+
+    m_pSession->sPassword = sPassword;
+    m_pSession->listRecords = entriesToRecords(m_pSession->listEntries);
+
+    const qint32 nNumberOfEntries = m_pSession->listEntries.size();
+    for (qint32 i = 0; i < nNumberOfEntries; i++) {
+        const QString &sPath = m_pSession->listEntries.at(i).sPath;
+        m_pSession->hashRecordIndexes.insert(sPath, m_pSession->hashRecordIndexes.contains(sPath) ? -1 : i);
+    }
+
+    return true;
+}
+
+void XArchiveIp7zSession::close()
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    _close();
+}
+
+bool XArchiveIp7zSession::isOpen() const
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    return m_pSession->opened.archive != nullptr;
+}
+
+QString XArchiveIp7zSession::getFormatName() const
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    return m_pSession->opened.sFormat;
+}
+
+QList<XBinary::ARCHIVERECORD> XArchiveIp7zSession::getRecords() const
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    return m_pSession->listRecords;
+}
+
+qint32 XArchiveIp7zSession::getRecordIndex(const QString &sRecordName) const
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    return m_pSession->hashRecordIndexes.value(sRecordName, -1);
+}
+
+bool XArchiveIp7zSession::extractRecord(qint32 nIndex, QIODevice *pOutputDevice, QString *pErrorString, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMap<qint32, QIODevice *> mapOutputDevices;
+    mapOutputDevices.insert(nIndex, pOutputDevice);
+
+    return extractRecords(mapOutputDevices, pErrorString, pPdStruct);
+}
+
+bool XArchiveIp7zSession::extractRecords(const QMap<qint32, QIODevice *> &mapOutputDevices, QString *pErrorString, XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    setError(pErrorString, QString());
+
+    if (!m_pSession->opened.archive) {
+        setError(pErrorString, QStringLiteral("Archive session is not open"));
+        return false;
+    }
+
+    // The map iterates in ascending index order, which is the order
+    // IInArchive::Extract expects.
+    QMap<UInt32, QIODevice *> mapOutputs;
+    QVector<UInt32> listIndices;
+
+    for (auto it = mapOutputDevices.constBegin(); it != mapOutputDevices.constEnd(); ++it) {
+        const qint32 nIndex = it.key();
+        QIODevice *pDevice = it.value();
+
+        if (!pDevice || !pDevice->isOpen() || !pDevice->isWritable()) {
+            setError(pErrorString, QStringLiteral("Invalid archive record or output device"));
+            return false;
+        }
+        if ((nIndex < 0) || (nIndex >= m_pSession->listEntries.size()) || m_pSession->listEntries.at(nIndex).bIsFolder ||
+            entryIsUnsafeSpecial(m_pSession->listEntries.at(nIndex))) {
+            setError(pErrorString, QStringLiteral("Selected archive record is missing or is not a regular file"));
+            return false;
+        }
+
+        mapOutputs.insert((UInt32)nIndex, pDevice);
+        listIndices.append((UInt32)nIndex);
+    }
+
+    if (listIndices.isEmpty()) return true;
+
+    return runExtract(&m_pSession->opened, m_pSession->listEntries, m_pSession->sPassword, listIndices.constData(), (UInt32)listIndices.size(), false,
+                      QString(), nullptr, pErrorString, pPdStruct, &mapOutputs);
+}
+
+void XArchiveIp7zSession::_close()
+{
+    m_pSession->opened.close();
+    m_pSession->sPassword.clear();
+    m_pSession->listEntries.clear();
+    m_pSession->listRecords.clear();
+    m_pSession->hashRecordIndexes.clear();
+}
+
+void XArchiveIp7zSession::setUnpackProperties(const QMap<XBinary::UNPACK_PROP, QVariant> &mapProperties)
+{
+    QMutexLocker locker(&m_pSession->mutex);
+
+    m_pSession->opened.coderOptions = coderOptions(mapProperties);
+}
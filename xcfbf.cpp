@@ -23,11 +23,11 @@
 #include <new>
 
 #include <QtEndian>
+#include <QBitArray>
 #include <QPointer>
 #include <QSet>
 #include <algorithm>
 #include <limits>
-#include <memory>
 
 XBinary::XCONVERT _TABLE_CFBF_STRUCTID[] = {
     {XCFBF::STRUCTID_UNKNOWN, "Unknown", QObject::tr("Unknown")},
@@ -1032,16 +1032,14 @@ bool XCFBF::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &
     }
 
     if (pContext->nRootStreamSize > 0) {
-        if ((pContext->nRootStreamSize > (quint64)(std::numeric_limits<qint32>::max)()) ||
+        if ((pContext->nRootStreamSize > (quint64)(std::numeric_limits<qint64>::max)()) ||
             ((quint64)pContext->nRootStartSector >= nPhysicalSectors)) {
             return _cfbfFailUnpackInit(&guardedThis, pState, pContext);
         }
-        const QByteArray baRootMiniStream = _readStreamBySectorChain(
-            pContext->listFAT, pContext->nRootStartSector, nSectorSize,
-            (qint64)pContext->nRootStreamSize, pPdStruct);
-        if (!guardedThis) return false;
-        pContext->baRootMiniStream = baRootMiniStream;
-        if ((quint64)pContext->baRootMiniStream.size() != pContext->nRootStreamSize) {
+        // The root mini-stream stays on disk; mini streams map through its runs.
+        const bool bRootRuns = _getSectorChainRuns(pContext->listFAT, pContext->nRootStartSector, nSectorSize, nSectorSize, nPhysicalSectors,
+                                                   (qint64)pContext->nRootStreamSize, &pContext->listRootRuns, pPdStruct);
+        if (!bRootRuns || pContext->listRootRuns.isEmpty()) {
             return _cfbfFailUnpackInit(&guardedThis, pState, pContext);
         }
     } else if ((pContext->nRootStartSector != 0xFFFFFFFF) && (pContext->nRootStartSector != 0xFFFFFFFE)) {
@@ -1064,7 +1062,7 @@ bool XCFBF::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &
                 return _cfbfFailUnpackInit(&guardedThis, pState, pContext);
             }
         } else if (nStreamSize < pContext->nMiniCutoff) {
-            if ((nStartSector >= (quint32)pContext->listMiniFAT.size()) || pContext->baRootMiniStream.isEmpty()) {
+            if ((nStartSector >= (quint32)pContext->listMiniFAT.size()) || pContext->listRootRuns.isEmpty()) {
                 return _cfbfFailUnpackInit(&guardedThis, pState, pContext);
             }
         } else if (((quint64)nStartSector >= nPhysicalSectors) || (nStartSector >= (quint32)pContext->listFAT.size())) {
@@ -1190,22 +1188,101 @@ XBinary::ARCHIVERECORD XCFBF::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStr
     return result;
 }
 
-static bool _cfbfStageWriteAll(QPointer<QIODevice> *pGuardedStage, qint64 *pnStaged, const char *pData, qint64 nSize)
+static void _cfbfAppendSectorRun(QList<XCFBF::CFBF_SECTOR_RUN> *pListRuns, qint64 nStreamOffset, qint64 nOffset, qint64 nSize)
 {
-    qint64 nWritten = 0;
-    while (nWritten < nSize) {
-        if (pGuardedStage->isNull() || !(*pGuardedStage)->seek(*pnStaged + nWritten)) return false;
-        qint64 nResult = (*pGuardedStage)->write(
-            pData + nWritten, nSize - nWritten);
-        if (pGuardedStage->isNull() || nResult <= 0 || nResult > (nSize - nWritten)) {
-            return false;
+    if (!pListRuns->isEmpty()) {
+        XCFBF::CFBF_SECTOR_RUN &last = pListRuns->last();
+        if ((last.nOffset + last.nSize == nOffset) && (last.nStreamOffset + last.nSize == nStreamOffset)) {
+            last.nSize += nSize;
+            return;
         }
-        nWritten += nResult;
     }
-    *pnStaged += nWritten;
-    return true;
+
+    XCFBF::CFBF_SECTOR_RUN run = {};
+    run.nStreamOffset = nStreamOffset;
+    run.nOffset = nOffset;
+    run.nSize = nSize;
+    pListRuns->append(run);
+}
+
+// Index of the run holding nStreamOffset, or -1.
+static qint32 _cfbfFindSectorRun(const QList<XCFBF::CFBF_SECTOR_RUN> &listRuns, qint64 nStreamOffset)
+{
+    QList<XCFBF::CFBF_SECTOR_RUN>::const_iterator iter =
+        std::upper_bound(listRuns.constBegin(), listRuns.constEnd(), nStreamOffset,
+                         [](qint64 nValue, const XCFBF::CFBF_SECTOR_RUN &run) { return nValue < run.nStreamOffset; });
+    if (iter == listRuns.constBegin()) {
+        return -1;
+    }
+    --iter;
+    if ((nStreamOffset - iter->nStreamOffset) >= iter->nSize) {
+        return -1;
+    }
+
+    return (qint32)(iter - listRuns.constBegin());
 }
 
+namespace {
+
+// Read-only random-access view of a CFBF stream.  The sector chain is resolved
+// into file runs up front, so a read touches the source once per run.
+class CfbfStreamDevice : public QIODevice {
+public:
+    CfbfStreamDevice(XCFBF *pBinary, const QList<XCFBF::CFBF_SECTOR_RUN> &listRuns, qint64 nSize, XBinary::PDSTRUCT *pPdStruct)
+        : m_pBinary(pBinary), m_listRuns(listRuns), m_nSize(nSize), m_pPdStruct(pPdStruct)
+    {
+    }
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_nSize; }
+
+protected:
+    qint64 readData(char *pData, qint64 nMaxSize) override
+    {
+        if (!m_pBinary || (nMaxSize < 0) || ((nMaxSize > 0) && !pData) || !XBinary::isPdStructNotCanceled(m_pPdStruct)) {
+            return -1;
+        }
+
+        qint64 nPosition = pos();
+        qint64 nRead = 0;
+        qint32 nIndex = (nPosition < m_nSize) ? _cfbfFindSectorRun(m_listRuns, nPosition) : -1;
+
+        while ((nRead < nMaxSize) && (nPosition < m_nSize)) {
+            if ((nIndex < 0) || (nIndex >= m_listRuns.size())) {
+                return -1;
+            }
+
+            const XCFBF::CFBF_SECTOR_RUN &run = m_listRuns.at(nIndex);
+            const qint64 nDelta = nPosition - run.nStreamOffset;
+            if ((nDelta < 0) || (nDelta >= run.nSize)) {
+                return -1;
+            }
+
+            const qint64 nChunkSize = (std::min)(nMaxSize - nRead, run.nSize - nDelta);
+            const qint64 nResult = m_pBinary->read_array_process(run.nOffset + nDelta, pData + nRead, nChunkSize, m_pPdStruct);
+            if (!m_pBinary || (nResult != nChunkSize)) {
+                return -1;
+            }
+
+            nRead += nChunkSize;
+            nPosition += nChunkSize;
+            nIndex++;
+        }
+
+        return nRead;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    QPointer<XCFBF> m_pBinary;
+    QList<XCFBF::CFBF_SECTOR_RUN> m_listRuns;
+    qint64 m_nSize;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
+}  // namespace
+
 bool XCFBF::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct)
 {
     QPointer<XCFBF> guardedThis(this);
@@ -1248,102 +1325,45 @@ bool XCFBF::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pP
         return false;
     }
 
-    std::unique_ptr<QIODevice> pStage(XBinary::createFileBuffer(
-        (qint64)nStreamSize, pPdStruct));
-    if (!guardedThis || !pStage || !guardedOutput || !guardedSource)
-        return false;
-    const bool bStageSourceCurrent =
-        isUnpackSourceCurrent(pState, pPdStruct);
-    if (!guardedThis || !bStageSourceCurrent) return false;
-    QPointer<QIODevice> guardedStage(pStage.get());
-    qint64 nStaged = 0;
-
-    if (nStreamSize == 0) {
-        const bool bEmptySourceCurrent =
-            isUnpackSourceCurrent(pState, pPdStruct);
-        if (!guardedThis || !bEmptySourceCurrent || !guardedOutput)
-            return false;
-        const bool bPublished = publishUnpackOutput(
-            pStage.get(), guardedOutput.data(), pState, pPdStruct);
-        return guardedThis && bPublished;
-    }
-
-    quint32 nCurrentSector = nStartSector;
-    quint64 nBytesRemaining = nStreamSize;
-    QSet<quint32> setVisited;
-
-    if (bIsMini) {
-        const qint32 nMaxChain = pContext->listMiniFAT.size();
-        const quint64 nRequiredSectors = (nStreamSize + (quint64)pContext->nMiniSectorSize - 1) / (quint64)pContext->nMiniSectorSize;
-        if (nRequiredSectors > (quint64)nMaxChain) {
-            return false;
-        }
-
-        while ((nBytesRemaining > 0) && (nCurrentSector < (quint32)nMaxChain) && (nCurrentSector != 0xFFFFFFFE) && (nCurrentSector != 0xFFFFFFFF) &&
-               XBinary::isPdStructNotCanceled(pPdStruct)) {
-            if (setVisited.contains(nCurrentSector)) {
-                return false;
-            }
-            setVisited.insert(nCurrentSector);
-
-            const quint64 nOffset = (quint64)nCurrentSector * (quint64)pContext->nMiniSectorSize;
-            if (nOffset >= (quint64)pContext->baRootMiniStream.size()) {
-                return false;
-            }
-
-            const qint64 nChunkSize = (qint64)(std::min)((quint64)pContext->nMiniSectorSize, nBytesRemaining);
-            if ((nOffset + (quint64)nChunkSize) > (quint64)pContext->baRootMiniStream.size() ||
-                !_cfbfStageWriteAll(&guardedStage, &nStaged, pContext->baRootMiniStream.constData() + (qint64)nOffset, nChunkSize)) {
-                return false;
-            }
-
-            nBytesRemaining -= (quint64)nChunkSize;
-            nCurrentSector = pContext->listMiniFAT.at(nCurrentSector);
-        }
-    } else {
-        const qint32 nMaxChain = pContext->listFAT.size();
-        const qint64 nFileSize = getSize();
-        if (!guardedThis) return false;
-        const quint64 nRequiredSectors = (nStreamSize + (quint64)pContext->nSectorSize - 1) / (quint64)pContext->nSectorSize;
-        if (nRequiredSectors > (quint64)nMaxChain) {
-            return false;
+    QList<CFBF_SECTOR_RUN> listRuns;
+    if (nStreamSize > 0) {
+        bool bRuns = false;
+        if (bIsMini) {
+            QList<CFBF_SECTOR_RUN> listMiniRuns;
+            bRuns = _getSectorChainRuns(pContext->listMiniFAT, nStartSector, pContext->nMiniSectorSize, 0, (quint64)pContext->listMiniFAT.size(),
+                                        (qint64)nStreamSize, &listMiniRuns, pPdStruct) &&
+                    _mapSectorRuns(listMiniRuns, pContext->listRootRuns, &listRuns);
+        } else {
+            const qint64 nFileSize = getSize();
+            if (!guardedThis) return false;
+            // Whole sectors after the header, as _readStreamBySectorChain bounds the chain.
+            const quint64 nPhysicalSectors =
+                (nFileSize >= pContext->nSectorSize) ? (quint64)((nFileSize - pContext->nSectorSize) / pContext->nSectorSize) : 0;
+            bRuns = _getSectorChainRuns(pContext->listFAT, nStartSector, pContext->nSectorSize, pContext->nSectorSize, nPhysicalSectors,
+                                        (qint64)nStreamSize, &listRuns, pPdStruct);
         }
+        if (!bRuns) return false;
+    }
 
-        while ((nBytesRemaining > 0) && (nCurrentSector < (quint32)nMaxChain) && (nCurrentSector != 0xFFFFFFFE) && (nCurrentSector != 0xFFFFFFFF) &&
-               XBinary::isPdStructNotCanceled(pPdStruct)) {
-            if (setVisited.contains(nCurrentSector)) {
-                return false;
-            }
-            setVisited.insert(nCurrentSector);
-
-            const quint64 nOffset = (quint64)pContext->nSectorSize + (quint64)nCurrentSector * (quint64)pContext->nSectorSize;
-            const qint64 nChunkSize = (qint64)(std::min)((quint64)pContext->nSectorSize, nBytesRemaining);
-
-            if ((nOffset > (quint64)nFileSize) || ((quint64)nChunkSize > ((quint64)nFileSize - nOffset))) {
-                return false;
-            }
-
-            QByteArray baChunk = read_array((qint64)nOffset, nChunkSize);
-            if (!guardedThis || (baChunk.size() != nChunkSize) ||
-                !_cfbfStageWriteAll(&guardedStage, &nStaged, baChunk.constData(), nChunkSize)) {
-                return false;
-            }
-
-            nBytesRemaining -= (quint64)nChunkSize;
-            nCurrentSector = pContext->listFAT.at(nCurrentSector);
-        }
+    // The stream view is published directly; no staging copy of the stream.
+    CfbfStreamDevice streamDevice(this, listRuns, (qint64)nStreamSize, pPdStruct);
+    if (!streamDevice.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        return false;
     }
 
-    if ((nBytesRemaining != 0) || (nCurrentSector != 0xFFFFFFFE) ||
-        (nStaged != (qint64)nStreamSize) ||
-        !XBinary::isPdStructNotCanceled(pPdStruct)) return false;
     const bool bFinalSourceCurrent =
         isUnpackSourceCurrent(pState, pPdStruct);
     if (!guardedThis || !bFinalSourceCurrent || !guardedOutput)
         return false;
     const bool bPublished = publishUnpackOutput(
-        pStage.get(), guardedOutput.data(), pState, pPdStruct);
-    return guardedThis && bPublished;
+        &streamDevice, guardedOutput.data(), pState, pPdStruct);
+    if (!guardedThis || !bPublished) return false;
+
+    // The stream view reads the source while it is published; a source
+    // replaced meanwhile invalidates what was written.
+    const bool bPublishedSourceCurrent =
+        isUnpackSourceCurrent(pState, pPdStruct);
+    return guardedThis && bPublishedSourceCurrent;
 }
 
 bool XCFBF::moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
@@ -1576,57 +1596,113 @@ QByteArray XCFBF::_readStreamBySectorChain(const QList<quint32> &listFAT, quint3
     }
 
     const quint64 nPhysicalSectors = (quint64)((nFileSize - nSectorSize) / nSectorSize);
-    const quint64 nMaximumChain = (std::min)((quint64)listFAT.size(), nPhysicalSectors);
-    if ((nMaximumChain == 0) || ((quint64)nStartSector >= nMaximumChain)) {
+    QList<CFBF_SECTOR_RUN> listRuns;
+    if (!_getSectorChainRuns(listFAT, nStartSector, nSectorSize, nSectorSize, nPhysicalSectors, nStreamSize, &listRuns, pPdStruct) || listRuns.isEmpty()) {
         return QByteArray();
     }
 
-    if (bKnownSize) {
-        const quint64 nRequiredSectors = ((quint64)nStreamSize + (quint64)nSectorSize - 1) / (quint64)nSectorSize;
-        if (nRequiredSectors > nMaximumChain) {
+    const qint64 nTotalSize = listRuns.last().nStreamOffset + listRuns.last().nSize;
+    if (nTotalSize > (qint64)(std::numeric_limits<qint32>::max)()) {
+        return QByteArray();
+    }
+    baResult.resize((qint32)nTotalSize);
+    if (baResult.size() != nTotalSize) {
+        return QByteArray();
+    }
+
+    // One source read per contiguous run rather than one per sector.
+    for (const CFBF_SECTOR_RUN &run : listRuns) {
+        const qint64 nRead = read_array_process(run.nOffset, baResult.data() + run.nStreamOffset, run.nSize, pPdStruct);
+        if (!guardedThis || (nRead != run.nSize)) {
             return QByteArray();
         }
-        baResult.reserve((qint32)nStreamSize);
     }
 
+    return baResult;
+}
+
+bool XCFBF::_getSectorChainRuns(const QList<quint32> &listTable, quint32 nStartSector, qint64 nSectorSize, qint64 nBaseOffset, quint64 nMaximumChain,
+                                qint64 nStreamSize, QList<CFBF_SECTOR_RUN> *pListRuns, PDSTRUCT *pPdStruct)
+{
+    if (!pListRuns) {
+        return false;
+    }
+    pListRuns->clear();
+
+    const bool bKnownSize = nStreamSize >= 0;
+    nMaximumChain = (std::min)(nMaximumChain, (quint64)listTable.size());
+    if ((nSectorSize <= 0) || (nBaseOffset < 0) || (nStreamSize < -1)) {
+        return false;
+    }
+    if (bKnownSize && (nStreamSize == 0)) {
+        return true;
+    }
+    if ((nMaximumChain == 0) || ((quint64)nStartSector >= nMaximumChain)) {
+        return false;
+    }
+    if (bKnownSize && ((((quint64)nStreamSize + (quint64)nSectorSize - 1) / (quint64)nSectorSize) > nMaximumChain)) {
+        return false;
+    }
+
+    QBitArray baVisited((qint32)nMaximumChain);
     quint32 nCurrentSector = nStartSector;
-    qint64 nBytesRemaining = bKnownSize ? nStreamSize : -1;
-    QSet<quint32> setVisited;
+    qint64 nStreamOffset = 0;
 
     while (nCurrentSector != 0xFFFFFFFE) {
-        if (!XBinary::isPdStructNotCanceled(pPdStruct) || ((quint64)nCurrentSector >= nMaximumChain) || setVisited.contains(nCurrentSector)) {
-            return QByteArray();
-        }
-        setVisited.insert(nCurrentSector);
-
-        const qint64 nOffset = nSectorSize + (qint64)nCurrentSector * nSectorSize;
-        QByteArray baSector = read_array(nOffset, nSectorSize);
-        if (!guardedThis || (baSector.size() != nSectorSize)) {
-            return QByteArray();
+        if (!XBinary::isPdStructNotCanceled(pPdStruct) || ((quint64)nCurrentSector >= nMaximumChain) || baVisited.testBit((qint32)nCurrentSector)) {
+            return false;
         }
+        baVisited.setBit((qint32)nCurrentSector);
 
-        const qint64 nReadSize = bKnownSize ? (std::min)(nSectorSize, nBytesRemaining) : nSectorSize;
-        if ((nReadSize <= 0) || (baResult.size() > (std::numeric_limits<qint32>::max)() - nReadSize)) {
-            return QByteArray();
-        }
-        baResult.append(baSector.constData(), (qint32)nReadSize);
+        const qint64 nSize = bKnownSize ? (std::min)(nSectorSize, nStreamSize - nStreamOffset) : nSectorSize;
+        _cfbfAppendSectorRun(pListRuns, nStreamOffset, nBaseOffset + (qint64)nCurrentSector * nSectorSize, nSize);
+        nStreamOffset += nSize;
 
-        quint32 nNextSector = listFAT.at(nCurrentSector);
-        if (bKnownSize) {
-            nBytesRemaining -= nReadSize;
-            if (nBytesRemaining == 0) {
-                return (nNextSector == 0xFFFFFFFE) ? baResult : QByteArray();
-            }
+        const quint32 nNextSector = listTable.at((qint32)nCurrentSector);
+        if (bKnownSize && (nStreamOffset == nStreamSize)) {
+            return (nNextSector == 0xFFFFFFFE);
         }
 
         nCurrentSector = nNextSector;
     }
 
-    if (!XBinary::isPdStructNotCanceled(pPdStruct) || (bKnownSize && (nBytesRemaining != 0))) {
-        return QByteArray();
+    return !bKnownSize && XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+bool XCFBF::_mapSectorRuns(const QList<CFBF_SECTOR_RUN> &listRuns, const QList<CFBF_SECTOR_RUN> &listContainerRuns, QList<CFBF_SECTOR_RUN> *pListResult)
+{
+    if (!pListResult) {
+        return false;
     }
+    pListResult->clear();
 
-    return baResult;
+    for (const CFBF_SECTOR_RUN &run : listRuns) {
+        qint64 nContainerOffset = run.nOffset;
+        qint64 nStreamOffset = run.nStreamOffset;
+        qint64 nRemaining = run.nSize;
+        qint32 nIndex = _cfbfFindSectorRun(listContainerRuns, nContainerOffset);
+
+        while (nRemaining > 0) {
+            if ((nIndex < 0) || (nIndex >= listContainerRuns.size())) {
+                return false;
+            }
+
+            const CFBF_SECTOR_RUN &container = listContainerRuns.at(nIndex);
+            const qint64 nDelta = nContainerOffset - container.nStreamOffset;
+            if ((nDelta < 0) || (nDelta >= container.nSize)) {
+                return false;
+            }
+
+            const qint64 nChunkSize = (std::min)(nRemaining, container.nSize - nDelta);
+            _cfbfAppendSectorRun(pListResult, nStreamOffset, container.nOffset + nDelta, nChunkSize);
+            nContainerOffset += nChunkSize;
+            nStreamOffset += nChunkSize;
+            nRemaining -= nChunkSize;
+            nIndex++;
+        }
+    }
+
+    return true;
 }
 
 QList<QString> XCFBF::getSearchSignatures()
@@ -84,6 +84,12 @@ public:
         quint64 streamSize;           // Size of the stream in bytes
     };
 
+    struct CFBF_SECTOR_RUN {
+        qint64 nStreamOffset;  // Offset of the run inside the stream
+        qint64 nOffset;        // Offset of the run in the containing data
+        qint64 nSize;          // Run size in bytes
+    };
+
     enum STRUCTID : qint32 {
         STRUCTID_UNKNOWN = 0,
         STRUCTID_StructuredStorageHeader,
@@ -143,12 +149,17 @@ private:
         quint64 nRootStreamSize;          // Root storage stream size
         QList<quint32> listFAT;           // Full FAT table (sector chain)
         QList<quint32> listMiniFAT;       // Mini-sector chain table
-        QByteArray baRootMiniStream;      // Root mini-stream addressed by mini-sector ID
+        QList<CFBF_SECTOR_RUN> listRootRuns;  // File runs of the root mini-stream
         QList<qint64> listRecordOffsets;  // Offsets to stream directory entries
     };
 
     QList<quint32> _readFAT(const StructuredStorageHeader &ssh, PDSTRUCT *pPdStruct);
     QByteArray _readStreamBySectorChain(const QList<quint32> &listFAT, quint32 nStartSector, qint64 nSectorSize, qint64 nStreamSize, PDSTRUCT *pPdStruct);
+    // Resolves a sector chain into contiguous runs; nStreamSize -1 follows the chain to its end.
+    static bool _getSectorChainRuns(const QList<quint32> &listTable, quint32 nStartSector, qint64 nSectorSize, qint64 nBaseOffset, quint64 nMaximumChain,
+                                    qint64 nStreamSize, QList<CFBF_SECTOR_RUN> *pListRuns, PDSTRUCT *pPdStruct);
+    // Translates runs addressed inside a container stream (the root mini-stream) into file runs.
+    static bool _mapSectorRuns(const QList<CFBF_SECTOR_RUN> &listRuns, const QList<CFBF_SECTOR_RUN> &listContainerRuns, QList<CFBF_SECTOR_RUN> *pListResult);
 
     static void _addRegion(QList<FPART> *pListResult, qint64 fileSize, qint64 offset, qint64 size, const QString &name);
 private:
@@ -81,7 +81,8 @@ bool XCompressedDevice::setData(QIODevice *pDevice, const XBinary::FPART &fPart,
         (XBinary::HANDLE_METHOD)fPart.mapProperties.value(XBinary::FPART_PROP_HANDLEMETHOD,
                                                           XBinary::HANDLE_METHOD_STORE).toUInt();
 
-    if (handleMethod != XBinary::HANDLE_METHOD_STORE) {
+    // Methods whose output is the input bytes are served as a view of the source.
+    if (!XDecompress::isCodecFlagsPresent(handleMethod, XDecompress::CODEC_FLAG_IDENTITY)) {
         const qint64 nUncompressedSize =
             fPart.mapProperties.value(XBinary::FPART_PROP_UNCOMPRESSEDSIZE, (qint64)0).toLongLong();
         if (nUncompressedSize < 0) {
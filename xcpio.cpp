@@ -20,6 +20,7 @@
  */
 #include "xcpio.h"
 
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <new>
@@ -34,6 +35,9 @@ XBinary::XCONVERT _TABLE_XCPIO_STRUCTID[] = {{XCPIO::STRUCTID_UNKNOWN, "Unknown"
 static const quint32 CPIO_MODE_IFMT = 0170000;
 static const quint32 CPIO_MODE_IFDIR = 0040000;
 static const qint32 CPIO_MAX_RECORDS = 0x100000;
+// Headers and names are decoded from a window of this size instead of being
+// read one field at a time.
+static const qint64 CPIO_READ_WINDOW_SIZE = 0x100000;
 
 XCPIO::XCPIO(QIODevice *pDevice) : XArchive(pDevice)
 {
@@ -54,56 +58,55 @@ bool XCPIO::isValid(QIODevice *pDevice, PDSTRUCT *pPdStruct)
     return xcpio.isValid(pPdStruct);
 }
 
-XCPIO::CPIO_FORMAT XCPIO::_detectFormat(qint64 nOffset)
+XCPIO::CPIO_FORMAT XCPIO::_detectFormat(const char *pData, qint64 nSize)
 {
-    QPointer<XCPIO> guardedThis(this);
     CPIO_FORMAT result = CPIO_FORMAT_UNKNOWN;
 
-    const qint64 nTotalSize = getSize();
-    if (!guardedThis) return result;
-    if ((nOffset < 0) || (nOffset > nTotalSize)) {
-        return result;
-    }
-    const qint64 nAvailableSize = nTotalSize - nOffset;
-
-    if (nAvailableSize < 2) {
+    if (!pData || (nSize < 2)) {
         return result;
     }
 
-    if (nAvailableSize >= 6) {
-        char szMagic[7] = {0};
-        if (read_array_process(nOffset, szMagic, 6, nullptr) != 6) {
-            return result;
-        }
-        if (!guardedThis) return result;
-
-        QString sMagic = QString::fromLatin1(szMagic, 6);
-
-        if (sMagic == "070701") {
+    if (nSize >= 6) {
+        if (memcmp(pData, "070701", 6) == 0) {
             return CPIO_FORMAT_NEWC;
-        } else if (sMagic == "070702") {
+        } else if (memcmp(pData, "070702", 6) == 0) {
             return CPIO_FORMAT_CRC;
-        } else if (sMagic == "070707") {
+        } else if (memcmp(pData, "070707", 6) == 0) {
             return CPIO_FORMAT_ODC;
-        } else if (sMagic == "070727") {
+        } else if (memcmp(pData, "070727", 6) == 0) {
             return CPIO_FORMAT_AFIO;
         }
     }
 
-    const quint16 nMagicLE = read_uint16(nOffset);
-    if (!guardedThis) return result;
-    if (nMagicLE == 0x71C7) {
+    if (_getBinaryUInt16(pData, false) == 0x71C7) {
         result = CPIO_FORMAT_BINARY_LE;
-    } else {
-        const quint16 nMagicBE = read_uint16(nOffset, true);
-        if (!guardedThis) return result;
-        if (nMagicBE == 0x71C7)
+    } else if (_getBinaryUInt16(pData, true) == 0x71C7) {
         result = CPIO_FORMAT_BINARY_BE;
     }
 
     return result;
 }
 
+XCPIO::CPIO_FORMAT XCPIO::_detectFormat(qint64 nOffset)
+{
+    QPointer<XCPIO> guardedThis(this);
+
+    const qint64 nTotalSize = getSize();
+    if (!guardedThis) return CPIO_FORMAT_UNKNOWN;
+    if ((nOffset < 0) || (nOffset > nTotalSize)) {
+        return CPIO_FORMAT_UNKNOWN;
+    }
+
+    const qint64 nMagicSize = qMin<qint64>(6, nTotalSize - nOffset);
+    char szMagic[6] = {0};
+    if ((nMagicSize < 2) || (read_array_process(nOffset, szMagic, nMagicSize, nullptr) != nMagicSize)) {
+        return CPIO_FORMAT_UNKNOWN;
+    }
+    if (!guardedThis) return CPIO_FORMAT_UNKNOWN;
+
+    return _detectFormat(szMagic, nMagicSize);
+}
+
 qint64 XCPIO::_readHexValue(const char *pValue, qint32 nSize)
 {
     if (!pValue || nSize <= 0) {
@@ -152,72 +155,97 @@ qint64 XCPIO::_readOctValue(const char *pValue, qint32 nSize)
     return nResult;
 }
 
-quint16 XCPIO::_readBinaryUInt16(qint64 nOffset, bool bIsBigEndian)
-{
-    return read_uint16(nOffset, bIsBigEndian);
-}
-
-quint32 XCPIO::_readBinaryUInt32(qint64 nOffset, bool bIsBigEndian)
+quint16 XCPIO::_getBinaryUInt16(const char *pData, bool bIsBigEndian)
 {
-    QPointer<XCPIO> guardedThis(this);
-    quint32 nHigh = _readBinaryUInt16(nOffset, bIsBigEndian);
-    if (!guardedThis) return 0;
-    quint32 nLow = _readBinaryUInt16(nOffset + 2, bIsBigEndian);
-    if (!guardedThis) return 0;
+    const quint8 *pBytes = (const quint8 *)pData;
 
-    return (nHigh << 16) | nLow;
+    return bIsBigEndian ? (quint16)((pBytes[0] << 8) | pBytes[1]) : (quint16)((pBytes[1] << 8) | pBytes[0]);
 }
 
-XCPIO::CPIO_NEWC_HEADER XCPIO::_readNewcHeader(qint64 nOffset)
+quint32 XCPIO::_getBinaryUInt32(const char *pData, bool bIsBigEndian)
 {
-    CPIO_NEWC_HEADER header = {};
-    read_array_process(nOffset, (char *)&header, sizeof(CPIO_NEWC_HEADER), nullptr);
-    return header;
+    // Two 16-bit words, most significant word first.
+    return ((quint32)_getBinaryUInt16(pData, bIsBigEndian) << 16) | _getBinaryUInt16(pData + 2, bIsBigEndian);
 }
 
-XCPIO::CPIO_ODC_HEADER XCPIO::_readOdcHeader(qint64 nOffset)
+bool XCPIO::_readWindow(CPIO_READ_WINDOW *pWindow, qint64 nOffset, qint64 nSize, PDSTRUCT *pPdStruct)
 {
-    CPIO_ODC_HEADER header = {};
-    read_array_process(nOffset, (char *)&header, sizeof(CPIO_ODC_HEADER), nullptr);
-    return header;
+    QPointer<XCPIO> guardedThis(this);
+    if (!pWindow || (nOffset < 0) || (nSize < 0) || (nOffset > pWindow->nTotalSize) || (nSize > (pWindow->nTotalSize - nOffset))) {
+        return false;
+    }
+
+    if ((nOffset >= pWindow->nOffset) && ((nOffset + nSize) <= (pWindow->nOffset + pWindow->baData.size()))) {
+        return true;
+    }
+
+    // Slide the window so that it starts at the requested offset.  A scan reads
+    // ahead so that the following records come from memory; a single record
+    // reads its header probe and name only.
+    const qint64 nReadSize = pWindow->bExact ? nSize : qMin(qMax(nSize, CPIO_READ_WINDOW_SIZE), pWindow->nTotalSize - nOffset);
+    pWindow->baData = read_array_process(nOffset, nReadSize, pPdStruct);
+    if (!guardedThis) return false;
+    pWindow->nOffset = nOffset;
+
+    if (pWindow->baData.size() != nReadSize) {
+        pWindow->baData.clear();
+        return false;
+    }
+
+    return true;
 }
 
-XCPIO::CPIO_AFIO_HEADER XCPIO::_readAfioHeader(qint64 nOffset)
+bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdStruct)
 {
-    CPIO_AFIO_HEADER header = {};
-    read_array_process(nOffset, (char *)&header, sizeof(CPIO_AFIO_HEADER), nullptr);
-    return header;
+    QPointer<XCPIO> guardedThis(this);
+    CPIO_READ_WINDOW window = {};
+    window.nTotalSize = getSize();
+    window.bExact = true;
+    if (!guardedThis) return false;
+
+    return _parseRecord(&window, nOffset, pInfo, pPdStruct);
 }
 
-bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdStruct)
+bool XCPIO::_parseRecord(CPIO_READ_WINDOW *pWindow, qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdStruct)
 {
     QPointer<XCPIO> guardedThis(this);
-    if ((!pInfo) || (nOffset < 0) || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+    if ((!pWindow) || (!pInfo) || (nOffset < 0) || !XBinary::isPdStructNotCanceled(pPdStruct)) {
         return false;
     }
 
     *pInfo = {};
-    pInfo->format = _detectFormat(nOffset);
-    if (!guardedThis) return false;
     pInfo->nHeaderOffset = nOffset;
 
-    if (pInfo->format == CPIO_FORMAT_UNKNOWN) {
+    const qint64 nTotalSize = pWindow->nTotalSize;
+    if ((nOffset > nTotalSize) || ((nTotalSize - nOffset) < 2)) {
         return false;
     }
 
-    const qint64 nTotalSize = getSize();
+    // The largest fixed header; a shorter tail is still enough for the magic.
+    const qint64 nProbeSize = qMin<qint64>(sizeof(CPIO_AFIO_HEADER), nTotalSize - nOffset);
+    if (!_readWindow(pWindow, nOffset, nProbeSize, pPdStruct)) {
+        return false;
+    }
     if (!guardedThis) return false;
+
+    const char *pHeader = pWindow->baData.constData() + (nOffset - pWindow->nOffset);
+    pInfo->format = _detectFormat(pHeader, nProbeSize);
+
+    if (pInfo->format == CPIO_FORMAT_UNKNOWN) {
+        return false;
+    }
+
     qint64 nNameSize = 0;
     qint64 nDataSize = 0;
     qint64 nExpectedCheck = -1;
 
     if ((pInfo->format == CPIO_FORMAT_NEWC) || (pInfo->format == CPIO_FORMAT_CRC)) {
-        if ((nOffset > nTotalSize) || ((qint64)sizeof(CPIO_NEWC_HEADER) > (nTotalSize - nOffset))) {
+        if ((qint64)sizeof(CPIO_NEWC_HEADER) > nProbeSize) {
             return false;
         }
 
-        CPIO_NEWC_HEADER header = _readNewcHeader(nOffset);
-        if (!guardedThis) return false;
+        CPIO_NEWC_HEADER header = {};
+        memcpy(&header, pHeader, sizeof(CPIO_NEWC_HEADER));
 
         const char *pFields[] = {header.ino,       header.mode,      header.uid,      header.gid,   header.nlink,
                                  header.mtime,     header.filesize,  header.devmajor, header.devminor,
@@ -238,12 +266,12 @@ bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdS
         pInfo->nMTime = (quint64)_readHexValue(header.mtime, 8);
         nExpectedCheck = _readHexValue(header.check, 8);
     } else if (pInfo->format == CPIO_FORMAT_ODC) {
-        if ((nOffset > nTotalSize) || ((qint64)sizeof(CPIO_ODC_HEADER) > (nTotalSize - nOffset))) {
+        if ((qint64)sizeof(CPIO_ODC_HEADER) > nProbeSize) {
             return false;
         }
 
-        CPIO_ODC_HEADER header = _readOdcHeader(nOffset);
-        if (!guardedThis) return false;
+        CPIO_ODC_HEADER header = {};
+        memcpy(&header, pHeader, sizeof(CPIO_ODC_HEADER));
 
         if ((_readOctValue(header.dev, 6) < 0) || (_readOctValue(header.ino, 6) < 0) ||
             (_readOctValue(header.mode, 6) < 0) || (_readOctValue(header.uid, 6) < 0) ||
@@ -263,12 +291,12 @@ bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdS
         pInfo->nRDev = (quint32)_readOctValue(header.rdev, 6);
         pInfo->nMTime = (quint64)_readOctValue(header.mtime, 11);
     } else if (pInfo->format == CPIO_FORMAT_AFIO) {
-        if ((nOffset > nTotalSize) || ((qint64)sizeof(CPIO_AFIO_HEADER) > (nTotalSize - nOffset))) {
+        if ((qint64)sizeof(CPIO_AFIO_HEADER) > nProbeSize) {
             return false;
         }
 
-        CPIO_AFIO_HEADER header = _readAfioHeader(nOffset);
-        if (!guardedThis) return false;
+        CPIO_AFIO_HEADER header = {};
+        memcpy(&header, pHeader, sizeof(CPIO_AFIO_HEADER));
 
         if ((header.inoMarker != 'm') || (header.mtimeMarker != 'n') ||
             (header.xsizeMarker != 's') || (header.filesizeMarker != ':') ||
@@ -291,29 +319,21 @@ bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdS
         pInfo->nRDev = (quint32)_readHexValue(header.rdev, 8);
         pInfo->nMTime = (quint64)_readHexValue(header.mtime, 16);
     } else {
-        bool bIsBigEndian = (pInfo->format == CPIO_FORMAT_BINARY_BE);
+        const bool bIsBigEndian = (pInfo->format == CPIO_FORMAT_BINARY_BE);
 
-        if ((nOffset > nTotalSize) || ((qint64)sizeof(CPIO_BINARY_HEADER) > (nTotalSize - nOffset))) {
+        if ((qint64)sizeof(CPIO_BINARY_HEADER) > nProbeSize) {
             return false;
         }
 
         pInfo->nHeaderSize = sizeof(CPIO_BINARY_HEADER);
-        nNameSize = _readBinaryUInt16(nOffset + offsetof(CPIO_BINARY_HEADER, namesize), bIsBigEndian);
-        if (!guardedThis) return false;
-        nDataSize = _readBinaryUInt32(nOffset + offsetof(CPIO_BINARY_HEADER, filesizeHigh), bIsBigEndian);
-        if (!guardedThis) return false;
-        pInfo->nMode = _readBinaryUInt16(nOffset + offsetof(CPIO_BINARY_HEADER, mode), bIsBigEndian);
-        if (!guardedThis) return false;
-        pInfo->nUID = _readBinaryUInt16(nOffset + offsetof(CPIO_BINARY_HEADER, uid), bIsBigEndian);
-        if (!guardedThis) return false;
-        pInfo->nGID = _readBinaryUInt16(nOffset + offsetof(CPIO_BINARY_HEADER, gid), bIsBigEndian);
-        if (!guardedThis) return false;
-        pInfo->nNLink = _readBinaryUInt16(nOffset + offsetof(CPIO_BINARY_HEADER, nlink), bIsBigEndian);
-        if (!guardedThis) return false;
-        pInfo->nRDev = _readBinaryUInt16(nOffset + offsetof(CPIO_BINARY_HEADER, rdev), bIsBigEndian);
-        if (!guardedThis) return false;
-        pInfo->nMTime = _readBinaryUInt32(nOffset + offsetof(CPIO_BINARY_HEADER, mtimeHigh), bIsBigEndian);
-        if (!guardedThis) return false;
+        nNameSize = _getBinaryUInt16(pHeader + offsetof(CPIO_BINARY_HEADER, namesize), bIsBigEndian);
+        nDataSize = _getBinaryUInt32(pHeader + offsetof(CPIO_BINARY_HEADER, filesizeHigh), bIsBigEndian);
+        pInfo->nMode = _getBinaryUInt16(pHeader + offsetof(CPIO_BINARY_HEADER, mode), bIsBigEndian);
+        pInfo->nUID = _getBinaryUInt16(pHeader + offsetof(CPIO_BINARY_HEADER, uid), bIsBigEndian);
+        pInfo->nGID = _getBinaryUInt16(pHeader + offsetof(CPIO_BINARY_HEADER, gid), bIsBigEndian);
+        pInfo->nNLink = _getBinaryUInt16(pHeader + offsetof(CPIO_BINARY_HEADER, nlink), bIsBigEndian);
+        pInfo->nRDev = _getBinaryUInt16(pHeader + offsetof(CPIO_BINARY_HEADER, rdev), bIsBigEndian);
+        pInfo->nMTime = _getBinaryUInt32(pHeader + offsetof(CPIO_BINARY_HEADER, mtimeHigh), bIsBigEndian);
     }
 
     if ((nNameSize <= 0) || (nNameSize > 0x10000) || (nDataSize < 0) ||
@@ -321,7 +341,7 @@ bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdS
         return false;
     }
 
-    if ((nOffset > nTotalSize) || (pInfo->nHeaderSize > (nTotalSize - nOffset))) {
+    if (pInfo->nHeaderSize > (nTotalSize - nOffset)) {
         return false;
     }
     const qint64 nNameOffset = nOffset + pInfo->nHeaderSize;
@@ -330,20 +350,25 @@ bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdS
     }
     const qint64 nNameEnd = nNameOffset + nNameSize;
 
-    QByteArray baName = read_array_process(nNameOffset, nNameSize, pPdStruct);
+    // Usually already inside the window; otherwise the window slides to the header.
+    if (!_readWindow(pWindow, nOffset, nNameEnd - nOffset, pPdStruct)) {
+        return false;
+    }
     if (!guardedThis) return false;
 
-    if ((baName.size() != nNameSize) || baName.isEmpty() || (baName.back() != '\0')) {
+    const char *pName = pWindow->baData.constData() + (nNameOffset - pWindow->nOffset);
+    if (pName[nNameSize - 1] != '\0') {
         return false;
     }
 
-    baName.chop(1);
-    if (baName.contains('\0')) {
+    const qint32 nNameLength = (qint32)(nNameSize - 1);
+    if (memchr(pName, '\0', nNameLength)) {
         return false;
     }
 
-    pInfo->sFileName = QString::fromLatin1(baName.constData(), baName.size());
+    pInfo->sFileName = QString::fromLatin1(pName, nNameLength);
 
+    // Skipping the member data is pure offset arithmetic; nothing is read.
     qint64 nDataOffset = nNameEnd;
 
     if ((pInfo->format == CPIO_FORMAT_NEWC) || (pInfo->format == CPIO_FORMAT_CRC)) {
@@ -387,24 +412,22 @@ bool XCPIO::_parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdS
     pInfo->bIsFolder = ((pInfo->nMode & CPIO_MODE_IFMT) == CPIO_MODE_IFDIR) || pInfo->sFileName.endsWith(QLatin1Char('/'));
 
     if (pInfo->format == CPIO_FORMAT_CRC) {
+        // The 070702 checksum covers the data, so it has to be read; the
+        // window keeps small members in memory.
         quint32 nCalculatedCheck = 0;
         qint64 nCurrentOffset = nDataOffset;
         qint64 nRemaining = nDataSize;
-        const qint32 nBufferCapacity = 0x4000;
-        std::unique_ptr<char[]> pBuffer(new (std::nothrow) char[nBufferCapacity]);
-        if (!pBuffer) {
-            return false;
-        }
 
         while ((nRemaining > 0) && XBinary::isPdStructNotCanceled(pPdStruct)) {
-            const qint32 nChunkSize = (qint32)qMin<qint64>(nBufferCapacity, nRemaining);
-            const qint64 nRead = read_array_process(
-                nCurrentOffset, pBuffer.get(), nChunkSize, pPdStruct);
-            if (!guardedThis || (nRead != nChunkSize)) {
+            const qint64 nChunkSize = qMin<qint64>(CPIO_READ_WINDOW_SIZE, nRemaining);
+            if (!_readWindow(pWindow, nCurrentOffset, nChunkSize, pPdStruct)) {
                 return false;
             }
-            for (qint32 i = 0; i < nChunkSize; i++) {
-                nCalculatedCheck += (quint8)pBuffer[i];
+            if (!guardedThis) return false;
+
+            const quint8 *pData = (const quint8 *)pWindow->baData.constData() + (nCurrentOffset - pWindow->nOffset);
+            for (qint64 i = 0; i < nChunkSize; i++) {
+                nCalculatedCheck += pData[i];
             }
             nCurrentOffset += nChunkSize;
             nRemaining -= nChunkSize;
@@ -437,10 +460,12 @@ bool XCPIO::_scanArchive(qint32 nLimit, QList<RECORD> *pListRecords, qint64 *pAr
     if (!guardedThis) return false;
     qint32 nRecordCount = 0;
     bool bSawTrailer = false;
+    CPIO_READ_WINDOW window = {};
+    window.nTotalSize = nTotalSize;
 
     while ((nOffset < nTotalSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
         CPIO_RECORD_INFO info = {};
-        const bool bParsed = _parseRecord(nOffset, &info, pPdStruct);
+        const bool bParsed = _parseRecord(&window, nOffset, &info, pPdStruct);
         if (!guardedThis) return false;
         if (!bParsed) {
             break;
@@ -850,11 +875,13 @@ QList<XBinary::FPART> XCPIO::getFileParts(quint32 nFileParts, qint32 nLimit, PDS
     qint32 nRecordCount = 0;
     bool bSawTrailer = false;
     bool bParseError = false;
+    CPIO_READ_WINDOW window = {};
+    window.nTotalSize = nTotalSize;
 
     while ((nOffset < nTotalSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
         CPIO_RECORD_INFO info = {};
 
-        if (!_parseRecord(nOffset, &info, pPdStruct)) {
+        if (!_parseRecord(&window, nOffset, &info, pPdStruct)) {
             bParseError = true;
             break;
         }
@@ -934,6 +961,11 @@ QMap<XBinary::UNPACK_PROP, QVariant> XCPIO::getDefaultUnpackProperties()
     return result;
 }
 
+bool XCPIO::isParallelUnpackSupported()
+{
+    return true;
+}
+
 bool XCPIO::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
 {
     QPointer<XCPIO> guardedThis(this);
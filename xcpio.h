@@ -26,6 +26,7 @@
 class XCPIO : public XArchive {
     Q_OBJECT
 
+public:
 #pragma pack(push)
 #pragma pack(1)
     struct CPIO_NEWC_HEADER {
@@ -109,6 +110,12 @@ class XCPIO : public XArchive {
         CPIO_FORMAT_BINARY_BE
     };
 
+    // Header decoding shared with parsers that walk a cpio stream as it is
+    // decoded (the XRPM payload scan).
+    static CPIO_FORMAT _detectFormat(const char *pData, qint64 nSize);
+    static qint64 _readHexValue(const char *pValue, qint32 nSize);
+    static qint64 _readOctValue(const char *pValue, qint32 nSize);
+
 public:
     struct INTERNAL_INFO : XArchive::INTERNAL_INFO {};
 
@@ -151,6 +158,7 @@ public:
 
     // Streaming unpacking API
     virtual QMap<UNPACK_PROP, QVariant> getDefaultUnpackProperties() override;
+    virtual bool isParallelUnpackSupported() override;
     virtual bool initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr) override;
     virtual ARCHIVERECORD infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
@@ -181,15 +189,20 @@ private:
         bool bIsFolder;
     };
 
+    // Sliding read window over the archive; records are decoded from it in memory.
+    struct CPIO_READ_WINDOW {
+        QByteArray baData;
+        qint64 nOffset;
+        qint64 nTotalSize;
+        bool bExact;  // Read only the requested bytes; set for one-off parses
+    };
+
     CPIO_FORMAT _detectFormat(qint64 nOffset);
-    qint64 _readHexValue(const char *pValue, qint32 nSize);
-    qint64 _readOctValue(const char *pValue, qint32 nSize);
-    quint16 _readBinaryUInt16(qint64 nOffset, bool bIsBigEndian);
-    quint32 _readBinaryUInt32(qint64 nOffset, bool bIsBigEndian);
-    CPIO_NEWC_HEADER _readNewcHeader(qint64 nOffset);
-    CPIO_ODC_HEADER _readOdcHeader(qint64 nOffset);
-    CPIO_AFIO_HEADER _readAfioHeader(qint64 nOffset);
+    static quint16 _getBinaryUInt16(const char *pData, bool bIsBigEndian);
+    static quint32 _getBinaryUInt32(const char *pData, bool bIsBigEndian);
+    bool _readWindow(CPIO_READ_WINDOW *pWindow, qint64 nOffset, qint64 nSize, PDSTRUCT *pPdStruct);
     bool _parseRecord(qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdStruct = nullptr);
+    bool _parseRecord(CPIO_READ_WINDOW *pWindow, qint64 nOffset, CPIO_RECORD_INFO *pInfo, PDSTRUCT *pPdStruct = nullptr);
     bool _scanArchive(qint32 nLimit, QList<RECORD> *pListRecords, qint64 *pArchiveEnd, PDSTRUCT *pPdStruct);
     bool _isTrailerRecord(const QString &sFileName);
 private:
@@ -20,6 +20,14 @@
  */
 #include "xdeb.h"
 
+#include <cstring>
+#include <limits>
+#include <new>
+#include <QtEndian>
+#include "subdevice.h"
+#include "xgzip.h"
+#include "xtar.h"
+
 XBinary::XCONVERT _TABLE_XDEB_STRUCTID[] = {
     {XDEB::STRUCTID_UNKNOWN, "Unknown", QObject::tr("Unknown")},
 };
@@ -42,8 +50,310 @@ bool isDebTarMember(const QString &sName, const QString &sPrefix)
 
     return false;
 }
+
+XBinary::HANDLE_METHOD debTarMemberMethod(const QString &sName)
+{
+    XBinary::HANDLE_METHOD result = XBinary::HANDLE_METHOD_UNKNOWN;
+
+    if (sName.endsWith(QLatin1String(".tar"))) {
+        result = XBinary::HANDLE_METHOD_STORE;
+    } else if (sName.endsWith(QLatin1String(".tar.gz"))) {
+        result = XBinary::HANDLE_METHOD_DEFLATE;  // gzip; header stripped separately
+    } else if (sName.endsWith(QLatin1String(".tar.xz"))) {
+        result = XBinary::HANDLE_METHOD_XZ;
+    } else if (sName.endsWith(QLatin1String(".tar.zst"))) {
+        result = XBinary::HANDLE_METHOD_ZSTD;
+    } else if (sName.endsWith(QLatin1String(".tar.bz2"))) {
+        result = XBinary::HANDLE_METHOD_BZIP2;
+    } else if (sName.endsWith(QLatin1String(".tar.lzma"))) {
+        result = XBinary::HANDLE_METHOD_LZMA;
+    }
+
+    return result;
+}
+
+const qint32 N_DEB_MAX_ENTRIES = 0x100000;
+const qint64 N_DEB_TAR_BLOCK_SIZE = 512;
+const qint64 N_DEB_TAR_MAX_METADATA = 0x100000;
+
+QString debTarReadString(const char *pValue, qint32 nSize)
+{
+    qint32 nLength = 0;
+    while ((nLength < nSize) && (pValue[nLength] != '\0')) {
+        nLength++;
+    }
+
+    return QString::fromUtf8(pValue, nLength);
+}
+
+// Optional numeric header field; an unparsable one reads as zero.
+quint64 debTarReadField(const char *pValue, qint32 nSize)
+{
+    qint64 nValue = 0;
+    return XTAR::_parseNumber(pValue, nSize, &nValue) ? (quint64)nValue : 0;
+}
 }  // namespace
 
+// Write-only sink that parses a ustar/GNU/pax tar stream as the member decoder
+// produces it.  Only the current 512-byte header and long-name/pax metadata
+// are buffered; member data is counted (and summed into a CRC-32 for the gzip
+// trailer) but never stored.  The header fields are decoded by XTAR.
+class XDEB::TarScanDevice : public QIODevice {
+public:
+    TarScanDevice(qint32 nStreamIndex, const QString &sPrefix)
+        : m_nStreamIndex(nStreamIndex),
+          m_sPrefix(sPrefix),
+          m_nConsumed(0),
+          m_nCRC32(0xFFFFFFFFU),
+          m_nSkipRemaining(0),
+          m_nCaptureRemaining(0),
+          m_nCaptureType(0),
+          m_nPaxSize(-1),
+          m_bEndFound(false),
+          m_bFailed(false)
+    {
+    }
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_nConsumed; }
+    bool seek(qint64 nPosition) override { return (nPosition == pos()) && QIODevice::seek(nPosition); }
+
+    // The end marker was seen, or the stream stopped cleanly on a header boundary.
+    bool isComplete() const
+    {
+        return m_bEndFound || ((m_nConsumed > 0) && m_baBlock.isEmpty() && (m_nSkipRemaining == 0) && (m_nCaptureRemaining == 0) && (m_nCaptureType == 0));
+    }
+    bool isFailed() const { return m_bFailed; }
+    quint32 crc32() const { return m_nCRC32 ^ 0xFFFFFFFFU; }
+    QList<DEB_UNPACK_ENTRY> takeEntries()
+    {
+        QList<DEB_UNPACK_ENTRY> listResult;
+        listResult.swap(m_listEntries);
+        return listResult;
+    }
+
+protected:
+    qint64 readData(char *pData, qint64 nMaxSize) override
+    {
+        Q_UNUSED(pData)
+        Q_UNUSED(nMaxSize)
+
+        return -1;
+    }
+
+    qint64 writeData(const char *pData, qint64 nMaxSize) override
+    {
+        if (m_bFailed || (nMaxSize < 0) || ((nMaxSize > 0) && !pData)) {
+            m_bFailed = true;
+            return -1;
+        }
+
+        if (nMaxSize > 0) {
+            m_nCRC32 = XBinary::_getCRC32(pData, nMaxSize, m_nCRC32, XBinary::_getCRC32Table_EDB88320());
+        }
+
+        qint64 nOffset = 0;
+
+        while ((nOffset < nMaxSize) && !m_bFailed) {
+            qint64 nTake = 0;
+
+            if (m_bEndFound) {
+                // Zero blocks and record padding after the end marker.
+                nTake = nMaxSize - nOffset;
+            } else if (m_nCaptureRemaining > 0) {
+                nTake = qMin(nMaxSize - nOffset, m_nCaptureRemaining);
+                m_baMetadata.append(pData + nOffset, (qint32)nTake);
+                m_nCaptureRemaining -= nTake;
+
+                if (m_nCaptureRemaining == 0) {
+                    _applyMetadata();
+                }
+            } else if (m_nSkipRemaining > 0) {
+                nTake = qMin(nMaxSize - nOffset, m_nSkipRemaining);
+                m_nSkipRemaining -= nTake;
+            } else {
+                nTake = qMin(nMaxSize - nOffset, N_DEB_TAR_BLOCK_SIZE - (qint64)m_baBlock.size());
+                m_baBlock.append(pData + nOffset, (qint32)nTake);
+            }
+
+            nOffset += nTake;
+            m_nConsumed += nTake;
+
+            if ((m_baBlock.size() == N_DEB_TAR_BLOCK_SIZE) && !_parseBlock()) {
+                m_bFailed = true;
+            }
+        }
+
+        return m_bFailed ? -1 : nMaxSize;
+    }
+
+private:
+    void _applyMetadata()
+    {
+        if (m_nCaptureType == 'L') {
+            m_sLongName = debTarReadString(m_baMetadata.constData(), m_baMetadata.size());
+        } else if (m_nCaptureType == 'K') {
+            m_sLongLinkName = debTarReadString(m_baMetadata.constData(), m_baMetadata.size());
+        } else if (m_nCaptureType == 'x') {
+            // "<length> <key>=<value>\n" records.
+            qint32 nPosition = 0;
+            while (nPosition < m_baMetadata.size()) {
+                const qint32 nSpace = m_baMetadata.indexOf(' ', nPosition);
+                if (nSpace <= nPosition) break;
+                bool bLength = false;
+                const qint32 nLength = m_baMetadata.mid(nPosition, nSpace - nPosition).toInt(&bLength);
+                if (!bLength || (nLength <= (nSpace - nPosition)) || (nLength > (m_baMetadata.size() - nPosition))) break;
+
+                const QByteArray baRecord = m_baMetadata.mid(nSpace + 1, nPosition + nLength - nSpace - 2);
+                const qint32 nEqual = baRecord.indexOf('=');
+                if (nEqual > 0) {
+                    const QByteArray baKey = baRecord.left(nEqual);
+                    const QByteArray baValue = baRecord.mid(nEqual + 1);
+                    if (baKey == "path") {
+                        m_sPaxPath = QString::fromUtf8(baValue);
+                    } else if (baKey == "linkpath") {
+                        m_sPaxLinkPath = QString::fromUtf8(baValue);
+                    } else if (baKey == "size") {
+                        bool bSize = false;
+                        const qint64 nSize = baValue.toLongLong(&bSize);
+                        m_nPaxSize = (bSize && (nSize >= 0)) ? nSize : -1;
+                    }
+                }
+
+                nPosition += nLength;
+            }
+        }
+
+        m_baMetadata.clear();
+        m_nCaptureType = 0;
+    }
+
+    bool _parseBlock()
+    {
+        const char *pBlock = m_baBlock.constData();
+
+        bool bZero = true;
+        for (qint32 i = 0; (i < N_DEB_TAR_BLOCK_SIZE) && bZero; i++) {
+            bZero = (pBlock[i] == 0);
+        }
+
+        if (bZero) {
+            m_bEndFound = true;
+            m_baBlock.clear();
+            return true;
+        }
+
+        XTAR::posix_header header = {};
+        memcpy(&header, pBlock, sizeof(XTAR::posix_header));
+
+        // The checksum counts its own field as spaces and covers the block
+        // padding after the 500-byte header.
+        qint64 nStoredCheckSum = 0;
+        if (!XTAR::_parseNumber(header.chksum, sizeof(header.chksum), &nStoredCheckSum)) {
+            return false;
+        }
+        memset(header.chksum, ' ', sizeof(header.chksum));
+        quint32 nCheckSum = XTAR::calculateChecksum(header);
+        for (qint32 i = (qint32)sizeof(XTAR::posix_header); i < N_DEB_TAR_BLOCK_SIZE; i++) {
+            nCheckSum += (quint8)pBlock[i];
+        }
+
+        qint64 nHeaderSize = 0;
+        if (((quint64)nStoredCheckSum != nCheckSum) || !XTAR::_parseNumber(header.size, sizeof(header.size), &nHeaderSize)) {
+            return false;
+        }
+
+        const char cType = header.typeflag[0];
+        qint64 nSize = nHeaderSize;
+        if ((m_nPaxSize >= 0) && (cType != 'L') && (cType != 'K') && (cType != 'x') && (cType != 'g')) {
+            nSize = m_nPaxSize;
+        }
+
+        if (nSize > ((std::numeric_limits<qint64>::max)() - N_DEB_TAR_BLOCK_SIZE)) {
+            return false;
+        }
+        const qint64 nPaddedSize = (nSize + N_DEB_TAR_BLOCK_SIZE - 1) & ~(N_DEB_TAR_BLOCK_SIZE - 1);
+
+        if ((cType == 'L') || (cType == 'K') || (cType == 'x')) {
+            if (nSize > N_DEB_TAR_MAX_METADATA) {
+                return false;
+            }
+
+            m_nCaptureType = cType;
+            m_nCaptureRemaining = nSize;
+            m_nSkipRemaining = nPaddedSize - nSize;
+            if (nSize == 0) {
+                _applyMetadata();
+            }
+        } else if (cType == 'g') {
+            m_nSkipRemaining = nPaddedSize;
+        } else {
+            QString sName = m_sLongName;
+            if (sName.isEmpty()) sName = m_sPaxPath;
+            if (sName.isEmpty()) sName = XTAR::_getRecordPath(header);
+
+            QString sLinkName = m_sLongLinkName;
+            if (sLinkName.isEmpty()) sLinkName = m_sPaxLinkPath;
+            if (sLinkName.isEmpty()) sLinkName = debTarReadString(header.linkname, sizeof(header.linkname));
+
+            // Links, device nodes, directories and FIFOs have no data blocks.
+            const bool bHasData = (cType < '1') || (cType > '6');
+
+            while (sName.startsWith(QLatin1String("./"))) {
+                sName.remove(0, 2);
+            }
+
+            // "." and "./" are the archive root itself.
+            if (!sName.isEmpty() && (sName != QLatin1String("."))) {
+                if (m_listEntries.count() >= N_DEB_MAX_ENTRIES) {
+                    return false;
+                }
+
+                DEB_UNPACK_ENTRY entry = {};
+                entry.sFileName = m_sPrefix + sName;
+                entry.sLinkName = sLinkName;
+                entry.nStreamIndex = m_nStreamIndex;
+                entry.nDataOffset = m_nConsumed;
+                entry.nDataSize = bHasData ? nSize : 0;
+                entry.nMode = (quint32)debTarReadField(header.mode, sizeof(header.mode));
+                entry.nUID = (quint32)debTarReadField(header.uid, sizeof(header.uid));
+                entry.nGID = (quint32)debTarReadField(header.gid, sizeof(header.gid));
+                entry.nMTime = debTarReadField(header.mtime, sizeof(header.mtime));
+                entry.bIsFolder = (cType == '5') || sName.endsWith(QLatin1Char('/'));
+                m_listEntries.append(entry);
+            }
+
+            m_nSkipRemaining = bHasData ? nPaddedSize : 0;
+            m_sLongName.clear();
+            m_sLongLinkName.clear();
+            m_sPaxPath.clear();
+            m_sPaxLinkPath.clear();
+            m_nPaxSize = -1;
+        }
+
+        m_baBlock.clear();
+        return true;
+    }
+
+    qint32 m_nStreamIndex;
+    QString m_sPrefix;
+    qint64 m_nConsumed;
+    quint32 m_nCRC32;
+    QByteArray m_baBlock;
+    QByteArray m_baMetadata;
+    qint64 m_nSkipRemaining;
+    qint64 m_nCaptureRemaining;
+    char m_nCaptureType;
+    QString m_sLongName;
+    QString m_sLongLinkName;
+    QString m_sPaxPath;
+    QString m_sPaxLinkPath;
+    qint64 m_nPaxSize;
+    QList<DEB_UNPACK_ENTRY> m_listEntries;
+    bool m_bEndFound;
+    bool m_bFailed;
+};
+
 XDEB::XDEB(QIODevice *pDevice) : X_Ar(pDevice)
 {
 }
@@ -133,11 +443,13 @@ XBinary::FILEFORMATINFO XDEB::getFileFormatInfo(PDSTRUCT *pPdStruct)
 {
     XBinary::FILEFORMATINFO result = {};
 
-    QList<XArchive::RECORD> listArchiveRecords = getRecords(N_DEB_MAX_MEMBERS + 1, pPdStruct);
+    // The ar member view, not this class's unified record stream.
+    X_Ar xar(getDevice());
+    QList<XArchive::RECORD> listArchiveRecords = xar.getRecords(N_DEB_MAX_MEMBERS + 1, pPdStruct);
 
     if (isValid(&listArchiveRecords, pPdStruct)) {
         RECORD record = getArchiveRecord("debian-binary", &listArchiveRecords);
-        QByteArray baVersion = decompress(&record, pPdStruct);
+        QByteArray baVersion = xar.decompress(&record, pPdStruct);
 
         if ((baVersion == QByteArrayLiteral("2.0\n")) && XBinary::isPdStructNotCanceled(pPdStruct)) {
             result.bIsValid = true;
@@ -178,6 +490,355 @@ quint32 XDEB::ftStringToStructID(const QString &sFtString)
     return XCONVERT_ftStringToId(sFtString, _TABLE_XDEB_STRUCTID, sizeof(_TABLE_XDEB_STRUCTID) / sizeof(XBinary::XCONVERT));
 }
 
+bool XDEB::isParallelUnpackSupported()
+{
+    return false;
+}
+
+bool XDEB::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
+{
+    if (m_bUnpackOperationInProgress) {
+        return false;
+    }
+    UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress);
+    if (!operationGuard.isAcquired()) return false;
+    QPointer<XDEB> guardedArchive(this);
+
+    if (!pState) {
+        return false;
+    }
+
+    if ((pState->pContext || !pState->baUnpackSourceToken.isEmpty()) &&
+        !guardedArchive->ownsUnpackSource(pState)) {
+        return false;
+    }
+    DEB_UNPACK_CONTEXT *pOldContext = static_cast<DEB_UNPACK_CONTEXT *>(pState->pContext);
+    guardedArchive->releaseUnpackSource(pState);
+    pState->pContext = nullptr;
+    delete pOldContext;
+    if (!guardedArchive) return false;
+    *pState = UNPACK_STATE();
+    if (!XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return false;
+    }
+    const bool bBound = guardedArchive->bindUnpackSource(pState, pPdStruct);
+    if (!guardedArchive || !bBound) return false;
+
+    QPointer<QIODevice> guardedSource(guardedArchive->getDevice());
+    if (!guardedSource) {
+        guardedArchive->releaseUnpackSource(pState);
+        *pState = UNPACK_STATE();
+        return false;
+    }
+
+    X_Ar xar(guardedSource.data());
+    QList<XArchive::RECORD> listArchiveRecords = xar.getRecords(N_DEB_MAX_MEMBERS + 1, pPdStruct);
+    bool bValid = XDEB::isValid(&listArchiveRecords, pPdStruct);
+    if (bValid) {
+        const QByteArray baVersion = xar.decompress(&listArchiveRecords[0], pPdStruct);
+        bValid = (baVersion == QByteArrayLiteral("2.0\n"));
+    }
+    if (!guardedArchive || !guardedSource) return false;
+    if (!bValid || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        guardedArchive->releaseUnpackSource(pState);
+        *pState = UNPACK_STATE();
+        return false;
+    }
+
+    DEB_UNPACK_CONTEXT *pContext = new (std::nothrow) DEB_UNPACK_CONTEXT;
+    if (!pContext) {
+        guardedArchive->releaseUnpackSource(pState);
+        *pState = UNPACK_STATE();
+        return false;
+    }
+
+    // Walk control.tar.* then data.tar.*, each decoded once into the header
+    // parser.  Members after data.tar are reserved and ignored.
+    bool bResult = true;
+    const qint32 nNumberOfRecords = listArchiveRecords.count();
+    for (qint32 i = 1; (i < nNumberOfRecords) && bResult && (pContext->listStreams.count() < 2); i++) {
+        const XArchive::RECORD &record = listArchiveRecords.at(i);
+        const bool bControl = isDebTarMember(record.spInfo.sRecordName, QStringLiteral("control"));
+        const bool bData = isDebTarMember(record.spInfo.sRecordName, QStringLiteral("data"));
+        if (!bControl && !bData) continue;
+
+        DEB_TAR_STREAM stream = {};
+        bResult = guardedArchive->_getTarStream(record, &stream, pPdStruct);
+        if (!guardedArchive) {
+            delete pContext;
+            return false;
+        }
+        if (bResult) {
+            const qint32 nStreamIndex = pContext->listStreams.count();
+            pContext->listStreams.append(stream);
+            bResult = guardedArchive->_scanTarStream(stream, nStreamIndex, bControl ? QStringLiteral("DEBIAN/") : QString(), &pContext->listEntries,
+                                                     pPdStruct);
+            if (!guardedArchive) {
+                delete pContext;
+                return false;
+            }
+        }
+    }
+
+    if (!bResult || (pContext->listStreams.count() != 2) || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        guardedArchive->releaseUnpackSource(pState);
+        delete pContext;
+        *pState = UNPACK_STATE();
+        return false;
+    }
+
+    pState->pContext = pContext;
+    pState->nCurrentIndex = 0;
+    pState->nNumberOfRecords = pContext->listEntries.count();
+    pState->nCurrentOffset = 0;
+    pState->nTotalSize = guardedArchive->getSize();
+    pState->mapUnpackProperties = mapProperties;
+
+    if (!guardedArchive->validateAndFinalizeUnpackSource(pState, pContext, pPdStruct)) {
+        if (!guardedArchive) return false;
+        pState->pContext = nullptr;
+        guardedArchive->releaseUnpackSource(pState);
+        delete pContext;
+        *pState = UNPACK_STATE();
+        return false;
+    }
+
+    return true;
+}
+
+XBinary::ARCHIVERECORD XDEB::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
+{
+    UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress, &m_bNestedUnpackInfoAuthorized);
+    if (!operationGuard.isAllowed()) return XBinary::ARCHIVERECORD();
+    QPointer<XDEB> guardedArchive(this);
+
+    ARCHIVERECORD result = {};
+
+    if (!pState || !pState->pContext || !guardedArchive->isUnpackSourceCurrent(pState, pPdStruct) || !guardedArchive ||
+        (pState->nCurrentIndex < 0) || (pState->nCurrentIndex >= pState->nNumberOfRecords)) {
+        return result;
+    }
+
+    DEB_UNPACK_CONTEXT *pContext = (DEB_UNPACK_CONTEXT *)pState->pContext;
+    if (pState->nCurrentIndex >= pContext->listEntries.count()) {
+        return result;
+    }
+
+    // A tar member has no extent of its own on the package device; it is
+    // published as an index-paired archive stream and extracted through
+    // unpackCurrent().
+    const DEB_UNPACK_ENTRY &entry = pContext->listEntries.at(pState->nCurrentIndex);
+    result.mapProperties.insert(FPART_PROP_ORIGINALNAME, entry.sFileName);
+    result.mapProperties.insert(FPART_PROP_UNCOMPRESSEDSIZE, entry.nDataSize);
+    result.mapProperties.insert(FPART_PROP_FILEMODE, entry.nMode);
+    result.mapProperties.insert(FPART_PROP_UID, entry.nUID);
+    result.mapProperties.insert(FPART_PROP_GID, entry.nGID);
+    result.mapProperties.insert(FPART_PROP_ISFOLDER, entry.bIsFolder);
+    if (!entry.sLinkName.isEmpty()) {
+        result.mapProperties.insert(FPART_PROP_LINKNAME, entry.sLinkName);
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    result.mapProperties.insert(FPART_PROP_DATETIME, QDateTime::fromSecsSinceEpoch((qint64)entry.nMTime));
+#else
+    result.mapProperties.insert(FPART_PROP_DATETIME, QDateTime::fromMSecsSinceEpoch((qint64)entry.nMTime * 1000));
+#endif
+
+    if (!XBinary::markArchiveStreamRecord(&result, pState->nCurrentIndex)) {
+        return ARCHIVERECORD();
+    }
+
+    return result;
+}
+
+bool XDEB::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct)
+{
+    UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress);
+    QPointer<XDEB> guardedArchive(this);
+    QPointer<QIODevice> guardedOutput(pDevice);
+
+    if (!operationGuard.isAcquired() || !pState || !pState->pContext || !guardedOutput ||
+        !guardedArchive->isUnpackSourceCurrent(pState, pPdStruct) || !guardedArchive || (pState->nCurrentIndex < 0) ||
+        (pState->nCurrentIndex >= pState->nNumberOfRecords)) {
+        return false;
+    }
+
+    const bool bAliases = XBinary::devicesAlias(guardedArchive->getDevice(), guardedOutput.data());
+    if (!guardedArchive || !guardedOutput || bAliases) return false;
+
+    DEB_UNPACK_CONTEXT *pContext = (DEB_UNPACK_CONTEXT *)pState->pContext;
+    if (pState->nCurrentIndex >= pContext->listEntries.count()) {
+        return false;
+    }
+
+    const DEB_UNPACK_ENTRY entry = pContext->listEntries.at(pState->nCurrentIndex);
+    if ((entry.nStreamIndex < 0) || (entry.nStreamIndex >= pContext->listStreams.count())) {
+        return false;
+    }
+
+    // Only the tar stream holding this member is decoded.  Its forward decoder
+    // keeps its place between members; only a member behind it decodes the
+    // stream from the start.
+    const DEB_TAR_STREAM stream = pContext->listStreams.at(entry.nStreamIndex);
+    XForwardDecoder *pForwardDecoder = &(pContext->forwardDecoders[entry.nStreamIndex]);
+
+    pForwardDecoder->setData(guardedArchive->getDevice(), stream.nStreamOffset, stream.nStreamSize, stream.compressMethod, pState->mapUnpackProperties);
+
+    bool bResult = true;
+
+    if (entry.nDataSize > 0) {
+        bResult = pForwardDecoder->read(entry.nDataOffset, entry.nDataSize, guardedOutput.data(), pPdStruct);
+    }
+
+    // The last member of a stream also waits for the codec to reach the end,
+    // so a corrupt tail fails it instead of passing unnoticed.
+    const bool bLastOfStream = (pState->nCurrentIndex == (pContext->listEntries.count() - 1)) ||
+                               (pContext->listEntries.at(pState->nCurrentIndex + 1).nStreamIndex != entry.nStreamIndex);
+    if (bResult && bLastOfStream) {
+        bResult = pForwardDecoder->finish(pPdStruct);
+    }
+
+    return guardedArchive && bResult && guardedArchive->isUnpackSourceCurrent(pState, pPdStruct);
+}
+
+bool XDEB::moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
+{
+    UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress);
+    if (!operationGuard.isAcquired()) return false;
+    QPointer<XDEB> guardedArchive(this);
+
+    if (!pState || !pState->pContext || !guardedArchive->isUnpackSourceCurrent(pState, pPdStruct) || !guardedArchive ||
+        (pState->nCurrentIndex < 0) || (pState->nCurrentIndex >= pState->nNumberOfRecords)) {
+        return false;
+    }
+
+    pState->nCurrentIndex++;
+
+    return (pState->nCurrentIndex < pState->nNumberOfRecords);
+}
+
+bool XDEB::finishUnpack(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
+{
+    UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress);
+    if (!operationGuard.isAcquired()) return false;
+    QPointer<XDEB> guardedArchive(this);
+
+    Q_UNUSED(pPdStruct)
+
+    if (!pState) {
+        return false;
+    }
+
+    if ((pState->pContext || !pState->baUnpackSourceToken.isEmpty()) &&
+        !guardedArchive->ownsUnpackSource(pState)) return false;
+    guardedArchive->releaseUnpackSource(pState);
+    if (pState->pContext) {
+        DEB_UNPACK_CONTEXT *pContext = (DEB_UNPACK_CONTEXT *)pState->pContext;
+        pState->pContext = nullptr;
+        delete pContext;
+        if (!guardedArchive) return false;
+    }
+
+    *pState = UNPACK_STATE();
+
+    return true;
+}
+
+QList<XArchive::RECORD> XDEB::getArchiveMembers(qint32 nLimit, PDSTRUCT *pPdStruct)
+{
+    X_Ar xar(getDevice());
+
+    return xar.getRecords(nLimit, pPdStruct);
+}
+
+bool XDEB::_getTarStream(const RECORD &record, DEB_TAR_STREAM *pStream, PDSTRUCT *pPdStruct)
+{
+    QPointer<XDEB> guardedArchive(this);
+    QPointer<QIODevice> guardedSource(getDevice());
+
+    if (!pStream || !guardedSource || (record.nDataOffset < 0) || (record.nDataSize <= 0)) {
+        return false;
+    }
+
+    *pStream = {};
+    pStream->nStreamOffset = record.nDataOffset;
+    pStream->nStreamSize = record.nDataSize;
+    pStream->compressMethod = debTarMemberMethod(record.spInfo.sRecordName);
+
+    if (pStream->compressMethod == HANDLE_METHOD_UNKNOWN) {
+        return false;
+    }
+
+    // For gzip, strip the header and the CRC32/ISIZE trailer so the DEFLATE
+    // stream starts cleanly; the trailer is checked against the scan.
+    if (pStream->compressMethod == HANDLE_METHOD_DEFLATE) {
+        SubDevice memberDevice(guardedSource.data(), record.nDataOffset, record.nDataSize);
+        if (!memberDevice.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+
+        XGzip gzip(&memberDevice);
+        const bool bGzipValid = gzip.isValid(pPdStruct);
+        const qint64 nHeaderSize = bGzipValid ? gzip.getHeaderSize() : 0;
+        memberDevice.close();
+
+        if (!guardedArchive || !guardedSource || !bGzipValid || (nHeaderSize <= 0) || (record.nDataSize <= (nHeaderSize + 8))) {
+            return false;
+        }
+
+        pStream->nStreamOffset = record.nDataOffset + nHeaderSize;
+        pStream->nStreamSize = record.nDataSize - nHeaderSize - 8;
+
+        const QByteArray baTrailer = guardedArchive->read_array_process(record.nDataOffset + record.nDataSize - 8, 8, pPdStruct);
+        if (!guardedArchive || (baTrailer.size() != 8)) {
+            return false;
+        }
+
+        pStream->bHasTrailer = true;
+        pStream->nCRC32 = qFromLittleEndian<quint32>(baTrailer.constData());
+        pStream->nISize = qFromLittleEndian<quint32>(baTrailer.constData() + 4);
+    }
+
+    return XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+bool XDEB::_scanTarStream(const DEB_TAR_STREAM &stream, qint32 nStreamIndex, const QString &sPrefix, QList<DEB_UNPACK_ENTRY> *pListEntries,
+                          PDSTRUCT *pPdStruct)
+{
+    QPointer<XDEB> guardedArchive(this);
+
+    if (!pListEntries) {
+        return false;
+    }
+
+    TarScanDevice scanDevice(nStreamIndex, sPrefix);
+    if (!scanDevice.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        return false;
+    }
+
+    const bool bDecoded = XForwardDecoder::decodeStream(guardedArchive->getDevice(), stream.nStreamOffset, stream.nStreamSize, stream.compressMethod,
+                                                        QMap<UNPACK_PROP, QVariant>(), &scanDevice, pPdStruct);
+    scanDevice.close();
+
+    if (!guardedArchive || !bDecoded || scanDevice.isFailed() || !scanDevice.isComplete() || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return false;
+    }
+
+    // The raw DEFLATE stream ends before the gzip trailer, which the codec
+    // never sees; RFC 1952 stores the size modulo 2^32.
+    if (stream.bHasTrailer && ((scanDevice.crc32() != stream.nCRC32) || ((quint32)(quint64)scanDevice.size() != stream.nISize))) {
+        return false;
+    }
+
+    const QList<DEB_UNPACK_ENTRY> listEntries = scanDevice.takeEntries();
+    if (listEntries.count() > (N_DEB_MAX_ENTRIES - pListEntries->count())) {
+        return false;
+    }
+
+    pListEntries->append(listEntries);
+
+    return true;
+}
+
 bool XDEB::handleInternalInfo(PDSTRUCT *pPdStruct)
 {
     QPointer<XDEB> guardedThis(this);
@@ -22,6 +22,7 @@
 #define XDEB_H
 
 #include "x_ar.h"
+#include "xforwarddecoder.h"
 
 class XDEB : public X_Ar {
     Q_OBJECT
@@ -49,7 +50,59 @@ public:
     virtual QString getFileFormatExt() override;
     virtual FILEFORMATINFO getFileFormatInfo(PDSTRUCT *pPdStruct) override;
     virtual QString getMIMEString() override;
+
+    // One record stream over the package: control.tar members under "DEBIAN/",
+    // then the data.tar members.  The tar members are decoded on the fly.
+    virtual bool isParallelUnpackSupported() override;
+    virtual bool initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr) override;
+    virtual ARCHIVERECORD infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
+    virtual bool unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct = nullptr) override;
+    virtual bool moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
+    virtual bool finishUnpack(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
+    // getRecords() lists the tar members above; the ar members
+    // (debian-binary, control.tar.*, data.tar.*) are listed here.
+    QList<RECORD> getArchiveMembers(qint32 nLimit, PDSTRUCT *pPdStruct = nullptr);
+
 private:
+    // Compressed tar stream inside an ar member.
+    struct DEB_TAR_STREAM {
+        qint64 nStreamOffset;
+        qint64 nStreamSize;
+        HANDLE_METHOD compressMethod;
+        bool bHasTrailer;  // gzip: CRC-32 and ISIZE of the decoded stream
+        quint32 nCRC32;
+        quint32 nISize;
+    };
+
+    // One tar member, located by its offset in the decoded tar stream.
+    struct DEB_UNPACK_ENTRY {
+        QString sFileName;
+        QString sLinkName;
+        qint32 nStreamIndex;
+        qint64 nDataOffset;
+        qint64 nDataSize;
+        quint32 nMode;
+        quint32 nUID;
+        quint32 nGID;
+        quint64 nMTime;
+        bool bIsFolder;
+    };
+
+    struct DEB_UNPACK_CONTEXT {
+        QList<DEB_TAR_STREAM> listStreams;
+        QList<DEB_UNPACK_ENTRY> listEntries;
+        // One per entry of listStreams (control.tar, data.tar); members are
+        // extracted through one decode of their stream.
+        XForwardDecoder forwardDecoders[2];
+    };
+
+    class TarScanDevice;
+
+    bool _getTarStream(const RECORD &record, DEB_TAR_STREAM *pStream, PDSTRUCT *pPdStruct);
+    // Decodes the stream once, feeding the tar header parser directly.
+    bool _scanTarStream(const DEB_TAR_STREAM &stream, qint32 nStreamIndex, const QString &sPrefix, QList<DEB_UNPACK_ENTRY> *pListEntries,
+                        PDSTRUCT *pPdStruct);
+
     INTERNAL_INFO m_internalInfo;
 };
 
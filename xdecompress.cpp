@@ -22,7 +22,10 @@
 #include "subdevice.h"
 #include "xpng.h"
 #include "Algos/algo_utils.h"
+#include <QBuffer>
 #include <QCoreApplication>
+#include <QFile>
+#include <QHash>
 #include <QPointer>
 #include <algorithm>
 #include <limits>
@@ -451,6 +454,13 @@ static bool decPrepareBoundedInput(QIODevice *pDevice, qint64 nOffset, qint64 nL
 }
 }  // namespace
 
+const qint32 XDecompress::N_PROP_EXTENSION;
+const XBinary::PACK_PROP XDecompress::PACK_PROP_STREAMING;
+const XBinary::UNPACK_PROP XDecompress::UNPACK_PROP_MAPSOURCE;
+const XBinary::UNPACK_PROP XDecompress::UNPACK_PROP_PARTIALWINDOW;
+const XBinary::UNPACK_PROP XDecompress::UNPACK_PROP_THREADS;
+const XBinary::UNPACK_PROP XDecompress::UNPACK_PROP_DECODERMEMORY;
+
 XDecompress::XDecompress(QObject *parent) : QObject(parent)
 {
     m_pCurrentSolidDevice = nullptr;
@@ -904,7 +914,43 @@ bool XDecompress::decompressArchiveRecord(const XBinary::ARCHIVERECORD &archiveR
     state.nProcessedOffset = 0;
     state.nProcessedLimit = -1;
 
-    return multiDecompress(&state, pPdStruct);
+    // UNPACK_PROP_MAPSOURCE: map the member once and hand it to the decoders as
+    // an in-memory QBuffer, which the span-aware ones (store, inflate, LZMA,
+    // zstd, LZ4) consume in place.  Solid members are left alone because their
+    // caches are keyed by the input device.  A mapped page past the end of a
+    // shortened file faults (SIGBUS) instead of returning a short read, so only
+    // files this process opened read-only are mapped, and the mapping is used
+    // only if the file still covers it once it is in place.
+    QPointer<QFile> pSourceFile(qobject_cast<QFile *>(pDeviceInput));
+    uchar *pMapped = nullptr;
+    QBuffer mappedBuffer;
+    if (mapUnpackProperties.value(UNPACK_PROP_MAPSOURCE, false).toBool() && pSourceFile && !pSourceFile->isWritable() &&
+        (archiveRecord.nStreamSize > 0) &&
+        (archiveRecord.nStreamSize <= (std::numeric_limits<int>::max)()) &&
+        !archiveRecord.mapProperties.contains(XBinary::FPART_PROP_SOLIDFOLDERINDEX) &&
+        !archiveRecord.mapProperties.value(XBinary::FPART_PROP_ISSOLID, false).toBool()) {
+        pMapped = pSourceFile->map(archiveRecord.nStreamOffset, archiveRecord.nStreamSize);
+        if (pMapped && ((pSourceFile->size() - archiveRecord.nStreamOffset) < archiveRecord.nStreamSize)) {
+            pSourceFile->unmap(pMapped);
+            pMapped = nullptr;
+        }
+        if (pMapped) {
+            mappedBuffer.setData(QByteArray::fromRawData((const char *)pMapped, (int)archiveRecord.nStreamSize));
+            if (mappedBuffer.open(QIODevice::ReadOnly)) {
+                state.pDeviceInput = &mappedBuffer;
+                state.nInputOffset = 0;
+            }
+        }
+    }
+
+    const bool bResult = multiDecompress(&state, pPdStruct);
+
+    if (pMapped) {
+        mappedBuffer.close();
+        if (pSourceFile) pSourceFile->unmap(pMapped);
+    }
+
+    return bResult;
 }
 
 void XDecompress::clearSolidCache()
@@ -1338,7 +1384,7 @@ bool XDecompress::multiDecompress(XBinary::DATAPROCESS_STATE *pState, XBinary::P
 
     XBinary::HANDLE_METHOD topMethod = (XBinary::HANDLE_METHOD)pState->mapProperties.value(XBinary::FPART_PROP_HANDLEMETHOD, XBinary::HANDLE_METHOD_STORE).toUInt();
     // BCJ2 handles its own 4 sub-streams internally in decompress() — never treat it as multi-method
-    if (topMethod != XBinary::HANDLE_METHOD_BCJ2) {
+    if (!isCodecFlagsPresent(topMethod, CODEC_FLAG_MULTISTREAM)) {
         if (pState->mapProperties.contains(XBinary::FPART_PROP_HANDLEMETHOD3)) {
             nNumberOfMethods = 3;
         } else if (pState->mapProperties.contains(XBinary::FPART_PROP_HANDLEMETHOD2)) {
@@ -1349,10 +1395,13 @@ bool XDecompress::multiDecompress(XBinary::DATAPROCESS_STATE *pState, XBinary::P
     if ((nNumberOfMethods == 1) && (!bIsSolid)) {
         const XBinary::CRC_TYPE crcType =
             (XBinary::CRC_TYPE)pState->mapProperties.value(XBinary::FPART_PROP_CRC_TYPE, XBinary::CRC_TYPE_UNKNOWN).toUInt();
-        const bool bCheckCRC = (crcType != XBinary::CRC_TYPE_UNKNOWN) &&
+        const bool bWindowed = (pState->nProcessedOffset != 0) || (pState->nProcessedLimit != -1);
+        // UNPACK_PROP_PARTIALWINDOW: the caller accepts an unauthenticated
+        // slice, so the window streams and the decoder stops at its end.
+        const bool bPartialWindow = bWindowed && pState->mapUnpackProperties.value(UNPACK_PROP_PARTIALWINDOW, false).toBool();
+        const bool bCheckCRC = (!bPartialWindow) && (crcType != XBinary::CRC_TYPE_UNKNOWN) &&
                                pState->mapProperties.contains(XBinary::FPART_PROP_RESULTCRC) &&
                                XBinary::isUnpackCRCEnabled(pState->mapUnpackProperties, crcType);
-        const bool bWindowed = (pState->nProcessedOffset != 0) || (pState->nProcessedLimit != -1);
 
         if (bCheckCRC && bWindowed) {
             // A record CRC covers the complete decoded record, never a caller's
@@ -1416,8 +1465,7 @@ bool XDecompress::multiDecompress(XBinary::DATAPROCESS_STATE *pState, XBinary::P
     } else if (bIsSolid) {
         // Check if this is a RAR solid archive — RAR solid requires sequential decompression
         // with persistent decoder state, unlike 7z solid which uses a single compressed block.
-        bool bIsRarSolid = (topMethod == XBinary::HANDLE_METHOD_RAR_15) || (topMethod == XBinary::HANDLE_METHOD_RAR_20) || (topMethod == XBinary::HANDLE_METHOD_RAR_29) ||
-                           (topMethod == XBinary::HANDLE_METHOD_RAR_50) || (topMethod == XBinary::HANDLE_METHOD_RAR_70);
+        bool bIsRarSolid = isCodecFlagsPresent(topMethod, CODEC_FLAG_SOLIDSTATE);
 
         // STORE files inside a RAR solid archive must also use decompressRarSolid() to keep
         // the solid index counter in sync. RAR records have SOLIDFOLDERINDEX but no
@@ -1668,6 +1716,346 @@ static quint64 decLzipReadLE64(const char *pData)
     return nValue;
 }
 
+// Codec registry.  Methods whose decoder is a single call get an entry
+// point here; the rest keep a dedicated branch in decompress() and are
+// listed for their capability flags only.
+static bool decCodecStore(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+
+    // For STORE after AES decryption, the input may include AES padding bytes.
+    // Cap input to the actual uncompressed size (including zero) to avoid
+    // copying padding or stale data into an empty result.
+    if (pState->mapProperties.contains(XBinary::FPART_PROP_UNCOMPRESSEDSIZE)) {
+        const qint64 nUncompressedSize = pState->mapProperties.value(XBinary::FPART_PROP_UNCOMPRESSEDSIZE, 0).toLongLong();
+        if ((nUncompressedSize >= 0) && (nUncompressedSize < pState->nInputLimit)) {
+            pState->nInputLimit = nUncompressedSize;
+        }
+    }
+
+    return XStoreDecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecBzip2(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XBZIP2Decoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecBrotli(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XBrotliDecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecLzma(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return baProperty.isEmpty() ? XLZMADecoder::decompress(pState, pPdStruct) : XLZMADecoder::decompress(pState, baProperty, pPdStruct);
+}
+
+static bool decCodecLzma2(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return baProperty.isEmpty() ? XLZMADecoder::decompressLZMA2(pState, pPdStruct) : XLZMADecoder::decompressLZMA2(pState, baProperty, pPdStruct);
+}
+
+static bool decCodecBranch(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBranchDecoder::BTYPE bType, XBinary::PDSTRUCT *pPdStruct)
+{
+    quint32 nIp = 0;
+    return decGetBranchStartOffset(baProperty, &nIp) && XBranchDecoder::decompressBranch(pState, bType, pPdStruct, nIp);
+}
+
+static bool decCodecArm64(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return decCodecBranch(pState, baProperty, XBranchDecoder::BTYPE_ARM64, pPdStruct);
+}
+
+static bool decCodecArm(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return decCodecBranch(pState, baProperty, XBranchDecoder::BTYPE_ARM, pPdStruct);
+}
+
+static bool decCodecArmt(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return decCodecBranch(pState, baProperty, XBranchDecoder::BTYPE_ARMT, pPdStruct);
+}
+
+static bool decCodecPpc(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return decCodecBranch(pState, baProperty, XBranchDecoder::BTYPE_PPC, pPdStruct);
+}
+
+static bool decCodecSparc(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return decCodecBranch(pState, baProperty, XBranchDecoder::BTYPE_SPARC, pPdStruct);
+}
+
+static bool decCodecIa64(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return decCodecBranch(pState, baProperty, XBranchDecoder::BTYPE_IA64, pPdStruct);
+}
+
+static bool decCodecDelta(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    // Property byte holds distance - 1 (7z and XZ delta filter convention)
+    const qint32 nDistance = baProperty.isEmpty() ? 1 : ((qint32)(quint8)baProperty.at(0) + 1);
+    return XBranchDecoder::decompressDelta(pState, nDistance, pPdStruct);
+}
+
+static bool decCodecXz(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XLZMADecoder::decompressXZ(pState, pPdStruct);
+}
+
+static bool decCodecPpmd7(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    return XPPMdDecoder::decompressPPMD7(pState, baProperty, pPdStruct);
+}
+
+static bool decCodecPpmd8(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XPPMdDecoder::decompressPPMD8(pState, pPdStruct);
+}
+
+static bool decCodecDeflate(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XDeflateDecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecDeflate64(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XDeflateDecoder::decompress64(pState, pPdStruct);
+}
+
+static bool decCodecZlib(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XDeflateDecoder::decompress_zlib(pState, pPdStruct);
+}
+
+template <qint32 N_BITS, bool B_IT215>
+static bool decCodecIt214(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XIT214Decoder::decompress(pState, N_BITS, B_IT215, pPdStruct);
+}
+
+template <bool B_8KDICT, bool B_3TREES>
+static bool decCodecImplode(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XImplodeDecoder::decompress(pState, B_8KDICT, B_3TREES, pPdStruct);
+}
+
+static bool decCodecShrink(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XShrinkDecoder::decompress(pState, pPdStruct);
+}
+
+template <qint32 N_FACTOR>
+static bool decCodecReduce(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XReduceDecoder::decompress(pState, N_FACTOR, pPdStruct);
+}
+
+static bool decCodecLzwPdf(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XLZWDecoder::decompress_pdf(pState, pPdStruct);
+}
+
+static bool decCodecAscii85(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XASCII85Decoder::decompress_pdf(pState, pPdStruct);
+}
+
+static bool decCodecAsciiHex(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XASCIIHexDecoder::decompress_pdf(pState, pPdStruct);
+}
+
+static bool decCodecRunLength(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XRunLengthDecoder::decompress_pdf(pState, pPdStruct);
+}
+
+template <qint32 N_METHOD>
+static bool decCodecLzh(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XLZHDecoder::decompress(pState, N_METHOD, pPdStruct);
+}
+
+static bool decCodecAce(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XAceDecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecArj(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XArjDecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecArjFastest(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XArjDecoder::decompressFastest(pState, pPdStruct);
+}
+
+static bool decCodecZstd(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XZstdDecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecLz4(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XLZ4Decoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecLz5(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XLZ5Decoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecLizard(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XLizardDecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecLzop(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XLZODecoder::decompress(pState, pPdStruct);
+}
+
+static bool decCodecCompress(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct)
+{
+    Q_UNUSED(baProperty)
+    return XCompressDecoder::decompress(pState, pPdStruct);
+}
+
+namespace {
+const XDecompress::CODEC g_decCodecs[] = {
+    {XBinary::HANDLE_METHOD_STORE, XDecompress::CODEC_FLAG_IDENTITY, decCodecStore},
+    {XBinary::HANDLE_METHOD_BZIP2, 0, decCodecBzip2},
+    {XBinary::HANDLE_METHOD_BROTLI, 0, decCodecBrotli},
+    {XBinary::HANDLE_METHOD_LZMA, 0, decCodecLzma},
+    {XBinary::HANDLE_METHOD_LZMA2, 0, decCodecLzma2},
+    {XBinary::HANDLE_METHOD_XZ, 0, decCodecXz},
+    {XBinary::HANDLE_METHOD_BCJ, 0, nullptr},
+    {XBinary::HANDLE_METHOD_ARM64_BCJ, 0, decCodecArm64},
+    {XBinary::HANDLE_METHOD_ARM_BCJ, 0, decCodecArm},
+    {XBinary::HANDLE_METHOD_ARMT_BCJ, 0, decCodecArmt},
+    {XBinary::HANDLE_METHOD_PPC_BCJ, 0, decCodecPpc},
+    {XBinary::HANDLE_METHOD_SPARC_BCJ, 0, decCodecSparc},
+    {XBinary::HANDLE_METHOD_IA64_BCJ, 0, decCodecIa64},
+    {XBinary::HANDLE_METHOD_DELTA, 0, decCodecDelta},
+    {XBinary::HANDLE_METHOD_BCJ2, XDecompress::CODEC_FLAG_MULTISTREAM, nullptr},
+    {XBinary::HANDLE_METHOD_KWAJ_XOR, 0, nullptr},
+    {XBinary::HANDLE_METHOD_PPMD7, 0, decCodecPpmd7},
+    {XBinary::HANDLE_METHOD_PPMD8, 0, decCodecPpmd8},
+    {XBinary::HANDLE_METHOD_DEFLATE, 0, decCodecDeflate},
+    {XBinary::HANDLE_METHOD_DEFLATE64, 0, decCodecDeflate64},
+    {XBinary::HANDLE_METHOD_ZLIB, 0, decCodecZlib},
+    {XBinary::HANDLE_METHOD_IT214_8, 0, decCodecIt214<8, false>},
+    {XBinary::HANDLE_METHOD_IT214_16, 0, decCodecIt214<16, false>},
+    {XBinary::HANDLE_METHOD_IT215_8, 0, decCodecIt214<8, true>},
+    {XBinary::HANDLE_METHOD_IT215_16, 0, decCodecIt214<16, true>},
+    {XBinary::HANDLE_METHOD_IMPLODED_4KDICT_2TREES, 0, decCodecImplode<false, false>},
+    {XBinary::HANDLE_METHOD_IMPLODED_4KDICT_3TREES, 0, decCodecImplode<false, true>},
+    {XBinary::HANDLE_METHOD_IMPLODED_8KDICT_2TREES, 0, decCodecImplode<true, false>},
+    {XBinary::HANDLE_METHOD_IMPLODED_8KDICT_3TREES, 0, decCodecImplode<true, true>},
+    {XBinary::HANDLE_METHOD_SHRINK, 0, decCodecShrink},
+    {XBinary::HANDLE_METHOD_REDUCE_1, 0, decCodecReduce<1>},
+    {XBinary::HANDLE_METHOD_REDUCE_2, 0, decCodecReduce<2>},
+    {XBinary::HANDLE_METHOD_REDUCE_3, 0, decCodecReduce<3>},
+    {XBinary::HANDLE_METHOD_REDUCE_4, 0, decCodecReduce<4>},
+    {XBinary::HANDLE_METHOD_LZW_PDF, 0, decCodecLzwPdf},
+    {XBinary::HANDLE_METHOD_ASCII85, 0, decCodecAscii85},
+    {XBinary::HANDLE_METHOD_ASCIIHEX, 0, decCodecAsciiHex},
+    {XBinary::HANDLE_METHOD_RUNLENGTH, 0, decCodecRunLength},
+    {XBinary::HANDLE_METHOD_LZH1, 0, decCodecLzh<1>},
+    {XBinary::HANDLE_METHOD_LZH5, 0, decCodecLzh<5>},
+    {XBinary::HANDLE_METHOD_LZH6, 0, decCodecLzh<6>},
+    {XBinary::HANDLE_METHOD_LZH7, 0, decCodecLzh<7>},
+    {XBinary::HANDLE_METHOD_ACE, 0, decCodecAce},
+    {XBinary::HANDLE_METHOD_ARJ, 0, decCodecArj},
+    {XBinary::HANDLE_METHOD_ARJ_FASTEST, 0, decCodecArjFastest},
+    {XBinary::HANDLE_METHOD_RAR_15, XDecompress::CODEC_FLAG_SOLIDSTATE, nullptr},
+    {XBinary::HANDLE_METHOD_RAR_20, XDecompress::CODEC_FLAG_SOLIDSTATE, nullptr},
+    {XBinary::HANDLE_METHOD_RAR_29, XDecompress::CODEC_FLAG_SOLIDSTATE, nullptr},
+    {XBinary::HANDLE_METHOD_RAR_50, XDecompress::CODEC_FLAG_SOLIDSTATE, nullptr},
+    {XBinary::HANDLE_METHOD_RAR_70, XDecompress::CODEC_FLAG_SOLIDSTATE, nullptr},
+    {XBinary::HANDLE_METHOD_ZIP_AES, 0, nullptr},
+    {XBinary::HANDLE_METHOD_ZIP_AES128, 0, nullptr},
+    {XBinary::HANDLE_METHOD_ZIP_AES192, 0, nullptr},
+    {XBinary::HANDLE_METHOD_ZIP_AES256, 0, nullptr},
+    {XBinary::HANDLE_METHOD_ZIPCRYPTO, 0, nullptr},
+    {XBinary::HANDLE_METHOD_7Z_AES, 0, nullptr},
+    {XBinary::HANDLE_METHOD_RAR5_AES, 0, nullptr},
+    {XBinary::HANDLE_METHOD_PDF_CCITTIMAGE, 0, nullptr},
+    {XBinary::HANDLE_METHOD_PDF_PALETTE, 0, nullptr},
+    {XBinary::HANDLE_METHOD_PDF_IMAGEDATA, 0, nullptr},
+    {XBinary::HANDLE_METHOD_STORE_CAB, 0, nullptr},
+    {XBinary::HANDLE_METHOD_MSZIP_CAB, 0, nullptr},
+    {XBinary::HANDLE_METHOD_LZX_CAB, 0, nullptr},
+    {XBinary::HANDLE_METHOD_ZSTD, 0, decCodecZstd},
+    {XBinary::HANDLE_METHOD_LZ4, 0, decCodecLz4},
+    {XBinary::HANDLE_METHOD_LZ5, 0, decCodecLz5},
+    {XBinary::HANDLE_METHOD_LIZARD, 0, decCodecLizard},
+    {XBinary::HANDLE_METHOD_LZOP, 0, decCodecLzop},
+    {XBinary::HANDLE_METHOD_COMPRESS, 0, decCodecCompress},
+    {XBinary::HANDLE_METHOD_LZIP, 0, nullptr},
+};
+
+// Method -> descriptor, built once on first use.
+QHash<quint32, const XDecompress::CODEC *> decCodecIndex()
+{
+    QHash<quint32, const XDecompress::CODEC *> hashResult;
+    const qint32 nNumberOfCodecs = (qint32)(sizeof(g_decCodecs) / sizeof(g_decCodecs[0]));
+    hashResult.reserve(nNumberOfCodecs);
+
+    for (qint32 i = 0; i < nNumberOfCodecs; i++) {
+        hashResult.insert((quint32)g_decCodecs[i].method, &g_decCodecs[i]);
+    }
+
+    return hashResult;
+}
+}  // namespace
+
+const XDecompress::CODEC *XDecompress::getCodec(XBinary::HANDLE_METHOD method)
+{
+    static const QHash<quint32, const CODEC *> hashCodecs = decCodecIndex();
+
+    return hashCodecs.value((quint32)method, nullptr);
+}
+
+quint32 XDecompress::getCodecFlags(XBinary::HANDLE_METHOD method)
+{
+    const CODEC *pCodec = getCodec(method);
+
+    return pCodec ? pCodec->nFlags : 0;
+}
+
+bool XDecompress::isCodecFlagsPresent(XBinary::HANDLE_METHOD method, quint32 nFlags)
+{
+    return (getCodecFlags(method) & nFlags) == nFlags;
+}
+
 bool XDecompress::decompress(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRUCT *pPdStruct)
 {
     if (!pState) {
@@ -1797,30 +2185,10 @@ bool XDecompress::decompress(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRU
         }
     }
 
-    if (compressMethod == XBinary::HANDLE_METHOD_STORE) {
-        // For STORE after AES decryption, the input may include AES padding bytes.
-        // Cap input to the actual uncompressed size (including zero) to avoid
-        // copying padding or stale data into an empty result.
-        if (bUncompressedSizeDefined && (nUncompressedSize >= 0) && (nUncompressedSize < pState->nInputLimit)) {
-            pState->nInputLimit = nUncompressedSize;
-        }
-        bResult = XStoreDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_BZIP2) {
-        bResult = XBZIP2Decoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_BROTLI) {
-        bResult = XBrotliDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZMA) {
-        if (!baProperty.isEmpty()) {
-            bResult = XLZMADecoder::decompress(pState, baProperty, pPdStruct);
-        } else {
-            bResult = XLZMADecoder::decompress(pState, pPdStruct);
-        }
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZMA2) {
-        if (!baProperty.isEmpty()) {
-            bResult = XLZMADecoder::decompressLZMA2(pState, baProperty, pPdStruct);
-        } else {
-            bResult = XLZMADecoder::decompressLZMA2(pState, pPdStruct);
-        }
+    const CODEC *pCodec = getCodec(compressMethod);
+
+    if (pCodec && pCodec->pDecompress) {
+        bResult = pCodec->pDecompress(pState, baProperty, pPdStruct);
     } else if (compressMethod == XBinary::HANDLE_METHOD_BCJ) {
         // x86 BCJ inverse filter — delegate to the single byte-exact reference port.
         if (pState->pDeviceInput && pState->pDeviceOutput) {
@@ -1852,34 +2220,6 @@ bool XDecompress::decompress(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRU
 
             bResult = XBinary::_writeDevice(baData.constData(), baData.size(), pState) == baData.size();
         }
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ARM64_BCJ) {
-        quint32 nIp = 0;
-        bResult = decGetBranchStartOffset(baProperty, &nIp) &&
-                  XBranchDecoder::decompressBranch(pState, XBranchDecoder::BTYPE_ARM64, pPdStruct, nIp);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ARM_BCJ) {
-        quint32 nIp = 0;
-        bResult = decGetBranchStartOffset(baProperty, &nIp) &&
-                  XBranchDecoder::decompressBranch(pState, XBranchDecoder::BTYPE_ARM, pPdStruct, nIp);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ARMT_BCJ) {
-        quint32 nIp = 0;
-        bResult = decGetBranchStartOffset(baProperty, &nIp) &&
-                  XBranchDecoder::decompressBranch(pState, XBranchDecoder::BTYPE_ARMT, pPdStruct, nIp);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_PPC_BCJ) {
-        quint32 nIp = 0;
-        bResult = decGetBranchStartOffset(baProperty, &nIp) &&
-                  XBranchDecoder::decompressBranch(pState, XBranchDecoder::BTYPE_PPC, pPdStruct, nIp);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_SPARC_BCJ) {
-        quint32 nIp = 0;
-        bResult = decGetBranchStartOffset(baProperty, &nIp) &&
-                  XBranchDecoder::decompressBranch(pState, XBranchDecoder::BTYPE_SPARC, pPdStruct, nIp);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IA64_BCJ) {
-        quint32 nIp = 0;
-        bResult = decGetBranchStartOffset(baProperty, &nIp) &&
-                  XBranchDecoder::decompressBranch(pState, XBranchDecoder::BTYPE_IA64, pPdStruct, nIp);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_DELTA) {
-        // Property byte holds distance - 1 (7z and XZ delta filter convention)
-        qint32 nDistance = baProperty.isEmpty() ? 1 : ((qint32)(quint8)baProperty.at(0) + 1);
-        bResult = XBranchDecoder::decompressDelta(pState, nDistance, pPdStruct);
     } else if (compressMethod == XBinary::HANDLE_METHOD_KWAJ_XOR) {
         // KWAJ compression method 1: every byte XOR 0xFF
         if (pState->pDeviceInput && pState->pDeviceOutput) {
@@ -1909,70 +2249,7 @@ bool XDecompress::decompress(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRU
 
             bResult = XBinary::_writeDevice(baData.constData(), baData.size(), pState) == baData.size();
         }
-    } else if (compressMethod == XBinary::HANDLE_METHOD_XZ) {
-        bResult = XLZMADecoder::decompressXZ(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_PPMD7) {
-        bResult = XPPMdDecoder::decompressPPMD7(pState, baProperty, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_PPMD8) {
-        bResult = XPPMdDecoder::decompressPPMD8(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_DEFLATE) {
-        bResult = XDeflateDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_DEFLATE64) {
-        bResult = XDeflateDecoder::decompress64(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IT214_8) {
-        bResult = XIT214Decoder::decompress(pState, 8, false, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IT214_16) {
-        bResult = XIT214Decoder::decompress(pState, 16, false, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IT215_8) {
-        bResult = XIT214Decoder::decompress(pState, 8, true, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IT215_16) {
-        bResult = XIT214Decoder::decompress(pState, 16, true, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IMPLODED_4KDICT_2TREES) {
-        bResult = XImplodeDecoder::decompress(pState, false, false, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IMPLODED_4KDICT_3TREES) {
-        bResult = XImplodeDecoder::decompress(pState, false, true, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IMPLODED_8KDICT_2TREES) {
-        bResult = XImplodeDecoder::decompress(pState, true, false, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_IMPLODED_8KDICT_3TREES) {
-        bResult = XImplodeDecoder::decompress(pState, true, true, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_SHRINK) {
-        bResult = XShrinkDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_REDUCE_1) {
-        bResult = XReduceDecoder::decompress(pState, 1, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_REDUCE_2) {
-        bResult = XReduceDecoder::decompress(pState, 2, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_REDUCE_3) {
-        bResult = XReduceDecoder::decompress(pState, 3, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_REDUCE_4) {
-        bResult = XReduceDecoder::decompress(pState, 4, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ZLIB) {
-        bResult = XDeflateDecoder::decompress_zlib(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZW_PDF) {
-        bResult = XLZWDecoder::decompress_pdf(pState, pPdStruct);
-        // bResult = XStoreDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ASCII85) {
-        bResult = XASCII85Decoder::decompress_pdf(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ASCIIHEX) {
-        bResult = XASCIIHexDecoder::decompress_pdf(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_RUNLENGTH) {
-        bResult = XRunLengthDecoder::decompress_pdf(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZH1) {
-        bResult = XLZHDecoder::decompress(pState, 1, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZH5) {
-        bResult = XLZHDecoder::decompress(pState, 5, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZH6) {
-        bResult = XLZHDecoder::decompress(pState, 6, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZH7) {
-        bResult = XLZHDecoder::decompress(pState, 7, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ACE) {
-        bResult = XAceDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ARJ) {
-        bResult = XArjDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ARJ_FASTEST) {
-        bResult = XArjDecoder::decompressFastest(pState, pPdStruct);
-    } else if ((compressMethod == XBinary::HANDLE_METHOD_RAR_15) || (compressMethod == XBinary::HANDLE_METHOD_RAR_20) ||
-               (compressMethod == XBinary::HANDLE_METHOD_RAR_29) || (compressMethod == XBinary::HANDLE_METHOD_RAR_50) ||
-               (compressMethod == XBinary::HANDLE_METHOD_RAR_70)) {
+    } else if (isCodecFlagsPresent(compressMethod, CODEC_FLAG_SOLIDSTATE)) {
         pState->bReadError = false;
         pState->bWriteError = false;
         pState->nCountInput = 0;
@@ -2905,18 +3182,6 @@ bool XDecompress::decompress(XBinary::DATAPROCESS_STATE *pState, XBinary::PDSTRU
                 bResult = false;
             }
         }
-    } else if (compressMethod == XBinary::HANDLE_METHOD_ZSTD) {
-        bResult = XZstdDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZ4) {
-        bResult = XLZ4Decoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZ5) {
-        bResult = XLZ5Decoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LIZARD) {
-        bResult = XLizardDecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_LZOP) {
-        bResult = XLZODecoder::decompress(pState, pPdStruct);
-    } else if (compressMethod == XBinary::HANDLE_METHOD_COMPRESS) {
-        bResult = XCompressDecoder::decompress(pState, pPdStruct);
     } else if (compressMethod == XBinary::HANDLE_METHOD_LZIP) {
         // A lzip file is a concatenation of independently checksummed members.
         // Walk trailers backwards first so framing is known before any output
@@ -56,6 +56,42 @@ class XDecompress : public QObject {
     Q_OBJECT
 
 public:
+    // Properties beyond XBinary::PACK_PROP and XBinary::UNPACK_PROP.  XBinary's
+    // enumerators are small sequential values; every value this library adds is
+    // assigned here from N_PROP_EXTENSION up, so a new one is checked for
+    // collisions against this list only.  XArchive re-exports them.
+    static const qint32 N_PROP_EXTENSION = 0x1000;
+    // bool: write the archive once, front to back; sizes follow the data
+    static const XBinary::PACK_PROP PACK_PROP_STREAMING = (XBinary::PACK_PROP)(N_PROP_EXTENSION + 0);
+    // bool: decode members of a QFile opened read-only from a QFile::map view instead of device reads
+    static const XBinary::UNPACK_PROP UNPACK_PROP_MAPSOURCE = (XBinary::UNPACK_PROP)(N_PROP_EXTENSION + 0);
+    // bool: stream a bounded output window without the full-record CRC check, so decoding stops once the window is filled
+    static const XBinary::UNPACK_PROP UNPACK_PROP_PARTIALWINDOW = (XBinary::UNPACK_PROP)(N_PROP_EXTENSION + 1);
+    // qint32: decoder threads for formats handled by the 7-Zip core and for ISO 9660 zisofs blocks; 0 means all cores
+    static const XBinary::UNPACK_PROP UNPACK_PROP_THREADS = (XBinary::UNPACK_PROP)(N_PROP_EXTENSION + 2);
+    // qint64: decoder memory budget in bytes for formats handled by the 7-Zip core
+    static const XBinary::UNPACK_PROP UNPACK_PROP_DECODERMEMORY = (XBinary::UNPACK_PROP)(N_PROP_EXTENSION + 3);
+
+    // Capabilities of a codec as implemented by this decoder
+    enum CODEC_FLAG {
+        CODEC_FLAG_IDENTITY = 0x0001,     // output bytes are the input bytes, so a window can be served as a view of the source
+        CODEC_FLAG_SOLIDSTATE = 0x0002,   // decoder state carries over between members of a solid archive
+        CODEC_FLAG_MULTISTREAM = 0x0004   // consumes several packed streams itself (BCJ2)
+    };
+
+    typedef bool (*CODEC_DECOMPRESS)(XBinary::DATAPROCESS_STATE *pState, const QByteArray &baProperty, XBinary::PDSTRUCT *pPdStruct);
+
+    struct CODEC {
+        XBinary::HANDLE_METHOD method;
+        quint32 nFlags;                  // CODEC_FLAG_*
+        CODEC_DECOMPRESS pDecompress;    // nullptr: decoded by a dedicated branch of decompress()
+    };
+
+    // Registry lookup; nullptr for methods this decoder does not know.
+    static const CODEC *getCodec(XBinary::HANDLE_METHOD method);
+    static quint32 getCodecFlags(XBinary::HANDLE_METHOD method);
+    static bool isCodecFlagsPresent(XBinary::HANDLE_METHOD method, quint32 nFlags);
+
     explicit XDecompress(QObject *parent = nullptr);
     virtual ~XDecompress();
     bool decompressFPART(const XBinary::FPART &fPart, QIODevice *pDeviceInput, QIODevice *pDeviceOutput, XBinary::PDSTRUCT *pPdStruct);
@@ -0,0 +1,366 @@
+/* Copyright (c) 2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "xforwarddecoder.h"
+#include "subdevice.h"
+
+#include <QScopedPointer>
+#include <QThread>
+#include <new>
+
+namespace {
+const qint64 N_FORWARDDECODER_CHUNK = 0x100000;
+const unsigned long N_FORWARDDECODER_POLL_MS = 100;
+}  // namespace
+
+// Output of the codec.  Every write blocks until the caller asks for data, and
+// the last one also until the caller asks for more, which keeps the codec
+// parked between read() calls.
+class XForwardDecoder::Pipe : public QIODevice {
+public:
+    explicit Pipe(XForwardDecoder *pDecoder) : m_pDecoder(pDecoder), m_nWritten(0)
+    {
+    }
+
+    bool isSequential() const override
+    {
+        return false;
+    }
+
+    qint64 size() const override
+    {
+        return m_nWritten;
+    }
+
+    bool seek(qint64 nPosition) override
+    {
+        return (nPosition == pos()) && QIODevice::seek(nPosition);
+    }
+
+protected:
+    qint64 readData(char *pData, qint64 nMaxSize) override
+    {
+        Q_UNUSED(pData)
+        Q_UNUSED(nMaxSize)
+
+        return -1;
+    }
+
+    qint64 writeData(const char *pData, qint64 nMaxSize) override
+    {
+        if ((nMaxSize < 0) || ((nMaxSize > 0) && !pData)) {
+            return -1;
+        }
+
+        QMutexLocker locker(&m_pDecoder->m_mutex);
+
+        for (qint64 nDone = 0; nDone < nMaxSize;) {
+            if (!_waitForRequest()) return -1;
+
+            const qint64 nPart = qMin(nMaxSize - nDone, N_FORWARDDECODER_CHUNK);
+            m_pDecoder->m_baChunk = QByteArray(pData + nDone, (qint32)nPart);
+            m_pDecoder->m_bRequested = false;
+            m_pDecoder->m_condition.wakeAll();
+            nDone += nPart;
+        }
+
+        if (!_waitForRequest()) return -1;
+
+        m_nWritten += nMaxSize;
+
+        return nMaxSize;
+    }
+
+private:
+    bool _waitForRequest()
+    {
+        while (!m_pDecoder->m_bRequested && !m_pDecoder->m_bAbort) {
+            m_pDecoder->m_condition.wait(&m_pDecoder->m_mutex);
+        }
+
+        return !m_pDecoder->m_bAbort;
+    }
+
+    XForwardDecoder *m_pDecoder;
+    qint64 m_nWritten;
+};
+
+class XForwardDecoder::Worker : public QThread {
+public:
+    explicit Worker(XForwardDecoder *pDecoder) : m_pDecoder(pDecoder), m_pipe(pDecoder)
+    {
+    }
+
+    // Opened by the caller before start(); SubDevice positions the source on
+    // every read, so the caller may move it between read() calls.
+    bool open()
+    {
+        m_pInput.reset(new SubDevice(m_pDecoder->m_pSource.data(), m_pDecoder->m_nStreamOffset, m_pDecoder->m_nStreamSize));
+
+        return m_pInput->open(QIODevice::ReadOnly) && m_pipe.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    }
+
+protected:
+    void run() override
+    {
+        {
+            // Parked until _pull() raises the first request.
+            QMutexLocker locker(&m_pDecoder->m_mutex);
+
+            while (!m_pDecoder->m_bRequested && !m_pDecoder->m_bAbort) {
+                m_pDecoder->m_condition.wait(&m_pDecoder->m_mutex);
+            }
+
+            if (m_pDecoder->m_bAbort) {
+                m_pDecoder->m_bFinished = true;
+                return;
+            }
+        }
+
+        // Cancellation reaches the codec through the pipe, whose writes fail
+        // once the decoder is aborted.
+        XBinary::PDSTRUCT pdStruct = XBinary::createPdStruct();
+        const bool bResult = decodeStream(m_pInput.data(), 0, m_pDecoder->m_nStreamSize, m_pDecoder->m_method, m_pDecoder->m_mapUnpackProperties,
+                                          &m_pipe, &pdStruct);
+
+        QMutexLocker locker(&m_pDecoder->m_mutex);
+        m_pDecoder->m_bFinished = true;
+        m_pDecoder->m_bDecoded = bResult;
+        m_pDecoder->m_condition.wakeAll();
+    }
+
+private:
+    XForwardDecoder *m_pDecoder;
+    QScopedPointer<SubDevice> m_pInput;
+    Pipe m_pipe;
+};
+
+XForwardDecoder::XForwardDecoder()
+{
+    m_nStreamOffset = 0;
+    m_nStreamSize = 0;
+    m_method = XBinary::HANDLE_METHOD_UNKNOWN;
+    m_pWorker = nullptr;
+    m_nCursor = 0;
+    m_nPendingPosition = 0;
+    m_bRequested = false;
+    m_bAbort = false;
+    m_bFinished = false;
+    m_bDecoded = false;
+}
+
+XForwardDecoder::~XForwardDecoder()
+{
+    reset();
+}
+
+bool XForwardDecoder::decodeStream(QIODevice *pSource, qint64 nStreamOffset, qint64 nStreamSize, XBinary::HANDLE_METHOD method,
+                                   const QMap<XBinary::UNPACK_PROP, QVariant> &mapUnpackProperties, QIODevice *pOutput,
+                                   XBinary::PDSTRUCT *pPdStruct)
+{
+    QPointer<QIODevice> guardedSource(pSource);
+    QPointer<QIODevice> guardedOutput(pOutput);
+
+    if (!guardedSource || !guardedOutput || (nStreamOffset < 0) || (nStreamSize < 0)) {
+        return false;
+    }
+
+    XBinary::DATAPROCESS_STATE state = {};
+    state.pDeviceInput = guardedSource.data();
+    state.pDeviceOutput = guardedOutput.data();
+    state.nInputOffset = nStreamOffset;
+    state.nInputLimit = nStreamSize;
+    state.nProcessedOffset = 0;
+    state.nProcessedLimit = -1;
+    state.mapProperties.insert(XBinary::FPART_PROP_HANDLEMETHOD, method);
+    state.mapUnpackProperties = mapUnpackProperties;
+
+    XDecompress decompress;
+    const bool bDecoded = decompress.multiDecompress(&state, pPdStruct);
+
+    return guardedSource && guardedOutput && bDecoded && !state.bReadError && !state.bWriteError && XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+void XForwardDecoder::setData(QIODevice *pSource, qint64 nStreamOffset, qint64 nStreamSize, XBinary::HANDLE_METHOD method,
+                              const QMap<XBinary::UNPACK_PROP, QVariant> &mapUnpackProperties)
+{
+    if ((m_pSource == pSource) && (m_nStreamOffset == nStreamOffset) && (m_nStreamSize == nStreamSize) && (m_method == method) &&
+        (m_mapUnpackProperties == mapUnpackProperties)) {
+        return;
+    }
+
+    reset();
+
+    m_pSource = pSource;
+    m_nStreamOffset = nStreamOffset;
+    m_nStreamSize = nStreamSize;
+    m_method = method;
+    m_mapUnpackProperties = mapUnpackProperties;
+}
+
+bool XForwardDecoder::read(qint64 nOffset, qint64 nSize, QIODevice *pOutput, XBinary::PDSTRUCT *pPdStruct)
+{
+    QPointer<QIODevice> guardedOutput(pOutput);
+
+    if (!m_pSource || !guardedOutput || (nOffset < 0) || (nSize < 0) || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return false;
+    }
+
+    // Going backwards needs a fresh codec.
+    if (nOffset < m_nCursor) {
+        reset();
+    }
+
+    if (!m_pWorker && !_start()) {
+        reset();
+        return false;
+    }
+
+    qint64 nSkip = nOffset - m_nCursor;
+    qint64 nRemaining = nSize;
+
+    while ((nSkip > 0) || (nRemaining > 0)) {
+        if (m_nPendingPosition >= m_baPending.size()) {
+            if (!_pull(pPdStruct)) {
+                // Truncated stream, codec error or cancellation; the codec may
+                // still be running, so stop it before the caller goes on.
+                reset();
+                return false;
+            }
+        }
+
+        const qint64 nAvailable = m_baPending.size() - m_nPendingPosition;
+
+        if (nSkip > 0) {
+            const qint64 nPart = qMin(nSkip, nAvailable);
+            m_nPendingPosition += (qint32)nPart;
+            m_nCursor += nPart;
+            nSkip -= nPart;
+        } else {
+            const qint64 nPart = qMin(nRemaining, nAvailable);
+            const qint64 nWritten = guardedOutput->write(m_baPending.constData() + m_nPendingPosition, nPart);
+
+            if (!guardedOutput || (nWritten != nPart)) {
+                return false;
+            }
+
+            m_nPendingPosition += (qint32)nPart;
+            m_nCursor += nPart;
+            nRemaining -= nPart;
+        }
+    }
+
+    return XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+bool XForwardDecoder::finish(XBinary::PDSTRUCT *pPdStruct)
+{
+    if (!m_pWorker) {
+        return true;  // Nothing was decoded since the last reset
+    }
+
+    // The decoded tail is discarded; only the codec's verdict matters.
+    while (_pull(pPdStruct)) {
+        m_nCursor += m_baPending.size();
+    }
+
+    bool bResult = false;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        bResult = m_bFinished && m_bDecoded;
+    }
+
+    reset();
+
+    return bResult && XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+void XForwardDecoder::reset()
+{
+    if (m_pWorker) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_bAbort = true;
+            m_condition.wakeAll();
+        }
+
+        // The codec stops at its next write; until then it may still be
+        // reading, so the source is not handed back before it has exited.
+        m_pWorker->wait();
+        delete m_pWorker;
+        m_pWorker = nullptr;
+    }
+
+    m_nCursor = 0;
+    m_baPending.clear();
+    m_nPendingPosition = 0;
+    m_baChunk.clear();
+    m_bRequested = false;
+    m_bAbort = false;
+    m_bFinished = false;
+    m_bDecoded = false;
+}
+
+bool XForwardDecoder::_start()
+{
+    if (!m_pSource || (m_nStreamOffset < 0) || (m_nStreamSize < 0)) {
+        return false;
+    }
+
+    m_pWorker = new (std::nothrow) Worker(this);
+
+    if (!m_pWorker || !m_pWorker->open()) {
+        delete m_pWorker;
+        m_pWorker = nullptr;
+        return false;
+    }
+
+    m_pWorker->start();
+
+    return true;
+}
+
+bool XForwardDecoder::_pull(XBinary::PDSTRUCT *pPdStruct)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_bRequested = true;
+    m_condition.wakeAll();
+
+    while (m_baChunk.isEmpty() && !m_bFinished) {
+        m_condition.wait(&m_mutex, N_FORWARDDECODER_POLL_MS);
+
+        if (!XBinary::isPdStructNotCanceled(pPdStruct)) {
+            return false;
+        }
+    }
+
+    if (m_baChunk.isEmpty()) {
+        // End of the stream before the requested range
+        return false;
+    }
+
+    m_baPending = m_baChunk;
+    m_baChunk.clear();
+    m_nPendingPosition = 0;
+
+    return true;
+}
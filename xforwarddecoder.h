@@ -0,0 +1,86 @@
+/* Copyright (c) 2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef XFORWARDDECODER_H
+#define XFORWARDDECODER_H
+
+#include "xdecompress.h"
+
+#include <QMutex>
+#include <QPointer>
+#include <QWaitCondition>
+
+// The decoded form of one compressed stream, read front to back by offset.
+// The codec runs on a worker thread that advances only while read() waits for
+// it, so the source is never read concurrently with the caller.  Reading the
+// members of a stream in order costs one decode in total; only a read behind
+// the cursor starts the codec again.
+class XForwardDecoder {
+public:
+    XForwardDecoder();
+    ~XForwardDecoder();
+
+    // Decodes a whole stream into pOutput in one pass; the codec's result,
+    // read and write errors included.  The header scans that list a stream's
+    // members use it, as does the worker behind read().
+    static bool decodeStream(QIODevice *pSource, qint64 nStreamOffset, qint64 nStreamSize, XBinary::HANDLE_METHOD method,
+                             const QMap<XBinary::UNPACK_PROP, QVariant> &mapUnpackProperties, QIODevice *pOutput,
+                             XBinary::PDSTRUCT *pPdStruct);
+
+    // A call with the same stream keeps the decoder and its cursor.
+    void setData(QIODevice *pSource, qint64 nStreamOffset, qint64 nStreamSize, XBinary::HANDLE_METHOD method,
+                 const QMap<XBinary::UNPACK_PROP, QVariant> &mapUnpackProperties);
+    // Copies [nOffset, nOffset + nSize) of the decoded stream to pOutput.
+    bool read(qint64 nOffset, qint64 nSize, QIODevice *pOutput, XBinary::PDSTRUCT *pPdStruct);
+    // Decodes the rest of the stream and reports whether the codec ended it
+    // cleanly, trailer and checksum included.  A read() that stops short of
+    // the end cannot see a corrupt tail; this can.
+    bool finish(XBinary::PDSTRUCT *pPdStruct);
+    void reset();
+
+private:
+    class Pipe;
+    class Worker;
+
+    bool _start();
+    bool _pull(XBinary::PDSTRUCT *pPdStruct);
+
+    QPointer<QIODevice> m_pSource;
+    qint64 m_nStreamOffset;
+    qint64 m_nStreamSize;
+    XBinary::HANDLE_METHOD m_method;
+    QMap<XBinary::UNPACK_PROP, QVariant> m_mapUnpackProperties;
+
+    Worker *m_pWorker;
+    qint64 m_nCursor;           // Decoded offset of m_baPending[m_nPendingPosition]
+    QByteArray m_baPending;     // Last chunk taken from the worker
+    qint32 m_nPendingPosition;  // First byte of m_baPending not yet consumed
+
+    // Shared with the worker thread
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QByteArray m_baChunk;  // Handed over by the worker, taken by _pull()
+    bool m_bRequested;     // The caller waits for the next chunk
+    bool m_bAbort;
+    bool m_bFinished;
+    bool m_bDecoded;  // The codec reached the end of the stream without an error
+};
+
+#endif  // XFORWARDDECODER_H
@@ -21,7 +21,16 @@
 #include "xiso9660.h"
 #include "Algos/xstoredecoder.h"
 
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+#include <memory>
 #include <new>
+#include <zlib.h>
 
 XBinary::XCONVERT _TABLE_XISO9660_STRUCTID[] = {{XISO9660::STRUCTID_UNKNOWN, "Unknown", QObject::tr("Unknown")},
                                                 {XISO9660::STRUCTID_PVDESC, "PVDESC", QString("Primary Volume Descriptor")},
@@ -493,6 +502,127 @@ QList<XBinary::FPART> XISO9660::getFileParts(quint32 nFileParts, qint32 nLimit,
     return listResult;
 }
 
+namespace {
+const qint64 ISO9660_DESCRIPTOR_OFFSET = 0x8000;
+const qint64 ISO9660_DESCRIPTOR_SIZE = 0x800;
+const qint32 ISO9660_MAX_DESCRIPTORS = 64;
+const qint64 ISO9660_DIRECTORY_WINDOW = 0x10000;  // Multiple of every allowed logical block size
+const qint32 ISO9660_MAX_CONTINUATIONS = 16;
+const qint32 ISO9660_ZISOFS_BLOCKS_PER_THREAD = 4;
+const uchar ISO9660_ZISOFS_MAGIC[8] = {0x37, 0xE4, 0x53, 0x96, 0xC9, 0xDB, 0xD6, 0x07};
+
+bool isoIsJolietEscape(const uchar *pEscape)
+{
+    return (pEscape[0] == '%') && (pEscape[1] == '/') && ((pEscape[2] == '@') || (pEscape[2] == 'C') || (pEscape[2] == 'E'));
+}
+
+// Start of the system use area of a directory record: the identifier is padded to an even length.
+qint32 isoGetSystemUseOffset(quint8 nFileNameLength)
+{
+    return 33 + nFileNameLength + ((nFileNameLength & 1) ? 0 : 1);
+}
+
+QString isoDecodeJolietName(const uchar *pName, qint32 nLength)
+{
+    QString sResult;
+    sResult.reserve(nLength / 2);
+
+    for (qint32 i = 0; i + 1 < nLength; i += 2) {
+        sResult.append(QChar(qFromBigEndian<quint16>(pName + i)));
+    }
+
+    return sResult;
+}
+
+struct ISO9660_ZISOFS_JOB {
+    const char *pInput;
+    qint64 nInputSize;
+    qint64 nOutputSize;
+    QByteArray baOutput;
+    bool bValid;
+};
+
+// Each zisofs block is an independent zlib stream; an empty block is a hole.
+void isoDecodeZisofsBlock(ISO9660_ZISOFS_JOB *pJob)
+{
+    pJob->bValid = false;
+    pJob->baOutput.resize((qint32)pJob->nOutputSize);
+    if (pJob->baOutput.size() != pJob->nOutputSize) return;
+
+    if (pJob->nInputSize == 0) {
+        pJob->baOutput.fill(0);
+        pJob->bValid = true;
+        return;
+    }
+
+    // Block sizes are at most 2^17, so one inflate() call covers the block.
+    z_stream stream = {};
+    if (inflateInit(&stream) != Z_OK) return;
+
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(pJob->pInput));
+    stream.avail_in = (uInt)pJob->nInputSize;
+    stream.next_out = reinterpret_cast<Bytef *>(pJob->baOutput.data());
+    stream.avail_out = (uInt)pJob->nOutputSize;
+
+    const int nResult = inflate(&stream, Z_FINISH);
+    pJob->bValid = (nResult == Z_STREAM_END) && (stream.total_out == (uLong)pJob->nOutputSize);
+    inflateEnd(&stream);
+}
+
+void isoRunZisofsJobs(ISO9660_ZISOFS_JOB *pJobs, qint32 nNumberOfJobs, QAtomicInt *pNextJob, XBinary::PDSTRUCT *pPdStruct)
+{
+    while (true) {
+        const qint32 nIndex = pNextJob->fetchAndAddOrdered(1);
+
+        if (nIndex >= nNumberOfJobs) {
+            break;
+        }
+
+        if (XBinary::isPdStructStopped(pPdStruct)) {
+            continue;
+        }
+
+        isoDecodeZisofsBlock(&(pJobs[nIndex]));
+    }
+}
+
+class IsoZisofsBlockWorker : public QRunnable {
+public:
+    IsoZisofsBlockWorker(ISO9660_ZISOFS_JOB *pJobs, qint32 nNumberOfJobs, QAtomicInt *pNextJob, XBinary::PDSTRUCT *pPdStruct)
+        : m_pJobs(pJobs), m_nNumberOfJobs(nNumberOfJobs), m_pNextJob(pNextJob), m_pPdStruct(pPdStruct)
+    {
+    }
+
+    void run() override
+    {
+        isoRunZisofsJobs(m_pJobs, m_nNumberOfJobs, m_pNextJob, m_pPdStruct);
+    }
+
+private:
+    ISO9660_ZISOFS_JOB *m_pJobs;
+    qint32 m_nNumberOfJobs;
+    QAtomicInt *m_pNextJob;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
+bool isoWriteAll(QIODevice *pDevice, const char *pData, qint64 nSize)
+{
+    QPointer<QIODevice> guardedDevice(pDevice);
+    qint64 nWritten = 0;
+
+    while (nWritten < nSize) {
+        if (!guardedDevice) return false;
+        const qint64 nResult = guardedDevice->write(pData + nWritten, nSize - nWritten);
+        if (!guardedDevice || (nResult <= 0) || (nResult > (nSize - nWritten))) {
+            return false;
+        }
+        nWritten += nResult;
+    }
+
+    return true;
+}
+}  // namespace
+
 QString XISO9660::_cleanFileName(const QString &sFileName)
 {
     QString sResult = sFileName;
@@ -506,127 +636,333 @@ QString XISO9660::_cleanFileName(const QString &sFileName)
     return sResult;
 }
 
-QList<XBinary::ARCHIVERECORD> XISO9660::_parseDirectoryEntries(qint64 nOffset, qint64 nSize, qint32 nBlockSize, const QString &sParentPath, PDSTRUCT *pPdStruct)
+bool XISO9660::_getScanContext(ISO9660_SCAN_CONTEXT *pScanContext, PDSTRUCT *pPdStruct)
+{
+    QPointer<XISO9660> guardedThis(this);
+
+    if (!pScanContext) {
+        return false;
+    }
+    *pScanContext = ISO9660_SCAN_CONTEXT();
+    pScanContext->nRootDirOffset = -1;
+
+    const qint64 nTotalSize = getSize();
+    const qint32 nBlockSize = _getLogicalBlockSize();
+    if (!guardedThis || (nBlockSize < 512) || (nBlockSize > 8192)) {
+        return false;
+    }
+    pScanContext->nLogicalBlockSize = nBlockSize;
+
+    // Walk the descriptor set once, a whole descriptor per read.
+    qint64 nJolietOffset = -1;
+    qint64 nJolietSize = 0;
+
+    for (qint32 i = 0; (i < ISO9660_MAX_DESCRIPTORS) && isPdStructNotCanceled(pPdStruct); i++) {
+        const QByteArray baDescriptor = read_array(ISO9660_DESCRIPTOR_OFFSET + i * ISO9660_DESCRIPTOR_SIZE, ISO9660_DESCRIPTOR_SIZE);
+        if (!guardedThis || (baDescriptor.size() != ISO9660_DESCRIPTOR_SIZE) || (memcmp(baDescriptor.constData() + 1, "CD001", 5) != 0)) {
+            break;
+        }
+
+        const uchar *pDescriptor = reinterpret_cast<const uchar *>(baDescriptor.constData());
+        const quint8 nType = pDescriptor[0];
+
+        if (nType == 255) {
+            break;
+        }
+
+        // The root directory record sits at offset 156 of both the primary and supplementary descriptors.
+        const qint64 nRootOffset = (qint64)qFromLittleEndian<quint32>(pDescriptor + 158) * nBlockSize;
+        const qint64 nRootSize = (qint64)qFromLittleEndian<quint32>(pDescriptor + 166);
+
+        if ((nType == 1) && (pScanContext->nRootDirOffset == -1)) {
+            pScanContext->nRootDirOffset = nRootOffset;
+            pScanContext->nRootDirSize = nRootSize;
+        } else if ((nType == 2) && (nJolietOffset == -1) && isoIsJolietEscape(pDescriptor + 88) && (nRootOffset > 0) && (nRootSize > 0) &&
+                   (nRootOffset < nTotalSize)) {
+            nJolietOffset = nRootOffset;
+            nJolietSize = nRootSize;
+        }
+    }
+
+    if ((pScanContext->nRootDirOffset <= 0) || (pScanContext->nRootDirSize <= 0) || (pScanContext->nRootDirOffset >= nTotalSize)) {
+        return false;
+    }
+
+    // Rock Ridge announces itself with an SP entry in the "." record of the primary root.
+    const QByteArray baRoot = read_array(pScanContext->nRootDirOffset, nBlockSize);
+    if (!guardedThis) return false;
+    const uchar *pRoot = reinterpret_cast<const uchar *>(baRoot.constData());
+
+    if ((baRoot.size() >= 34) && (pRoot[0] >= 34) && (pRoot[0] <= baRoot.size())) {
+        const qint32 nSystemUse = isoGetSystemUseOffset(pRoot[32]);
+        if ((nSystemUse + 7 <= pRoot[0]) && (pRoot[nSystemUse] == 'S') && (pRoot[nSystemUse + 1] == 'P') && (pRoot[nSystemUse + 2] >= 7) &&
+            (pRoot[nSystemUse + 4] == 0xBE) && (pRoot[nSystemUse + 5] == 0xEF)) {
+            pScanContext->bRockRidge = true;
+            pScanContext->nSuspSkip = pRoot[nSystemUse + 6];
+        }
+    }
+
+    // Rock Ridge names are the richer ones (case, length, links); Joliet is the fallback.
+    if (!pScanContext->bRockRidge && (nJolietOffset != -1)) {
+        pScanContext->bJoliet = true;
+        pScanContext->nRootDirOffset = nJolietOffset;
+        pScanContext->nRootDirSize = nJolietSize;
+    }
+
+    return isPdStructNotCanceled(pPdStruct);
+}
+
+XISO9660::ISO9660_ROCKRIDGE XISO9660::_parseSystemUse(const char *pData, qint32 nSize, const ISO9660_SCAN_CONTEXT &scanContext, PDSTRUCT *pPdStruct)
+{
+    QPointer<XISO9660> guardedThis(this);
+    ISO9660_ROCKRIDGE result = {};
+    result.nChildLocation = -1;
+    result.nZisofsSize = -1;
+
+    QByteArray baArea = QByteArray::fromRawData(pData, nSize);
+    QByteArray baName;
+    QByteArray baLink;
+    bool bLinkContinue = false;
+    qint32 nPosition = scanContext.nSuspSkip;
+
+    for (qint32 nArea = 0; nArea <= ISO9660_MAX_CONTINUATIONS; nArea++) {
+        const uchar *pArea = reinterpret_cast<const uchar *>(baArea.constData());
+        const qint32 nAreaSize = baArea.size();
+        qint64 nContinuationOffset = -1;
+        qint64 nContinuationSize = 0;
+
+        while (nPosition + 4 <= nAreaSize) {
+            const uchar *pEntry = pArea + nPosition;
+            const qint32 nLength = pEntry[2];
+
+            if ((nLength < 4) || (nPosition + nLength > nAreaSize) || ((pEntry[0] == 'S') && (pEntry[1] == 'T'))) {
+                break;
+            }
+
+            if ((pEntry[0] == 'C') && (pEntry[1] == 'E') && (nLength >= 28)) {
+                nContinuationOffset = (qint64)qFromLittleEndian<quint32>(pEntry + 4) * scanContext.nLogicalBlockSize + qFromLittleEndian<quint32>(pEntry + 12);
+                nContinuationSize = qFromLittleEndian<quint32>(pEntry + 20);
+            } else if ((pEntry[0] == 'N') && (pEntry[1] == 'M') && (nLength >= 5)) {
+                // CURRENT/PARENT flagged names belong to "." and "..", which are never listed.
+                if (!(pEntry[4] & 0x06)) {
+                    baName.append(reinterpret_cast<const char *>(pEntry + 5), nLength - 5);
+                    result.bHasName = true;
+                }
+            } else if ((pEntry[0] == 'P') && (pEntry[1] == 'X') && (nLength >= 36)) {
+                result.nMode = qFromLittleEndian<quint32>(pEntry + 4);
+                result.bHasMode = true;
+            } else if ((pEntry[0] == 'S') && (pEntry[1] == 'L') && (nLength >= 5)) {
+                qint32 nComponent = 5;
+
+                while (nComponent + 2 <= nLength) {
+                    const quint8 nFlags = pEntry[nComponent];
+                    const qint32 nComponentLength = pEntry[nComponent + 1];
+                    if (nComponent + 2 + nComponentLength > nLength) break;
+
+                    if (!baLink.isEmpty() && !bLinkContinue && !baLink.endsWith('/')) {
+                        baLink.append('/');
+                    }
+
+                    if (nFlags & 0x02) {
+                        baLink.append('.');
+                    } else if (nFlags & 0x04) {
+                        baLink.append("..");
+                    } else if (nFlags & 0x08) {
+                        baLink.append('/');
+                    } else {
+                        baLink.append(reinterpret_cast<const char *>(pEntry + nComponent + 2), nComponentLength);
+                    }
+
+                    bLinkContinue = (nFlags & 0x01);
+                    nComponent += 2 + nComponentLength;
+                }
+            } else if ((pEntry[0] == 'C') && (pEntry[1] == 'L') && (nLength >= 12)) {
+                result.nChildLocation = (qint64)qFromLittleEndian<quint32>(pEntry + 4) * scanContext.nLogicalBlockSize;
+            } else if ((pEntry[0] == 'R') && (pEntry[1] == 'E')) {
+                result.bRelocated = true;
+            } else if ((pEntry[0] == 'Z') && (pEntry[1] == 'F') && (nLength >= 16) && (pEntry[4] == 'p') && (pEntry[5] == 'z')) {
+                result.nZisofsSize = qFromLittleEndian<quint32>(pEntry + 8);
+            }
+
+            nPosition += nLength;
+        }
+
+        if ((nContinuationOffset < 0) || (nContinuationSize <= 0) || (nContinuationSize > scanContext.nLogicalBlockSize) ||
+            !isPdStructNotCanceled(pPdStruct)) {
+            break;
+        }
+
+        baArea = read_array(nContinuationOffset, nContinuationSize);
+        if (!guardedThis) return ISO9660_ROCKRIDGE();
+        nPosition = 0;
+    }
+
+    if (result.bHasName) {
+        result.sName = QString::fromUtf8(baName);
+    }
+
+    result.sLinkName = QString::fromUtf8(baLink);
+
+    return result;
+}
+
+QList<XBinary::ARCHIVERECORD> XISO9660::_parseDirectoryEntries(qint64 nOffset, qint64 nSize, const ISO9660_SCAN_CONTEXT &scanContext, const QString &sParentPath,
+                                                               PDSTRUCT *pPdStruct)
 {
     QPointer<XISO9660> guardedThis(this);
     QList<ARCHIVERECORD> listResult;
 
-    qint64 nFileSize = getSize();
+    const qint32 nBlockSize = scanContext.nLogicalBlockSize;
+    const qint64 nFileSize = getSize();
+    if (!guardedThis) return listResult;
     qint64 nEndOffset = nOffset + nSize;
 
     if (nEndOffset > nFileSize) {
         nEndOffset = nFileSize;
     }
 
-    qint64 nCurrentOffset = nOffset;
+    // The extent is read in whole logical blocks and decoded in memory.  Records
+    // never cross a block boundary; a zero length byte pads to the next block.
+    for (qint64 nWindowOffset = nOffset; (nWindowOffset < nEndOffset) && isPdStructNotCanceled(pPdStruct); nWindowOffset += ISO9660_DIRECTORY_WINDOW) {
+        const qint64 nWindowSize = qMin(ISO9660_DIRECTORY_WINDOW, nEndOffset - nWindowOffset);
+        const QByteArray baWindow = read_array(nWindowOffset, nWindowSize);
+        if (!guardedThis) return QList<ARCHIVERECORD>();
+        if (baWindow.size() != nWindowSize) {
+            break;
+        }
 
-    while ((nCurrentOffset < nEndOffset) && isPdStructNotCanceled(pPdStruct)) {
-        // Align to logical block boundaries for padding detection
-        qint64 nBlockStart = nCurrentOffset;
-        qint64 nNextBlockStart = ((nBlockStart / nBlockSize) + 1) * (qint64)nBlockSize;
-        qint64 nBlockEnd = qMin(nNextBlockStart, nEndOffset);
+        const uchar *pWindow = reinterpret_cast<const uchar *>(baWindow.constData());
 
-        while (nCurrentOffset < nBlockEnd && isPdStructNotCanceled(pPdStruct)) {
-            quint8 nRecordLength = guardedThis->read_uint8(nCurrentOffset);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
+        for (qint32 nBlock = 0; (nBlock < nWindowSize) && isPdStructNotCanceled(pPdStruct); nBlock += nBlockSize) {
+            const qint32 nBlockEnd = (qint32)qMin<qint64>(nBlock + nBlockSize, nWindowSize);
+            qint32 nCurrent = nBlock;
 
-            if (nRecordLength == 0) {
-                // Zero-padding to next logical block
-                nCurrentOffset = nBlockEnd;
-                break;
-            }
+            while (nCurrent < nBlockEnd) {
+                const uchar *pRecord = pWindow + nCurrent;
+                const qint32 nRecordLength = pRecord[0];
 
-            if (nRecordLength < 34 || nCurrentOffset + nRecordLength > nBlockEnd) {
-                nCurrentOffset = nBlockEnd;
-                break;
-            }
+                if ((nRecordLength < 34) || (nCurrent + nRecordLength > nBlockEnd)) {
+                    break;
+                }
 
-            quint8 nExtAttrLength = guardedThis->read_uint8(nCurrentOffset + 1);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint32 nExtentLocation = guardedThis->read_uint32(nCurrentOffset + 2);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint32 nDataLength = guardedThis->read_uint32(nCurrentOffset + 10);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint8 nFileFlags = guardedThis->read_uint8(nCurrentOffset + 25);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint8 nFileNameLength = guardedThis->read_uint8(nCurrentOffset + 32);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-
-            QString sFileName;
-
-            if (nFileNameLength > 0 && nCurrentOffset + 33 + nFileNameLength <= nBlockEnd) {
-                QByteArray baFileName = guardedThis->read_array(nCurrentOffset + 33, nFileNameLength);
-                if (!guardedThis) return QList<ARCHIVERECORD>();
-                sFileName = QString::fromLatin1(baFileName);
-            }
+                const quint8 nExtAttrLength = pRecord[1];
+                const quint32 nExtentLocation = qFromLittleEndian<quint32>(pRecord + 2);
+                const quint32 nDataLength = qFromLittleEndian<quint32>(pRecord + 10);
+                const quint8 nFileFlags = pRecord[25];
+                const quint8 nFileNameLength = pRecord[32];
 
-            // Skip "." (0x00) and ".." (0x01) entries
-            if (nFileNameLength == 1 && (sFileName == "\x00" || sFileName == "\x01")) {
-                nCurrentOffset += nRecordLength;
-                continue;
-            }
+                nCurrent += nRecordLength;
 
-            ARCHIVERECORD record = {};
-            record.nStreamOffset = (qint64)nExtentLocation * nBlockSize + (qint64)nExtAttrLength * nBlockSize;
-            record.nStreamSize = nDataLength;
+                // Skip "." (0x00) and ".." (0x01) entries
+                if ((nFileNameLength == 0) || (33 + nFileNameLength > nRecordLength) || ((nFileNameLength == 1) && (pRecord[33] <= 1))) {
+                    continue;
+                }
 
-            QString sCleanName = guardedThis->_cleanFileName(sFileName);
-            QString sFullPath;
+                QString sFileName;
 
-            if (sParentPath.isEmpty()) {
-                sFullPath = sCleanName;
-            } else {
-                sFullPath = sParentPath + "/" + sCleanName;
-            }
+                if (scanContext.bJoliet) {
+                    sFileName = isoDecodeJolietName(pRecord + 33, nFileNameLength);
+                } else {
+                    sFileName = QString::fromLatin1(reinterpret_cast<const char *>(pRecord + 33), nFileNameLength);
+                }
 
-            bool bIsFolder = (nFileFlags & 0x02) != 0;
+                ISO9660_ROCKRIDGE rockRidge = {};
+                rockRidge.nChildLocation = -1;
+                rockRidge.nZisofsSize = -1;
+
+                if (scanContext.bRockRidge) {
+                    const qint32 nSystemUse = isoGetSystemUseOffset(nFileNameLength);
+                    if (nSystemUse < nRecordLength) {
+                        rockRidge = guardedThis->_parseSystemUse(reinterpret_cast<const char *>(pRecord + nSystemUse), nRecordLength - nSystemUse,
+                                                                 scanContext, pPdStruct);
+                        if (!guardedThis) return QList<ARCHIVERECORD>();
+                    }
+                }
 
-            record.mapProperties[FPART_PROP_ORIGINALNAME] = sFullPath;
-            record.mapProperties[FPART_PROP_UNCOMPRESSEDSIZE] = (qint64)nDataLength;
-            record.mapProperties[FPART_PROP_COMPRESSEDSIZE] = (qint64)nDataLength;
-            record.mapProperties[FPART_PROP_HANDLEMETHOD] = HANDLE_METHOD_STORE;
-            record.mapProperties[FPART_PROP_ISFOLDER] = bIsFolder;
+                if (rockRidge.bRelocated) {
+                    continue;
+                }
 
-            if (bIsFolder) {
-                record.mapProperties[FPART_PROP_STREAMOFFSET] = (qint64)nExtentLocation * nBlockSize;
-                record.mapProperties[FPART_PROP_STREAMSIZE] = (qint64)nDataLength;
-            }
+                ARCHIVERECORD record = {};
+                record.nStreamOffset = (qint64)nExtentLocation * nBlockSize + (qint64)nExtAttrLength * nBlockSize;
+                record.nStreamSize = nDataLength;
+
+                const QString sCleanName = rockRidge.bHasName ? rockRidge.sName : guardedThis->_cleanFileName(sFileName);
+                QString sFullPath;
 
-            // Read recording date/time from directory record
-            quint8 nYear = guardedThis->read_uint8(nCurrentOffset + 18);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint8 nMonth = guardedThis->read_uint8(nCurrentOffset + 19);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint8 nDay = guardedThis->read_uint8(nCurrentOffset + 20);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint8 nHour = guardedThis->read_uint8(nCurrentOffset + 21);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint8 nMinute = guardedThis->read_uint8(nCurrentOffset + 22);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-            quint8 nSecond = guardedThis->read_uint8(nCurrentOffset + 23);
-            if (!guardedThis) return QList<ARCHIVERECORD>();
-
-            if (nYear > 0 && nMonth >= 1 && nMonth <= 12 && nDay >= 1 && nDay <= 31) {
-                QDateTime dt(QDate(1900 + nYear, nMonth, nDay), QTime(nHour, nMinute, nSecond));
-
-                if (dt.isValid()) {
-                    record.mapProperties[FPART_PROP_MTIME] = dt;
+                if (sParentPath.isEmpty()) {
+                    sFullPath = sCleanName;
+                } else {
+                    sFullPath = sParentPath + "/" + sCleanName;
                 }
-            }
 
-            listResult.append(record);
-            nCurrentOffset += nRecordLength;
+                const bool bIsFolder = ((nFileFlags & 0x02) != 0) || (rockRidge.nChildLocation != -1);
+
+                record.mapProperties[FPART_PROP_ORIGINALNAME] = sFullPath;
+                record.mapProperties[FPART_PROP_UNCOMPRESSEDSIZE] = (qint64)nDataLength;
+                record.mapProperties[FPART_PROP_COMPRESSEDSIZE] = (qint64)nDataLength;
+                record.mapProperties[FPART_PROP_HANDLEMETHOD] = HANDLE_METHOD_STORE;
+                record.mapProperties[FPART_PROP_ISFOLDER] = bIsFolder;
+
+                if (rockRidge.bHasMode) {
+                    record.mapProperties[FPART_PROP_FILEMODE] = rockRidge.nMode;
+                }
+
+                if (!rockRidge.sLinkName.isEmpty()) {
+                    record.mapProperties[FPART_PROP_LINKNAME] = rockRidge.sLinkName;
+                }
+
+                if (rockRidge.nChildLocation != -1) {
+                    // A relocated directory: its size is in the "." record of the target extent.
+                    const QByteArray baChild = read_array(rockRidge.nChildLocation, 34);
+                    if (!guardedThis) return QList<ARCHIVERECORD>();
+                    const qint64 nChildSize =
+                        (baChild.size() == 34) ? (qint64)qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(baChild.constData()) + 10) : 0;
+
+                    record.nStreamOffset = rockRidge.nChildLocation;
+                    record.nStreamSize = nChildSize;
+                    record.mapProperties[FPART_PROP_STREAMOFFSET] = rockRidge.nChildLocation;
+                    record.mapProperties[FPART_PROP_STREAMSIZE] = nChildSize;
+                } else if (bIsFolder) {
+                    record.mapProperties[FPART_PROP_STREAMOFFSET] = (qint64)nExtentLocation * nBlockSize;
+                    record.mapProperties[FPART_PROP_STREAMSIZE] = (qint64)nDataLength;
+                } else if (rockRidge.nZisofsSize != -1) {
+                    record.mapProperties[FPART_PROP_UNCOMPRESSEDSIZE] = rockRidge.nZisofsSize;
+                    record.mapProperties[FPART_PROP_TYPE] = QString("zisofs");
+                    record.mapProperties.remove(FPART_PROP_HANDLEMETHOD);
+                }
+
+                // Recording date/time from the directory record
+                const quint8 nYear = pRecord[18];
+                const quint8 nMonth = pRecord[19];
+                const quint8 nDay = pRecord[20];
+                const quint8 nHour = pRecord[21];
+                const quint8 nMinute = pRecord[22];
+                const quint8 nSecond = pRecord[23];
+
+                if (nYear > 0 && nMonth >= 1 && nMonth <= 12 && nDay >= 1 && nDay <= 31) {
+                    QDateTime dt(QDate(1900 + nYear, nMonth, nDay), QTime(nHour, nMinute, nSecond));
+
+                    if (dt.isValid()) {
+                        record.mapProperties[FPART_PROP_MTIME] = dt;
+                    }
+                }
+
+                listResult.append(record);
+            }
         }
     }
 
     return listResult;
 }
 
-QList<XBinary::ARCHIVERECORD> XISO9660::_collectAllRecords(qint64 nRootOffset, qint64 nRootSize, qint32 nBlockSize, PDSTRUCT *pPdStruct)
+QList<XBinary::ARCHIVERECORD> XISO9660::_collectAllRecords(const ISO9660_SCAN_CONTEXT &scanContext, PDSTRUCT *pPdStruct)
 {
     QPointer<XISO9660> guardedThis(this);
     QList<ARCHIVERECORD> listResult;
 
+    const qint32 nBlockSize = scanContext.nLogicalBlockSize;
+
     // BFS: queue of (dirOffset, dirSize, parentPath)
     struct DirEntry {
         qint64 nOffset;
@@ -638,18 +974,18 @@ QList<XBinary::ARCHIVERECORD> XISO9660::_collectAllRecords(qint64 nRootOffset, q
     QSet<qint64> setProcessedBlocks;
 
     DirEntry rootEntry;
-    rootEntry.nOffset = nRootOffset;
-    rootEntry.nSize = nRootSize;
+    rootEntry.nOffset = scanContext.nRootDirOffset;
+    rootEntry.nSize = scanContext.nRootDirSize;
     rootEntry.sPath = QString();
 
     listDirQueue.append(rootEntry);
-    setProcessedBlocks.insert(nRootOffset / nBlockSize);
+    setProcessedBlocks.insert(scanContext.nRootDirOffset / nBlockSize);
 
     while (!listDirQueue.isEmpty() && isPdStructNotCanceled(pPdStruct)) {
         DirEntry dirInfo = listDirQueue.takeFirst();
 
         QList<ARCHIVERECORD> listDirRecords = guardedThis->_parseDirectoryEntries(
-            dirInfo.nOffset, dirInfo.nSize, nBlockSize, dirInfo.sPath,
+            dirInfo.nOffset, dirInfo.nSize, scanContext, dirInfo.sPath,
             pPdStruct);
         if (!guardedThis) return QList<ARCHIVERECORD>();
 
@@ -686,6 +1022,11 @@ QMap<XBinary::UNPACK_PROP, QVariant> XISO9660::getDefaultUnpackProperties()
     return result;
 }
 
+bool XISO9660::isParallelUnpackSupported()
+{
+    return true;
+}
+
 bool XISO9660::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
 {
     QPointer<XISO9660> guardedThis(this);
@@ -715,50 +1056,23 @@ bool XISO9660::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant
     if (!guardedThis || !bBound) return false;
 
     const qint64 nTotalSize = guardedThis->getSize();
-    const qint32 nLogicalBlockSize = guardedThis->_getLogicalBlockSize();
     if (!guardedThis) return false;
 
-    if (nLogicalBlockSize < 512 || nLogicalBlockSize > 8192) {
-        guardedThis->releaseUnpackSource(pState);
-        *pState = UNPACK_STATE();
-        return false;
-    }
-
-    // Read root directory record from PVD at offset 156
-    qint64 nRootRecordOffset = 0x8000 + 156;
-
-    if (nRootRecordOffset + 34 > nTotalSize) {
-        guardedThis->releaseUnpackSource(pState);
-        *pState = UNPACK_STATE();
-        return false;
-    }
-
-    quint8 nRootRecordLength = guardedThis->read_uint8(nRootRecordOffset);
+    // Root directory of the preferred tree: Rock Ridge primary, then Joliet, then plain ISO 9660
+    ISO9660_SCAN_CONTEXT scanContext = {};
+    const bool bScanContext = guardedThis->_getScanContext(&scanContext, pPdStruct);
     if (!guardedThis) return false;
 
-    if (nRootRecordLength < 34) {
+    if (!bScanContext) {
         guardedThis->releaseUnpackSource(pState);
         *pState = UNPACK_STATE();
         return false;
     }
 
-    quint32 nRootExtentLocation = guardedThis->read_uint32(nRootRecordOffset + 2);
-    if (!guardedThis) return false;
-    quint32 nRootDataLength = guardedThis->read_uint32(nRootRecordOffset + 10);
-    if (!guardedThis) return false;
-
-    qint64 nRootOffset = (qint64)nRootExtentLocation * nLogicalBlockSize;
-    qint64 nRootSize = (qint64)nRootDataLength;
-
-    if (nRootOffset <= 0 || nRootSize <= 0 || nRootOffset >= nTotalSize) {
-        guardedThis->releaseUnpackSource(pState);
-        *pState = UNPACK_STATE();
-        return false;
-    }
+    const qint32 nLogicalBlockSize = scanContext.nLogicalBlockSize;
 
     // Build flat list of all records via BFS traversal
-    QList<ARCHIVERECORD> listAllRecords = guardedThis->_collectAllRecords(
-        nRootOffset, nRootSize, nLogicalBlockSize, pPdStruct);
+    QList<ARCHIVERECORD> listAllRecords = guardedThis->_collectAllRecords(scanContext, pPdStruct);
     if (!guardedThis) return false;
 
     if (!isPdStructNotCanceled(pPdStruct)) {
@@ -813,11 +1127,156 @@ XBinary::ARCHIVERECORD XISO9660::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPd
 
     if (pState->nCurrentIndex >= 0 && pState->nCurrentIndex < pContext->listAllRecords.count()) {
         record = pContext->listAllRecords.at(pState->nCurrentIndex);
+
+        // zisofs data is not a plain extent; it is decompressed by unpackCurrent().
+        if ((record.mapProperties.value(FPART_PROP_TYPE).toString() == QLatin1String("zisofs")) &&
+            !XBinary::markArchiveStreamRecord(&record, pState->nCurrentIndex)) {
+            return ARCHIVERECORD();
+        }
     }
 
     return record;
 }
 
+bool XISO9660::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct)
+{
+    QPointer<XISO9660> guardedThis(this);
+    QPointer<QIODevice> guardedOutput(pDevice);
+
+    if (!pState || !pState->pContext || !guardedOutput || (pState->nCurrentIndex < 0) || (pState->nCurrentIndex >= pState->nNumberOfRecords)) {
+        return false;
+    }
+    const bool bSourceCurrent = guardedThis->isUnpackSourceCurrent(pState, pPdStruct);
+    if (!guardedThis || !bSourceCurrent) return false;
+
+    ISO9660_UNPACK_CONTEXT *pContext = (ISO9660_UNPACK_CONTEXT *)pState->pContext;
+    if (pState->nCurrentIndex >= pContext->listAllRecords.count()) return false;
+
+    const ARCHIVERECORD record = pContext->listAllRecords.at(pState->nCurrentIndex);
+
+    if (record.mapProperties.value(FPART_PROP_TYPE).toString() != QLatin1String("zisofs")) {
+        return guardedThis->XArchive::unpackCurrent(pState, guardedOutput.data(), pPdStruct);
+    }
+
+    UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress);
+    if (!operationGuard.isAcquired()) return false;
+
+    const bool bOutputSupported = guardedThis->isUnpackOutputSupported(guardedOutput.data());
+    if (!guardedThis || !guardedOutput || !bOutputSupported) return false;
+    const bool bAliases = XBinary::devicesAlias(guardedThis->getDevice(), guardedOutput.data());
+    if (!guardedThis || !guardedOutput || bAliases) return false;
+
+    const qint64 nUncompressedSize = record.mapProperties.value(FPART_PROP_UNCOMPRESSEDSIZE).toLongLong();
+    qint32 nNumberOfThreads = pState->mapUnpackProperties.value(UNPACK_PROP_THREADS, 0).toInt();
+    if (nNumberOfThreads <= 0) {
+        nNumberOfThreads = QThread::idealThreadCount();
+    }
+    nNumberOfThreads = qBound(1, nNumberOfThreads, 64);
+
+    std::unique_ptr<QIODevice> pStage(XBinary::createFileBuffer(nUncompressedSize, pPdStruct));
+    if (!guardedThis || !pStage || !guardedOutput) return false;
+
+    const bool bDecoded =
+        guardedThis->_unpackZisofs(record.nStreamOffset, record.nStreamSize, nUncompressedSize, pStage.get(), nNumberOfThreads, pPdStruct);
+    if (!guardedThis || !bDecoded || !guardedOutput) return false;
+
+    const bool bFinalSourceCurrent = guardedThis->isUnpackSourceCurrent(pState, pPdStruct);
+    if (!guardedThis || !bFinalSourceCurrent || !guardedOutput) return false;
+    const bool bPublished = guardedThis->publishUnpackOutput(pStage.get(), guardedOutput.data(), pState, pPdStruct);
+    return guardedThis && bPublished;
+}
+
+bool XISO9660::_unpackZisofs(qint64 nOffset, qint64 nSize, qint64 nUncompressedSize, QIODevice *pDevice, qint32 nNumberOfThreads, PDSTRUCT *pPdStruct)
+{
+    QPointer<XISO9660> guardedThis(this);
+
+    if (!pDevice || (nSize < 16) || (nUncompressedSize < 0) || !isPdStructNotCanceled(pPdStruct)) {
+        return (nSize == 0) && (nUncompressedSize == 0);
+    }
+
+    // Header: magic, uncompressed size, header size / 4, log2 of the block size
+    const QByteArray baHeader = read_array(nOffset, 16);
+    if (!guardedThis || (baHeader.size() != 16)) return false;
+    const uchar *pHeader = reinterpret_cast<const uchar *>(baHeader.constData());
+    const qint64 nHeaderSize = (qint64)pHeader[12] * 4;
+    const quint8 nBlockLog2 = pHeader[13];
+
+    if ((memcmp(pHeader, ISO9660_ZISOFS_MAGIC, sizeof(ISO9660_ZISOFS_MAGIC)) != 0) || (qFromLittleEndian<quint32>(pHeader + 8) != nUncompressedSize) ||
+        (nHeaderSize < 16) || (nBlockLog2 < 15) || (nBlockLog2 > 17)) {
+        return false;
+    }
+
+    const qint64 nBlockSize = (qint64)1 << nBlockLog2;
+    const qint64 nNumberOfBlocks = (nUncompressedSize + nBlockSize - 1) / nBlockSize;
+    const qint64 nTableSize = (nNumberOfBlocks + 1) * 4;
+    if (nHeaderSize + nTableSize > nSize) {
+        return false;
+    }
+
+    // Block pointers are offsets from the start of the file data
+    const QByteArray baTable = read_array(nOffset + nHeaderSize, nTableSize);
+    if (!guardedThis || (baTable.size() != nTableSize)) return false;
+    const uchar *pTable = reinterpret_cast<const uchar *>(baTable.constData());
+
+    QVector<qint64> vecPointers((qint32)nNumberOfBlocks + 1);
+    for (qint32 i = 0; i <= nNumberOfBlocks; i++) {
+        vecPointers[i] = qFromLittleEndian<quint32>(pTable + i * 4);
+        if ((vecPointers.at(i) > nSize) || ((i == 0) && (vecPointers.at(0) < nHeaderSize + nTableSize)) ||
+            ((i > 0) && (vecPointers.at(i) < vecPointers.at(i - 1)))) {
+            return false;
+        }
+    }
+
+    // Batches are read with one source read and inflated by a pool of workers.
+    const qint32 nBatchSize = nNumberOfThreads * ISO9660_ZISOFS_BLOCKS_PER_THREAD;
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, nNumberOfThreads - 1));
+
+    for (qint32 nFirst = 0; nFirst < nNumberOfBlocks; nFirst += nBatchSize) {
+        if (!isPdStructNotCanceled(pPdStruct)) return false;
+
+        const qint32 nLast = (qint32)qMin<qint64>(nFirst + nBatchSize, nNumberOfBlocks);
+        const QByteArray baInput = read_array(nOffset + vecPointers.at(nFirst), vecPointers.at(nLast) - vecPointers.at(nFirst));
+        if (!guardedThis || (baInput.size() != vecPointers.at(nLast) - vecPointers.at(nFirst))) return false;
+
+        const qint32 nNumberOfJobs = nLast - nFirst;
+        QVector<ISO9660_ZISOFS_JOB> vecJobs(nNumberOfJobs);
+
+        for (qint32 i = 0; i < nNumberOfJobs; i++) {
+            const qint32 nBlock = nFirst + i;
+            ISO9660_ZISOFS_JOB &job = vecJobs[i];
+            job.pInput = baInput.constData() + (vecPointers.at(nBlock) - vecPointers.at(nFirst));
+            job.nInputSize = vecPointers.at(nBlock + 1) - vecPointers.at(nBlock);
+            job.nOutputSize = qMin(nBlockSize, nUncompressedSize - (qint64)nBlock * nBlockSize);
+            job.bValid = false;
+        }
+
+        {
+            QAtomicInt nNextJob(0);
+            ISO9660_ZISOFS_JOB *pJobs = vecJobs.data();
+            const qint32 nNumberOfWorkers = qMin(nNumberOfThreads, nNumberOfJobs) - 1;
+
+            for (qint32 i = 0; i < nNumberOfWorkers; i++) {
+                threadPool.start(new IsoZisofsBlockWorker(pJobs, nNumberOfJobs, &nNextJob, pPdStruct));
+            }
+
+            isoRunZisofsJobs(pJobs, nNumberOfJobs, &nNextJob, pPdStruct);
+
+            threadPool.waitForDone();
+        }
+
+        for (qint32 i = 0; i < nNumberOfJobs; i++) {
+            const ISO9660_ZISOFS_JOB &job = vecJobs.at(i);
+
+            if (!job.bValid || !isoWriteAll(pDevice, job.baOutput.constData(), job.baOutput.size())) {
+                return false;
+            }
+        }
+    }
+
+    return isPdStructNotCanceled(pPdStruct);
+}
+
 bool XISO9660::moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
 {
     QPointer<XISO9660> guardedThis(this);
@@ -129,8 +129,10 @@ public:
     virtual QList<FPART> getFileParts(quint32 nFileParts, qint32 nLimit = -1, PDSTRUCT *pPdStruct = nullptr) override;
 
     virtual QMap<UNPACK_PROP, QVariant> getDefaultUnpackProperties() override;
+    virtual bool isParallelUnpackSupported() override;
     virtual bool initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr) override;
     virtual ARCHIVERECORD infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
+    virtual bool unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool finishUnpack(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
 
@@ -155,6 +157,20 @@ private:
         qint32 nLogicalBlockSize;
         qint64 nRootDirOffset;
         qint64 nRootDirSize;
+        bool bJoliet;       // Tree of a Joliet supplementary descriptor (UCS-2BE names)
+        bool bRockRidge;    // Rock Ridge names, modes and zisofs entries are present
+        qint32 nSuspSkip;   // SUSP bytes to skip in each system use area (SP entry)
+    };
+
+    struct ISO9660_ROCKRIDGE {
+        QString sName;
+        QString sLinkName;
+        quint32 nMode;
+        qint64 nChildLocation;    // CL: relocated directory extent, -1 if none
+        qint64 nZisofsSize;       // ZF: uncompressed size, -1 if none
+        bool bHasName;
+        bool bHasMode;
+        bool bRelocated;          // RE: listed again through the CL entry
     };
 
     struct ISO9660_UNPACK_CONTEXT {
@@ -165,8 +181,12 @@ private:
     qint32 _getLogicalBlockSize();
     qint64 _getPrimaryVolumeDescriptorOffset();
     bool _isValidDescriptor(qint64 nOffset, PDSTRUCT *pPdStruct);
-    QList<ARCHIVERECORD> _collectAllRecords(qint64 nRootOffset, qint64 nRootSize, qint32 nBlockSize, PDSTRUCT *pPdStruct);
-    QList<ARCHIVERECORD> _parseDirectoryEntries(qint64 nOffset, qint64 nSize, qint32 nBlockSize, const QString &sParentPath, PDSTRUCT *pPdStruct);
+    bool _getScanContext(ISO9660_SCAN_CONTEXT *pScanContext, PDSTRUCT *pPdStruct);
+    QList<ARCHIVERECORD> _collectAllRecords(const ISO9660_SCAN_CONTEXT &scanContext, PDSTRUCT *pPdStruct);
+    QList<ARCHIVERECORD> _parseDirectoryEntries(qint64 nOffset, qint64 nSize, const ISO9660_SCAN_CONTEXT &scanContext, const QString &sParentPath,
+                                                PDSTRUCT *pPdStruct);
+    ISO9660_ROCKRIDGE _parseSystemUse(const char *pData, qint32 nSize, const ISO9660_SCAN_CONTEXT &scanContext, PDSTRUCT *pPdStruct);
+    bool _unpackZisofs(qint64 nOffset, qint64 nSize, qint64 nUncompressedSize, QIODevice *pDevice, qint32 nNumberOfThreads, PDSTRUCT *pPdStruct);
     QString _cleanFileName(const QString &sFileName);
 
     QString m_sSystemIdentifier;
@@ -20,9 +20,12 @@
  */
 #include "xrpm.h"
 
+#include <cstring>
+#include <limits>
 #include <new>
 #include "subdevice.h"
 #include "xcpio.h"
+#include "xdecompress.h"
 #include "xgzip.h"
 
 static XBinary::XCONVERT _TABLE_XRPM_STRUCTID[] = {{XRPM::STRUCTID_UNKNOWN, "Unknown", QObject::tr("Unknown")},
@@ -62,8 +65,254 @@ bool hasCpioMagic(XBinary *pBinary, qint64 nOffset, qint64 nSize)
            ((((quint8)baMagic.at(0) == 0xC7) && ((quint8)baMagic.at(1) == 0x71)) ||
             (((quint8)baMagic.at(0) == 0x71) && ((quint8)baMagic.at(1) == 0xC7)));
 }
+
+// Same bounds XCPIO applies to a stored archive.
+const qint32 N_RPM_CPIO_MAX_ENTRIES = 0x100000;
+const qint64 N_RPM_CPIO_MAX_NAMESIZE = 0x10000;
+const qint64 N_RPM_CPIO_MAGIC_SIZE = 6;
+const quint32 N_RPM_CPIO_MODE_IFMT = 0170000;
+const quint32 N_RPM_CPIO_MODE_IFDIR = 0040000;
 }  // namespace
 
+// Write-only sink that parses a newc/crc/odc cpio stream as the payload
+// decoder produces it.  Only the current header and name are buffered; member
+// data is counted (and summed for the 070702 checksum) but never stored.  The
+// header fields are decoded by XCPIO.
+class XRPM::CpioScanDevice : public QIODevice {
+public:
+    CpioScanDevice()
+        : m_nConsumed(0),
+          m_nStage(0),
+          m_nPendingNeeded(N_RPM_CPIO_MAGIC_SIZE),
+          m_nEntryOffset(0),
+          m_nHeaderSize(0),
+          m_format(XCPIO::CPIO_FORMAT_UNKNOWN),
+          m_bCRC(false),
+          m_nExpectedCheck(0),
+          m_nCheckSum(0),
+          m_nDataStart(0),
+          m_nDataEnd(0),
+          m_nNextHeader(0),
+          m_bTrailerFound(false),
+          m_bFailed(false)
+    {
+        m_currentEntry = {};
+    }
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_nConsumed; }
+    bool seek(qint64 nPosition) override { return (nPosition == pos()) && QIODevice::seek(nPosition); }
+
+    bool isTrailerFound() const { return m_bTrailerFound; }
+    bool isFailed() const { return m_bFailed; }
+    QList<RPM_CPIO_ENTRY> takeEntries()
+    {
+        QList<RPM_CPIO_ENTRY> listResult;
+        listResult.swap(m_listEntries);
+        return listResult;
+    }
+
+protected:
+    qint64 readData(char *pData, qint64 nMaxSize) override
+    {
+        Q_UNUSED(pData)
+        Q_UNUSED(nMaxSize)
+
+        return -1;
+    }
+
+    qint64 writeData(const char *pData, qint64 nMaxSize) override
+    {
+        if (m_bFailed || (nMaxSize < 0) || ((nMaxSize > 0) && !pData)) {
+            m_bFailed = true;
+            return -1;
+        }
+
+        qint64 nOffset = 0;
+
+        while ((nOffset < nMaxSize) && !m_bFailed) {
+            if (m_bTrailerFound) {
+                // Block padding after the trailer.
+                m_nConsumed += nMaxSize - nOffset;
+                nOffset = nMaxSize;
+            } else if (m_nConsumed < m_nNextHeader) {
+                const qint64 nSkip = qMin(nMaxSize - nOffset, m_nNextHeader - m_nConsumed);
+
+                if (m_bCRC) {
+                    const qint64 nSumStart = qMax(m_nConsumed, m_nDataStart);
+                    const qint64 nSumEnd = qMin(m_nConsumed + nSkip, m_nDataEnd);
+
+                    for (qint64 i = nSumStart; i < nSumEnd; i++) {
+                        m_nCheckSum += (quint8)pData[nOffset + (i - m_nConsumed)];
+                    }
+                }
+
+                nOffset += nSkip;
+                m_nConsumed += nSkip;
+
+                if ((m_nConsumed == m_nNextHeader) && m_bCRC && (m_nCheckSum != m_nExpectedCheck)) {
+                    m_bFailed = true;
+                }
+            } else {
+                const qint64 nTake = qMin(nMaxSize - nOffset, m_nPendingNeeded - (qint64)m_baPending.size());
+                m_baPending.append(pData + nOffset, (qint32)nTake);
+                nOffset += nTake;
+                m_nConsumed += nTake;
+
+                if ((m_baPending.size() == m_nPendingNeeded) && !_parsePending()) {
+                    m_bFailed = true;
+                }
+            }
+        }
+
+        return m_bFailed ? -1 : nMaxSize;
+    }
+
+private:
+    bool _isNewc() const
+    {
+        return (m_format == XCPIO::CPIO_FORMAT_NEWC) || (m_format == XCPIO::CPIO_FORMAT_CRC);
+    }
+
+    bool _parsePending()
+    {
+        const char *pHeader = m_baPending.constData();
+
+        if (m_nStage == 0) {
+            m_format = XCPIO::_detectFormat(pHeader, N_RPM_CPIO_MAGIC_SIZE);
+            m_bCRC = (m_format == XCPIO::CPIO_FORMAT_CRC);
+
+            if (_isNewc()) {
+                m_nHeaderSize = sizeof(XCPIO::CPIO_NEWC_HEADER);
+            } else if (m_format == XCPIO::CPIO_FORMAT_ODC) {
+                m_nHeaderSize = sizeof(XCPIO::CPIO_ODC_HEADER);
+            } else {
+                return false;
+            }
+
+            m_nStage = 1;
+            m_nPendingNeeded = m_nHeaderSize;
+        } else if (m_nStage == 1) {
+            qint64 nNameSize = 0;
+            qint64 nDataSize = 0;
+            m_currentEntry = {};
+
+            if (_isNewc()) {
+                XCPIO::CPIO_NEWC_HEADER header = {};
+                memcpy(&header, pHeader, sizeof(XCPIO::CPIO_NEWC_HEADER));
+
+                const char *pFields[] = {header.ino,       header.mode,      header.uid,      header.gid,   header.nlink,
+                                         header.mtime,     header.filesize,  header.devmajor, header.devminor,
+                                         header.rdevmajor, header.rdevminor, header.namesize, header.check};
+                for (qint32 i = 0; i < (qint32)(sizeof(pFields) / sizeof(pFields[0])); i++) {
+                    if (XCPIO::_readHexValue(pFields[i], 8) < 0) {
+                        return false;
+                    }
+                }
+
+                m_currentEntry.nMode = (quint32)XCPIO::_readHexValue(header.mode, 8);
+                m_currentEntry.nUID = (quint32)XCPIO::_readHexValue(header.uid, 8);
+                m_currentEntry.nGID = (quint32)XCPIO::_readHexValue(header.gid, 8);
+                m_currentEntry.nMTime = (quint64)XCPIO::_readHexValue(header.mtime, 8);
+                nDataSize = XCPIO::_readHexValue(header.filesize, 8);
+                nNameSize = XCPIO::_readHexValue(header.namesize, 8);
+                m_nExpectedCheck = (quint32)XCPIO::_readHexValue(header.check, 8);
+            } else {
+                XCPIO::CPIO_ODC_HEADER header = {};
+                memcpy(&header, pHeader, sizeof(XCPIO::CPIO_ODC_HEADER));
+
+                if ((XCPIO::_readOctValue(header.dev, 6) < 0) || (XCPIO::_readOctValue(header.ino, 6) < 0) ||
+                    (XCPIO::_readOctValue(header.mode, 6) < 0) || (XCPIO::_readOctValue(header.uid, 6) < 0) ||
+                    (XCPIO::_readOctValue(header.gid, 6) < 0) || (XCPIO::_readOctValue(header.nlink, 6) < 0) ||
+                    (XCPIO::_readOctValue(header.rdev, 6) < 0) || (XCPIO::_readOctValue(header.mtime, 11) < 0) ||
+                    (XCPIO::_readOctValue(header.namesize, 6) < 0) || (XCPIO::_readOctValue(header.filesize, 11) < 0)) {
+                    return false;
+                }
+
+                m_currentEntry.nMode = (quint32)XCPIO::_readOctValue(header.mode, 6);
+                m_currentEntry.nUID = (quint32)XCPIO::_readOctValue(header.uid, 6);
+                m_currentEntry.nGID = (quint32)XCPIO::_readOctValue(header.gid, 6);
+                m_currentEntry.nMTime = (quint64)XCPIO::_readOctValue(header.mtime, 11);
+                nNameSize = XCPIO::_readOctValue(header.namesize, 6);
+                nDataSize = XCPIO::_readOctValue(header.filesize, 11);
+            }
+
+            if ((nNameSize <= 0) || (nNameSize > N_RPM_CPIO_MAX_NAMESIZE) || (nDataSize < 0)) {
+                return false;
+            }
+
+            m_currentEntry.nDataSize = nDataSize;
+            m_nStage = 2;
+            m_nPendingNeeded = m_nHeaderSize + nNameSize;
+        } else {
+            QByteArray baName = m_baPending.mid((qint32)m_nHeaderSize);
+
+            if (baName.isEmpty() || (baName.back() != '\0')) {
+                return false;
+            }
+
+            baName.chop(1);
+            if (baName.contains('\0')) {
+                return false;
+            }
+
+            const qint64 nMax = (std::numeric_limits<qint64>::max)();
+            const qint64 nNameEnd = m_nEntryOffset + m_baPending.size();
+            m_nDataStart = _isNewc() ? ((nNameEnd + 3) & ~((qint64)3)) : nNameEnd;
+            if ((m_currentEntry.nDataSize > (nMax - 3 - m_nDataStart))) {
+                return false;
+            }
+            m_nDataEnd = m_nDataStart + m_currentEntry.nDataSize;
+            m_nNextHeader = _isNewc() ? ((m_nDataEnd + 3) & ~((qint64)3)) : m_nDataEnd;
+            m_nCheckSum = 0;
+            if (m_bCRC && (m_nNextHeader == nNameEnd) && (m_nExpectedCheck != 0)) {
+                return false;
+            }
+
+            m_currentEntry.sFileName = QString::fromLatin1(baName.constData(), baName.size());
+            m_currentEntry.nDataOffset = m_nDataStart;
+            m_currentEntry.bIsFolder = ((m_currentEntry.nMode & N_RPM_CPIO_MODE_IFMT) == N_RPM_CPIO_MODE_IFDIR) ||
+                                       m_currentEntry.sFileName.endsWith(QLatin1Char('/'));
+
+            if (m_currentEntry.sFileName == QLatin1String("TRAILER!!!")) {
+                m_bTrailerFound = true;
+                m_bCRC = false;
+            } else {
+                if (m_listEntries.count() >= N_RPM_CPIO_MAX_ENTRIES) {
+                    return false;
+                }
+
+                m_listEntries.append(m_currentEntry);
+            }
+
+            m_baPending.clear();
+            m_nStage = 0;
+            m_nPendingNeeded = N_RPM_CPIO_MAGIC_SIZE;
+            m_nEntryOffset = m_nNextHeader;
+        }
+
+        return true;
+    }
+
+    qint64 m_nConsumed;
+    QByteArray m_baPending;
+    qint32 m_nStage;  // 0 magic, 1 fixed header, 2 name
+    qint64 m_nPendingNeeded;
+    qint64 m_nEntryOffset;
+    qint64 m_nHeaderSize;
+    XCPIO::CPIO_FORMAT m_format;
+    bool m_bCRC;
+    quint32 m_nExpectedCheck;
+    quint32 m_nCheckSum;
+    qint64 m_nDataStart;
+    qint64 m_nDataEnd;
+    qint64 m_nNextHeader;
+    RPM_CPIO_ENTRY m_currentEntry;
+    QList<RPM_CPIO_ENTRY> m_listEntries;
+    bool m_bTrailerFound;
+    bool m_bFailed;
+};
+
 XRPM::XRPM(QIODevice *pDevice) : XArchive(pDevice)
 {
 }
@@ -724,9 +973,26 @@ bool XRPM::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &m
     }
     pContext->sFileName = sBaseName + ".cpio";
 
+    // Walk the cpio stream once to list its members.  A payload that cannot be
+    // walked keeps the single "<name>.cpio" record.
+    const bool bScanned = guardedArchive->_scanPayloadEntries(pContext, pPdStruct);
+    if (!guardedArchive) {
+        delete pContext;
+        return false;
+    }
+    if (!XBinary::isPdStructNotCanceled(pPdStruct)) {
+        guardedArchive->releaseUnpackSource(pState);
+        delete pContext;
+        *pState = UNPACK_STATE();
+        return false;
+    }
+    if (!bScanned) {
+        pContext->listEntries.clear();
+    }
+
     pState->pContext = pContext;
     pState->nCurrentIndex = 0;
-    pState->nNumberOfRecords = 1;
+    pState->nNumberOfRecords = pContext->listEntries.isEmpty() ? 1 : pContext->listEntries.count();
     pState->nCurrentOffset = pContext->nPayloadOffset;
     pState->nTotalSize = nFileSize;
     pState->mapUnpackProperties = mapProperties;
@@ -768,6 +1034,36 @@ XBinary::ARCHIVERECORD XRPM::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStru
         return ARCHIVERECORD();
     }
 
+    if (!pContext->listEntries.isEmpty()) {
+        if (pState->nCurrentIndex >= pContext->listEntries.count()) {
+            return ARCHIVERECORD();
+        }
+
+        // A member has no extent of its own on the compressed device; it is
+        // published as an index-paired archive stream and extracted through
+        // unpackCurrent().
+        const RPM_CPIO_ENTRY &entry = pContext->listEntries.at(pState->nCurrentIndex);
+        result.mapProperties.insert(FPART_PROP_ORIGINALNAME, entry.sFileName);
+        result.mapProperties.insert(FPART_PROP_UNCOMPRESSEDSIZE, entry.nDataSize);
+        result.mapProperties.insert(FPART_PROP_FILEMODE, entry.nMode);
+        result.mapProperties.insert(FPART_PROP_UID, entry.nUID);
+        result.mapProperties.insert(FPART_PROP_GID, entry.nGID);
+        result.mapProperties.insert(FPART_PROP_ISFOLDER, entry.bIsFolder);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+        result.mapProperties.insert(FPART_PROP_DATETIME, QDateTime::fromSecsSinceEpoch((qint64)entry.nMTime));
+#else
+        result.mapProperties.insert(FPART_PROP_DATETIME, QDateTime::fromMSecsSinceEpoch((qint64)entry.nMTime * 1000));
+#endif
+        result.mapProperties.insert(FPART_PROP_INFO,
+                                    QString("%1 (rpm payload stream)").arg(XBinary::handleMethodToString(pContext->compressMethod)));
+
+        if (!XBinary::markArchiveStreamRecord(&result, pState->nCurrentIndex)) {
+            return ARCHIVERECORD();
+        }
+
+        return result;
+    }
+
     result.nStreamOffset = pContext->nPayloadOffset;
     result.nStreamSize = pContext->nPayloadSize;
     result.mapProperties.insert(FPART_PROP_ORIGINALNAME, pContext->sFileName);
@@ -799,7 +1095,82 @@ bool XRPM::moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
 
     pState->nCurrentIndex++;
 
-    return false;
+    return (pState->nCurrentIndex < pState->nNumberOfRecords);
+}
+
+bool XRPM::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct)
+{
+    QPointer<XRPM> guardedArchive(this);
+    QPointer<QIODevice> guardedOutput(pDevice);
+
+    if (!pState || !pState->pContext || !guardedOutput || !guardedArchive->isUnpackSourceCurrent(pState, pPdStruct) || !guardedArchive ||
+        (pState->nCurrentIndex < 0) || (pState->nCurrentIndex >= pState->nNumberOfRecords)) {
+        return false;
+    }
+
+    RPM_UNPACK_CONTEXT *pContext = (RPM_UNPACK_CONTEXT *)pState->pContext;
+
+    if (pContext->listEntries.isEmpty()) {
+        return guardedArchive->XArchive::unpackCurrent(pState, guardedOutput.data(), pPdStruct);
+    }
+
+    UNPACK_OPERATION_GUARD operationGuard(&m_bUnpackOperationInProgress);
+    if (!operationGuard.isAcquired() || (pState->nCurrentIndex >= pContext->listEntries.count())) return false;
+
+    const bool bAliases = XBinary::devicesAlias(guardedArchive->getDevice(), guardedOutput.data());
+    if (!guardedArchive || !guardedOutput || bAliases) return false;
+
+    const RPM_CPIO_ENTRY entry = pContext->listEntries.at(pState->nCurrentIndex);
+
+    // cpio members carry no CRC of their own, so the member is an output
+    // window over the payload.  The forward decoder keeps its place between
+    // members; only a member behind it decodes the payload from the start.
+    pContext->forwardDecoder.setData(guardedArchive->getDevice(), pContext->nPayloadOffset, pContext->nPayloadSize, pContext->compressMethod,
+                                     pState->mapUnpackProperties);
+
+    bool bResult = true;
+
+    if (entry.nDataSize > 0) {
+        bResult = pContext->forwardDecoder.read(entry.nDataOffset, entry.nDataSize, guardedOutput.data(), pPdStruct);
+    }
+
+    // The payload checksum sits behind the last member; a corrupt stream
+    // fails that member instead of ending the listing early.
+    if (bResult && (pState->nCurrentIndex == (pContext->listEntries.count() - 1))) {
+        bResult = pContext->forwardDecoder.finish(pPdStruct);
+    }
+
+    return guardedArchive && bResult && guardedArchive->isUnpackSourceCurrent(pState, pPdStruct);
+}
+
+bool XRPM::_scanPayloadEntries(RPM_UNPACK_CONTEXT *pContext, PDSTRUCT *pPdStruct)
+{
+    QPointer<XRPM> guardedArchive(this);
+
+    if (!pContext) {
+        return false;
+    }
+
+    CpioScanDevice scanDevice;
+    if (!scanDevice.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        return false;
+    }
+
+    const bool bDecoded = XForwardDecoder::decodeStream(guardedArchive->getDevice(), pContext->nPayloadOffset, pContext->nPayloadSize,
+                                                       pContext->compressMethod, QMap<UNPACK_PROP, QVariant>(), &scanDevice, pPdStruct);
+    scanDevice.close();
+
+    if (!guardedArchive || !bDecoded || scanDevice.isFailed() || !scanDevice.isTrailerFound() || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return false;
+    }
+
+    pContext->listEntries = scanDevice.takeEntries();
+
+    if (pContext->nUncompressedSize < 0) {
+        pContext->nUncompressedSize = scanDevice.size();
+    }
+
+    return true;
 }
 
 bool XRPM::finishUnpack(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
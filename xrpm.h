@@ -22,6 +22,7 @@
 #define XRPM_H
 
 #include "xarchive.h"
+#include "xforwarddecoder.h"
 
 // RPM package (RedHat Package Manager). Layout: 96-byte lead, an optional
 // signature header, the main header, then a compressed cpio payload. Both
@@ -89,6 +90,7 @@ public:
     virtual QMap<UNPACK_PROP, QVariant> getDefaultUnpackProperties() override;
     virtual bool initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr) override;
     virtual ARCHIVERECORD infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
+    virtual bool unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool finishUnpack(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
 
@@ -103,6 +105,18 @@ private:
     qint64 _getMainHeaderOffset();
     QString _readPayloadCompressorTag(qint64 nHeaderOffset);
 
+    // One cpio member, located by its offset in the decoded payload.
+    struct RPM_CPIO_ENTRY {
+        QString sFileName;
+        qint64 nDataOffset;
+        qint64 nDataSize;
+        quint32 nMode;
+        quint32 nUID;
+        quint32 nGID;
+        quint64 nMTime;
+        bool bIsFolder;
+    };
+
     struct RPM_UNPACK_CONTEXT {
         qint64 nPayloadOffset;
         qint64 nPayloadSize;
@@ -111,7 +125,17 @@ private:
         bool bHasCRC32;
         HANDLE_METHOD compressMethod;
         QString sFileName;
+        // Empty when the cpio stream could not be walked; the payload is then
+        // published as the single "<name>.cpio" record.
+        QList<RPM_CPIO_ENTRY> listEntries;
+        // Members are extracted through one decode of the payload.
+        XForwardDecoder forwardDecoder;
     };
+
+    class CpioScanDevice;
+
+    // Decodes the payload once, feeding the cpio header parser directly.
+    bool _scanPayloadEntries(RPM_UNPACK_CONTEXT *pContext, PDSTRUCT *pPdStruct);
 private:
     INTERNAL_INFO m_internalInfo;
 };
@@ -2327,6 +2327,11 @@ QMap<XBinary::UNPACK_PROP, QVariant> XSevenZip::getDefaultUnpackProperties()
     return result;
 }
 
+bool XSevenZip::isParallelUnpackSupported()
+{
+    return true;
+}
+
 bool XSevenZip::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
 {
     QPointer<XSevenZip> guardedArchive(this);
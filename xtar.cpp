@@ -755,6 +755,11 @@ QMap<XBinary::UNPACK_PROP, QVariant> XTAR::getDefaultUnpackProperties()
     return result;
 }
 
+bool XTAR::isParallelUnpackSupported()
+{
+    return true;
+}
+
 bool XTAR::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
 {
     QPointer<XTAR> guardedArchive(this);
@@ -51,6 +51,12 @@ public:
     };
 #pragma pack(pop)
 
+    // Header decoding shared with parsers that walk a tar stream as it is
+    // decoded (the XDEB member scan).
+    static QString _getRecordPath(const posix_header &header);
+    static bool _parseNumber(const char *pData, qint32 nSize, qint64 *pValue);
+    static quint32 calculateChecksum(const posix_header &header);
+
 private:
     enum TAR_FORMAT {
         TAR_FORMAT_DEFAULT = 0,
@@ -95,6 +101,7 @@ public:
 
     // Streaming unpacking API
     virtual QMap<UNPACK_PROP, QVariant> getDefaultUnpackProperties() override;
+    virtual bool isParallelUnpackSupported() override;
     virtual bool initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr) override;
     virtual ARCHIVERECORD infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
@@ -111,15 +118,12 @@ private:
     posix_header read_posix_header(qint64 nOffset);
     qint32 _getNumberOf_posix_headers(qint64 nOffset, PDSTRUCT *pPdStruct);
     qint64 _getSize(const posix_header &header);
-    static QString _getRecordPath(const posix_header &header);
-    static bool _parseNumber(const char *pData, qint32 nSize, qint64 *pValue);
     bool _readRecord(qint64 nOffset, qint64 nTotalSize, posix_header *pHeader,
                      qint64 *pFileSize, qint64 *pRecordSize,
                      bool *pIsZeroBlock, PDSTRUCT *pPdStruct);
     bool _scanArchive(qint64 nOffset, qint64 nTotalSize, qint32 *pNumberOfRecords, qint64 *pEndOffset, PDSTRUCT *pPdStruct);
     static bool createHeader(const QString &sFileName, const QString &sBasePath, qint64 nFileSize, quint32 nMode, qint64 nMTime,
                              posix_header *pHeader);
-    static quint32 calculateChecksum(const posix_header &header);
     static bool writeOctal(char *pDest, qint32 nSize, qint64 nValue);
 
 signals:
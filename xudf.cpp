@@ -22,15 +22,52 @@
 #include "Algos/xstoredecoder.h"
 
 #include <new>
+#include <cstring>
+#include <QFileDevice>
 #include <QPointer>
 
+namespace {
+const qint32 N_UDF_BLOCK_CACHE_BLOCKS = 1024;  // 2 MiB with 2 KiB blocks
+const qint32 N_UDF_BLOCK_CACHE_READAHEAD = 16;
+const qint32 N_UDF_BLOCK_CACHE_MAX_BLOCKSIZE = 0x10000;
+const qint32 N_UDF_MAX_ALLOCATION_DESCRIPTORS = 0x100000;
+const qint64 N_UDF_HOLE_BUFFER_SIZE = 0x10000;
+
+// Emits nSize zero bytes.  A file opened for appending is grown instead, which
+// leaves the range unallocated on file systems with sparse files.
+bool udfWriteHole(QIODevice *pDevice, qint64 nSize, XBinary::PDSTRUCT *pPdStruct)
+{
+    QFileDevice *pFile = qobject_cast<QFileDevice *>(pDevice);
+
+    if (pFile && !pFile->isSequential() && (pFile->pos() == pFile->size())) {
+        const qint64 nEnd = pFile->pos() + nSize;
+        if (pFile->resize(nEnd) && pFile->seek(nEnd)) {
+            return true;
+        }
+    }
+
+    const QByteArray baZeros((qint32)qMin(nSize, N_UDF_HOLE_BUFFER_SIZE), '\0');
+    qint64 nWritten = 0;
+
+    while ((nWritten < nSize) && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        const qint64 nPart = qMin(nSize - nWritten, (qint64)baZeros.size());
+        if (pDevice->write(baZeros.constData(), nPart) != nPart) {
+            return false;
+        }
+        nWritten += nPart;
+    }
+
+    return nWritten == nSize;
+}
+}  // namespace
+
 static XBinary::XCONVERT _TABLE_XUDF_STRUCTID[] = {{XUDF::STRUCTID_UNKNOWN, "Unknown", QObject::tr("Unknown")},
                                                    {XUDF::STRUCTID_TAG, "TAG", QString("Tag")},
                                                    {XUDF::STRUCTID_ANCHOR_VOLUME_DESCRIPTOR, "ANCHOR_VOLUME_DESCRIPTOR", QString("Anchor Volume Descriptor")},
                                                    {XUDF::STRUCTID_PRIMARY_VOLUME_DESCRIPTOR, "PRIMARY_VOLUME_DESCRIPTOR", QString("Primary Volume Descriptor")},
                                                    {XUDF::STRUCTID_FILE_ENTRY, "FILE_ENTRY", QString("File Entry")}};
 
-XUDF::XUDF(QIODevice *pDevice) : XArchive(pDevice)
+XUDF::XUDF(QIODevice *pDevice) : XArchive(pDevice), m_nBlockCacheSize(N_UDF_BLOCK_CACHE_BLOCKS), m_nCacheBlockSize(0)
 {
     QPointer<XUDF> guardedThis(this);
     QPointer<QIODevice> guardedDevice(pDevice);
@@ -536,7 +573,7 @@ bool XUDF::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &m
             return false;
         }
         pContext->nBlockSize = _getBlockSize();
-        pContext->listRecords = _parseFileSystem(pContext->nBlockSize, pPdStruct);
+        pContext->listRecords = _parseFileSystem(pContext->nBlockSize, pPdStruct, &pContext->listExtents);
         if (!guardedThis || !guardedDevice) {
             delete pContext;
             return false;
@@ -572,6 +609,19 @@ XBinary::ARCHIVERECORD XUDF::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStru
         if ((pContext->nCurrentRecordIndex >= 0) && (pContext->nCurrentRecordIndex < pContext->listRecords.count()) &&
             (pContext->nCurrentRecordIndex == pState->nCurrentIndex)) {
             result = pContext->listRecords.at(pContext->nCurrentRecordIndex);
+
+            // Only the first extent is published as the stream; fragmented or
+            // sparse data has to come through unpackCurrent().
+            const QList<UDF_EXTENT> listExtents = pContext->listExtents.value(pContext->nCurrentRecordIndex);
+            bool bStream = (listExtents.count() > 1);
+
+            for (qint32 i = 0; !bStream && (i < listExtents.count()); i++) {
+                bStream = !listExtents.at(i).bRecorded;
+            }
+
+            if (bStream && !XBinary::markArchiveStreamRecord(&result, pState->nCurrentIndex)) {
+                return ARCHIVERECORD();
+            }
         }
     }
 
@@ -592,20 +642,42 @@ bool XUDF::unpackCurrent(UNPACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPd
             ARCHIVERECORD ar = pContext->listRecords.at(pContext->nCurrentRecordIndex);
 
             if (!ar.mapProperties.value(FPART_PROP_ISFOLDER).toBool()) {
-                XBinary::DATAPROCESS_STATE decompressState = {};
-                decompressState.mapProperties.insert(XBinary::FPART_PROP_HANDLEMETHOD, XArchive::HANDLE_METHOD_STORE);
-                decompressState.mapProperties.insert(XBinary::FPART_PROP_UNCOMPRESSEDSIZE, ar.nStreamSize);
-                decompressState.pDeviceInput = guardedSource.data();
-                decompressState.pDeviceOutput = guardedOutput.data();
-                decompressState.nInputOffset = ar.nStreamOffset;
-                decompressState.nInputLimit = ar.nStreamSize;
-                decompressState.nProcessedOffset = 0;
-                decompressState.nProcessedLimit = -1;
-
-                bResult = XStoreDecoder::decompress(&decompressState, pPdStruct);
-                if (!guardedThis || !guardedSource || !guardedOutput) {
-                    return false;
+                // Extents are emitted back to back: recorded runs are copied,
+                // unrecorded runs become holes without touching the source.
+                const QList<UDF_EXTENT> listExtents = pContext->listExtents.value(pContext->nCurrentRecordIndex);
+                qint64 nRemaining = ar.mapProperties.value(FPART_PROP_UNCOMPRESSEDSIZE).toLongLong();
+
+                bResult = true;
+
+                for (qint32 i = 0; bResult && (i < listExtents.count()) && (nRemaining > 0); i++) {
+                    const UDF_EXTENT &extent = listExtents.at(i);
+                    const qint64 nPart = qMin(extent.nSize, nRemaining);
+
+                    if (extent.bRecorded) {
+                        XBinary::DATAPROCESS_STATE decompressState = {};
+                        decompressState.mapProperties.insert(XBinary::FPART_PROP_HANDLEMETHOD, XArchive::HANDLE_METHOD_STORE);
+                        decompressState.mapProperties.insert(XBinary::FPART_PROP_UNCOMPRESSEDSIZE, nPart);
+                        decompressState.pDeviceInput = guardedSource.data();
+                        decompressState.pDeviceOutput = guardedOutput.data();
+                        decompressState.nInputOffset = extent.nOffset;
+                        decompressState.nInputLimit = nPart;
+                        decompressState.nProcessedOffset = 0;
+                        decompressState.nProcessedLimit = -1;
+
+                        bResult = XStoreDecoder::decompress(&decompressState, pPdStruct);
+                    } else {
+                        bResult = udfWriteHole(guardedOutput.data(), nPart, pPdStruct);
+                    }
+
+                    if (!guardedThis || !guardedSource || !guardedOutput) {
+                        return false;
+                    }
+
+                    nRemaining -= nPart;
                 }
+
+                // Information length beyond the allocated extents is a damaged entry.
+                bResult = bResult && (nRemaining == 0) && isPdStructNotCanceled(pPdStruct);
             } else {
                 bResult = true;
             }
@@ -683,6 +755,10 @@ bool XUDF::_readExact(qint64 nOffset, char *pData, qint64 nSize)
         return false;
     }
 
+    if (m_nCacheBlockSize > 0) {
+        return _readCached(nOffset, pData, nSize);
+    }
+
     QPointer<XUDF> guardedThis(this);
     QPointer<QIODevice> guardedDevice(guardedThis ? guardedThis->getDevice() : nullptr);
     if (!guardedThis || !guardedDevice) {
@@ -693,6 +769,123 @@ bool XUDF::_readExact(qint64 nOffset, char *pData, qint64 nSize)
     return guardedThis && guardedDevice && (nRead == nSize);
 }
 
+void XUDF::setBlockCacheSize(qint32 nNumberOfBlocks)
+{
+    m_nBlockCacheSize = qMax(0, nNumberOfBlocks);
+}
+
+void XUDF::_enableBlockCache(qint32 nBlockSize)
+{
+    _disableBlockCache();
+
+    if ((m_nBlockCacheSize > 0) && (nBlockSize > 0) && (nBlockSize <= N_UDF_BLOCK_CACHE_MAX_BLOCKSIZE)) {
+        m_nCacheBlockSize = nBlockSize;
+        m_cacheBlocks.setMaxCost(m_nBlockCacheSize);
+    }
+}
+
+void XUDF::_disableBlockCache()
+{
+    m_nCacheBlockSize = 0;
+    m_cacheBlocks.clear();
+}
+
+bool XUDF::_readCached(qint64 nOffset, char *pData, qint64 nSize)
+{
+    const qint64 nBlockSize = m_nCacheBlockSize;
+    qint64 nCopied = 0;
+
+    while (nCopied < nSize) {
+        const qint64 nPosition = nOffset + nCopied;
+        const qint64 nBlock = nPosition / nBlockSize;
+
+        if (!m_cacheBlocks.contains(nBlock) && !_loadCacheBlocks(nBlock, N_UDF_BLOCK_CACHE_READAHEAD)) {
+            return false;
+        }
+
+        // object() also marks the block as the most recently used one.
+        const QByteArray *pBlock = m_cacheBlocks.object(nBlock);
+        if (!pBlock) {
+            return false;
+        }
+
+        const qint64 nBlockOffset = nPosition - nBlock * nBlockSize;
+        const qint64 nPart = qMin(nSize - nCopied, (qint64)pBlock->size() - nBlockOffset);
+        if (nPart <= 0) {
+            return false;  // past the end of the device
+        }
+
+        memcpy(pData + nCopied, pBlock->constData() + nBlockOffset, (size_t)nPart);
+        nCopied += nPart;
+    }
+
+    return true;
+}
+
+bool XUDF::_loadCacheBlocks(qint64 nFirstBlock, qint32 nNumberOfBlocks)
+{
+    const qint64 nBlockSize = m_nCacheBlockSize;
+    if ((nBlockSize <= 0) || (nFirstBlock < 0)) {
+        return false;
+    }
+
+    QPointer<XUDF> guardedThis(this);
+    QPointer<QIODevice> guardedDevice(getDevice());
+    if (!guardedDevice) {
+        return false;
+    }
+
+    const qint64 nDeviceSize = getSize();
+    const qint64 nStart = nFirstBlock * nBlockSize;
+    if (!guardedThis || !guardedDevice || (nStart >= nDeviceSize)) {
+        return false;
+    }
+
+    // The run stops before the first block that is already cached.
+    nNumberOfBlocks = qBound(1, nNumberOfBlocks, m_nBlockCacheSize);
+    qint32 nCount = 1;
+    while ((nCount < nNumberOfBlocks) && !m_cacheBlocks.contains(nFirstBlock + nCount)) {
+        nCount++;
+    }
+
+    const qint64 nReadSize = qMin((qint64)nCount * nBlockSize, nDeviceSize - nStart);
+    QByteArray baData(nReadSize, Qt::Uninitialized);
+    const qint64 nRead = read_array(nStart, baData.data(), nReadSize);
+    if (!guardedThis || !guardedDevice || (nRead != nReadSize)) {
+        return false;
+    }
+
+    // QCache drops its least recently used blocks to make room for the run.
+    for (qint32 i = 0; (i < nCount) && ((qint64)i * nBlockSize < nReadSize); i++) {
+        QByteArray *pBlock = new (std::nothrow) QByteArray(baData.mid((qint32)(i * nBlockSize), (qint32)nBlockSize));
+        if (!pBlock) {
+            return false;
+        }
+        m_cacheBlocks.insert(nFirstBlock + i, pBlock, 1);
+    }
+
+    return true;
+}
+
+void XUDF::_prefetchCacheBlocks(qint64 nOffset, qint64 nSize)
+{
+    const qint64 nBlockSize = m_nCacheBlockSize;
+    if ((nBlockSize <= 0) || (nOffset < 0) || (nSize <= 0)) {
+        return;
+    }
+
+    // Half the cache at most, so the extent does not push out its own
+    // file entry.
+    const qint64 nFirstBlock = nOffset / nBlockSize;
+    const qint64 nLastBlock = qMin((nOffset + nSize - 1) / nBlockSize, nFirstBlock + qMax(1, m_nBlockCacheSize / 2) - 1);
+
+    for (qint64 nBlock = nFirstBlock; nBlock <= nLastBlock; nBlock++) {
+        if (!m_cacheBlocks.contains(nBlock) && !_loadCacheBlocks(nBlock, (qint32)(nLastBlock - nBlock + 1))) {
+            return;
+        }
+    }
+}
+
 bool XUDF::_readTag(qint64 nOffset, UDF_TAG *pTag)
 {
     if (!pTag) {
@@ -1140,12 +1333,28 @@ bool XUDF::_isValidTag(qint64 nOffset, PDSTRUCT *pPdStruct)
     return (tag.nTagIdentifier > 0 && tag.nTagIdentifier < 300);
 }
 
-QList<XBinary::ARCHIVERECORD> XUDF::_parseFileSystem(qint32 nBlockSize, PDSTRUCT *pPdStruct)
+QList<XBinary::ARCHIVERECORD> XUDF::_parseFileSystem(qint32 nBlockSize, PDSTRUCT *pPdStruct, QList<QList<UDF_EXTENT>> *pListExtents)
 {
     QList<ARCHIVERECORD> listResult;
     QPointer<XUDF> guardedThis(this);
     QPointer<QIODevice> guardedDevice(getDevice());
 
+    // Descriptors, file entries and identifiers are decoded from cached
+    // blocks for the whole walk.
+    struct BlockCacheScope {
+        QPointer<XUDF> pUDF;
+        BlockCacheScope(XUDF *pValue, qint32 nValue) : pUDF(pValue)
+        {
+            pUDF->_enableBlockCache(nValue);
+        }
+        ~BlockCacheScope()
+        {
+            if (pUDF) {
+                pUDF->_disableBlockCache();
+            }
+        }
+    } blockCacheScope(this, nBlockSize);
+
     qint64 nAnchorOffset = _getAnchorVolumeDescriptorOffset();
     if (!guardedThis || !guardedDevice) {
         return listResult;
@@ -1276,12 +1485,17 @@ QList<XBinary::ARCHIVERECORD> XUDF::_parseFileSystem(qint32 nBlockSize, PDSTRUCT
         // + ExtendedAttributeICB(16) + ImplementationIdentifier(32) + UniqueID(8)
         // + LengthOfExtendedAttributes(4) + LengthOfAllocationDescriptors(4)
         // = 16+20+4+4+4+2+1+1+4+8+8+12+12+12+4+16+32+8+4+4 = 176
+        // An Extended File Entry adds ObjectSize(8), CreationTime(12),
+        // Reserved(4) and StreamDirectoryICB(16), so its lengths sit at 208/212
+        // and its allocation descriptors start at 216.
+        const bool bExtended = (feTag.nTagIdentifier == TAG_EXTENDED_FILE_ENTRY);
+        const qint64 nLengthsOffset = bExtended ? 208 : 168;
         quint32 nLenExtAttrs = 0;
-        if (!_readUInt32(dirInfo.nFileEntryOffset + 168, &nLenExtAttrs) || !guardedThis || !guardedDevice) {
+        if (!_readUInt32(dirInfo.nFileEntryOffset + nLengthsOffset, &nLenExtAttrs) || !guardedThis || !guardedDevice) {
             return listResult;
         }
         quint32 nLenAllocDescs = 0;
-        if (!_readUInt32(dirInfo.nFileEntryOffset + 172, &nLenAllocDescs) || !guardedThis || !guardedDevice) {
+        if (!_readUInt32(dirInfo.nFileEntryOffset + nLengthsOffset + 4, &nLenAllocDescs) || !guardedThis || !guardedDevice) {
             return listResult;
         }
         // ICBTag file type is at offset 16+12 = 28 (within ICBTag at offset 16)
@@ -1298,15 +1512,20 @@ QList<XBinary::ARCHIVERECORD> XUDF::_parseFileSystem(qint32 nBlockSize, PDSTRUCT
 
         bool bIsDirectory = (nICBFileType == 4);
 
-        qint64 nAllocDescsOffset = dirInfo.nFileEntryOffset + 176 + (qint64)nLenExtAttrs;
+        qint64 nAllocDescsOffset = dirInfo.nFileEntryOffset + nLengthsOffset + 8 + (qint64)nLenExtAttrs;
 
-        if (!bIsDirectory) {
-            // Regular file - read allocation descriptors to get data location
-            quint64 nInfoLength = 0;
-            if (!_readUInt64(dirInfo.nFileEntryOffset + 56, &nInfoLength) || !guardedThis || !guardedDevice) {
-                return listResult;
-            }
+        quint64 nInfoLength = 0;
+        if (!_readUInt64(dirInfo.nFileEntryOffset + 56, &nInfoLength) || !guardedThis || !guardedDevice) {
+            return listResult;
+        }
+
+        QList<UDF_EXTENT> listExtents;
+        if (!_readAllocationExtents(nAllocDescsOffset, nLenAllocDescs, nAllocType, nBlockSize, &listExtents, pPdStruct) || !guardedThis ||
+            !guardedDevice) {
+            return listResult;
+        }
 
+        if (!bIsDirectory) {
             ARCHIVERECORD record = {};
             record.mapProperties[FPART_PROP_ORIGINALNAME] = dirInfo.sPath;
             record.mapProperties[FPART_PROP_UNCOMPRESSEDSIZE] = (qint64)nInfoLength;
@@ -1314,39 +1533,20 @@ QList<XBinary::ARCHIVERECORD> XUDF::_parseFileSystem(qint32 nBlockSize, PDSTRUCT
             record.mapProperties[FPART_PROP_HANDLEMETHOD] = HANDLE_METHOD_STORE;
             record.mapProperties[FPART_PROP_ISFOLDER] = false;
 
-            if (nAllocType == 0 && nLenAllocDescs >= 8) {
-                // Short allocation descriptor: ExtentLength(4) + ExtentPosition(4)
-                quint32 nExtLength = 0;
-                if (!_readUInt32(nAllocDescsOffset, &nExtLength) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
-                nExtLength &= 0x3FFFFFFF;
-                quint32 nExtPos = 0;
-                if (!_readUInt32(nAllocDescsOffset + 4, &nExtPos) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
-                record.nStreamOffset = (qint64)nExtPos * nBlockSize;
-                record.nStreamSize = (qint64)nExtLength;
-            } else if (nAllocType == 1 && nLenAllocDescs >= 16) {
-                // Long allocation descriptor: ExtentLength(4) + ExtentLocation: LogicalBlockNum(4) + PartRef(2) + ImplUse(6)
-                quint32 nExtLength = 0;
-                if (!_readUInt32(nAllocDescsOffset, &nExtLength) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
-                nExtLength &= 0x3FFFFFFF;
-                quint32 nExtPos = 0;
-                if (!_readUInt32(nAllocDescsOffset + 4, &nExtPos) || !guardedThis || !guardedDevice) {
-                    return listResult;
+            // nStreamOffset/nStreamSize describe the first recorded extent;
+            // the complete list travels with the unpack context.
+            for (const UDF_EXTENT &extent : listExtents) {
+                if (extent.bRecorded) {
+                    record.nStreamOffset = extent.nOffset;
+                    record.nStreamSize = extent.nSize;
+                    break;
                 }
-                record.nStreamOffset = (qint64)nExtPos * nBlockSize;
-                record.nStreamSize = (qint64)nExtLength;
-            } else if (nAllocType == 3 && nLenAllocDescs > 0) {
-                // Data stored directly in allocation descriptors (inline)
-                record.nStreamOffset = nAllocDescsOffset;
-                record.nStreamSize = (qint64)nLenAllocDescs;
             }
 
             listResult.append(record);
+            if (pListExtents) {
+                pListExtents->append(listExtents);
+            }
         } else {
             // Directory - add folder record and enqueue children
             if (!dirInfo.sPath.isEmpty()) {
@@ -1357,134 +1557,127 @@ QList<XBinary::ARCHIVERECORD> XUDF::_parseFileSystem(qint32 nBlockSize, PDSTRUCT
                 record.mapProperties[FPART_PROP_HANDLEMETHOD] = HANDLE_METHOD_STORE;
                 record.mapProperties[FPART_PROP_ISFOLDER] = true;
                 listResult.append(record);
+                if (pListExtents) {
+                    pListExtents->append(QList<UDF_EXTENT>());
+                }
             }
 
-            // Read directory data to find File Identifier Descriptors
-            qint64 nDirDataOffset = -1;
-            qint64 nDirDataSize = 0;
+            // Parse File Identifier Descriptors (tag id 257) extent by extent;
+            // embedded directories are one extent inside the file entry.
+            qint64 nDirRemaining = (qint64)nInfoLength;
 
-            quint64 nInfoLength = 0;
-            if (!_readUInt64(dirInfo.nFileEntryOffset + 56, &nInfoLength) || !guardedThis || !guardedDevice) {
-                return listResult;
-            }
+            for (qint32 i = 0; (i < listExtents.count()) && (nDirRemaining > 0) && isPdStructNotCanceled(pPdStruct); i++) {
+                const UDF_EXTENT &extent = listExtents.at(i);
+                const qint64 nDirDataOffset = extent.nOffset;
+                const qint64 nDirDataSize = qMin(extent.nSize, nDirRemaining);
+                nDirRemaining -= nDirDataSize;
 
-            if (nAllocType == 0 && nLenAllocDescs >= 8) {
-                quint32 nExtPos = 0;
-                if (!_readUInt32(nAllocDescsOffset + 4, &nExtPos) || !guardedThis || !guardedDevice) {
-                    return listResult;
+                if (!extent.bRecorded || nDirDataOffset <= 0 || nDirDataSize <= 0 || nDirDataOffset >= getSize()) {
+                    continue;
                 }
-                nDirDataOffset = (qint64)nExtPos * nBlockSize;
-                nDirDataSize = (qint64)nInfoLength;
-            } else if (nAllocType == 1 && nLenAllocDescs >= 16) {
-                quint32 nExtPos = 0;
-                if (!_readUInt32(nAllocDescsOffset + 4, &nExtPos) || !guardedThis || !guardedDevice) {
+
+                _prefetchCacheBlocks(nDirDataOffset, nDirDataSize);
+                if (!guardedThis || !guardedDevice) {
                     return listResult;
                 }
-                nDirDataOffset = (qint64)nExtPos * nBlockSize;
-                nDirDataSize = (qint64)nInfoLength;
-            }
-
-            if (nDirDataOffset <= 0 || nDirDataSize <= 0 || nDirDataOffset >= getSize()) {
-                continue;
-            }
 
-            // Parse File Identifier Descriptors (tag id 257)
-            qint64 nFIDOffset = nDirDataOffset;
-            qint64 nFIDEnd = nDirDataOffset + nDirDataSize;
+                qint64 nFIDOffset = nDirDataOffset;
+                qint64 nFIDEnd = nDirDataOffset + nDirDataSize;
 
-            while (nFIDOffset < nFIDEnd && isPdStructNotCanceled(pPdStruct)) {
-                if (nFIDOffset + (qint64)sizeof(UDF_TAG) > getSize()) {
-                    break;
-                }
+                while (nFIDOffset < nFIDEnd && isPdStructNotCanceled(pPdStruct)) {
+                    if (nFIDOffset + (qint64)sizeof(UDF_TAG) > getSize()) {
+                        break;
+                    }
 
-                UDF_TAG fidTag = {};
-                if (!_readTag(nFIDOffset, &fidTag) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
+                    UDF_TAG fidTag = {};
+                    if (!_readTag(nFIDOffset, &fidTag) || !guardedThis || !guardedDevice) {
+                        return listResult;
+                    }
 
-                if (fidTag.nTagIdentifier != TAG_FILE_IDENTIFIER_DESCRIPTOR) {
-                    break;
-                }
+                    if (fidTag.nTagIdentifier != TAG_FILE_IDENTIFIER_DESCRIPTOR) {
+                        break;
+                    }
 
-                // File Identifier Descriptor layout:
-                // tag(16) + FileVersionNumber(2) + FileCharacteristics(1) + LengthOfFileIdentifier(1)
-                // + ICB(16) + LengthOfImplementationUse(2) [+ ImplementationUse(var)] [+ FileIdentifier(var)] [+ padding]
-                quint8 nFileCharacteristics = 0;
-                if (!_readUInt8(nFIDOffset + 18, &nFileCharacteristics) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
-                quint8 nLenFileId = 0;
-                if (!_readUInt8(nFIDOffset + 19, &nLenFileId) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
-                quint16 nLenImplUse = 0;
-                if (!_readUInt16(nFIDOffset + 36, &nLenImplUse) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
+                    // File Identifier Descriptor layout:
+                    // tag(16) + FileVersionNumber(2) + FileCharacteristics(1) + LengthOfFileIdentifier(1)
+                    // + ICB(16) + LengthOfImplementationUse(2) [+ ImplementationUse(var)] [+ FileIdentifier(var)] [+ padding]
+                    quint8 nFileCharacteristics = 0;
+                    if (!_readUInt8(nFIDOffset + 18, &nFileCharacteristics) || !guardedThis || !guardedDevice) {
+                        return listResult;
+                    }
+                    quint8 nLenFileId = 0;
+                    if (!_readUInt8(nFIDOffset + 19, &nLenFileId) || !guardedThis || !guardedDevice) {
+                        return listResult;
+                    }
+                    quint16 nLenImplUse = 0;
+                    if (!_readUInt16(nFIDOffset + 36, &nLenImplUse) || !guardedThis || !guardedDevice) {
+                        return listResult;
+                    }
 
-                // ICB (long_ad) of child: ExtentLength(4) + ExtentLocation: LogicalBlockNum(4) + PartRef(2) + ImplUse(6)
-                quint32 nChildICBLocation = 0;
-                if (!_readUInt32(nFIDOffset + 20 + 4, &nChildICBLocation) || !guardedThis || !guardedDevice) {
-                    return listResult;
-                }
+                    // ICB (long_ad) of child: ExtentLength(4) + ExtentLocation: LogicalBlockNum(4) + PartRef(2) + ImplUse(6)
+                    quint32 nChildICBLocation = 0;
+                    if (!_readUInt32(nFIDOffset + 20 + 4, &nChildICBLocation) || !guardedThis || !guardedDevice) {
+                        return listResult;
+                    }
 
-                bool bIsParent = (nFileCharacteristics & 0x08) != 0;  // Parent directory
-                bool bChildIsDir = (nFileCharacteristics & 0x02) != 0;
-                Q_UNUSED(bChildIsDir)
-
-                // Compute name
-                QString sChildName;
-                if (!bIsParent && nLenFileId > 0) {
-                    qint64 nNameOffset = nFIDOffset + 38 + (qint64)nLenImplUse;
-                    if (nNameOffset + nLenFileId <= getSize()) {
-                        QByteArray baName(nLenFileId, Qt::Uninitialized);
-                        if (!_readExact(nNameOffset, baName.data(), nLenFileId) || !guardedThis || !guardedDevice) {
-                            return listResult;
-                        }
-                        // OSTA CS0 encoded: if first byte is 8, rest is ASCII; if 16, UTF-16BE
-                        if (baName.size() > 0) {
-                            quint8 nEncType = (quint8)baName.at(0);
-                            if (nEncType == 16 && baName.size() >= 3) {
-                                for (qint32 j = 1; (j + 1) < baName.size(); j += 2) {
-                                    ushort nChar = ((ushort)(quint8)baName.at(j) << 8) | (ushort)(quint8)baName.at(j + 1);
-                                    sChildName.append(QChar(nChar));
+                    bool bIsParent = (nFileCharacteristics & 0x08) != 0;  // Parent directory
+                    bool bChildIsDir = (nFileCharacteristics & 0x02) != 0;
+                    Q_UNUSED(bChildIsDir)
+
+                    // Compute name
+                    QString sChildName;
+                    if (!bIsParent && nLenFileId > 0) {
+                        qint64 nNameOffset = nFIDOffset + 38 + (qint64)nLenImplUse;
+                        if (nNameOffset + nLenFileId <= getSize()) {
+                            QByteArray baName(nLenFileId, Qt::Uninitialized);
+                            if (!_readExact(nNameOffset, baName.data(), nLenFileId) || !guardedThis || !guardedDevice) {
+                                return listResult;
+                            }
+                            // OSTA CS0 encoded: if first byte is 8, rest is ASCII; if 16, UTF-16BE
+                            if (baName.size() > 0) {
+                                quint8 nEncType = (quint8)baName.at(0);
+                                if (nEncType == 16 && baName.size() >= 3) {
+                                    for (qint32 j = 1; (j + 1) < baName.size(); j += 2) {
+                                        ushort nChar = ((ushort)(quint8)baName.at(j) << 8) | (ushort)(quint8)baName.at(j + 1);
+                                        sChildName.append(QChar(nChar));
+                                    }
+                                } else if (nEncType == 8 && baName.size() >= 2) {
+                                    sChildName = QString::fromLatin1(baName.constData() + 1, baName.size() - 1);
                                 }
-                            } else if (nEncType == 8 && baName.size() >= 2) {
-                                sChildName = QString::fromLatin1(baName.constData() + 1, baName.size() - 1);
                             }
                         }
                     }
-                }
-
-                // Total FID size (must be 4-byte aligned)
-                qint32 nFIDSize = 38 + (qint32)nLenImplUse + (qint32)nLenFileId;
-                qint32 nFIDPadded = (nFIDSize + 3) & ~3;
 
-                if (nFIDPadded <= 0) {
-                    break;
-                }
+                    // Total FID size (must be 4-byte aligned)
+                    qint32 nFIDSize = 38 + (qint32)nLenImplUse + (qint32)nLenFileId;
+                    qint32 nFIDPadded = (nFIDSize + 3) & ~3;
 
-                if (!bIsParent && !sChildName.isEmpty() && nChildICBLocation > 0) {
-                    QString sChildPath;
-                    if (dirInfo.sPath.isEmpty()) {
-                        sChildPath = sChildName;
-                    } else {
-                        sChildPath = dirInfo.sPath + "/" + sChildName;
+                    if (nFIDPadded <= 0) {
+                        break;
                     }
 
-                    qint64 nChildFileEntryOffset = (qint64)nChildICBLocation * nBlockSize;
+                    if (!bIsParent && !sChildName.isEmpty() && nChildICBLocation > 0) {
+                        QString sChildPath;
+                        if (dirInfo.sPath.isEmpty()) {
+                            sChildPath = sChildName;
+                        } else {
+                            sChildPath = dirInfo.sPath + "/" + sChildName;
+                        }
+
+                        qint64 nChildFileEntryOffset = (qint64)nChildICBLocation * nBlockSize;
 
-                    if (nChildFileEntryOffset > 0 && nChildFileEntryOffset < getSize() && !setVisited.contains(nChildFileEntryOffset)) {
-                        setVisited.insert(nChildFileEntryOffset);
+                        if (nChildFileEntryOffset > 0 && nChildFileEntryOffset < getSize() && !setVisited.contains(nChildFileEntryOffset)) {
+                            setVisited.insert(nChildFileEntryOffset);
 
-                        DirEntry childEntry;
-                        childEntry.nFileEntryOffset = nChildFileEntryOffset;
-                        childEntry.sPath = sChildPath;
-                        listQueue.append(childEntry);
+                            DirEntry childEntry;
+                            childEntry.nFileEntryOffset = nChildFileEntryOffset;
+                            childEntry.sPath = sChildPath;
+                            listQueue.append(childEntry);
+                        }
                     }
-                }
 
-                nFIDOffset += nFIDPadded;
+                    nFIDOffset += nFIDPadded;
+                }
             }
         }
     }
@@ -1492,6 +1685,108 @@ QList<XBinary::ARCHIVERECORD> XUDF::_parseFileSystem(qint32 nBlockSize, PDSTRUCT
     return listResult;
 }
 
+bool XUDF::_readAllocationExtents(qint64 nOffset, quint32 nSize, quint8 nAllocType, qint32 nBlockSize, QList<UDF_EXTENT> *pListExtents,
+                                  PDSTRUCT *pPdStruct)
+{
+    if (!pListExtents) {
+        return false;
+    }
+
+    pListExtents->clear();
+
+    if (nAllocType == 3) {
+        // Data recorded in the allocation descriptor area itself
+        if (nSize > 0) {
+            UDF_EXTENT extent = {};
+            extent.nOffset = nOffset;
+            extent.nSize = (qint64)nSize;
+            extent.bRecorded = true;
+            pListExtents->append(extent);
+        }
+
+        return true;
+    }
+
+    if (nAllocType > 2) {
+        return false;  // reserved descriptor type
+    }
+
+    QPointer<XUDF> guardedThis(this);
+    QPointer<QIODevice> guardedDevice(getDevice());
+
+    // short_ad: ExtentLength(4) + ExtentPosition(4)
+    // long_ad: ExtentLength(4) + LogicalBlockNum(4) + PartRef(2) + ImplUse(6)
+    // ext_ad: ExtentLength(4) + RecordedLength(4) + InformationLength(4) +
+    //         LogicalBlockNum(4) + PartRef(2) + ImplUse(2)
+    // The top two bits of ExtentLength are the extent type.
+    const qint64 nDescriptorSize = (nAllocType == 0) ? 8 : ((nAllocType == 1) ? 16 : 20);
+    const qint64 nPositionOffset = (nAllocType == 2) ? 12 : 4;
+    qint64 nCurrent = nOffset;
+    qint64 nEnd = nOffset + (qint64)nSize;
+    qint32 nNumberOfDescriptors = 0;
+    QSet<qint64> setVisited;
+
+    while ((nCurrent + nDescriptorSize <= nEnd) && isPdStructNotCanceled(pPdStruct)) {
+        if (++nNumberOfDescriptors > N_UDF_MAX_ALLOCATION_DESCRIPTORS) {
+            return false;
+        }
+
+        quint32 nExtLength = 0;
+        quint32 nExtPos = 0;
+        if (!_readUInt32(nCurrent, &nExtLength) || !_readUInt32(nCurrent + nPositionOffset, &nExtPos) || !guardedThis || !guardedDevice) {
+            return false;
+        }
+
+        const quint32 nType = nExtLength >> 30;
+        const qint64 nExtSize = (qint64)(nExtLength & 0x3FFFFFFF);
+
+        if (nExtSize == 0) {
+            break;  // a zero length ends the sequence
+        }
+
+        if (nType == 3) {
+            // Continuation: the next descriptors follow an Allocation Extent
+            // Descriptor, tag(16) + PreviousAllocationExtentLocation(4) +
+            // LengthOfAllocationDescriptors(4)
+            const qint64 nNextOffset = (qint64)nExtPos * nBlockSize;
+            if ((nExtSize < 24) || setVisited.contains(nNextOffset) || (nNextOffset + 24 > getSize())) {
+                return false;
+            }
+            setVisited.insert(nNextOffset);
+
+            UDF_TAG tag = {};
+            quint32 nNextSize = 0;
+            if (!_readTag(nNextOffset, &tag) || !_readUInt32(nNextOffset + 20, &nNextSize) || !guardedThis || !guardedDevice) {
+                return false;
+            }
+            if (tag.nTagIdentifier != TAG_ALLOCATION_EXTENT_DESCRIPTOR) {
+                return false;
+            }
+
+            nCurrent = nNextOffset + 24;
+            nEnd = nCurrent + qMin((qint64)nNextSize, nExtSize - 24);
+
+            continue;
+        }
+
+        UDF_EXTENT extent = {};
+        extent.nOffset = (nType == 0) ? ((qint64)nExtPos * nBlockSize) : 0;
+        extent.nSize = nExtSize;
+        extent.bRecorded = (nType == 0);
+
+        if (!pListExtents->isEmpty() && (pListExtents->last().bRecorded == extent.bRecorded) &&
+            (!extent.bRecorded || (pListExtents->last().nOffset + pListExtents->last().nSize == extent.nOffset))) {
+            pListExtents->last().nSize += extent.nSize;
+        } else {
+            pListExtents->append(extent);
+        }
+
+        nCurrent += nDescriptorSize;
+    }
+
+    return isPdStructNotCanceled(pPdStruct);
+}
+
 QString XUDF::_cleanFileName(const QString &sFileName)
 {
     QString sResult = sFileName;
@@ -23,6 +23,8 @@
 
 #include "xarchive.h"
 
+#include <QCache>
+
 class XUDF : public XArchive {
     Q_OBJECT
 
@@ -175,6 +177,10 @@ public:
     QString getVolumeIdentifier();
     QString getVolumeSetIdentifier();
 
+    // Bound (in logical blocks) of the metadata block cache used while the
+    // file system is listed; 0 reads every field from the device.
+    void setBlockCacheSize(qint32 nNumberOfBlocks);
+
 private:
     struct UDF_SCAN_CONTEXT {
         qint32 nBlockSize;
@@ -182,9 +188,18 @@ private:
         qint64 nVolumeDescriptorSequenceSize;
     };
 
+    // One run of a file's data.  Unrecorded extents (allocated or not) read
+    // as zeros; embedded data is a recorded extent inside the file entry.
+    struct UDF_EXTENT {
+        qint64 nOffset;
+        qint64 nSize;
+        bool bRecorded;
+    };
+
     struct UDF_UNPACK_CONTEXT {
         qint32 nBlockSize;
         QList<ARCHIVERECORD> listRecords;
+        QList<QList<UDF_EXTENT>> listExtents;  // parallel to listRecords
         qint32 nCurrentRecordIndex;
     };
 
@@ -206,7 +221,11 @@ private:
     bool _isValidDescriptorTag(qint64 nOffset, quint16 nExpectedTagIdentifier, bool bStrict, UDF_TAG *pTag);
     bool _isAnchorVolumeDescriptorPointer(qint64 nOffset, bool bStrict);
     bool _hasVolumeRecognitionSequence();
-    QList<ARCHIVERECORD> _parseFileSystem(qint32 nBlockSize, PDSTRUCT *pPdStruct);
+    QList<ARCHIVERECORD> _parseFileSystem(qint32 nBlockSize, PDSTRUCT *pPdStruct, QList<QList<UDF_EXTENT>> *pListExtents = nullptr);
+    // Short/long/extended allocation descriptors, following Allocation Extent
+    // Descriptor continuations; adjacent runs are merged.
+    bool _readAllocationExtents(qint64 nOffset, quint32 nSize, quint8 nAllocType, qint32 nBlockSize, QList<UDF_EXTENT> *pListExtents,
+                                PDSTRUCT *pPdStruct);
     QString _cleanFileName(const QString &sFileName);
 
     // Every QIODevice operation is an external callback boundary.  These
@@ -221,8 +240,20 @@ private:
     bool _readUInt32(qint64 nOffset, quint32 *pValue);
     bool _readUInt64(qint64 nOffset, quint64 *pValue);
 
+    // Logical-block LRU behind _readExact while _parseFileSystem runs.  A miss
+    // reads a run of blocks in one device call; directory extents are loaded
+    // whole before their identifiers are decoded.
+    void _enableBlockCache(qint32 nBlockSize);
+    void _disableBlockCache();
+    bool _readCached(qint64 nOffset, char *pData, qint64 nSize);
+    bool _loadCacheBlocks(qint64 nFirstBlock, qint32 nNumberOfBlocks);
+    void _prefetchCacheBlocks(qint64 nOffset, qint64 nSize);
+
     QString m_sVolumeIdentifier;
     QString m_sVolumeSetIdentifier;
+    qint32 m_nBlockCacheSize;
+    qint32 m_nCacheBlockSize;  // 0 while the cache is off
+    QCache<qint64, QByteArray> m_cacheBlocks;  // one cost unit per block
 private:
     INTERNAL_INFO m_internalInfo;
 };
@@ -0,0 +1,308 @@
+/* Copyright (c) 2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "xvolumesetdevice.h"
+
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <algorithm>
+#include <limits>
+#include <new>
+
+namespace {
+const qint32 N_VOLUMESET_DEFAULT_OPEN_FILES = 4;
+const qint32 N_VOLUMESET_MAX_VOLUMES = 100000;
+
+bool volumeSetExists(const QString &sFileName)
+{
+    return QFileInfo(sFileName).isFile();
+}
+
+// Numbered volumes prefix + N + suffix, N zero-padded to nWidth, counted from nFirst.
+QStringList volumeSetNumbered(const QString &sPrefix, qint32 nWidth, const QString &sSuffix, qint32 nFirst)
+{
+    QStringList listResult;
+
+    for (qint32 i = nFirst; i < N_VOLUMESET_MAX_VOLUMES; i++) {
+        const QString sFileName = sPrefix + QString("%1").arg(i, nWidth, 10, QLatin1Char('0')) + sSuffix;
+        if (!volumeSetExists(sFileName)) break;
+        listResult.append(sFileName);
+    }
+
+    return listResult;
+}
+
+// 7-Zip and generic splits: name.7z.001, name.002, ...
+QRegularExpressionMatch volumeSetMatchSplit(const QString &sName)
+{
+    return QRegularExpression("^(.+\\.)(\\d{3,})$").match(sName);
+}
+}  // namespace
+
+XVolumeSetDevice::XVolumeSetDevice(QObject *pParent) : XIODevice(pParent)
+{
+    m_nMaxOpenFiles = N_VOLUMESET_DEFAULT_OPEN_FILES;
+    m_nSize = 0;
+}
+
+XVolumeSetDevice::~XVolumeSetDevice()
+{
+    _closeFiles();
+}
+
+QStringList XVolumeSetDevice::findVolumes(const QString &sFileName)
+{
+    const QFileInfo fileInfo(sFileName);
+    const QRegularExpressionMatch matchSplit = volumeSetMatchSplit(fileInfo.fileName());
+    QStringList listResult;
+
+    if (matchSplit.hasMatch()) {
+        listResult = volumeSetNumbered(fileInfo.absolutePath() + QLatin1Char('/') + matchSplit.captured(1), matchSplit.captured(2).length(), QString(), 1);
+    }
+
+    // A lone file is not a set; the caller opens it as usual.
+    if (listResult.count() < 2) {
+        listResult = QStringList(sFileName);
+    }
+
+    return listResult;
+}
+
+bool XVolumeSetDevice::setFileName(const QString &sFileName)
+{
+    return setFileNames(findVolumes(sFileName));
+}
+
+bool XVolumeSetDevice::setFileNames(const QStringList &listFileNames)
+{
+    if (isOpen()) {
+        return false;
+    }
+
+    _closeFiles();
+    m_vecVolumes.clear();
+    m_nSize = 0;
+
+    const qint32 nNumberOfVolumes = listFileNames.count();
+    if ((nNumberOfVolumes == 0) || (nNumberOfVolumes > N_VOLUMESET_MAX_VOLUMES)) {
+        return false;
+    }
+
+    QVector<VOLUME> vecVolumes;
+    vecVolumes.reserve(nNumberOfVolumes);
+    qint64 nOffset = 0;
+
+    for (qint32 i = 0; i < nNumberOfVolumes; i++) {
+        const QFileInfo fileInfo(listFileNames.at(i));
+        const qint64 nSize = fileInfo.size();
+
+        if (!fileInfo.isFile() || (nSize < 0) || (nOffset > (std::numeric_limits<qint64>::max)() - nSize)) {
+            return false;
+        }
+
+        VOLUME volume = {};
+        volume.sFileName = fileInfo.absoluteFilePath();
+        volume.nOffset = nOffset;
+        volume.nSize = nSize;
+        volume.pFile = nullptr;
+        vecVolumes.append(volume);
+
+        nOffset += nSize;
+    }
+
+    m_vecVolumes = vecVolumes;
+    m_nSize = nOffset;
+
+    return true;
+}
+
+void XVolumeSetDevice::setMaxOpenFiles(qint32 nMaxOpenFiles)
+{
+    m_nMaxOpenFiles = qMax(1, nMaxOpenFiles);
+
+    while (m_listOpenVolumes.count() > m_nMaxOpenFiles) {
+        const qint32 nVolume = m_listOpenVolumes.takeLast();
+        delete m_vecVolumes[nVolume].pFile;
+        m_vecVolumes[nVolume].pFile = nullptr;
+    }
+}
+
+qint32 XVolumeSetDevice::getMaxOpenFiles() const
+{
+    return m_nMaxOpenFiles;
+}
+
+qint32 XVolumeSetDevice::getNumberOfVolumes() const
+{
+    return m_vecVolumes.count();
+}
+
+QString XVolumeSetDevice::getVolumeFileName(qint32 nVolume) const
+{
+    return ((nVolume >= 0) && (nVolume < m_vecVolumes.count())) ? m_vecVolumes.at(nVolume).sFileName : QString();
+}
+
+qint64 XVolumeSetDevice::getVolumeOffset(qint32 nVolume) const
+{
+    return ((nVolume >= 0) && (nVolume < m_vecVolumes.count())) ? m_vecVolumes.at(nVolume).nOffset : -1;
+}
+
+qint64 XVolumeSetDevice::getVolumeSize(qint32 nVolume) const
+{
+    return ((nVolume >= 0) && (nVolume < m_vecVolumes.count())) ? m_vecVolumes.at(nVolume).nSize : -1;
+}
+
+qint32 XVolumeSetDevice::getVolumeIndex(qint64 nOffset) const
+{
+    if ((nOffset < 0) || (nOffset >= m_nSize)) {
+        return -1;
+    }
+
+    // Last volume starting at or before nOffset; empty volumes share the offset of the next one.
+    QVector<VOLUME>::const_iterator iter = std::upper_bound(m_vecVolumes.constBegin(), m_vecVolumes.constEnd(), nOffset,
+                                                            [](qint64 nValue, const VOLUME &volume) { return nValue < volume.nOffset; });
+
+    return (qint32)(iter - m_vecVolumes.constBegin()) - 1;
+}
+
+bool XVolumeSetDevice::open(OpenMode mode)
+{
+    bool bResult = false;
+
+    if (!m_vecVolumes.isEmpty() && (mode == QIODevice::ReadOnly) && XIODevice::open(mode)) {
+        // The first volume is opened eagerly so that a missing set fails here.
+        bResult = (_getVolumeFile(0) != nullptr) && XIODevice::seek(0);
+        if (!bResult) {
+            close();
+        }
+    }
+
+    return bResult;
+}
+
+void XVolumeSetDevice::close()
+{
+    _closeFiles();
+    XIODevice::close();
+}
+
+qint64 XVolumeSetDevice::size() const
+{
+    return m_nSize;
+}
+
+bool XVolumeSetDevice::seek(qint64 nPos)
+{
+    return (nPos >= 0) && (nPos <= m_nSize) && XIODevice::seek(nPos);
+}
+
+qint64 XVolumeSetDevice::pos() const
+{
+    return XIODevice::pos();
+}
+
+qint64 XVolumeSetDevice::readData(char *pData, qint64 nMaxSize)
+{
+    if ((nMaxSize < 0) || ((nMaxSize > 0) && !pData)) {
+        return -1;
+    }
+
+    qint64 nPosition = XIODevice::pos();
+    qint64 nRead = 0;
+    qint32 nVolume = getVolumeIndex(nPosition);
+
+    while ((nRead < nMaxSize) && (nPosition < m_nSize)) {
+        if ((nVolume < 0) || (nVolume >= m_vecVolumes.count())) {
+            return -1;
+        }
+
+        const qint64 nDelta = nPosition - m_vecVolumes.at(nVolume).nOffset;
+        const qint64 nChunkSize = qMin(nMaxSize - nRead, m_vecVolumes.at(nVolume).nSize - nDelta);
+
+        if (nChunkSize > 0) {
+            QFile *pFile = _getVolumeFile(nVolume);
+            if (!pFile || !pFile->seek(nDelta) || (pFile->read(pData + nRead, nChunkSize) != nChunkSize)) {
+                return -1;
+            }
+
+            nRead += nChunkSize;
+            nPosition += nChunkSize;
+        }
+
+        nVolume++;
+    }
+
+    return nRead;
+}
+
+qint64 XVolumeSetDevice::writeData(const char *pData, qint64 nMaxSize)
+{
+    Q_UNUSED(pData)
+    Q_UNUSED(nMaxSize)
+
+    return -1;
+}
+
+QFile *XVolumeSetDevice::_getVolumeFile(qint32 nVolume)
+{
+    if ((nVolume < 0) || (nVolume >= m_vecVolumes.count())) {
+        return nullptr;
+    }
+
+    VOLUME &volume = m_vecVolumes[nVolume];
+
+    if (volume.pFile) {
+        m_listOpenVolumes.removeOne(nVolume);
+        m_listOpenVolumes.prepend(nVolume);
+        return volume.pFile;
+    }
+
+    while (m_listOpenVolumes.count() >= m_nMaxOpenFiles) {
+        const qint32 nLeastRecent = m_listOpenVolumes.takeLast();
+        delete m_vecVolumes[nLeastRecent].pFile;
+        m_vecVolumes[nLeastRecent].pFile = nullptr;
+    }
+
+    QFile *pFile = new (std::nothrow) QFile(volume.sFileName);
+    if (!pFile) {
+        return nullptr;
+    }
+
+    // A volume that changed size since the set was mapped would shift every later offset.
+    if (!pFile->open(QIODevice::ReadOnly) || (pFile->size() != volume.nSize)) {
+        delete pFile;
+        return nullptr;
+    }
+
+    volume.pFile = pFile;
+    m_listOpenVolumes.prepend(nVolume);
+
+    return pFile;
+}
+
+void XVolumeSetDevice::_closeFiles()
+{
+    for (qint32 nVolume : m_listOpenVolumes) {
+        delete m_vecVolumes[nVolume].pFile;
+        m_vecVolumes[nVolume].pFile = nullptr;
+    }
+
+    m_listOpenVolumes.clear();
+}
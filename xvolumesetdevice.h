@@ -0,0 +1,85 @@
+/* Copyright (c) 2026 hors<horsicq@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef XVOLUMESETDEVICE_H
+#define XVOLUMESETDEVICE_H
+
+#include "xiodevice.h"
+
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+
+// A .001-style split (7-Zip name.7z.001, name.002, ...) read as one seekable
+// source: the volumes are plain byte slices of one archive.  RAR and split ZIP
+// volumes carry their own headers and are left to their formats.  Offsets map
+// to volumes by binary search, and at most getMaxOpenFiles() volume files are
+// open at a time.
+class XVolumeSetDevice : public XIODevice {
+    Q_OBJECT
+
+public:
+    explicit XVolumeSetDevice(QObject *pParent = nullptr);
+    ~XVolumeSetDevice();
+
+    // Volumes of the byte split sFileName belongs to, in set order; just
+    // sFileName if it is not one.
+    static QStringList findVolumes(const QString &sFileName);
+
+    bool setFileName(const QString &sFileName);
+    bool setFileNames(const QStringList &listFileNames);
+    void setMaxOpenFiles(qint32 nMaxOpenFiles);
+    qint32 getMaxOpenFiles() const;
+
+    qint32 getNumberOfVolumes() const;
+    QString getVolumeFileName(qint32 nVolume) const;
+    qint64 getVolumeOffset(qint32 nVolume) const;
+    qint64 getVolumeSize(qint32 nVolume) const;
+    qint32 getVolumeIndex(qint64 nOffset) const;
+
+    virtual bool open(OpenMode mode);
+    virtual void close();
+    virtual qint64 size() const;
+    virtual bool seek(qint64 nPos);
+    virtual qint64 pos() const;
+
+protected:
+    virtual qint64 readData(char *pData, qint64 nMaxSize);
+    virtual qint64 writeData(const char *pData, qint64 nMaxSize);
+
+private:
+    struct VOLUME {
+        QString sFileName;
+        qint64 nOffset;  // Logical offset of the volume in the set
+        qint64 nSize;
+        QFile *pFile;    // Open handle, nullptr while closed
+    };
+
+    QFile *_getVolumeFile(qint32 nVolume);
+    void _closeFiles();
+
+    QVector<VOLUME> m_vecVolumes;
+    QList<qint32> m_listOpenVolumes;  // Most recently used first
+    qint32 m_nMaxOpenFiles;
+    qint64 m_nSize;
+};
+
+#endif  // XVOLUMESETDEVICE_H
@@ -24,8 +24,15 @@
 #include "xipa.h"
 #include "xjar.h"
 #include <algorithm>
+#include <QAtomicInt>
+#include <QBuffer>
+#include <QFileDevice>
+#include <QRunnable>
 #include <QSet>
 #include <QTemporaryFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
 #include <QUuid>
 #include <limits>
 #include <new>
@@ -40,6 +47,7 @@
 #include "Algos/xzipcryptodecoder.h"
 #include "Algos/xaesdecoder.h"
 #include "Algos/xppmddecoder.h"
+#include "Algos/xzstddecoder.h"
 
 XBinary::XCONVERT _TABLE_XZip_STRUCTID[] = {
     {XZip::STRUCTID_UNKNOWN, "Unknown", QObject::tr("Unknown")},
@@ -102,7 +110,16 @@ static XBinary::PM_INFO createPMInfo(XBinary::HANDLE_METHOD hm0, XBinary::HANDLE
 
 namespace {
 const quint16 ZIP_FLAG_UTF8 = 0x0800;
+const quint16 ZIP_FLAG_ENCRYPTED = 0x0001;
+const quint16 ZIP_FLAG_DATADESCRIPTOR = 0x0008;
+const quint16 ZIP_FLAG_LZMA_EOS = 0x0002;
 const quint16 ZIP_EXTRA_UNICODE_PATH = 0x7075;
+const quint32 ZIP_SIGNATURE_DATADESCRIPTOR = 0x08074B50;
+const quint8 ZIP_VERSION_ZIP64 = 0x2D;
+const quint8 ZIP_VERSION_LZMA = 0x3F;  // APPNOTE 4.4.3: 6.3 for LZMA and Zstandard
+const quint64 N_ZIP_MAX_VALUE16 = 0xFFFF;
+const quint64 N_ZIP_MAX_VALUE32 = 0xFFFFFFFF;
+const qint64 N_ZIP64_LOCAL_EXTRA_SIZE = 20;
 
 quint16 readZipLE16(const char *pData)
 {
@@ -398,11 +415,6 @@ bool zipStageSource(QIODevice *pSource, QTemporaryFile *pStage, qint64 nExpected
         }
         nSize = nDeviceSize;
     }
-    if ((nSize >= 0) && ((quint64)nSize >= (std::numeric_limits<quint32>::max)())) {
-        zipRestoreSourcePosition(pSource, bSequential, nOriginalPosition);
-        return false;
-    }
-
     const qint32 nBufferSize = 0x10000;
     char *pBuffer = new (std::nothrow) char[nBufferSize];
     if (!pBuffer) {
@@ -425,8 +437,7 @@ bool zipStageSource(QIODevice *pSource, QTemporaryFile *pStage, qint64 nExpected
             bResult = false;
             break;
         }
-        if ((quint64)nRead >= ((quint64)(std::numeric_limits<quint32>::max)() - (quint64)nTotal) ||
-            !zipWriteAll(pStage, pBuffer, nRead, pPdStruct)) {
+        if (!zipWriteAll(pStage, pBuffer, nRead, pPdStruct)) {
             bResult = false;
             break;
         }
@@ -446,12 +457,197 @@ bool zipStageSource(QIODevice *pSource, QTemporaryFile *pStage, qint64 nExpected
     return true;
 }
 
+void appendZipLE(QByteArray *pbaData, quint64 nValue, qint32 nSize)
+{
+    for (qint32 i = 0; i < nSize; i++) {
+        pbaData->append((char)((nValue >> (8 * i)) & 0xFF));
+    }
+}
+
+// Values that do not fit a classic 32-bit field are stored as 0xFFFFFFFF plus a ZIP64 extra
+bool zipIsZip64Value(qint64 nValue)
+{
+    return (quint64)nValue >= N_ZIP_MAX_VALUE32;
+}
+
+// Version needed to extract is raised to 4.5 as soon as either header needs a ZIP64 extra
+void zipUpdateZip64Version(XZip::ZIPFILE_RECORD *pRecord)
+{
+    if (pRecord->bZip64 || zipIsZip64Value(pRecord->nHeaderOffset)) {
+        pRecord->nMinVersion = qMax(pRecord->nMinVersion, ZIP_VERSION_ZIP64);
+        pRecord->nVersion = qMax(pRecord->nVersion, ZIP_VERSION_ZIP64);
+    }
+}
+
+qint64 zipGetLocalHeaderSize(const XZip::ZIPFILE_RECORD &record, qint64 nFileNameLength)
+{
+    return (qint64)sizeof(XZip::LOCALFILEHEADER) + nFileNameLength + (record.bZip64 ? N_ZIP64_LOCAL_EXTRA_SIZE : 0);
+}
+
+// The local ZIP64 extra always holds both sizes; they stay zero while a data descriptor carries them
+QByteArray zipCreateLocalZip64Extra(const XZip::ZIPFILE_RECORD &record)
+{
+    const bool bDataDescriptor = (record.nFlags & ZIP_FLAG_DATADESCRIPTOR);
+
+    QByteArray baResult;
+    appendZipLE(&baResult, XZip::ZIP_ZIP64_EXTRA_FIELD_HEADER_ID, 2);
+    appendZipLE(&baResult, N_ZIP64_LOCAL_EXTRA_SIZE - 4, 2);
+    appendZipLE(&baResult, bDataDescriptor ? 0 : (quint64)record.nUncompressedSize, 8);
+    appendZipLE(&baResult, bDataDescriptor ? 0 : (quint64)record.nCompressedSize, 8);
+
+    return baResult;
+}
+
+// The central ZIP64 extra holds only the fields whose classic slot is 0xFFFFFFFF, in APPNOTE order
+QByteArray zipCreateCentralZip64Extra(const XZip::ZIPFILE_RECORD &record)
+{
+    QByteArray baData;
+
+    // Decided from the final sizes: a streamed member reserved a local extra but may still fit 32 bits
+    if (zipIsZip64Value(record.nUncompressedSize)) {
+        appendZipLE(&baData, (quint64)record.nUncompressedSize, 8);
+    }
+
+    if (zipIsZip64Value(record.nCompressedSize)) {
+        appendZipLE(&baData, (quint64)record.nCompressedSize, 8);
+    }
+
+    if (zipIsZip64Value(record.nHeaderOffset)) {
+        appendZipLE(&baData, (quint64)record.nHeaderOffset, 8);
+    }
+
+    if (baData.isEmpty()) {
+        return QByteArray();
+    }
+
+    QByteArray baResult;
+    appendZipLE(&baResult, XZip::ZIP_ZIP64_EXTRA_FIELD_HEADER_ID, 2);
+    appendZipLE(&baResult, baData.size(), 2);
+    baResult.append(baData);
+
+    return baResult;
+}
+
+quint64 readZipLE64(const char *pData)
+{
+    return (quint64)readZipLE32(pData) | ((quint64)readZipLE32(pData + 4) << 32);
+}
+
+// Replaces the classic fields that hold 0xFFFFFFFF with their values from the 0x0001 extra; fields that fit are not stored there
+bool zipApplyZip64Extra(const QByteArray &baExtraField, qint64 *pnUncompressedSize, qint64 *pnCompressedSize, qint64 *pnLocalHeaderOffset)
+{
+    qint64 *pFields[3] = {pnUncompressedSize, pnCompressedSize, pnLocalHeaderOffset};
+    qint32 nNumberOfFields = 0;
+
+    for (qint32 i = 0; i < 3; i++) {
+        if (pFields[i] && ((quint64)*pFields[i] == N_ZIP_MAX_VALUE32)) {
+            nNumberOfFields++;
+        }
+    }
+
+    if (nNumberOfFields == 0) {
+        return true;
+    }
+
+    const char *pData = baExtraField.constData();
+    const qint32 nExtraFieldSize = baExtraField.size();
+    qint32 nPosition = 0;
+
+    while ((nExtraFieldSize - nPosition) >= 4) {
+        const quint16 nHeaderID = readZipLE16(pData + nPosition);
+        const quint16 nDataSize = readZipLE16(pData + nPosition + 2);
+        nPosition += 4;
+
+        if (nDataSize > (nExtraFieldSize - nPosition)) {
+            break;
+        }
+
+        if (nHeaderID == XZip::ZIP_ZIP64_EXTRA_FIELD_HEADER_ID) {
+            if (nDataSize < (nNumberOfFields * 8)) {
+                return false;
+            }
+
+            qint32 nFieldPosition = nPosition;
+            for (qint32 i = 0; i < 3; i++) {
+                if (pFields[i] && ((quint64)*pFields[i] == N_ZIP_MAX_VALUE32)) {
+                    const quint64 nValue = readZipLE64(pData + nFieldPosition);
+                    if (nValue > (quint64)(std::numeric_limits<qint64>::max)()) {
+                        return false;
+                    }
+                    *pFields[i] = (qint64)nValue;
+                    nFieldPosition += 8;
+                }
+            }
+
+            return true;
+        }
+
+        nPosition += nDataSize;
+    }
+
+    return false;
+}
+
+XZip::LOCALFILEHEADER zipCreateLocalFileHeader(const XZip::ZIPFILE_RECORD &record, qint32 nFileNameLength)
+{
+    const QPair<quint16, quint16> dosDateTime = XBinary::qDateTimeToDosDateTime(record.dtTime);
+
+    XZip::LOCALFILEHEADER localFileHeader = {};
+    localFileHeader.nSignature = XZip::SIGNATURE_LFD;
+    localFileHeader.nMinVersion = record.nMinVersion;
+    localFileHeader.nMinOS = record.nMinOS;
+    localFileHeader.nFlags = record.nFlags;
+    localFileHeader.nMethod = record.method;
+    localFileHeader.nLastModTime = dosDateTime.second;
+    localFileHeader.nLastModDate = dosDateTime.first;
+    localFileHeader.nFileNameLength = (quint16)nFileNameLength;
+    localFileHeader.nExtraFieldLength = record.bZip64 ? (quint16)N_ZIP64_LOCAL_EXTRA_SIZE : 0;
+
+    // With a data descriptor the local fields stay zero and the descriptor carries the values
+    if (!(record.nFlags & ZIP_FLAG_DATADESCRIPTOR)) {
+        localFileHeader.nCRC32 = record.nCRC32;
+        localFileHeader.nCompressedSize = (quint32)record.nCompressedSize;
+        localFileHeader.nUncompressedSize = (quint32)record.nUncompressedSize;
+    }
+
+    if (record.bZip64) {
+        localFileHeader.nCompressedSize = (quint32)N_ZIP_MAX_VALUE32;
+        localFileHeader.nUncompressedSize = (quint32)N_ZIP_MAX_VALUE32;
+    }
+
+    return localFileHeader;
+}
+
+bool zipWriteLocalFileHeader(QIODevice *pDest, const XZip::ZIPFILE_RECORD &record, const QByteArray &baFileName, XBinary::PDSTRUCT *pPdStruct,
+                             qint64 *pnWritten = nullptr)
+{
+    const XZip::LOCALFILEHEADER localFileHeader = zipCreateLocalFileHeader(record, baFileName.size());
+    const QByteArray baZip64Extra = record.bZip64 ? zipCreateLocalZip64Extra(record) : QByteArray();
+
+    qint64 nPartWritten = 0;
+    bool bResult = zipWriteAll(pDest, reinterpret_cast<const char *>(&localFileHeader), sizeof(localFileHeader), pPdStruct, &nPartWritten);
+    if (pnWritten) *pnWritten = nPartWritten;
+    if (bResult) {
+        bResult = zipWriteAll(pDest, baFileName.constData(), baFileName.size(), pPdStruct, &nPartWritten);
+        if (pnWritten) *pnWritten += nPartWritten;
+    }
+    if (bResult) {
+        bResult = zipWriteAll(pDest, baZip64Extra.constData(), baZip64Extra.size(), pPdStruct, &nPartWritten);
+        if (pnWritten) *pnWritten += nPartWritten;
+    }
+
+    return bResult;
+}
+
+bool zipIsZip64EndRequired(qint64 nNumberOfRecords, qint64 nCentralSize, qint64 nStartPosition)
+{
+    return ((quint64)nNumberOfRecords >= N_ZIP_MAX_VALUE16) || zipIsZip64Value(nCentralSize) || zipIsZip64Value(nStartPosition);
+}
+
 bool zipGetCentralDirectorySizes(const QList<XZip::ZIPFILE_RECORD> *pRecords, const QByteArray &baComment,
                                  qint64 nStartPosition, qint64 *pCentralSize, qint64 *pTotalSize)
 {
     if (!pRecords || !pCentralSize || !pTotalSize || (nStartPosition < 0) ||
-        ((quint64)nStartPosition >= (std::numeric_limits<quint32>::max)()) ||
-        (pRecords->size() >= (std::numeric_limits<quint16>::max)()) ||
         (baComment.size() > (std::numeric_limits<quint16>::max)())) {
         return false;
     }
@@ -461,33 +657,30 @@ bool zipGetCentralDirectorySizes(const QList<XZip::ZIPFILE_RECORD> *pRecords, co
         const QByteArray baFileName = record.sFileName.toUtf8();
         if (baFileName.isEmpty() || (baFileName.size() > (std::numeric_limits<quint16>::max)()) ||
             ((qint64)record.method < 0) || ((qint64)record.method > (std::numeric_limits<quint16>::max)()) ||
-            (record.nCompressedSize < 0) ||
-            ((quint64)record.nCompressedSize >= (std::numeric_limits<quint32>::max)()) ||
-            (record.nUncompressedSize < 0) ||
-            ((quint64)record.nUncompressedSize >= (std::numeric_limits<quint32>::max)()) ||
-            (record.nHeaderOffset < 0) ||
-            ((quint64)record.nHeaderOffset >= (std::numeric_limits<quint32>::max)())) {
+            (record.nCompressedSize < 0) || (record.nUncompressedSize < 0) || (record.nHeaderOffset < 0) ||
+            (!record.bZip64 && (zipIsZip64Value(record.nCompressedSize) || zipIsZip64Value(record.nUncompressedSize)))) {
             return false;
         }
 
-        const qint64 nExpectedDataOffset = record.nHeaderOffset +
-                                           (qint64)sizeof(XZip::LOCALFILEHEADER) + baFileName.size();
+        const qint64 nExpectedDataOffset = record.nHeaderOffset + zipGetLocalHeaderSize(record, baFileName.size());
         if ((record.nHeaderOffset >= nStartPosition) || (record.nDataOffset != nExpectedDataOffset) ||
             (record.nDataOffset > nStartPosition) ||
             (record.nCompressedSize > (nStartPosition - record.nDataOffset)) ||
-            ((record.method == XZip::CMETHOD_STORE) && !(record.nFlags & 0x0001) &&
+            ((record.method == XZip::CMETHOD_STORE) && !(record.nFlags & ZIP_FLAG_ENCRYPTED) &&
              (record.nCompressedSize != record.nUncompressedSize))) {
             return false;
         }
 
-        const qint64 nRecordSize = (qint64)sizeof(XZip::CENTRALDIRECTORYFILEHEADER) + baFileName.size();
-        if (nCentralSize > (std::numeric_limits<quint32>::max)() - nRecordSize) return false;
+        const qint64 nRecordSize = (qint64)sizeof(XZip::CENTRALDIRECTORYFILEHEADER) + baFileName.size() +
+                                   zipCreateCentralZip64Extra(record).size();
+        if (nCentralSize > (std::numeric_limits<qint64>::max)() - nRecordSize) return false;
         nCentralSize += nRecordSize;
     }
 
-    if ((quint64)nCentralSize >= (std::numeric_limits<quint32>::max)()) return false;
-
-    const qint64 nTrailerSize = (qint64)sizeof(XZip::ENDOFCENTRALDIRECTORYRECORD) + baComment.size();
+    qint64 nTrailerSize = (qint64)sizeof(XZip::ENDOFCENTRALDIRECTORYRECORD) + baComment.size();
+    if (zipIsZip64EndRequired(pRecords->size(), nCentralSize, nStartPosition)) {
+        nTrailerSize += (qint64)sizeof(XZip::ZIP64ENDOFCENTRALDIRECTORYRECORD) + (qint64)sizeof(XZip::ZIP64ENDOFCENTRALDIRECTORYLOCATOR);
+    }
     if (nCentralSize > (std::numeric_limits<qint64>::max)() - nTrailerSize) return false;
 
     *pCentralSize = nCentralSize;
@@ -507,6 +700,8 @@ bool zipBuildCentralDirectory(QIODevice *pDest, const QList<XZip::ZIPFILE_RECORD
     }
 
     for (const XZip::ZIPFILE_RECORD &record : *pRecords) {
+        const QByteArray baZip64Extra = zipCreateCentralZip64Extra(record);
+
         XZip::CENTRALDIRECTORYFILEHEADER header = {};
         header.nSignature = XZip::SIGNATURE_CFD;
         header.nVersion = record.nVersion;
@@ -519,25 +714,57 @@ bool zipBuildCentralDirectory(QIODevice *pDest, const QList<XZip::ZIPFILE_RECORD
         header.nLastModDate = dosDateTime.first;
         header.nLastModTime = dosDateTime.second;
         header.nCRC32 = record.nCRC32;
-        header.nCompressedSize = (quint32)record.nCompressedSize;
-        header.nUncompressedSize = (quint32)record.nUncompressedSize;
+        header.nCompressedSize = (quint32)qMin((quint64)record.nCompressedSize, N_ZIP_MAX_VALUE32);
+        header.nUncompressedSize = (quint32)qMin((quint64)record.nUncompressedSize, N_ZIP_MAX_VALUE32);
         const QByteArray baFileName = record.sFileName.toUtf8();
         header.nFileNameLength = (quint16)baFileName.size();
+        header.nExtraFieldLength = (quint16)baZip64Extra.size();
         header.nExternalFileAttributes = record.nExternalFileAttributes;
-        header.nOffsetToLocalFileHeader = (quint32)record.nHeaderOffset;
+        header.nOffsetToLocalFileHeader = (quint32)qMin((quint64)record.nHeaderOffset, N_ZIP_MAX_VALUE32);
+
+        if (!baZip64Extra.isEmpty()) {
+            header.nVersion = qMax(header.nVersion, ZIP_VERSION_ZIP64);
+            header.nMinVersion = qMax(header.nMinVersion, ZIP_VERSION_ZIP64);
+        }
 
         if (!zipWriteAll(pDest, reinterpret_cast<const char *>(&header), sizeof(header), pPdStruct) ||
-            !zipWriteAll(pDest, baFileName.constData(), baFileName.size(), pPdStruct)) {
+            !zipWriteAll(pDest, baFileName.constData(), baFileName.size(), pPdStruct) ||
+            !zipWriteAll(pDest, baZip64Extra.constData(), baZip64Extra.size(), pPdStruct)) {
             return false;
         }
     }
 
+    const qint64 nNumberOfRecords = pRecords->size();
+
+    if (zipIsZip64EndRequired(nNumberOfRecords, nCentralSize, nStartPosition)) {
+        XZip::ZIP64ENDOFCENTRALDIRECTORYRECORD zip64EndRecord = {};
+        zip64EndRecord.nSignature = XZip::SIGNATURE_ECD64;
+        zip64EndRecord.nSizeOfRecord = sizeof(XZip::ZIP64ENDOFCENTRALDIRECTORYRECORD) - 12;
+        zip64EndRecord.nVersion = ZIP_VERSION_ZIP64;
+        zip64EndRecord.nMinVersion = ZIP_VERSION_ZIP64;
+        zip64EndRecord.nDiskNumberOfRecords = (quint64)nNumberOfRecords;
+        zip64EndRecord.nTotalNumberOfRecords = (quint64)nNumberOfRecords;
+        zip64EndRecord.nSizeOfCentralDirectory = (quint64)nCentralSize;
+        zip64EndRecord.nOffsetToCentralDirectory = (quint64)nStartPosition;
+
+        XZip::ZIP64ENDOFCENTRALDIRECTORYLOCATOR zip64Locator = {};
+        zip64Locator.nSignature = XZip::SIGNATURE_ECDL64;
+        zip64Locator.nOffsetToZip64EndOfCentralDirectory = (quint64)(nStartPosition + nCentralSize);
+        zip64Locator.nTotalNumberOfDisks = 1;
+
+        if (!zipWriteAll(pDest, reinterpret_cast<const char *>(&zip64EndRecord), sizeof(zip64EndRecord), pPdStruct) ||
+            !zipWriteAll(pDest, reinterpret_cast<const char *>(&zip64Locator), sizeof(zip64Locator), pPdStruct)) {
+            return false;
+        }
+    }
+
+    // Fields that overflow keep their 0xFFFF/0xFFFFFFFF sentinels; the ZIP64 record holds the values
     XZip::ENDOFCENTRALDIRECTORYRECORD endRecord = {};
     endRecord.nSignature = XZip::SIGNATURE_ECD;
-    endRecord.nDiskNumberOfRecords = (quint16)pRecords->size();
-    endRecord.nTotalNumberOfRecords = (quint16)pRecords->size();
-    endRecord.nSizeOfCentralDirectory = (quint32)nCentralSize;
-    endRecord.nOffsetToCentralDirectory = (quint32)nStartPosition;
+    endRecord.nDiskNumberOfRecords = (quint16)qMin((quint64)nNumberOfRecords, N_ZIP_MAX_VALUE16);
+    endRecord.nTotalNumberOfRecords = (quint16)qMin((quint64)nNumberOfRecords, N_ZIP_MAX_VALUE16);
+    endRecord.nSizeOfCentralDirectory = (quint32)qMin((quint64)nCentralSize, N_ZIP_MAX_VALUE32);
+    endRecord.nOffsetToCentralDirectory = (quint32)qMin((quint64)nStartPosition, N_ZIP_MAX_VALUE32);
     endRecord.nCommentLength = (quint16)baComment.size();
 
     if (!zipWriteAll(pDest, reinterpret_cast<const char *>(&endRecord), sizeof(endRecord), pPdStruct) ||
@@ -631,9 +858,10 @@ QString XZip::getVersion()
     qint64 nECDOffset = findECDOffset(nullptr);
 
     quint16 nVersion = 0;
+    CENTRALDIRECTORY_INFO centralDirectoryInfo = {};
 
-    if (nECDOffset != -1) {
-        qint64 nOffset = read_uint32(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nOffsetToCentralDirectory));
+    if ((nECDOffset != -1) && _getCentralDirectoryInfo(nECDOffset, &centralDirectoryInfo, nullptr)) {
+        qint64 nOffset = centralDirectoryInfo.nOffset;
 
         quint32 nSignature = read_uint32(nOffset + offsetof(CENTRALDIRECTORYFILEHEADER, nSignature));
 
@@ -662,13 +890,14 @@ bool XZip::isEncrypted()
 {
     qint64 nTotalSize = getSize();
     qint64 nECDOffset = findECDOffset(nullptr);
+    CENTRALDIRECTORY_INFO centralDirectoryInfo = {};
 
-    if ((nECDOffset >= 0) && ((nECDOffset + (qint64)sizeof(ENDOFCENTRALDIRECTORYRECORD)) <= nTotalSize)) {
-        qint64 nOffset = read_uint32(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nOffsetToCentralDirectory));
-        quint16 nNumberOfRecords = read_uint16(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nTotalNumberOfRecords));
+    if ((nECDOffset >= 0) && _getCentralDirectoryInfo(nECDOffset, &centralDirectoryInfo, nullptr)) {
+        qint64 nOffset = centralDirectoryInfo.nOffset;
+        qint64 nNumberOfRecords = centralDirectoryInfo.nNumberOfRecords;
         bool bCentralDirectoryFound = false;
 
-        for (quint16 i = 0; i < nNumberOfRecords; i++) {
+        for (qint64 i = 0; i < nNumberOfRecords; i++) {
             if ((nOffset < 0) || ((nOffset + (qint64)sizeof(CENTRALDIRECTORYFILEHEADER)) > nTotalSize) || (read_uint32(nOffset) != SIGNATURE_CFD)) {
                 break;
             }
@@ -758,9 +987,10 @@ QString XZip::getCompressMethodString()
     QList<HANDLE_METHOD> listMethods;
 
     qint64 nECDOffset = findECDOffset(nullptr);
+    CENTRALDIRECTORY_INFO centralDirectoryInfo = {};
 
-    if (nECDOffset != -1) {
-        qint64 nOffset = read_uint32(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nOffsetToCentralDirectory));
+    if ((nECDOffset != -1) && _getCentralDirectoryInfo(nECDOffset, &centralDirectoryInfo, nullptr)) {
+        qint64 nOffset = centralDirectoryInfo.nOffset;
 
         for (int i = 0; i < 20; i++) {
             quint32 nSignature = read_uint32(nOffset + offsetof(CENTRALDIRECTORYFILEHEADER, nSignature));
@@ -902,8 +1132,7 @@ bool XZip::addLocalFileRecord(QIODevice *pSource, QIODevice *pDest, ZIPFILE_RECO
 
     qint64 nStartPosition = pDest->pos();
     if (pDest->isSequential() && (nStartPosition < 0)) nStartPosition = pZipFileRecord->nHeaderOffset;
-    if (!zipCanAppendAt(pDest, nStartPosition) ||
-        ((quint64)nStartPosition >= (std::numeric_limits<quint32>::max)())) {
+    if (!zipCanAppendAt(pDest, nStartPosition)) {
         return false;
     }
 
@@ -944,34 +1173,16 @@ bool XZip::addLocalFileRecord(QIODevice *pSource, QIODevice *pDest, ZIPFILE_RECO
     }
 
     record.nCompressedSize = pPayload->size();
-    if ((record.nCompressedSize < 0) ||
-        ((quint64)record.nCompressedSize >= (std::numeric_limits<quint32>::max)()) ||
-        !pPayload->seek(0)) {
+    if ((record.nCompressedSize < 0) || !pPayload->seek(0)) {
         return false;
     }
 
-    const qint64 nRecordSize = (qint64)sizeof(LOCALFILEHEADER) + baFileName.size() + record.nCompressedSize;
-    if ((quint64)nRecordSize >= ((quint64)(std::numeric_limits<quint32>::max)() - (quint64)nStartPosition)) return false;
-
+    record.bZip64 = zipIsZip64Value(record.nUncompressedSize) || zipIsZip64Value(record.nCompressedSize);
     record.nHeaderOffset = nStartPosition;
-    record.nDataOffset = nStartPosition + (qint64)sizeof(LOCALFILEHEADER) + baFileName.size();
-
-    LOCALFILEHEADER header = {};
-    header.nSignature = SIGNATURE_LFD;
-    header.nMinVersion = record.nMinVersion;
-    header.nMinOS = record.nMinOS;
-    header.nFlags = record.nFlags;
-    header.nMethod = record.method;
-    const QPair<quint16, quint16> dosDateTime = XBinary::qDateTimeToDosDateTime(record.dtTime);
-    header.nLastModDate = dosDateTime.first;
-    header.nLastModTime = dosDateTime.second;
-    header.nCRC32 = record.nCRC32;
-    header.nCompressedSize = (quint32)record.nCompressedSize;
-    header.nUncompressedSize = (quint32)record.nUncompressedSize;
-    header.nFileNameLength = (quint16)baFileName.size();
-
-    if (!zipWriteAll(pDest, reinterpret_cast<const char *>(&header), sizeof(header), pPdStruct) ||
-        !zipWriteAll(pDest, baFileName.constData(), baFileName.size(), pPdStruct) ||
+    record.nDataOffset = nStartPosition + zipGetLocalHeaderSize(record, baFileName.size());
+    zipUpdateZip64Version(&record);
+
+    if (!zipWriteLocalFileHeader(pDest, record, baFileName, pPdStruct) ||
         !zipCopyExactly(pPayload, pDest, record.nCompressedSize, pPdStruct)) {
         zipRollbackWrite(pDest, nStartPosition);
         return false;
@@ -1130,11 +1341,136 @@ static bool zipReadExact(QPointer<XZip> *pGuardedArchive, QPointer<QIODevice> *p
            (pData->size() == nLength);
 }
 
+static bool zipIsDescriptorSizesMatch(const char *pData, qint32 nSizeFieldSize, qint64 nCompressedSize, qint64 nUncompressedSize)
+{
+    if (nSizeFieldSize == 8) {
+        return (readZipLE64(pData) == (quint64)nCompressedSize) && (readZipLE64(pData + 8) == (quint64)nUncompressedSize);
+    }
+
+    return (readZipLE32(pData) == (quint64)nCompressedSize) && (readZipLE32(pData + 4) == (quint64)nUncompressedSize);
+}
+
 static bool zipLocalRangeLessThan(const QPair<qint64, qint64> &a, const QPair<qint64, qint64> &b)
 {
     return a.first < b.first;
 }
 
+bool XZip::_getCentralDirectoryInfo(qint64 nECDOffset, CENTRALDIRECTORY_INFO *pInfo, PDSTRUCT *pPdStruct)
+{
+    QPointer<XZip> guardedArchive(this);
+    QPointer<QIODevice> guardedSource(getDevice());
+    if (!pInfo || !guardedSource || (nECDOffset < 0)) return false;
+    const qint64 nSize = guardedSource->size();
+
+    QByteArray baRecord;
+    if (!zipReadExact(&guardedArchive, &guardedSource, nSize, pPdStruct, nECDOffset, sizeof(ENDOFCENTRALDIRECTORYRECORD), &baRecord)) {
+        return false;
+    }
+
+    ENDOFCENTRALDIRECTORYRECORD ecd = {};
+    memcpy(&ecd, baRecord.constData(), sizeof(ecd));
+
+    // Multi-disk archives need a volume-aware reader
+    if ((ecd.nSignature != SIGNATURE_ECD) || (ecd.nDiskNumber != 0) || (ecd.nStartDisk != 0) ||
+        (ecd.nDiskNumberOfRecords != ecd.nTotalNumberOfRecords)) {
+        return false;
+    }
+
+    const bool bSentinel = (ecd.nTotalNumberOfRecords == N_ZIP_MAX_VALUE16) || (ecd.nSizeOfCentralDirectory == N_ZIP_MAX_VALUE32) ||
+                           (ecd.nOffsetToCentralDirectory == N_ZIP_MAX_VALUE32);
+
+    CENTRALDIRECTORY_INFO info = {};
+    info.nOffset = ecd.nOffsetToCentralDirectory;
+    info.nSize = ecd.nSizeOfCentralDirectory;
+    info.nNumberOfRecords = ecd.nTotalNumberOfRecords;
+    info.nEnd = nECDOffset;
+
+    const qint64 nLocatorOffset = nECDOffset - (qint64)sizeof(ZIP64ENDOFCENTRALDIRECTORYLOCATOR);
+    bool bZip64 = false;
+
+    if (nLocatorOffset >= (qint64)sizeof(ZIP64ENDOFCENTRALDIRECTORYRECORD)) {
+        QByteArray baLocator;
+        if (!zipReadExact(&guardedArchive, &guardedSource, nSize, pPdStruct, nLocatorOffset, sizeof(ZIP64ENDOFCENTRALDIRECTORYLOCATOR),
+                          &baLocator)) {
+            return false;
+        }
+
+        ZIP64ENDOFCENTRALDIRECTORYLOCATOR locator = {};
+        memcpy(&locator, baLocator.constData(), sizeof(locator));
+
+        if ((locator.nSignature == SIGNATURE_ECDL64) && (locator.nStartDisk == 0) && (locator.nTotalNumberOfDisks <= 1) &&
+            (locator.nOffsetToZip64EndOfCentralDirectory <= (quint64)(nLocatorOffset - (qint64)sizeof(ZIP64ENDOFCENTRALDIRECTORYRECORD)))) {
+            const qint64 nZip64RecordOffset = (qint64)locator.nOffsetToZip64EndOfCentralDirectory;
+
+            QByteArray baZip64Record;
+            if (!zipReadExact(&guardedArchive, &guardedSource, nSize, pPdStruct, nZip64RecordOffset,
+                              sizeof(ZIP64ENDOFCENTRALDIRECTORYRECORD), &baZip64Record)) {
+                return false;
+            }
+
+            ZIP64ENDOFCENTRALDIRECTORYRECORD zip64Record = {};
+            memcpy(&zip64Record, baZip64Record.constData(), sizeof(zip64Record));
+
+            const quint64 nMaxValue = (quint64)(std::numeric_limits<qint64>::max)();
+
+            // The record may carry extensible data, but it must end exactly at the locator
+            if ((zip64Record.nSignature == SIGNATURE_ECD64) && (zip64Record.nDiskNumber == 0) && (zip64Record.nStartDisk == 0) &&
+                (zip64Record.nDiskNumberOfRecords == zip64Record.nTotalNumberOfRecords) &&
+                (zip64Record.nSizeOfRecord == (quint64)(nLocatorOffset - nZip64RecordOffset - 12)) &&
+                (zip64Record.nTotalNumberOfRecords <= nMaxValue) && (zip64Record.nSizeOfCentralDirectory <= nMaxValue) &&
+                (zip64Record.nOffsetToCentralDirectory <= nMaxValue)) {
+                // Classic fields either repeat the ZIP64 values or hold their sentinels
+                if (((ecd.nTotalNumberOfRecords != N_ZIP_MAX_VALUE16) && (ecd.nTotalNumberOfRecords != zip64Record.nTotalNumberOfRecords)) ||
+                    ((ecd.nSizeOfCentralDirectory != N_ZIP_MAX_VALUE32) &&
+                     (ecd.nSizeOfCentralDirectory != zip64Record.nSizeOfCentralDirectory)) ||
+                    ((ecd.nOffsetToCentralDirectory != N_ZIP_MAX_VALUE32) &&
+                     (ecd.nOffsetToCentralDirectory != zip64Record.nOffsetToCentralDirectory))) {
+                    return false;
+                }
+
+                info.nOffset = (qint64)zip64Record.nOffsetToCentralDirectory;
+                info.nSize = (qint64)zip64Record.nSizeOfCentralDirectory;
+                info.nNumberOfRecords = (qint64)zip64Record.nTotalNumberOfRecords;
+                info.nEnd = nZip64RecordOffset;
+                bZip64 = true;
+            }
+        }
+    }
+
+    // Without a valid ZIP64 record the sentinels cannot be resolved
+    if (bSentinel && !bZip64) {
+        return false;
+    }
+
+    *pInfo = info;
+
+    return guardedArchive && guardedSource && XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+bool XZip::_readZip64Values(qint64 nExtraFieldOffset, qint64 nExtraFieldLength, qint64 *pnUncompressedSize, qint64 *pnCompressedSize,
+                            qint64 *pnLocalHeaderOffset, PDSTRUCT *pPdStruct)
+{
+    QPointer<XZip> guardedArchive(this);
+    QPointer<QIODevice> guardedSource(getDevice());
+    if (!guardedSource) return false;
+
+    const bool bRequired = (pnUncompressedSize && ((quint64)*pnUncompressedSize == N_ZIP_MAX_VALUE32)) ||
+                           (pnCompressedSize && ((quint64)*pnCompressedSize == N_ZIP_MAX_VALUE32)) ||
+                           (pnLocalHeaderOffset && ((quint64)*pnLocalHeaderOffset == N_ZIP_MAX_VALUE32));
+
+    if (!bRequired) {
+        return true;
+    }
+
+    QByteArray baExtraField;
+    if (!zipReadExact(&guardedArchive, &guardedSource, guardedSource->size(), pPdStruct, nExtraFieldOffset, nExtraFieldLength,
+                      &baExtraField)) {
+        return false;
+    }
+
+    return zipApplyZip64Extra(baExtraField, pnUncompressedSize, pnCompressedSize, pnLocalHeaderOffset);
+}
+
 qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
 {
     QPointer<XZip> guardedArchive(this);
@@ -1175,31 +1511,29 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
                 continue;
             }
 
-            const quint16 nDiskNumber = ecd.nDiskNumber;
-            const quint16 nStartDisk = ecd.nStartDisk;
-            const quint16 nDiskRecords = ecd.nDiskNumberOfRecords;
-            const quint16 nTotalRecords = ecd.nTotalNumberOfRecords;
-            const quint32 nCentralDirectorySize = ecd.nSizeOfCentralDirectory;
-            const qint64 nOffsetToCentralDirectory = ecd.nOffsetToCentralDirectory;
-
-            // Multi-disk and ZIP64 archives need different record layouts and
-            // are not implemented by this reader. Do not reinterpret their
-            // sentinel values as ordinary 32-bit offsets/counts.
-            if ((nDiskNumber != 0) || (nStartDisk != 0) || (nDiskRecords != nTotalRecords) ||
-                (nTotalRecords == 0xFFFF) || (nCentralDirectorySize == 0xFFFFFFFF) ||
-                (nOffsetToCentralDirectory == 0xFFFFFFFF)) {
+            // Multi-disk archives are rejected there; ZIP64 sentinels are
+            // resolved from the ZIP64 end record, never read as 32-bit values.
+            CENTRALDIRECTORY_INFO centralDirectoryInfo = {};
+            const bool bInfo = guardedArchive->_getCentralDirectoryInfo(nCurrent, &centralDirectoryInfo, pPdStruct);
+            if (!guardedArchive || !guardedSource) return -1;
+            if (!bInfo) {
                 continue;
             }
 
+            const qint64 nTotalRecords = centralDirectoryInfo.nNumberOfRecords;
+            const qint64 nCentralDirectorySize = centralDirectoryInfo.nSize;
+            const qint64 nOffsetToCentralDirectory = centralDirectoryInfo.nOffset;
+            const qint64 nCentralDirectoryEnd = centralDirectoryInfo.nEnd;
+
             if (nTotalRecords == 0) {
-                if ((nCentralDirectorySize == 0) && (nOffsetToCentralDirectory == nCurrent)) {
+                if ((nCentralDirectorySize == 0) && (nOffsetToCentralDirectory == nCentralDirectoryEnd)) {
                     nResult = nCurrent;
                 }
                 continue;
             }
 
-            if ((nOffsetToCentralDirectory < 0) || (nOffsetToCentralDirectory > nCurrent) ||
-                ((qint64)nCentralDirectorySize != (nCurrent - nOffsetToCentralDirectory))) {
+            if ((nOffsetToCentralDirectory < 0) || (nOffsetToCentralDirectory > nCentralDirectoryEnd) ||
+                (nCentralDirectorySize != (nCentralDirectoryEnd - nOffsetToCentralDirectory))) {
                 continue;
             }
 
@@ -1208,8 +1542,8 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
             QSet<qint64> setLocalHeaderOffsets;
             QList<QPair<qint64, qint64>> listLocalRanges;
 
-            for (quint32 i = 0; i < nTotalRecords; i++) {
-                if ((nCurrent - nCurrentHeaderOffset) <
+            for (qint64 i = 0; i < nTotalRecords; i++) {
+                if ((nCentralDirectoryEnd - nCurrentHeaderOffset) <
                     (qint64)sizeof(CENTRALDIRECTORYFILEHEADER)) {
                     bValid = false;
                     break;
@@ -1228,18 +1562,25 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
                 qint64 nRecordSize = sizeof(CENTRALDIRECTORYFILEHEADER) + (qint64)cdfh.nFileNameLength + (qint64)cdfh.nExtraFieldLength +
                                      (qint64)cdfh.nFileCommentLength;
 
-                if ((cdfh.nStartDisk != 0) || (cdfh.nCompressedSize == 0xFFFFFFFF) ||
-                    (cdfh.nUncompressedSize == 0xFFFFFFFF) ||
-                    (cdfh.nOffsetToLocalFileHeader == 0xFFFFFFFF) ||
-                    ((cdfh.nMethod == CMETHOD_STORE) && !(cdfh.nFlags & 0x0001) &&
-                     (cdfh.nCompressedSize != cdfh.nUncompressedSize)) ||
-                    (nRecordSize > (nCurrent - nCurrentHeaderOffset))) {
+                if ((cdfh.nStartDisk != 0) || (nRecordSize > (nCentralDirectoryEnd - nCurrentHeaderOffset))) {
                     bValid = false;
                     break;
                 }
 
                 const qint64 nCentralNameOffset = nCurrentHeaderOffset + sizeof(CENTRALDIRECTORYFILEHEADER);
                 const qint64 nCentralExtraOffset = nCentralNameOffset + cdfh.nFileNameLength;
+
+                qint64 nCentralCompressedSize = cdfh.nCompressedSize;
+                qint64 nCentralUncompressedSize = cdfh.nUncompressedSize;
+                qint64 nLocalHeaderOffset = cdfh.nOffsetToLocalFileHeader;
+                const bool bZip64Read = guardedArchive->_readZip64Values(nCentralExtraOffset, cdfh.nExtraFieldLength, &nCentralUncompressedSize,
+                                                                         &nCentralCompressedSize, &nLocalHeaderOffset, pPdStruct);
+                if (!guardedArchive || !guardedSource) return -1;
+                if (!bZip64Read || ((cdfh.nMethod == CMETHOD_STORE) && !(cdfh.nFlags & 0x0001) &&
+                                    (nCentralCompressedSize != nCentralUncompressedSize))) {
+                    bValid = false;
+                    break;
+                }
                 QString sDecodedName;
                 const bool bNameRead = guardedArchive->_readFileName(
                     nCentralNameOffset, cdfh.nFileNameLength, cdfh.nFlags,
@@ -1251,7 +1592,6 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
                     break;
                 }
 
-                qint64 nLocalHeaderOffset = cdfh.nOffsetToLocalFileHeader;
                 if ((nLocalHeaderOffset < 0) ||
                     ((nOffsetToCentralDirectory - nLocalHeaderOffset) < (qint64)sizeof(LOCALFILEHEADER)) ||
                     setLocalHeaderOffsets.contains(nLocalHeaderOffset)) {
@@ -1268,6 +1608,16 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
                 qint64 nLocalDataOffset =
                     nLocalHeaderOffset + sizeof(LOCALFILEHEADER) + (qint64)lfh.nFileNameLength + (qint64)lfh.nExtraFieldLength;
 
+                // A local ZIP64 extra implies 8-byte sizes in the data descriptor as well
+                const bool bLocalZip64 = (lfh.nCompressedSize == N_ZIP_MAX_VALUE32) || (lfh.nUncompressedSize == N_ZIP_MAX_VALUE32);
+                qint64 nLocalCompressedSize = lfh.nCompressedSize;
+                qint64 nLocalUncompressedSize = lfh.nUncompressedSize;
+                const bool bLocalZip64Read =
+                    (lfh.nSignature == SIGNATURE_LFD) &&
+                    guardedArchive->_readZip64Values(nLocalHeaderOffset + sizeof(LOCALFILEHEADER) + lfh.nFileNameLength, lfh.nExtraFieldLength,
+                                                     &nLocalUncompressedSize, &nLocalCompressedSize, nullptr, pPdStruct);
+                if (!guardedArchive || !guardedSource) return -1;
+
                 QByteArray baLocalName;
                 QByteArray baCentralName;
                 const bool bNamesRead =
@@ -1278,58 +1628,58 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
                               cdfh.nFileNameLength, &baCentralName);
                 if (!guardedArchive || !guardedSource) return -1;
 
-                if (!bNamesRead || (lfh.nSignature != SIGNATURE_LFD) ||
+                if (!bNamesRead || !bLocalZip64Read || (lfh.nSignature != SIGNATURE_LFD) ||
                     (lfh.nMinVersion != cdfh.nMinVersion) || (lfh.nMinOS != cdfh.nMinOS) ||
                     (lfh.nFlags != cdfh.nFlags) || (lfh.nMethod != cdfh.nMethod) ||
                     (lfh.nFileNameLength != cdfh.nFileNameLength) || (nLocalDataOffset > nOffsetToCentralDirectory) ||
-                    ((qint64)cdfh.nCompressedSize > (nOffsetToCentralDirectory - nLocalDataOffset)) ||
+                    (nCentralCompressedSize > (nOffsetToCentralDirectory - nLocalDataOffset)) ||
                     (baLocalName != baCentralName) ||
                     (!(lfh.nFlags & 0x0008) &&
-                     ((lfh.nCRC32 != cdfh.nCRC32) || (lfh.nCompressedSize != cdfh.nCompressedSize) ||
-                      (lfh.nUncompressedSize != cdfh.nUncompressedSize)))) {
+                     ((lfh.nCRC32 != cdfh.nCRC32) || (nLocalCompressedSize != nCentralCompressedSize) ||
+                      (nLocalUncompressedSize != nCentralUncompressedSize)))) {
                     bValid = false;
                     break;
                 }
 
-                qint64 nLocalRecordEnd = nLocalDataOffset + (qint64)cdfh.nCompressedSize;
+                qint64 nLocalRecordEnd = nLocalDataOffset + nCentralCompressedSize;
                 if (lfh.nFlags & 0x0008) {
                     // With bit 3 set, local size/CRC fields are placeholders and
                     // the descriptor is the authenticated source of those values.
                     if (((lfh.nCRC32 != 0) && (lfh.nCRC32 != cdfh.nCRC32)) ||
-                        ((lfh.nCompressedSize != 0) && (lfh.nCompressedSize != cdfh.nCompressedSize)) ||
-                        ((lfh.nUncompressedSize != 0) && (lfh.nUncompressedSize != cdfh.nUncompressedSize))) {
+                        ((nLocalCompressedSize != 0) && (nLocalCompressedSize != nCentralCompressedSize)) ||
+                        ((nLocalUncompressedSize != 0) && (nLocalUncompressedSize != nCentralUncompressedSize))) {
                         bValid = false;
                         break;
                     }
 
                     const qint64 nDescriptorOffset = nLocalRecordEnd;
+                    const qint32 nSizeFieldSize = bLocalZip64 ? 8 : 4;
+                    const qint64 nUnsignedDescriptorSize = 4 + 2 * nSizeFieldSize;
                     bool bDescriptorValid = false;
                     qint64 nDescriptorSize = 0;
                     QByteArray baDescriptor;
                     const qint64 nAvailableDescriptor =
                         nOffsetToCentralDirectory - nDescriptorOffset;
                     const qint64 nDescriptorReadSize =
-                        qMin<qint64>(16, qMax<qint64>(0, nAvailableDescriptor));
-                    if ((nDescriptorReadSize >= 12) &&
+                        qMin<qint64>(nUnsignedDescriptorSize + 4, qMax<qint64>(0, nAvailableDescriptor));
+                    if ((nDescriptorReadSize >= nUnsignedDescriptorSize) &&
                         !zipReadExact(&guardedArchive, &guardedSource, nSize, pPdStruct,nDescriptorOffset, nDescriptorReadSize,
                                    &baDescriptor)) return -1;
                     char *pDescriptor = baDescriptor.data();
-                    if ((baDescriptor.size() >= 16) &&
+                    if ((baDescriptor.size() >= (nUnsignedDescriptorSize + 4)) &&
                         (XBinary::_read_uint32(pDescriptor) == 0x08074B50) &&
                         (XBinary::_read_uint32(pDescriptor + 4) == cdfh.nCRC32) &&
-                        (XBinary::_read_uint32(pDescriptor + 8) == cdfh.nCompressedSize) &&
-                        (XBinary::_read_uint32(pDescriptor + 12) == cdfh.nUncompressedSize)) {
+                        zipIsDescriptorSizesMatch(pDescriptor + 8, nSizeFieldSize, nCentralCompressedSize, nCentralUncompressedSize)) {
                             bDescriptorValid = true;
-                            nDescriptorSize = 16;
+                            nDescriptorSize = nUnsignedDescriptorSize + 4;
                     }
                     // A signature is optional, and a legitimate CRC may itself
                     // equal 0x08074B50. Check the unsigned form independently.
-                    if (!bDescriptorValid && (baDescriptor.size() >= 12) &&
+                    if (!bDescriptorValid && (baDescriptor.size() >= nUnsignedDescriptorSize) &&
                         (XBinary::_read_uint32(pDescriptor) == cdfh.nCRC32) &&
-                        (XBinary::_read_uint32(pDescriptor + 4) == cdfh.nCompressedSize) &&
-                        (XBinary::_read_uint32(pDescriptor + 8) == cdfh.nUncompressedSize)) {
+                        zipIsDescriptorSizesMatch(pDescriptor + 4, nSizeFieldSize, nCentralCompressedSize, nCentralUncompressedSize)) {
                         bDescriptorValid = true;
-                        nDescriptorSize = 12;
+                        nDescriptorSize = nUnsignedDescriptorSize;
                     }
                     if (!bDescriptorValid) {
                         bValid = false;
@@ -1358,15 +1708,15 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
 
             // The optional central-directory digital-signature and archive-extra
             // records are not files and are not included in the EOCD entry count.
-            while (bValid && (nCurrentHeaderOffset < nCurrent)) {
-                if ((nCurrent - nCurrentHeaderOffset) < 6) {
+            while (bValid && (nCurrentHeaderOffset < nCentralDirectoryEnd)) {
+                if ((nCentralDirectoryEnd - nCurrentHeaderOffset) < 6) {
                     bValid = false;
                     break;
                 }
 
                 QByteArray baOptionalHeader;
                 if (!zipReadExact(&guardedArchive, &guardedSource, nSize, pPdStruct,nCurrentHeaderOffset,
-                               qMin<qint64>(8, nCurrent - nCurrentHeaderOffset),
+                               qMin<qint64>(8, nCentralDirectoryEnd - nCurrentHeaderOffset),
                                &baOptionalHeader)) return -1;
                 const quint32 nSignature = XBinary::_read_uint32(
                     baOptionalHeader.data());
@@ -1375,7 +1725,7 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
                     nRecordSize = 6 + (qint64)XBinary::_read_uint16(
                                               baOptionalHeader.data() + 4);
                 } else if (nSignature == 0x08064B50) {  // archive extra data record
-                    if ((nCurrent - nCurrentHeaderOffset) < 8) {
+                    if ((nCentralDirectoryEnd - nCurrentHeaderOffset) < 8) {
                         bValid = false;
                         break;
                     }
@@ -1386,14 +1736,14 @@ qint64 XZip::findECDOffset(PDSTRUCT *pPdStruct)
                     break;
                 }
 
-                if ((nRecordSize <= 0) || (nRecordSize > (nCurrent - nCurrentHeaderOffset))) {
+                if ((nRecordSize <= 0) || (nRecordSize > (nCentralDirectoryEnd - nCurrentHeaderOffset))) {
                     bValid = false;
                     break;
                 }
                 nCurrentHeaderOffset += nRecordSize;
             }
 
-            if (bValid && (nCurrentHeaderOffset == nCurrent)) {
+            if (bValid && (nCurrentHeaderOffset == nCentralDirectoryEnd)) {
                 nResult = nCurrent;
             }
         }
@@ -1738,9 +2088,12 @@ QList<XBinary::FPART> XZip::getFileParts(quint32 nFileParts, qint32 nLimit, PDST
     if (nECDOffset != -1) {
         if ((nTotalSize >= (qint64)sizeof(ENDOFCENTRALDIRECTORYRECORD)) &&
             (nECDOffset <= (nTotalSize - (qint64)sizeof(ENDOFCENTRALDIRECTORYRECORD)))) {
-            quint16 nTotalNumberOfRecords = read_uint16(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nTotalNumberOfRecords));
-            quint32 nSizeOfCentralDirectory = read_uint32(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nSizeOfCentralDirectory));
-            quint32 nOffsetToCentralDirectory = read_uint32(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nOffsetToCentralDirectory));
+            CENTRALDIRECTORY_INFO centralDirectoryInfo = {};
+            const bool bCentralDirectoryInfo = _getCentralDirectoryInfo(nECDOffset, &centralDirectoryInfo, pPdStruct);
+            const qint64 nTotalNumberOfRecords = centralDirectoryInfo.nNumberOfRecords;
+            const qint64 nSizeOfCentralDirectory = centralDirectoryInfo.nSize;
+            const qint64 nOffsetToCentralDirectory = centralDirectoryInfo.nOffset;
+            const qint64 nCentralDirectoryEnd = centralDirectoryInfo.nEnd;
             quint16 nCommentLength = read_uint16(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nCommentLength));
 
             nMaxOffset = qMin(nECDOffset + (qint64)sizeof(ENDOFCENTRALDIRECTORYRECORD) + (qint64)nCommentLength, nTotalSize);
@@ -1757,13 +2110,13 @@ QList<XBinary::FPART> XZip::getFileParts(quint32 nFileParts, qint32 nLimit, PDST
                 listResult.append(record);
             }
 
-            if ((nFileParts & FILEPART_HEADER) || (nFileParts & FILEPART_STREAM)) {
-                if (((qint64)nOffsetToCentralDirectory < nECDOffset) &&
-                    ((qint64)nSizeOfCentralDirectory <= (nECDOffset - (qint64)nOffsetToCentralDirectory))) {
+            if (bCentralDirectoryInfo && ((nFileParts & FILEPART_HEADER) || (nFileParts & FILEPART_STREAM))) {
+                if ((nOffsetToCentralDirectory < nCentralDirectoryEnd) &&
+                    (nSizeOfCentralDirectory <= (nCentralDirectoryEnd - nOffsetToCentralDirectory))) {
                     qint64 nOffset = nOffsetToCentralDirectory;
 
-                    for (qint32 i = 0; (i < nTotalNumberOfRecords) && zipPartsCanAppend(nLimit, &listResult) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
-                        if ((nOffset >= 0) && ((nECDOffset - nOffset) >= (qint64)sizeof(CENTRALDIRECTORYFILEHEADER))) {
+                    for (qint64 i = 0; (i < nTotalNumberOfRecords) && zipPartsCanAppend(nLimit, &listResult) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
+                        if ((nOffset >= 0) && ((nCentralDirectoryEnd - nOffset) >= (qint64)sizeof(CENTRALDIRECTORYFILEHEADER))) {
                             CENTRALDIRECTORYFILEHEADER cdh = read_CENTRALDIRECTORYFILEHEADER(nOffset, pPdStruct);
                             const qint64 nCentralRecordSize = sizeof(CENTRALDIRECTORYFILEHEADER) +
                                                               (qint64)cdh.nFileNameLength +
@@ -1771,7 +2124,7 @@ QList<XBinary::FPART> XZip::getFileParts(quint32 nFileParts, qint32 nLimit, PDST
                                                               (qint64)cdh.nFileCommentLength;
 
                             if ((cdh.nSignature == SIGNATURE_CFD) &&
-                                (nCentralRecordSize <= (nECDOffset - nOffset))) {
+                                (nCentralRecordSize <= (nCentralDirectoryEnd - nOffset))) {
                                 const qint64 nCentralNameOffset = nOffset + sizeof(CENTRALDIRECTORYFILEHEADER);
                                 const qint64 nCentralExtraOffset = nCentralNameOffset + cdh.nFileNameLength;
                                 QString sOriginalName;
@@ -1780,6 +2133,14 @@ QList<XBinary::FPART> XZip::getFileParts(quint32 nFileParts, qint32 nLimit, PDST
                                     break;
                                 }
 
+                                qint64 nCompressedSize = cdh.nCompressedSize;
+                                qint64 nUncompressedSize = cdh.nUncompressedSize;
+                                qint64 nLocalOffset = cdh.nOffsetToLocalFileHeader;
+                                if (!_readZip64Values(nCentralExtraOffset, cdh.nExtraFieldLength, &nUncompressedSize, &nCompressedSize,
+                                                      &nLocalOffset, pPdStruct)) {
+                                    break;
+                                }
+
                                 if ((nFileParts & FILEPART_HEADER) && zipPartsCanAppend(nLimit, &listResult)) {
                                     FPART record = {};
 
@@ -1793,8 +2154,6 @@ QList<XBinary::FPART> XZip::getFileParts(quint32 nFileParts, qint32 nLimit, PDST
                                     listResult.append(record);
                                 }
 
-                                qint64 nLocalOffset = cdh.nOffsetToLocalFileHeader;
-
                                 if ((nLocalOffset >= 0) &&
                                     ((qint64)nOffsetToCentralDirectory - nLocalOffset >= (qint64)sizeof(LOCALFILEHEADER))) {
                                     LOCALFILEHEADER lfh = read_LOCALFILEHEADER(nLocalOffset, pPdStruct);
@@ -1804,8 +2163,7 @@ QList<XBinary::FPART> XZip::getFileParts(quint32 nFileParts, qint32 nLimit, PDST
 
                                     if ((lfh.nSignature == SIGNATURE_LFD) &&
                                         (nLocalDataOffset <= (qint64)nOffsetToCentralDirectory) &&
-                                        ((qint64)cdh.nCompressedSize <=
-                                         ((qint64)nOffsetToCentralDirectory - nLocalDataOffset))) {
+                                        (nCompressedSize <= ((qint64)nOffsetToCentralDirectory - nLocalDataOffset))) {
                                         if ((nFileParts & FILEPART_HEADER) || (nFileParts & FILEPART_STREAM)) {
                                             QString sName = QString("%1 %2").arg(tr("Stream")).arg(QString::number(i));
 
@@ -1827,13 +2185,13 @@ QList<XBinary::FPART> XZip::getFileParts(quint32 nFileParts, qint32 nLimit, PDST
 
                                                 record.filePart = FILEPART_STREAM;
                                                 record.nFileOffset = nLocalDataOffset;
-                                                record.nFileSize = cdh.nCompressedSize;
+                                                record.nFileSize = nCompressedSize;
                                                 record.nVirtualAddress = XADDR_MAX;
                                                 record.sName = sName;
                                                 record.mapProperties.insert(FPART_PROP_ORIGINALNAME, sOriginalName);
                                                 record.mapProperties.insert(FPART_PROP_HANDLEMETHOD, zipToCompressMethod(cdh.nMethod, cdh.nFlags));
-                                                record.mapProperties.insert(FPART_PROP_COMPRESSEDSIZE, cdh.nCompressedSize);
-                                                record.mapProperties.insert(FPART_PROP_UNCOMPRESSEDSIZE, cdh.nUncompressedSize);
+                                                record.mapProperties.insert(FPART_PROP_COMPRESSEDSIZE, nCompressedSize);
+                                                record.mapProperties.insert(FPART_PROP_UNCOMPRESSEDSIZE, nUncompressedSize);
 
                                                 qint64 nExtraFieldOffset = nOffset + sizeof(CENTRALDIRECTORYFILEHEADER) + cdh.nFileNameLength;
                                                 bool bHasUsableCRC = !((cdh.nMethod == CMETHOD_AES) &&
@@ -1975,15 +2333,20 @@ bool XZip::_isRecordNamePresent(qint64 nECDOffset, QString sRecordName1,
     qint64 nTotalSize = getSize();
 
     if (nECDOffset != -1) {
-        qint32 nNumberOfRecords = read_uint16(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nTotalNumberOfRecords));
+        CENTRALDIRECTORY_INFO centralDirectoryInfo = {};
+        if (!_getCentralDirectoryInfo(nECDOffset, &centralDirectoryInfo, pPdStruct)) {
+            return false;
+        }
+
+        qint64 nNumberOfRecords = centralDirectoryInfo.nNumberOfRecords;
 
         if (nLimit != -1) {
-            nNumberOfRecords = qMin(nNumberOfRecords, nLimit);
+            nNumberOfRecords = qMin(nNumberOfRecords, (qint64)nLimit);
         }
 
-        qint64 nOffset = read_uint32(nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD, nOffsetToCentralDirectory));
+        qint64 nOffset = centralDirectoryInfo.nOffset;
 
-        for (qint32 i = 0; i < (nNumberOfRecords) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
+        for (qint64 i = 0; i < (nNumberOfRecords) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
             CENTRALDIRECTORYFILEHEADER cdh = read_CENTRALDIRECTORYFILEHEADER(nOffset, pPdStruct);
 
             if (cdh.nSignature != SIGNATURE_CFD) {
@@ -2181,8 +2544,7 @@ bool XZip::initPack(PACK_STATE *pState, QIODevice *pDevice, const QMap<PACK_PROP
 
     qint64 nStartOffset = pDevice->pos();
     if (pDevice->isSequential() && (nStartOffset < 0)) nStartOffset = 0;
-    if (!zipCanAppendAt(pDevice, nStartOffset) ||
-        ((quint64)nStartOffset >= (std::numeric_limits<quint32>::max)())) return false;
+    if (!zipCanAppendAt(pDevice, nStartOffset)) return false;
 
     ZIP_PACK_CONTEXT *pNewContext = new (std::nothrow) ZIP_PACK_CONTEXT();
     if (!pNewContext) return false;
@@ -2217,8 +2579,7 @@ bool XZip::initPack(PACK_STATE *pState, QIODevice *pDevice, const QMap<PACK_PROP
 
     nStartOffset = pDevice->pos();
     if (pDevice->isSequential() && (nStartOffset < 0)) nStartOffset = 0;
-    if (!zipCanAppendAt(pDevice, nStartOffset) ||
-        ((quint64)nStartOffset >= (std::numeric_limits<quint32>::max)())) {
+    if (!zipCanAppendAt(pDevice, nStartOffset)) {
         zipDeletePackContext(pNewContext);
         *pState = PACK_STATE();
         return false;
@@ -2238,39 +2599,110 @@ bool XZip::initPack(PACK_STATE *pState, QIODevice *pDevice, const QMap<PACK_PROP
     return true;
 }
 
-bool XZip::addFile(PACK_STATE *pState, const QString &sFilePath, PDSTRUCT *pPdStruct)
+namespace {
+// Members below this size are read and compressed in memory by worker threads. Larger ones are
+// streamed into the archive; their deflate blocks are compressed in parallel instead.
+const qint64 N_ZIP_BUFFERED_MEMBER_SIZE = 0x100000;
+const qint64 N_ZIP_BATCH_INPUT_SIZE = 0x4000000;
+const qint32 N_ZIP_MEMBERS_PER_THREAD = 4;
+
+// Large members of unknown size (nUncompressedSize == -1) can only come from a device
+const qint64 N_ZIP64_STREAMED_MEMBER_SIZE = 0xFF000000;
+
+struct ZIP_PACK_MEMBER {
+    QString sFilePath;
+    QIODevice *pSource;  // Read instead of sFilePath when set
+    QByteArray baFileName;
+    XZip::ZIPFILE_RECORD record;
+    qint32 nCompressionLevel;
+    QString sPassword;
+    QByteArray baPayload;
+    bool bValid;
+};
+
+// Method, encryption and level are shared by file and device members
+bool zipInitMember(const XBinary::PACK_STATE *pState, const QString &sStoredPath, ZIP_PACK_MEMBER *pMember)
 {
-    if (!pState || !pState->pDevice || !pState->pDevice->isWritable() || !pState->pContext ||
-        !XBinary::isPdStructNotCanceled(pPdStruct)) {
+    XBinary::HANDLE_METHOD compressMethod =
+        (XBinary::HANDLE_METHOD)pState->mapProperties.value(XBinary::PACK_PROP_COMPRESSMETHOD, XBinary::HANDLE_METHOD_DEFLATE).toInt();
+    XBinary::CRYPTO_METHOD cryptoMethod =
+        (XBinary::CRYPTO_METHOD)pState->mapProperties.value(XBinary::PACK_PROP_ENCRYPTIONMETHOD, XBinary::CRYPTO_METHOD_NONE).toInt();
+    QString sPassword = pState->mapProperties.value(XBinary::PACK_PROP_PASSWORD).toString();
+    qint32 nCompressionLevel = pState->mapProperties.value(XBinary::PACK_PROP_COMPRESSIONLEVEL, -1).toInt();
+
+    QString sFileName = sStoredPath;
+    sFileName = sFileName.replace("\\", "/");
+    const QByteArray baFileName = sFileName.toUtf8();
+    if (baFileName.isEmpty() || (baFileName.size() > (std::numeric_limits<quint16>::max)())) return false;
+
+    // Levels: deflate and LZMA 0..9, Zstandard 1..22
+    XZip::CMETHOD cmethod = XZip::CMETHOD_STORE;
+    qint32 nDefaultLevel = 8;
+    qint32 nMinLevel = 0;
+    qint32 nMaxLevel = 9;
+    if (compressMethod == XBinary::HANDLE_METHOD_DEFLATE) {
+        cmethod = XZip::CMETHOD_DEFLATE;
+    } else if (compressMethod == XBinary::HANDLE_METHOD_LZMA) {
+        cmethod = XZip::CMETHOD_LZMA;
+        nDefaultLevel = 5;
+    } else if (compressMethod == XBinary::HANDLE_METHOD_ZSTD) {
+        cmethod = XZip::CMETHOD_ZSTD;
+        nDefaultLevel = 3;
+        nMinLevel = 1;
+        nMaxLevel = 22;
+    } else if (compressMethod != XBinary::HANDLE_METHOD_STORE) {
         return false;
     }
+    if ((cryptoMethod != XBinary::CRYPTO_METHOD_NONE) && (cryptoMethod != XBinary::CRYPTO_METHOD_ZIPCRYPTO)) return false;
+    if (!sPassword.isEmpty() && (cryptoMethod != XBinary::CRYPTO_METHOD_ZIPCRYPTO)) return false;
 
-    ZIP_PACK_CONTEXT *pContext = static_cast<ZIP_PACK_CONTEXT *>(pState->pContext);
-    QList<ZIPFILE_RECORD> *pListZipFileRecords = pContext->pListZipFileRecords;
-    if (pContext->bFailed || !zipIsPackStateConsistent(pState, pContext) ||
-        (pListZipFileRecords->size() >= ((std::numeric_limits<quint16>::max)() - 1)) ||
-        ((quint64)pContext->nCurrentOffset >= (std::numeric_limits<quint32>::max)())) {
-        return false;
+    if (nCompressionLevel == -1) {
+        nCompressionLevel = nDefaultLevel;
     }
+    if ((nCompressionLevel < nMinLevel) || (nCompressionLevel > nMaxLevel)) return false;
 
+    const bool bExtendedMethod = (cmethod == XZip::CMETHOD_LZMA) || (cmethod == XZip::CMETHOD_ZSTD);
+
+    XZip::ZIPFILE_RECORD zipFileRecord = {};
+    zipFileRecord.sFileName = sFileName;
+    zipFileRecord.nVersion = bExtendedMethod ? ZIP_VERSION_LZMA : 0x14;
+    zipFileRecord.nOS = 0;
+    zipFileRecord.nMinVersion = bExtendedMethod ? ZIP_VERSION_LZMA : 0x14;
+    zipFileRecord.nMinOS = 0;
+    zipFileRecord.nFlags = ZIP_FLAG_UTF8;
+    if (cmethod == XZip::CMETHOD_LZMA) zipFileRecord.nFlags |= ZIP_FLAG_LZMA_EOS;
+    zipFileRecord.method = cmethod;
+    zipFileRecord.dtTime = QDateTime::currentDateTime();
+    zipFileRecord.nUncompressedSize = -1;
+
+    const bool bEncrypt = !sPassword.isEmpty() && (cryptoMethod == XBinary::CRYPTO_METHOD_ZIPCRYPTO);
+    if (bEncrypt) zipFileRecord.nFlags |= ZIP_FLAG_ENCRYPTED;
+
+    pMember->sFilePath.clear();
+    pMember->pSource = nullptr;
+    pMember->baFileName = baFileName;
+    pMember->record = zipFileRecord;
+    pMember->nCompressionLevel = nCompressionLevel;
+    pMember->sPassword = bEncrypt ? sPassword : QString();
+    pMember->baPayload.clear();
+    pMember->bValid = false;
+
+    return true;
+}
+
+bool zipPrepareMember(const XBinary::PACK_STATE *pState, const QString &sFilePath, ZIP_PACK_MEMBER *pMember)
+{
     QFileInfo fileInfo(sFilePath);
     if (!fileInfo.exists() || !fileInfo.isFile() || !fileInfo.isReadable()) {
         return false;
     }
     const qint64 nFileSize = fileInfo.size();
-    if ((nFileSize < 0) || ((quint64)nFileSize >= (std::numeric_limits<quint32>::max)())) return false;
+    if (nFileSize < 0) return false;
 
     QString sStoredPath;
-    PATH_MODE pathMode = (PATH_MODE)pState->mapProperties.value(PACK_PROP_PATHMODE, PATH_MODE_BASENAME).toInt();
-    QString sBasePath = pState->mapProperties.value(PACK_PROP_BASEPATH).toString();
-    if ((pathMode != XBinary::PATH_MODE_DEFAULT) && (pathMode != XBinary::PATH_MODE_RELATIVE) &&
-        (pathMode != XBinary::PATH_MODE_BASENAME) && (pathMode != XBinary::PATH_MODE_ABSOLUTE)) {
-        return false;
-    }
-    HANDLE_METHOD compressMethod = (HANDLE_METHOD)pState->mapProperties.value(PACK_PROP_COMPRESSMETHOD, HANDLE_METHOD_DEFLATE).toInt();
-    CRYPTO_METHOD cryptoMethod = (CRYPTO_METHOD)pState->mapProperties.value(PACK_PROP_ENCRYPTIONMETHOD, CRYPTO_METHOD_NONE).toInt();
-    QString sPassword = pState->mapProperties.value(PACK_PROP_PASSWORD).toString();
-    qint32 nCompressionLevel = pState->mapProperties.value(PACK_PROP_COMPRESSIONLEVEL, -1).toInt();
+    XBinary::PATH_MODE pathMode =
+        (XBinary::PATH_MODE)pState->mapProperties.value(XBinary::PACK_PROP_PATHMODE, XBinary::PATH_MODE_BASENAME).toInt();
+    QString sBasePath = pState->mapProperties.value(XBinary::PACK_PROP_BASEPATH).toString();
 
     switch (pathMode) {
         case XBinary::PATH_MODE_ABSOLUTE: sStoredPath = fileInfo.absoluteFilePath(); break;
@@ -2287,146 +2719,467 @@ bool XZip::addFile(PACK_STATE *pState, const QString &sFilePath, PDSTRUCT *pPdSt
         default: return false;
     }
 
-    sStoredPath = sStoredPath.replace("\\", "/");
-    const QByteArray baFileName = sStoredPath.toUtf8();
-    if (baFileName.isEmpty() || (baFileName.size() > (std::numeric_limits<quint16>::max)())) return false;
+    if (!zipInitMember(pState, sStoredPath, pMember)) return false;
 
-    CMETHOD cmethod = CMETHOD_STORE;
-    if (compressMethod == XArchive::HANDLE_METHOD_DEFLATE) cmethod = CMETHOD_DEFLATE;
-    else if (compressMethod != XArchive::HANDLE_METHOD_STORE) return false;
-    if ((cryptoMethod != XBinary::CRYPTO_METHOD_NONE) && (cryptoMethod != XBinary::CRYPTO_METHOD_ZIPCRYPTO)) return false;
-    if (!sPassword.isEmpty() && (cryptoMethod != XBinary::CRYPTO_METHOD_ZIPCRYPTO)) return false;
+    pMember->sFilePath = sFilePath;
+    pMember->record.dtTime = fileInfo.lastModified();
+    pMember->record.nUncompressedSize = nFileSize;
+    pMember->record.nExternalFileAttributes = XZip::filePermissionsToExternalAttributes(fileInfo.permissions());
 
-    ZIPFILE_RECORD zipFileRecord = {};
-    zipFileRecord.sFileName = sStoredPath;
-    zipFileRecord.nVersion = 0x14;
-    zipFileRecord.nOS = 0;
-    zipFileRecord.nMinVersion = 0x14;
-    zipFileRecord.nMinOS = 0;
-    zipFileRecord.nFlags = ZIP_FLAG_UTF8;
-    zipFileRecord.method = cmethod;
-    zipFileRecord.dtTime = fileInfo.lastModified();
-    zipFileRecord.nUncompressedSize = nFileSize;
+    return true;
+}
 
-    if (nCompressionLevel == -1) {
-        nCompressionLevel = 8;
+// Worker side: one read of the source, CRC over the same bytes, compression and encryption in memory
+void zipCompressMemberToBuffer(ZIP_PACK_MEMBER *pMember, XBinary::PDSTRUCT *pPdStruct)
+{
+    pMember->bValid = false;
+    pMember->baPayload.clear();
+
+    QFile file(pMember->sFilePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QByteArray baSource = file.read(pMember->record.nUncompressedSize + 1);
+    file.close();
+    if (baSource.size() != pMember->record.nUncompressedSize) return;
+
+    pMember->record.nCRC32 = XBinary::_getCRC32(baSource, 0xFFFFFFFF, XBinary::_getCRC32Table_EDB88320()) ^ 0xFFFFFFFF;
+
+    QByteArray baCompressed;
+
+    if (pMember->record.method == XZip::CMETHOD_STORE) {
+        baCompressed = baSource;
+    } else {
+        QBuffer bufferIn(&baSource);
+        QBuffer bufferOut(&baCompressed);
+        if (!bufferIn.open(QIODevice::ReadOnly) || !bufferOut.open(QIODevice::WriteOnly)) return;
+
+        XBinary::DATAPROCESS_STATE compressState = {};
+        compressState.pDeviceInput = &bufferIn;
+        compressState.pDeviceOutput = &bufferOut;
+        compressState.nInputOffset = 0;
+        compressState.nInputLimit = baSource.size();
+
+        bool bCompressed = false;
+        if (pMember->record.method == XZip::CMETHOD_DEFLATE) {
+            bCompressed = XDeflateDecoder::compress(&compressState, pPdStruct, pMember->nCompressionLevel);
+        } else if (pMember->record.method == XZip::CMETHOD_LZMA) {
+            bCompressed = XLZMADecoder::compress(&compressState, pPdStruct, pMember->nCompressionLevel);
+        } else if (pMember->record.method == XZip::CMETHOD_ZSTD) {
+            bCompressed = XZstdDecoder::compress(&compressState, pPdStruct, pMember->nCompressionLevel);
+        }
+        if (!bCompressed) return;
+        bufferOut.close();
     }
-    if ((nCompressionLevel < 0) || (nCompressionLevel > 9)) return false;
 
-    QFile::Permissions permissions = fileInfo.permissions();
-    zipFileRecord.nExternalFileAttributes = filePermissionsToExternalAttributes(permissions);
+    if (!pMember->sPassword.isEmpty()) {
+        QByteArray baEncrypted;
+        QBuffer bufferIn(&baCompressed);
+        QBuffer bufferOut(&baEncrypted);
+        if (!bufferIn.open(QIODevice::ReadOnly) || !bufferOut.open(QIODevice::WriteOnly)) return;
 
-    QFile file(sFilePath);
-    if (!file.open(QIODevice::ReadOnly)) return false;
-    QTemporaryFile stagedSource;
-    qint64 nStagedSize = 0;
-    if (!zipStageSource(&file, &stagedSource, nFileSize, pPdStruct, &nStagedSize, &zipFileRecord.nCRC32) ||
-        (nStagedSize != nFileSize)) {
+        XBinary::DATAPROCESS_STATE encryptState = {};
+        encryptState.pDeviceInput = &bufferIn;
+        encryptState.pDeviceOutput = &bufferOut;
+        encryptState.nInputOffset = 0;
+        encryptState.nInputLimit = baCompressed.size();
+        if (!XZipCryptoDecoder::encrypt(&encryptState, pMember->sPassword, pMember->record.nCRC32, pPdStruct)) return;
+        bufferOut.close();
+        pMember->baPayload = baEncrypted;
+    } else {
+        pMember->baPayload = baCompressed;
+    }
+
+    pMember->record.nCompressedSize = pMember->baPayload.size();
+    pMember->bValid = XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+void zipRunMemberJobs(ZIP_PACK_MEMBER *pMembers, qint32 nNumberOfMembers, QAtomicInt *pNextMember, XBinary::PDSTRUCT *pPdStruct)
+{
+    while (true) {
+        const qint32 nIndex = pNextMember->fetchAndAddOrdered(1);
+
+        if (nIndex >= nNumberOfMembers) {
+            break;
+        }
+
+        if (!XBinary::isPdStructNotCanceled(pPdStruct)) {
+            continue;
+        }
+
+        zipCompressMemberToBuffer(&(pMembers[nIndex]), pPdStruct);
+    }
+}
+
+class XZipMemberWorker : public QRunnable {
+public:
+    XZipMemberWorker(ZIP_PACK_MEMBER *pMembers, qint32 nNumberOfMembers, QAtomicInt *pNextMember, XBinary::PDSTRUCT *pPdStruct)
+        : m_pMembers(pMembers), m_nNumberOfMembers(nNumberOfMembers), m_pNextMember(pNextMember), m_pPdStruct(pPdStruct)
+    {
+    }
+
+    void run() override
+    {
+        zipRunMemberJobs(m_pMembers, m_nNumberOfMembers, m_pNextMember, m_pPdStruct);
+    }
+
+private:
+    ZIP_PACK_MEMBER *m_pMembers;
+    qint32 m_nNumberOfMembers;
+    QAtomicInt *m_pNextMember;
+    XBinary::PDSTRUCT *m_pPdStruct;
+};
+
+bool zipCanAddMember(const XBinary::PACK_STATE *pState, const XZip::ZIP_PACK_CONTEXT *pContext)
+{
+    return !pContext->bFailed && zipIsPackStateConsistent(pState, pContext) &&
+           (pContext->pListZipFileRecords->size() < (std::numeric_limits<qint32>::max)());
+}
+
+void zipCommitMember(XBinary::PACK_STATE *pState, XZip::ZIP_PACK_CONTEXT *pContext, const XZip::ZIPFILE_RECORD &record, qint64 nEndOffset)
+{
+    pContext->pListZipFileRecords->append(record);
+    pContext->nCurrentOffset = nEndOffset;
+    pContext->nNumberOfRecords = pContext->pListZipFileRecords->size();
+    pState->nCurrentOffset = pContext->nCurrentOffset;
+    pState->nNumberOfRecords = pContext->nNumberOfRecords;
+}
+
+// The payload comes from pPayload when given, otherwise from the member's in-memory buffer
+bool zipAppendMemberPayload(XBinary::PACK_STATE *pState, XZip::ZIP_PACK_CONTEXT *pContext, ZIP_PACK_MEMBER *pMember, QIODevice *pPayload,
+                            qint64 nPayloadSize, XBinary::PDSTRUCT *pPdStruct)
+{
+    if (!zipCanAddMember(pState, pContext) || !XBinary::isPdStructNotCanceled(pPdStruct)) return false;
+    if (nPayloadSize < 0) return false;
+
+    XZip::ZIPFILE_RECORD &record = pMember->record;
+    record.nCompressedSize = nPayloadSize;
+    record.bZip64 = zipIsZip64Value(record.nUncompressedSize) || zipIsZip64Value(record.nCompressedSize);
+
+    const qint64 nStartPosition = pContext->nCurrentOffset;
+    record.nHeaderOffset = nStartPosition;
+    record.nDataOffset = nStartPosition + zipGetLocalHeaderSize(record, pMember->baFileName.size());
+    zipUpdateZip64Version(&record);
+
+    const qint64 nRecordSize = zipGetLocalHeaderSize(record, pMember->baFileName.size()) + nPayloadSize;
+
+    pContext->pListZipFileRecords->reserve(pContext->pListZipFileRecords->size() + 1);
+    qint64 nRecordWritten = 0;
+    qint64 nPartWritten = 0;
+    bool bWriteOK = zipWriteLocalFileHeader(pState->pDevice, record, pMember->baFileName, pPdStruct, &nPartWritten);
+    nRecordWritten += nPartWritten;
+    if (bWriteOK) {
+        if (pPayload) {
+            bWriteOK = zipCopyExactly(pPayload, pState->pDevice, nPayloadSize, pPdStruct, &nPartWritten);
+        } else {
+            bWriteOK = (pMember->baPayload.size() == nPayloadSize) &&
+                       zipWriteAll(pState->pDevice, pMember->baPayload.constData(), nPayloadSize, pPdStruct, &nPartWritten);
+        }
+        nRecordWritten += nPartWritten;
+    }
+    if (!bWriteOK || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        zipMarkPackWriteFailure(pState, pContext, nStartPosition, nRecordWritten);
         return false;
     }
-    zipFileRecord.nUncompressedSize = nStagedSize;
 
-    QPair<quint16, quint16> dosDateTime = XBinary::qDateTimeToDosDateTime(zipFileRecord.dtTime);
-    quint16 nDosDate = dosDateTime.first;
-    quint16 nDosTime = dosDateTime.second;
+    pMember->baPayload.clear();
+    zipCommitMember(pState, pContext, record, nStartPosition + nRecordSize);
+    return true;
+}
 
-    bool bEncrypt = !sPassword.isEmpty() && (cryptoMethod == XBinary::CRYPTO_METHOD_ZIPCRYPTO);
-    if (bEncrypt) zipFileRecord.nFlags |= 0x01;
+bool zipAppendBufferedMember(XBinary::PACK_STATE *pState, XZip::ZIP_PACK_CONTEXT *pContext, ZIP_PACK_MEMBER *pMember, XBinary::PDSTRUCT *pPdStruct)
+{
+    if (!pMember->bValid) return false;
 
-    QTemporaryFile compressedPayload;
-    QTemporaryFile encryptedPayload;
-    QIODevice *pPayload = &stagedSource;
-    qint64 nPayloadSize = nStagedSize;
+    return zipAppendMemberPayload(pState, pContext, pMember, nullptr, pMember->baPayload.size(), pPdStruct);
+}
+
+// Compresses (or stores) pSource into pDest, computing the CRC over the bytes as they are read.
+// A member of unknown size is read to the end of the source and gets its size from the count.
+bool zipWriteMemberPayload(QIODevice *pSource, QIODevice *pDest, ZIP_PACK_MEMBER *pMember, XBinary::PDSTRUCT *pPdStruct, qint64 *pnWritten)
+{
+    *pnWritten = 0;
+
+    const qint64 nInputLimit = pMember->record.nUncompressedSize;
 
-    if (zipFileRecord.method == CMETHOD_DEFLATE) {
-        if (!compressedPayload.open()) return false;
+    if (pMember->record.method != XZip::CMETHOD_STORE) {
         XBinary::DATAPROCESS_STATE compressState = {};
-        compressState.pDeviceInput = &stagedSource;
-        compressState.pDeviceOutput = &compressedPayload;
+        compressState.pDeviceInput = pSource;
+        compressState.pDeviceOutput = pDest;
         compressState.nInputOffset = 0;
-        compressState.nInputLimit = nStagedSize;
-        if (!XDeflateDecoder::compress(&compressState, pPdStruct, nCompressionLevel) ||
-            !compressedPayload.flush() || !XBinary::isPdStructNotCanceled(pPdStruct)) {
-            return false;
+        compressState.nInputLimit = nInputLimit;
+
+        bool bResult = false;
+        if (pMember->record.method == XZip::CMETHOD_DEFLATE) {
+            bResult = XDeflateDecoder::compressParallel(&compressState, pPdStruct, pMember->nCompressionLevel, 0, &(pMember->record.nCRC32));
+        } else if (pMember->record.method == XZip::CMETHOD_LZMA) {
+            bResult = XLZMADecoder::compress(&compressState, pPdStruct, pMember->nCompressionLevel, &(pMember->record.nCRC32));
+        } else if (pMember->record.method == XZip::CMETHOD_ZSTD) {
+            bResult = XZstdDecoder::compress(&compressState, pPdStruct, pMember->nCompressionLevel, &(pMember->record.nCRC32));
         }
-        nPayloadSize = compressedPayload.size();
-        if ((nPayloadSize < 0) || !compressedPayload.seek(0)) return false;
-        pPayload = &compressedPayload;
+        *pnWritten = compressState.nCountOutput;
+        pMember->record.nUncompressedSize = compressState.nCountInput;
+        return bResult && ((nInputLimit == -1) || (compressState.nCountInput == nInputLimit));
+    }
+
+    const qint32 nBufferSize = 0x10000;
+    char *pBuffer = new (std::nothrow) char[nBufferSize];
+    if (!pBuffer) return false;
+
+    qint64 nRemaining = nInputLimit;
+    qint64 nTotal = 0;
+    quint32 nCRC = 0xFFFFFFFF;
+    bool bResult = true;
+    while ((nRemaining != 0) && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        const qint64 nChunkSize = (nRemaining < 0) ? nBufferSize : qMin<qint64>(nRemaining, nBufferSize);
+        const qint64 nRead = pSource->read(pBuffer, nChunkSize);
+        if ((nRead == 0) && (nRemaining < 0) && pSource->atEnd()) break;
+
+        qint64 nChunkWritten = 0;
+        if ((nRead <= 0) || (nRead > nChunkSize) || !zipWriteAll(pDest, pBuffer, nRead, pPdStruct, &nChunkWritten)) {
+            *pnWritten += nChunkWritten;
+            bResult = false;
+            break;
+        }
+        *pnWritten += nChunkWritten;
+        nCRC = XBinary::_getCRC32(pBuffer, (qint32)nRead, nCRC, XBinary::_getCRC32Table_EDB88320());
+        nTotal += nRead;
+        if (nRemaining > 0) nRemaining -= nRead;
     }
 
-    if (bEncrypt) {
-        if (!encryptedPayload.open() || !pPayload->seek(0)) return false;
+    delete[] pBuffer;
+    pMember->record.nCRC32 = nCRC ^ 0xFFFFFFFF;
+    pMember->record.nUncompressedSize = nTotal;
+    return bResult && (nRemaining <= 0) && XBinary::isPdStructNotCanceled(pPdStruct);
+}
+
+// Large members go straight from the source into the archive. A seekable destination gets its
+// local header patched afterwards; a sequential one, or PACK_PROP_STREAMING, gets bit 3 and a
+// trailing data descriptor instead. Members that may reach 4 GB carry a ZIP64 extra from the start.
+bool zipAppendStreamedMember(XBinary::PACK_STATE *pState, XZip::ZIP_PACK_CONTEXT *pContext, ZIP_PACK_MEMBER *pMember, XBinary::PDSTRUCT *pPdStruct)
+{
+    if (!zipCanAddMember(pState, pContext) || !XBinary::isPdStructNotCanceled(pPdStruct)) return false;
+
+    QFile file;
+    QIODevice *pSource = pMember->pSource;
+    if (!pSource) {
+        file.setFileName(pMember->sFilePath);
+        if (!file.open(QIODevice::ReadOnly) || (file.size() != pMember->record.nUncompressedSize)) return false;
+        pSource = &file;
+    }
+
+    if (!pMember->sPassword.isEmpty()) {
+        // ZipCrypto needs the CRC in its header before the payload: spill the compressed data once
+        QTemporaryFile compressedPayload;
+        QTemporaryFile encryptedPayload;
+        qint64 nCompressedSize = 0;
+        if (!compressedPayload.open() || !zipWriteMemberPayload(pSource, &compressedPayload, pMember, pPdStruct, &nCompressedSize) ||
+            !compressedPayload.flush() || !compressedPayload.seek(0) || !encryptedPayload.open()) {
+            return false;
+        }
+
         XBinary::DATAPROCESS_STATE encryptState = {};
-        encryptState.pDeviceInput = pPayload;
+        encryptState.pDeviceInput = &compressedPayload;
         encryptState.pDeviceOutput = &encryptedPayload;
         encryptState.nInputOffset = 0;
-        encryptState.nInputLimit = nPayloadSize;
-        if (!XZipCryptoDecoder::encrypt(&encryptState, sPassword, zipFileRecord.nCRC32, pPdStruct) ||
-            !encryptedPayload.flush() || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        encryptState.nInputLimit = nCompressedSize;
+        if (!XZipCryptoDecoder::encrypt(&encryptState, pMember->sPassword, pMember->record.nCRC32, pPdStruct) || !encryptedPayload.flush() ||
+            !encryptedPayload.seek(0) || !XBinary::isPdStructNotCanceled(pPdStruct)) {
             return false;
         }
-        nPayloadSize = encryptedPayload.size();
-        if ((nPayloadSize < 0) || !encryptedPayload.seek(0)) return false;
-        pPayload = &encryptedPayload;
-    } else if (!pPayload->seek(0)) {
-        return false;
+
+        return zipAppendMemberPayload(pState, pContext, pMember, &encryptedPayload, encryptedPayload.size(), pPdStruct);
     }
 
-    if ((quint64)nPayloadSize >= (std::numeric_limits<quint32>::max)()) return false;
-    zipFileRecord.nCompressedSize = nPayloadSize;
-    zipFileRecord.nHeaderOffset = pState->nCurrentOffset;
-    zipFileRecord.nDataOffset = pState->nCurrentOffset + (qint64)sizeof(LOCALFILEHEADER) + baFileName.size();
-
-    const qint64 nRecordSize = (qint64)sizeof(LOCALFILEHEADER) + baFileName.size() + nPayloadSize;
-    if ((nRecordSize <= 0) ||
-        ((quint64)nRecordSize >= ((quint64)(std::numeric_limits<quint32>::max)() -
-                                  (quint64)pContext->nCurrentOffset))) return false;
-
-    LOCALFILEHEADER localFileHeader = {};
-    localFileHeader.nSignature = SIGNATURE_LFD;
-    localFileHeader.nMinVersion = zipFileRecord.nMinVersion;
-    localFileHeader.nMinOS = zipFileRecord.nMinOS;
-    localFileHeader.nFlags = zipFileRecord.nFlags;
-    localFileHeader.nMethod = zipFileRecord.method;
-    localFileHeader.nLastModTime = nDosTime;
-    localFileHeader.nLastModDate = nDosDate;
-    localFileHeader.nCRC32 = zipFileRecord.nCRC32;
-    localFileHeader.nCompressedSize = (quint32)zipFileRecord.nCompressedSize;
-    localFileHeader.nUncompressedSize = (quint32)zipFileRecord.nUncompressedSize;
-    localFileHeader.nFileNameLength = (quint16)baFileName.size();
-
-    if (pListZipFileRecords->size() >= (std::numeric_limits<quint16>::max)()) {
-        return false;
+    QIODevice *pDevice = pState->pDevice;
+    const bool bDataDescriptor = pDevice->isSequential() || pState->mapProperties.value(XArchive::PACK_PROP_STREAMING, false).toBool();
+    XZip::ZIPFILE_RECORD &record = pMember->record;
+
+    if (bDataDescriptor) {
+        record.nFlags |= ZIP_FLAG_DATADESCRIPTOR;
     }
-    pListZipFileRecords->reserve(pListZipFileRecords->size() + 1);
+
+    // The extra field length is fixed once the header is out, so the decision is made up front
+    record.bZip64 = (record.nUncompressedSize < 0) || (record.nUncompressedSize >= N_ZIP64_STREAMED_MEMBER_SIZE);
+
     const qint64 nStartPosition = pContext->nCurrentOffset;
+    const qint64 nLocalHeaderSize = zipGetLocalHeaderSize(record, pMember->baFileName.size());
+    record.nHeaderOffset = nStartPosition;
+    record.nDataOffset = nStartPosition + nLocalHeaderSize;
+    record.nCompressedSize = 0;
+    zipUpdateZip64Version(&record);
+
+    pContext->pListZipFileRecords->reserve(pContext->pListZipFileRecords->size() + 1);
+
     qint64 nRecordWritten = 0;
     qint64 nPartWritten = 0;
-    bool bWriteOK = zipWriteAll(pState->pDevice, reinterpret_cast<const char *>(&localFileHeader),
-                                sizeof(localFileHeader), pPdStruct, &nPartWritten);
+    bool bWriteOK = zipWriteLocalFileHeader(pDevice, record, pMember->baFileName, pPdStruct, &nPartWritten);
     nRecordWritten += nPartWritten;
     if (bWriteOK) {
-        bWriteOK = zipWriteAll(pState->pDevice, baFileName.constData(), baFileName.size(),
-                               pPdStruct, &nPartWritten);
+        bWriteOK = zipWriteMemberPayload(pSource, pDevice, pMember, pPdStruct, &nPartWritten);
         nRecordWritten += nPartWritten;
+        record.nCompressedSize = nPartWritten;
+    }
+
+    if (bWriteOK && !record.bZip64 && (zipIsZip64Value(record.nCompressedSize) || zipIsZip64Value(record.nUncompressedSize))) {
+        bWriteOK = false;
     }
+
+    // ZIP64 descriptors carry 8-byte sizes
+    const qint64 nTrailerSize = bDataDescriptor ? (record.bZip64 ? 24 : 16) : 0;
+    const qint64 nRecordSize = nLocalHeaderSize + record.nCompressedSize + nTrailerSize;
+
     if (bWriteOK) {
-        bWriteOK = zipCopyExactly(pPayload, pState->pDevice, nPayloadSize, pPdStruct, &nPartWritten);
-        nRecordWritten += nPartWritten;
+        if (bDataDescriptor) {
+            QByteArray baDescriptor;
+            appendZipLE(&baDescriptor, ZIP_SIGNATURE_DATADESCRIPTOR, 4);
+            appendZipLE(&baDescriptor, record.nCRC32, 4);
+            appendZipLE(&baDescriptor, (quint64)record.nCompressedSize, record.bZip64 ? 8 : 4);
+            appendZipLE(&baDescriptor, (quint64)record.nUncompressedSize, record.bZip64 ? 8 : 4);
+            bWriteOK = zipWriteAll(pDevice, baDescriptor.constData(), baDescriptor.size(), pPdStruct, &nPartWritten);
+            nRecordWritten += nPartWritten;
+        } else {
+            const qint64 nEndPosition = nStartPosition + nRecordSize;
+            bWriteOK = pDevice->seek(nStartPosition) && zipWriteLocalFileHeader(pDevice, record, pMember->baFileName, pPdStruct) &&
+                       pDevice->seek(nEndPosition);
+        }
     }
+
     if (!bWriteOK || !XBinary::isPdStructNotCanceled(pPdStruct)) {
         zipMarkPackWriteFailure(pState, pContext, nStartPosition, nRecordWritten);
         return false;
     }
 
-    pListZipFileRecords->append(zipFileRecord);
-    pContext->nCurrentOffset = nStartPosition + nRecordSize;
-    pContext->nNumberOfRecords = pListZipFileRecords->size();
-    pState->nCurrentOffset = pContext->nCurrentOffset;
-    pState->nNumberOfRecords = pContext->nNumberOfRecords;
+    zipCommitMember(pState, pContext, record, nStartPosition + nRecordSize);
     return true;
 }
 
+bool zipAppendMember(XBinary::PACK_STATE *pState, XZip::ZIP_PACK_CONTEXT *pContext, ZIP_PACK_MEMBER *pMember, XBinary::PDSTRUCT *pPdStruct)
+{
+    if (!pMember->pSource && (pMember->record.nUncompressedSize < N_ZIP_BUFFERED_MEMBER_SIZE)) {
+        zipCompressMemberToBuffer(pMember, pPdStruct);
+        return zipAppendBufferedMember(pState, pContext, pMember, pPdStruct);
+    }
+
+    return zipAppendStreamedMember(pState, pContext, pMember, pPdStruct);
+}
+
+// Runs of small members are compressed concurrently and appended in submission order;
+// a large member ends the run and is streamed by the calling thread.
+bool zipAppendMembers(XBinary::PACK_STATE *pState, XZip::ZIP_PACK_CONTEXT *pContext, QVector<ZIP_PACK_MEMBER> *pMembers, XBinary::PDSTRUCT *pPdStruct)
+{
+    const qint32 nNumberOfThreads = qMax(1, QThread::idealThreadCount());
+    const qint32 nBatchSize = nNumberOfThreads * N_ZIP_MEMBERS_PER_THREAD;
+    const qint32 nNumberOfMembers = pMembers->size();
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, nNumberOfThreads - 1));
+
+    qint32 nIndex = 0;
+
+    while ((nIndex < nNumberOfMembers) && XBinary::isPdStructNotCanceled(pPdStruct)) {
+        ZIP_PACK_MEMBER *pMember = &((*pMembers)[nIndex]);
+
+        if (pMember->record.nUncompressedSize >= N_ZIP_BUFFERED_MEMBER_SIZE) {
+            if (!zipAppendStreamedMember(pState, pContext, pMember, pPdStruct)) return false;
+            nIndex++;
+            continue;
+        }
+
+        qint32 nBatchEnd = nIndex;
+        qint64 nBatchInput = 0;
+
+        while ((nBatchEnd < nNumberOfMembers) && ((nBatchEnd - nIndex) < nBatchSize)) {
+            const qint64 nSize = pMembers->at(nBatchEnd).record.nUncompressedSize;
+            if ((nSize >= N_ZIP_BUFFERED_MEMBER_SIZE) || ((nBatchEnd > nIndex) && ((nBatchInput + nSize) > N_ZIP_BATCH_INPUT_SIZE))) break;
+            nBatchInput += nSize;
+            nBatchEnd++;
+        }
+
+        const qint32 nNumberOfJobs = nBatchEnd - nIndex;
+        ZIP_PACK_MEMBER *pJobs = pMembers->data() + nIndex;
+
+        {
+            QAtomicInt nNextMember(0);
+            const qint32 nNumberOfWorkers = qMin(nNumberOfThreads, nNumberOfJobs) - 1;
+
+            for (qint32 i = 0; i < nNumberOfWorkers; i++) {
+                threadPool.start(new XZipMemberWorker(pJobs, nNumberOfJobs, &nNextMember, pPdStruct));
+            }
+
+            zipRunMemberJobs(pJobs, nNumberOfJobs, &nNextMember, pPdStruct);
+
+            threadPool.waitForDone();
+        }
+
+        for (qint32 i = 0; i < nNumberOfJobs; i++) {
+            if (!zipAppendBufferedMember(pState, pContext, &(pJobs[i]), pPdStruct)) return false;
+        }
+
+        nIndex = nBatchEnd;
+    }
+
+    return XBinary::isPdStructNotCanceled(pPdStruct);
+}
+}  // namespace
+
+bool XZip::addDevice(PACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct)
+{
+    // Only file devices carry a name; other devices go through the named overload
+    QFileDevice *pFileDevice = qobject_cast<QFileDevice *>(pDevice);
+    if (!pFileDevice || pFileDevice->fileName().isEmpty()) {
+        return false;
+    }
+
+    return addDevice(pState, pDevice, QFileInfo(pFileDevice->fileName()).fileName(), pPdStruct);
+}
+
+bool XZip::addDevice(PACK_STATE *pState, QIODevice *pDevice, const QString &sRecordName, PDSTRUCT *pPdStruct)
+{
+    if (!pState || !pState->pDevice || !pState->pDevice->isWritable() || !pState->pContext || !pDevice || !pDevice->isReadable() ||
+        (pDevice == pState->pDevice) || !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return false;
+    }
+
+    ZIP_PACK_CONTEXT *pContext = static_cast<ZIP_PACK_CONTEXT *>(pState->pContext);
+    if (!zipCanAddMember(pState, pContext)) {
+        return false;
+    }
+
+    ZIP_PACK_MEMBER member = {};
+    if (!zipInitMember(pState, sRecordName, &member)) {
+        return false;
+    }
+
+    // The whole device is packed; a sequential one is read once to its end and its size is learned on the way
+    if (!pDevice->isSequential()) {
+        if (!pDevice->seek(0)) return false;
+        member.record.nUncompressedSize = pDevice->size();
+    }
+    member.pSource = pDevice;
+
+    return zipAppendStreamedMember(pState, pContext, &member, pPdStruct);
+}
+
+bool XZip::addFile(PACK_STATE *pState, const QString &sFilePath, PDSTRUCT *pPdStruct)
+{
+    if (!pState || !pState->pDevice || !pState->pDevice->isWritable() || !pState->pContext ||
+        !XBinary::isPdStructNotCanceled(pPdStruct)) {
+        return false;
+    }
+
+    ZIP_PACK_CONTEXT *pContext = static_cast<ZIP_PACK_CONTEXT *>(pState->pContext);
+    if (!zipCanAddMember(pState, pContext)) {
+        return false;
+    }
+
+    ZIP_PACK_MEMBER member = {};
+    if (!zipPrepareMember(pState, sFilePath, &member)) {
+        return false;
+    }
+
+    return zipAppendMember(pState, pContext, &member, pPdStruct);
+}
+
 static void zipRestoreBasePath(XBinary::PACK_STATE *pState, bool bRestoreBasePath, bool bHadBasePath, const QVariant &originalBasePath)
 {
     if (!bRestoreBasePath) return;
@@ -2474,6 +3227,9 @@ bool XZip::addFolder(PACK_STATE *pState, const QString &sDirectoryPath, PDSTRUCT
 
     qint32 nNumberOfFiles = listFiles.count();
 
+    QVector<ZIP_PACK_MEMBER> vecMembers;
+    vecMembers.reserve(nNumberOfFiles);
+
     for (qint32 i = 0; (i < nNumberOfFiles) && XBinary::isPdStructNotCanceled(pPdStruct); i++) {
         QString sFilePath = listFiles.at(i);
         QFileInfo fileInfo(sFilePath);
@@ -2482,14 +3238,18 @@ bool XZip::addFolder(PACK_STATE *pState, const QString &sDirectoryPath, PDSTRUCT
             continue;
         }
 
-        if (!addFile(pState, sFilePath, pPdStruct)) {
+        ZIP_PACK_MEMBER member = {};
+        if (!zipPrepareMember(pState, sFilePath, &member)) {
             zipRestoreBasePath(pState, bRestoreBasePath, bHadBasePath, originalBasePath);
             return false;
         }
+        vecMembers.append(member);
     }
 
+    const bool bResult = zipAppendMembers(pState, pContext, &vecMembers, pPdStruct);
+
     zipRestoreBasePath(pState, bRestoreBasePath, bHadBasePath, originalBasePath);
-    return XBinary::isPdStructNotCanceled(pPdStruct);
+    return bResult && XBinary::isPdStructNotCanceled(pPdStruct);
 }
 
 bool XZip::finishPack(PACK_STATE *pState, PDSTRUCT *pPdStruct)
@@ -2598,6 +3358,11 @@ QMap<XBinary::UNPACK_PROP, QVariant> XZip::getDefaultUnpackProperties()
     return result;
 }
 
+bool XZip::isParallelUnpackSupported()
+{
+    return true;
+}
+
 bool XZip::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct)
 {
     QPointer<XZip> guardedArchive(this);
@@ -2658,15 +3423,15 @@ bool XZip::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &m
     }
     bool bIsECD = false;
     qint64 nCDFHOffset = 0;
+    CENTRALDIRECTORY_INFO centralDirectoryInfo = {};
 
     if (nECDOffset != -1) {
-        nCDFHOffset = (qint64)guardedArchive->read_uint32(
-            nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD,
-                                  nOffsetToCentralDirectory));
-        if (!guardedArchive) {
+        const bool bCentralDirectoryInfo = guardedArchive->_getCentralDirectoryInfo(nECDOffset, &centralDirectoryInfo, pPdStruct);
+        if (!guardedArchive || !bCentralDirectoryInfo) {
             *pState = UNPACK_STATE();
             return false;
         }
+        nCDFHOffset = centralDirectoryInfo.nOffset;
 
         const quint32 nSignature = guardedArchive->read_uint32(nCDFHOffset);
         if (!guardedArchive) {
@@ -2680,14 +3445,11 @@ bool XZip::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &m
 
     if (bIsECD) {
         pState->nCurrentOffset = nCDFHOffset;
-        pState->nNumberOfRecords = guardedArchive->read_uint16(
-            nECDOffset + offsetof(ENDOFCENTRALDIRECTORYRECORD,
-                                  nTotalNumberOfRecords));
-        if (!guardedArchive) {
-            *pState = UNPACK_STATE();
-            return false;
+        // UNPACK_STATE counts records in a qint32; a larger ZIP64 count is rejected, not truncated.
+        bResult = (centralDirectoryInfo.nNumberOfRecords > 0) && (centralDirectoryInfo.nNumberOfRecords <= (std::numeric_limits<qint32>::max)());
+        if (bResult) {
+            pState->nNumberOfRecords = (qint32)centralDirectoryInfo.nNumberOfRecords;
         }
-        bResult = (pState->nNumberOfRecords > 0);
     } else if (nECDOffset == -1) {
         // Fallback: count complete local file records only when no authenticated
         // central directory is available. If an EOCD signature follows those
@@ -2720,7 +3482,7 @@ bool XZip::initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &m
         }
         pContext->bIsECD = bIsECD;
         pContext->nCentralDirectoryOffset = bIsECD ? nCDFHOffset : 0;
-        pContext->nCentralDirectoryEnd = bIsECD ? nECDOffset : 0;
+        pContext->nCentralDirectoryEnd = bIsECD ? centralDirectoryInfo.nEnd : 0;
         pState->mapUnpackProperties = mapProperties;
         pState->pContext = pContext;
         if (!guardedArchive->validateAndFinalizeUnpackSource(
@@ -2774,8 +3536,8 @@ XBinary::ARCHIVERECORD XZip::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStru
         quint16 nLastModTime = 0;
         quint16 nLastModDate = 0;
         quint32 nCRC32 = 0;
-        quint32 nCompressedSize = 0;
-        quint32 nUncompressedSize = 0;
+        qint64 nCompressedSize = 0;
+        qint64 nUncompressedSize = 0;
         quint32 nExternalFileAttributes = 0;
         // Extra field and file comment information
         qint64 nExtraFieldOffset = 0;
@@ -2798,9 +3560,20 @@ XBinary::ARCHIVERECORD XZip::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStru
                 return XBinary::ARCHIVERECORD();
             qint64 nCentralRecordSize = sizeof(CENTRALDIRECTORYFILEHEADER) + (qint64)cdfh.nFileNameLength +
                                        (qint64)cdfh.nExtraFieldLength + (qint64)cdfh.nFileCommentLength;
-            if ((nCentralRecordSize > (pContext->nCentralDirectoryEnd - pState->nCurrentOffset)) ||
-                ((qint64)cdfh.nOffsetToLocalFileHeader >
-                 (pContext->nCentralDirectoryOffset - (qint64)sizeof(LOCALFILEHEADER)))) {
+            if (nCentralRecordSize > (pContext->nCentralDirectoryEnd - pState->nCurrentOffset)) {
+                return XBinary::ARCHIVERECORD();
+            }
+
+            nExtraFieldOffset = pState->nCurrentOffset + sizeof(CENTRALDIRECTORYFILEHEADER) + cdfh.nFileNameLength;
+            nExtraFieldLength = cdfh.nExtraFieldLength;
+
+            nCompressedSize = cdfh.nCompressedSize;
+            nUncompressedSize = cdfh.nUncompressedSize;
+            nLocalHeaderOffset = cdfh.nOffsetToLocalFileHeader;
+            const bool bZip64Read = guardedArchive->_readZip64Values(nExtraFieldOffset, nExtraFieldLength, &nUncompressedSize,
+                                                                     &nCompressedSize, &nLocalHeaderOffset, pPdStruct);
+            if (!guardedArchive || !guardedSource || !bZip64Read ||
+                (nLocalHeaderOffset > (pContext->nCentralDirectoryOffset - (qint64)sizeof(LOCALFILEHEADER)))) {
                 return XBinary::ARCHIVERECORD();
             }
 
@@ -2813,14 +3586,8 @@ XBinary::ARCHIVERECORD XZip::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStru
             nLastModTime = cdfh.nLastModTime;
             nLastModDate = cdfh.nLastModDate;
             nCRC32 = cdfh.nCRC32;
-            nCompressedSize = cdfh.nCompressedSize;
-            nUncompressedSize = cdfh.nUncompressedSize;
-
-            nLocalHeaderOffset = cdfh.nOffsetToLocalFileHeader;
             nExternalFileAttributes = cdfh.nExternalFileAttributes;
 
-            nExtraFieldOffset = pState->nCurrentOffset + sizeof(CENTRALDIRECTORYFILEHEADER) + cdfh.nFileNameLength;
-            nExtraFieldLength = cdfh.nExtraFieldLength;
             nFileCommentOffset = nExtraFieldOffset + nExtraFieldLength;
             nFileCommentLength = cdfh.nFileCommentLength;
             if (!guardedArchive->_readFileName(
@@ -2847,8 +3614,18 @@ XBinary::ARCHIVERECORD XZip::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStru
 
         qint64 nLocalDataOffset =
             nLocalHeaderOffset + sizeof(LOCALFILEHEADER) + (qint64)lfh.nFileNameLength + (qint64)lfh.nExtraFieldLength;
-        quint32 nValidatedCompressedSize = bIsECD ? nCompressedSize : lfh.nCompressedSize;
-        if ((nLocalDataOffset > nLocalLimit) || ((qint64)nValidatedCompressedSize > (nLocalLimit - nLocalDataOffset))) {
+        qint64 nLocalCompressedSize = lfh.nCompressedSize;
+        qint64 nLocalUncompressedSize = lfh.nUncompressedSize;
+        if (!bIsECD) {
+            const bool bZip64Read =
+                guardedArchive->_readZip64Values(nLocalHeaderOffset + sizeof(LOCALFILEHEADER) + lfh.nFileNameLength, lfh.nExtraFieldLength,
+                                                 &nLocalUncompressedSize, &nLocalCompressedSize, nullptr, pPdStruct);
+            if (!guardedArchive || !guardedSource || !bZip64Read) {
+                return XBinary::ARCHIVERECORD();
+            }
+        }
+        const qint64 nValidatedCompressedSize = bIsECD ? nCompressedSize : nLocalCompressedSize;
+        if ((nLocalDataOffset > nLocalLimit) || (nValidatedCompressedSize > (nLocalLimit - nLocalDataOffset))) {
             return XBinary::ARCHIVERECORD();
         }
 
@@ -2860,8 +3637,8 @@ XBinary::ARCHIVERECORD XZip::infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStru
             nMethod = lfh.nMethod;
             nLastModTime = lfh.nLastModTime;
             nLastModDate = lfh.nLastModDate;
-            nCompressedSize = lfh.nCompressedSize;
-            nUncompressedSize = lfh.nUncompressedSize;
+            nCompressedSize = nLocalCompressedSize;
+            nUncompressedSize = nLocalUncompressedSize;
 
             nExtraFieldOffset = nLocalHeaderOffset + sizeof(LOCALFILEHEADER) + lfh.nFileNameLength;
             nExtraFieldLength = lfh.nExtraFieldLength;
@@ -3109,8 +3886,14 @@ bool XZip::moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct)
             LOCALFILEHEADER lfh = guardedArchive->read_LOCALFILEHEADER(
                 pState->nCurrentOffset, pPdStruct);
             if (!guardedArchive || !guardedSource) return false;
+            qint64 nCompressedSize = lfh.nCompressedSize;
+            qint64 nUncompressedSize = lfh.nUncompressedSize;
+            const bool bZip64Read = guardedArchive->_readZip64Values(
+                pState->nCurrentOffset + sizeof(LOCALFILEHEADER) + lfh.nFileNameLength, lfh.nExtraFieldLength, &nUncompressedSize,
+                &nCompressedSize, nullptr, pPdStruct);
+            if (!guardedArchive || !guardedSource || !bZip64Read) return false;
             qint64 nRecordSize =
-                sizeof(LOCALFILEHEADER) + (qint64)lfh.nFileNameLength + (qint64)lfh.nExtraFieldLength + (qint64)lfh.nCompressedSize;
+                sizeof(LOCALFILEHEADER) + (qint64)lfh.nFileNameLength + (qint64)lfh.nExtraFieldLength + nCompressedSize;
             if (nRecordSize > (pState->nTotalSize - pState->nCurrentOffset)) return false;
             pState->nCurrentOffset += nRecordSize;
         }
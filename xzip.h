@@ -39,7 +39,9 @@ public:
     enum SIGNATURE {
         SIGNATURE_ECD = 0x06054B50,
         SIGNATURE_CFD = 0x02014B50,
-        SIGNATURE_LFD = 0x04034B50
+        SIGNATURE_LFD = 0x04034B50,
+        SIGNATURE_ECD64 = 0x06064B50,
+        SIGNATURE_ECDL64 = 0x07064B50
     };
 
     enum STRUCTID {
@@ -107,6 +109,9 @@ public:
     static const quint16 ZIP_AES_EXTRA_FIELD_DATA_SIZE = 0x0007;
     static const quint16 ZIP_AES_VENDOR_ID_AE = 0x4541;  // 'AE' in little-endian
 
+    // ZIP64 extended information extra field header ID
+    static const quint16 ZIP_ZIP64_EXTRA_FIELD_HEADER_ID = 0x0001;
+
 #pragma pack(push)
 #pragma pack(1)
     struct LOCALFILEHEADER {
@@ -138,6 +143,27 @@ public:
         // Comment
     };
 
+    struct ZIP64ENDOFCENTRALDIRECTORYRECORD {
+        quint32 nSignature;     // SIGNATURE_ECD64
+        quint64 nSizeOfRecord;  // Size of the remaining record
+        quint16 nVersion;
+        quint16 nMinVersion;
+        quint32 nDiskNumber;
+        quint32 nStartDisk;
+        quint64 nDiskNumberOfRecords;
+        quint64 nTotalNumberOfRecords;
+        quint64 nSizeOfCentralDirectory;
+        quint64 nOffsetToCentralDirectory;
+        // Extensible data
+    };
+
+    struct ZIP64ENDOFCENTRALDIRECTORYLOCATOR {
+        quint32 nSignature;  // SIGNATURE_ECDL64
+        quint32 nStartDisk;
+        quint64 nOffsetToZip64EndOfCentralDirectory;
+        quint32 nTotalNumberOfDisks;
+    };
+
     struct CENTRALDIRECTORYFILEHEADER {
         quint32 nSignature;  // SIGNATURE_CFD
         quint8 nVersion;
@@ -196,6 +222,7 @@ public:
         qint64 nHeaderOffset;
         qint64 nDataOffset;
         quint32 nExternalFileAttributes;
+        bool bZip64;  // Sizes are carried by a ZIP64 extra field in the local and central headers
         // TODO Comment!!!
     };
 
@@ -215,6 +242,14 @@ public:
         qint64 nCentralDirectoryEnd;
     };
 
+    // Central directory location from the classic end record, or from the ZIP64 one when its locator is present
+    struct CENTRALDIRECTORY_INFO {
+        qint64 nOffset;
+        qint64 nSize;
+        qint64 nNumberOfRecords;
+        qint64 nEnd;  // First byte after the central directory: the ZIP64 end record if present, otherwise the classic one
+    };
+
     explicit XZip(QIODevice *pDevice = nullptr);
     virtual bool isValid(PDSTRUCT *pPdStruct = nullptr) override;
     static bool isValid(QIODevice *pDevice, PDSTRUCT *pPdStruct = nullptr);
@@ -261,6 +296,8 @@ public:
     virtual _MEMORY_MAP getMemoryMap(MAPMODE mapMode = MAPMODE_UNKNOWN, PDSTRUCT *pPdStruct = nullptr) override;
 
     virtual bool initPack(PACK_STATE *pState, QIODevice *pDevice, const QMap<PACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr) override;
+    virtual bool addDevice(PACK_STATE *pState, QIODevice *pDevice, PDSTRUCT *pPdStruct = nullptr) override;
+    bool addDevice(PACK_STATE *pState, QIODevice *pDevice, const QString &sRecordName, PDSTRUCT *pPdStruct = nullptr);
     virtual bool addFile(PACK_STATE *pState, const QString &sFilePath, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool addFolder(PACK_STATE *pState, const QString &sDirectoryPath, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool finishPack(PACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
@@ -268,6 +305,7 @@ public:
     virtual QList<PM_INFO> packImplemented() override;
 
     virtual QMap<UNPACK_PROP, QVariant> getDefaultUnpackProperties() override;
+    virtual bool isParallelUnpackSupported() override;
     virtual bool initUnpack(UNPACK_STATE *pState, const QMap<UNPACK_PROP, QVariant> &mapProperties, PDSTRUCT *pPdStruct = nullptr) override;
     virtual ARCHIVERECORD infoCurrent(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
     virtual bool moveToNext(UNPACK_STATE *pState, PDSTRUCT *pPdStruct = nullptr) override;
@@ -292,6 +330,9 @@ protected:
                               bool bRequireNonEmpty = false);
     qint32 _getNumberOfLocalFileHeaders(qint64 nOffset, qint64 nSize, qint64 *pnRealSize, PDSTRUCT *pPdStruct);
     bool _isECDSignaturePresent(qint64 nOffset, PDSTRUCT *pPdStruct);
+    bool _getCentralDirectoryInfo(qint64 nECDOffset, CENTRALDIRECTORY_INFO *pInfo, PDSTRUCT *pPdStruct);
+    bool _readZip64Values(qint64 nExtraFieldOffset, qint64 nExtraFieldLength, qint64 *pnUncompressedSize, qint64 *pnCompressedSize,
+                          qint64 *pnLocalHeaderOffset, PDSTRUCT *pPdStruct);
 private:
     INTERNAL_INFO m_internalInfo;
 };